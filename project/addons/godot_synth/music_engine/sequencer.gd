@@ -1,11 +1,18 @@
-extends Node
+# Turns generated note lists into SynthSequencer patterns
+class_name SequencerPatterns
+extends RefCounted
 
 
-# Called when the node enters the scene tree for the first time.
-func _ready() -> void:
-	pass # Replace with function body.
-
-
-# Called every frame. 'delta' is the elapsed time since the previous frame.
-func _process(delta: float) -> void:
-	pass
+# Notes from MotifGenerator play one after another, each for its "duration" in beats.
+# A negative duration is a rest.
+static func from_motif(motif: Array[Dictionary], steps_per_beat: int = 4) -> PackedFloat32Array:
+	var pattern := PackedFloat32Array()
+	var step := 0.0
+	for note in motif:
+		var length: float = note.get("duration", 1.0) * steps_per_beat
+		if length < 0.0:
+			step -= length
+			continue
+		pattern.append_array([step, note.get("midi_note", 60), note.get("velocity", 1.0), note.get("articulation", 1.0), length])
+		step += length
+	return pattern
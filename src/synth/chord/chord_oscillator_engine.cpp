@@ -1,8 +1,10 @@
 #include "chord_oscillator_engine.h"
+#include "../core/dsp_math.h"
 #include "../core/modulated_parameter.h"
 #include "../core/synth_note_context.h"
 #include "../core/wave_helper_cache.h"
 #include "chord_synth_configuration.h"
+#include <algorithm>
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/templates/pair.hpp>
@@ -10,6 +12,83 @@
 
 namespace godot {
 
+namespace {
+
+constexpr int MAX_NOTES = ChordOscillatorEngine::MAX_CHORD_NOTES;
+
+// Scale factor to prevent clipping, fixed to keep a consistent volume per note
+constexpr float NOTE_GAIN = 0.5f;
+
+struct ChordShape {
+	int count;
+	int intervals[MAX_NOTES];
+};
+
+// Semitone intervals from the root for every ChordType, in enum order
+constexpr ChordShape CHORD_SHAPES[CHORD_MAX] = {
+	{ 3, { 0, 4, 7 } }, // CHORD_MAJOR
+	{ 3, { 0, 3, 7 } }, // CHORD_MINOR
+	{ 3, { 0, 3, 6 } }, // CHORD_DIMINISHED
+	{ 3, { 0, 4, 8 } }, // CHORD_AUGMENTED
+	{ 3, { 0, 2, 7 } }, // CHORD_SUSPENDED_2
+	{ 3, { 0, 5, 7 } }, // CHORD_SUSPENDED_4
+	{ 4, { 0, 4, 7, 11 } }, // CHORD_MAJOR_7
+	{ 4, { 0, 3, 7, 10 } }, // CHORD_MINOR_7
+	{ 4, { 0, 4, 7, 10 } }, // CHORD_DOMINANT_7
+	{ 4, { 0, 3, 6, 9 } }, // CHORD_DIMINISHED_7
+	{ 4, { 0, 3, 6, 10 } }, // CHORD_HALF_DIMINISHED_7
+	{ 4, { 0, 4, 8, 10 } }, // CHORD_AUGMENTED_7
+	{ 4, { 0, 3, 7, 11 } }, // CHORD_MINOR_MAJOR_7
+	{ 4, { 0, 4, 7, 9 } }, // CHORD_MAJOR_6
+	{ 4, { 0, 3, 7, 9 } }, // CHORD_MINOR_6
+	{ 5, { 0, 4, 7, 10, 14 } }, // CHORD_DOMINANT_9
+	{ 5, { 0, 4, 7, 11, 14 } }, // CHORD_MAJOR_9
+	{ 5, { 0, 3, 7, 10, 14 } }, // CHORD_MINOR_9
+	{ 4, { 0, 4, 7, 14 } }, // CHORD_ADD_9
+};
+
+// Every chord voiced in every inversion, in ascending order
+struct ChordVoicings {
+	int offsets[CHORD_MAX][MAX_NOTES][MAX_NOTES];
+};
+
+constexpr ChordVoicings build_chord_voicings() {
+	ChordVoicings voicings = {};
+	for (int chord = 0; chord < CHORD_MAX; chord++) {
+		const ChordShape &shape = CHORD_SHAPES[chord];
+		for (int inversion = 0; inversion < shape.count; inversion++) {
+			// Move the lowest notes up an octave
+			int notes[MAX_NOTES] = {};
+			for (int i = 0; i < shape.count; i++) {
+				notes[i] = shape.intervals[i] + (i < inversion ? 12 : 0);
+			}
+
+			// Insertion sort to keep ascending order
+			for (int i = 1; i < shape.count; i++) {
+				int value = notes[i];
+				int j = i - 1;
+				while (j >= 0 && notes[j] > value) {
+					notes[j + 1] = notes[j];
+					j--;
+				}
+				notes[j + 1] = value;
+			}
+
+			for (int i = 0; i < shape.count; i++) {
+				voicings.offsets[chord][inversion][i] = notes[i];
+			}
+		}
+	}
+	return voicings;
+}
+
+constexpr ChordVoicings CHORD_VOICINGS = build_chord_voicings();
+
+static_assert(CHORD_VOICINGS.offsets[CHORD_MAJOR][1][2] == 12, "First inversion of a major triad ends on the octave");
+static_assert(CHORD_VOICINGS.offsets[CHORD_DOMINANT_9][1][3] == 12, "Inverted 9th chords must stay sorted");
+
+} // namespace
+
 void ChordOscillatorEngine::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_waveform", "type"), &ChordOscillatorEngine::set_waveform);
 	ClassDB::bind_method(D_METHOD("get_waveform"), &ChordOscillatorEngine::get_waveform);
@@ -32,7 +111,21 @@ ChordOscillatorEngine::ChordOscillatorEngine() :
 		cached_pulse_width(0.5f),
 		cached_detune(0.0f),
 		cached_output_gain(0.7f), // Reduce default gain to avoid clipping
-		root_note_only(false) { // Default to normal chord mode
+		root_note_only(false), // Default to normal chord mode
+		note_count(0),
+		current_chord_index(-1),
+		current_inversion(-1),
+		current_base_frequency(0.0f),
+		current_detune(0.0f),
+		current_sample_rate(0.0f),
+		current_table_pulse_width(-1.0f) {
+	for (int i = 0; i < MAX_CHORD_NOTES; i++) {
+		note_phases[i] = 0.0f;
+		note_increments[i] = 0.0f;
+		note_gains[i] = 0.0f;
+		note_tables[i] = nullptr;
+	}
+	set_waveform(waveform);
 }
 
 ChordOscillatorEngine::~ChordOscillatorEngine() {
@@ -40,133 +133,58 @@ ChordOscillatorEngine::~ChordOscillatorEngine() {
 
 float ChordOscillatorEngine::get_frequency_for_note(int note) const {
 	// A4 = 440Hz = MIDI note 69
-	return 440.0f * std::pow(2.0f, (note - 69) / 12.0f);
+	return DspMath::note_to_frequency(static_cast<float>(note));
 }
 
-std::vector<int> ChordOscillatorEngine::get_chord_intervals(int chord_type) const {
-	std::vector<int> intervals;
-
-	// Root note is always included (0 semitones from root)
-	intervals.push_back(0);
-
-	// Add intervals based on chord type
-	switch (chord_type) {
-		case CHORD_MAJOR:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			break;
-		case CHORD_MINOR:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(7); // Perfect fifth
-			break;
-		case CHORD_DIMINISHED:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(6); // Diminished fifth
-			break;
-		case CHORD_AUGMENTED:
-			intervals.push_back(4); // Major third
-			intervals.push_back(8); // Augmented fifth
-			break;
-		case CHORD_SUSPENDED_2:
-			intervals.push_back(2); // Major second
-			intervals.push_back(7); // Perfect fifth
-			break;
-		case CHORD_SUSPENDED_4:
-			intervals.push_back(5); // Perfect fourth
-			intervals.push_back(7); // Perfect fifth
-			break;
-		case CHORD_MAJOR_7:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(11); // Major seventh
-			break;
-		case CHORD_MINOR_7:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(10); // Minor seventh
-			break;
-		case CHORD_DOMINANT_7:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(10); // Minor seventh
-			break;
-		case CHORD_DIMINISHED_7:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(6); // Diminished fifth
-			intervals.push_back(9); // Diminished seventh
-			break;
-		case CHORD_HALF_DIMINISHED_7:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(6); // Diminished fifth
-			intervals.push_back(10); // Minor seventh
-			break;
-		case CHORD_AUGMENTED_7:
-			intervals.push_back(4); // Major third
-			intervals.push_back(8); // Augmented fifth
-			intervals.push_back(10); // Minor seventh
-			break;
-		case CHORD_MINOR_MAJOR_7:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(11); // Major seventh
-			break;
-		case CHORD_MAJOR_6:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(9); // Major sixth
-			break;
-		case CHORD_MINOR_6:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(9); // Major sixth
-			break;
-		case CHORD_DOMINANT_9:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(10); // Minor seventh
-			intervals.push_back(14); // Major ninth
-			break;
-		case CHORD_MAJOR_9:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(11); // Major seventh
-			intervals.push_back(14); // Major ninth
-			break;
-		case CHORD_MINOR_9:
-			intervals.push_back(3); // Minor third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(10); // Minor seventh
-			intervals.push_back(14); // Major ninth
-			break;
-		case CHORD_ADD_9:
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			intervals.push_back(14); // Major ninth (without seventh)
-			break;
-		default:
-			// Default to major triad
-			intervals.push_back(4); // Major third
-			intervals.push_back(7); // Perfect fifth
-			break;
-	}
+void ChordOscillatorEngine::update_chord_bank(int chord_index, int inversion, float base_frequency, float detune) {
+	const int *offsets = CHORD_VOICINGS.offsets[chord_index][inversion];
+	note_count = root_note_only ? 1 : CHORD_SHAPES[chord_index].count;
 
-	return intervals;
-}
+	for (int i = 0; i < MAX_CHORD_NOTES; i++) {
+		if (i >= note_count) {
+			// Silent slots keep the inner loop at a fixed width
+			note_increments[i] = 0.0f;
+			note_gains[i] = 0.0f;
+			continue;
+		}
 
-std::vector<int> ChordOscillatorEngine::apply_inversion(const std::vector<int> &intervals, int inversion) const {
-	std::vector<int> inverted = intervals;
+		// Semitone offset from the root plus a per-note detune in cents, to
+		// add richness and prevent cancellation between chord notes
+		float semitone_offset = root_note_only ? 0.0f : static_cast<float>(offsets[i]);
+		float fixed_detune = 3.0f + (i * 2.0f);
+		float user_detune = detune * 5.0f * (i + 1);
+		float cents = semitone_offset * 100.0f + fixed_detune + user_detune;
 
-	// Apply inversion (move notes up an octave)
-	if (inversion > 0 && inversion < intervals.size()) {
-		for (int i = 0; i < inversion; i++) {
-			inverted[i] += 12; // Move up an octave
-		}
+		note_increments[i] = base_frequency * DspMath::cents_to_ratio(cents) / sample_rate;
+		note_gains[i] = NOTE_GAIN;
+	}
+
+	current_chord_index = chord_index;
+	current_inversion = inversion;
+	current_base_frequency = base_frequency;
+	current_detune = detune;
+	current_sample_rate = sample_rate;
+}
 
-		// Sort to maintain ascending order
-		std::sort(inverted.begin(), inverted.end());
+void ChordOscillatorEngine::update_note_tables(float pulse_width) {
+	// Lookups only, set_waveform() built the tables. Without all of them every note is
+	// computed directly.
+	WaveHelperCache *cache = WaveHelperCache::get_singleton();
+	bool complete = cache != nullptr;
+	for (int i = 0; i < MAX_CHORD_NOTES; i++) {
+		note_tables[i] = cache ? cache->find_table(note_waveforms[i], pulse_width) : nullptr;
+		complete = complete && note_tables[i] != nullptr;
 	}
+	if (!complete) {
+		note_tables[0] = nullptr;
+	}
+	current_table_pulse_width = pulse_width;
+}
 
-	return inverted;
+void ChordOscillatorEngine::reset_chord_phases() {
+	for (int i = 0; i < MAX_CHORD_NOTES; i++) {
+		note_phases[i] = 0.0f;
+	}
 }
 
 void ChordOscillatorEngine::set_parameter(const String &name, const Ref<ModulatedParameter> &param) {
@@ -184,295 +202,130 @@ Dictionary ChordOscillatorEngine::get_parameters() const {
 	return parameters;
 }
 
-PackedFloat32Array ChordOscillatorEngine::process_block(int buffer_size, const Ref<SynthNoteContext> &context) {
-	// Create output buffer
-	PackedFloat32Array output_buffer;
-	output_buffer.resize(buffer_size);
-
+bool ChordOscillatorEngine::render_block(float *p_output, int p_count, double p_start_time, const Ref<SynthNoteContext> &context) {
 	if (!context.is_valid()) {
 		// Fill buffer with silence
-		std::fill(output_buffer.ptrw(), output_buffer.ptrw() + buffer_size, 0.0f);
-		UtilityFunctions::print("Silence buffer - No Context");
-		return output_buffer;
+		std::fill(p_output, p_output + p_count, 0.0f);
+		return false;
 	}
 
 	// If no note is playing, return silence
 	if (context->get_note() < 0 || context->get_velocity() <= 0.0f) {
-		std::fill(output_buffer.ptrw(), output_buffer.ptrw() + buffer_size, 0.0f);
-		UtilityFunctions::print("Silence buffer - note: " + String::num(context->get_note()) +
-				" velocity: " + String::num(context->get_velocity()));
-		return output_buffer;
+		std::fill(p_output, p_output + p_count, 0.0f);
+		return false;
+	}
+
+	// Phases persist across blocks and only restart on a new note
+	if (context->get_is_note_triggered()) {
+		reset_chord_phases();
 	}
 
+	// Look the parameters up once per block
+	Ref<ModulatedParameter> pitch_param = get_parameter(ChordSynthConfiguration::PARAM_PITCH);
+	Ref<ModulatedParameter> chord_param = get_parameter(ChordSynthConfiguration::PARAM_CHORD_TYPE);
+	Ref<ModulatedParameter> inversion_param = get_parameter(ChordSynthConfiguration::PARAM_INVERSION);
+	Ref<ModulatedParameter> amp_param = get_parameter(ChordSynthConfiguration::PARAM_AMPLITUDE);
+	Ref<ModulatedParameter> pw_param = get_parameter(ChordSynthConfiguration::PARAM_PULSE_WIDTH);
+	Ref<ModulatedParameter> detune_param = get_parameter(ChordSynthConfiguration::PARAM_DETUNE);
+
 	// Calculate base frequency for the current note
 	float base_frequency = get_frequency_for_note(context->get_note());
 
 	// Apply pitch modulation if available
-	if (parameters.has(ChordSynthConfiguration::PARAM_PITCH)) {
-		Ref<ModulatedParameter> pitch_param = parameters[ChordSynthConfiguration::PARAM_PITCH];
-		if (pitch_param.is_valid()) {
-			float pitch_offset = pitch_param->get_value(context);
-			// Convert semitone offset to frequency multiplier
-			float pitch_multiplier = std::pow(2.0f, pitch_offset / 12.0f);
-			base_frequency *= pitch_multiplier;
-		}
+	if (pitch_param.is_valid()) {
+		float pitch_offset = pitch_param->get_value(context);
+		// Convert semitone offset to frequency multiplier
+		base_frequency *= DspMath::semitones_to_ratio(pitch_offset);
 	}
 
-	// Calculate time increment per sample
-	double time_increment = 1.0 / sample_rate;
-	double current_time = context->get_absolute_time();
-
 	// Pre-fetch parameter values
-	float chord_type_value = 0.0f; // Default to major chord
-	if (parameters.has(ChordSynthConfiguration::PARAM_CHORD_TYPE)) {
-		Ref<ModulatedParameter> chord_param = parameters[ChordSynthConfiguration::PARAM_CHORD_TYPE];
-		if (chord_param.is_valid()) {
-			chord_type_value = chord_param->get_value(context);
-		}
-	}
-
-	float inversion_value = 0.0f; // Default to root position
-	if (parameters.has(ChordSynthConfiguration::PARAM_INVERSION)) {
-		Ref<ModulatedParameter> inversion_param = parameters[ChordSynthConfiguration::PARAM_INVERSION];
-		if (inversion_param.is_valid()) {
-			inversion_value = inversion_param->get_value(context);
-		}
-	}
-
-	float amplitude = 0.0f;
-	if (parameters.has(ChordSynthConfiguration::PARAM_AMPLITUDE)) {
-		Ref<ModulatedParameter> amp_param = parameters[ChordSynthConfiguration::PARAM_AMPLITUDE];
-		if (amp_param.is_valid()) {
-			amplitude = amp_param->get_value(context);
-		}
-	}
-
-	float pulse_width = 0.5f; // Default to 50% duty cycle
-	if (parameters.has(ChordSynthConfiguration::PARAM_PULSE_WIDTH)) {
-		Ref<ModulatedParameter> pw_param = parameters[ChordSynthConfiguration::PARAM_PULSE_WIDTH];
-		if (pw_param.is_valid()) {
-			pulse_width = pw_param->get_value(context);
-		}
-	}
-
-	// Store these values in the cache
-	cached_chord_type = chord_type_value;
-	cached_inversion = inversion_value;
-	cached_amplitude = amplitude;
-	cached_pulse_width = pulse_width;
+	cached_chord_type = chord_param.is_valid() ? chord_param->get_value(context) : 0.0f; // Default to major chord
+	cached_inversion = inversion_param.is_valid() ? inversion_param->get_value(context) : 0.0f; // Default to root position
+	cached_amplitude = amp_param.is_valid() ? amp_param->get_value(context) : 0.0f;
+	cached_pulse_width = pw_param.is_valid() ? pw_param->get_value(context) : 0.5f; // Default to 50% duty cycle
+	cached_detune = detune_param.is_valid() ? detune_param->get_value(context) : 0.0f; // Default to no detune
 
 	// Convert chord type value to integer index (0 to CHORD_MAX-1)
-	int chord_type_index = static_cast<int>(chord_type_value * (CHORD_MAX - 1) + 0.5f);
-	chord_type_index = std::max(0, std::min(chord_type_index, CHORD_MAX - 1));
-
-	// Debug output for chord type
-	static int chord_debug_counter = 0;
-	if (chord_debug_counter++ % 100 == 0) {
-		UtilityFunctions::print("Chord type value: " + String::num(chord_type_value) + 
-				", index: " + String::num(chord_type_index));
-	}
-
-	// Get chord intervals
-	std::vector<int> intervals;
-	
-	if (root_note_only) {
-		// If root_note_only is enabled, only use the root note (0 semitones)
-		intervals.push_back(0);
-		UtilityFunctions::print("Root note only mode enabled - using only the root note");
-	} else {
-		intervals = get_chord_intervals(chord_type_index);
-	}
+	int chord_index = static_cast<int>(cached_chord_type * (CHORD_MAX - 1) + 0.5f);
+	chord_index = std::max(0, std::min(chord_index, CHORD_MAX - 1));
 
 	// Convert inversion value to integer (0 to max possible inversions)
-	int max_inversions = intervals.size() - 1;
-	int inversion_index = static_cast<int>(inversion_value * max_inversions + 0.5f);
-	inversion_index = std::max(0, std::min(inversion_index, max_inversions));
-
-	// Apply inversion
-	std::vector<int> chord_notes = apply_inversion(intervals, inversion_index);
-
-	// Get detune parameter
-	float detune = 0.0f; // Default to no detune
-	if (parameters.has(ChordSynthConfiguration::PARAM_DETUNE)) {
-		Ref<ModulatedParameter> detune_param = parameters[ChordSynthConfiguration::PARAM_DETUNE];
-		if (detune_param.is_valid()) {
-			detune = detune_param->get_value(context);
-		}
-	}
-	cached_detune = detune;
-
-	// Calculate frequencies for all notes in the chord
-	std::vector<float> frequencies;
-	std::vector<float> phases;
-	phases.resize(chord_notes.size(), 0.0f);
-
-	// Initialize all phases to 0 - we'll use different waveforms instead of phase offsets
-	for (size_t i = 0; i < chord_notes.size(); i++) {
-		phases[i] = 0.0f;
+	int max_inversions = root_note_only ? 0 : CHORD_SHAPES[chord_index].count - 1;
+	int inversion = static_cast<int>(cached_inversion * max_inversions + 0.5f);
+	inversion = std::max(0, std::min(inversion, max_inversions));
+
+	// Only retune the bank when the quantized chord or its inputs change
+	if (chord_index != current_chord_index || inversion != current_inversion ||
+			base_frequency != current_base_frequency || cached_detune != current_detune ||
+			sample_rate != current_sample_rate) {
+		update_chord_bank(chord_index, inversion, base_frequency, cached_detune);
 	}
 
-	for (size_t i = 0; i < chord_notes.size(); i++) {
-		// Calculate the semitone offset from the root note
-		float semitone_offset = static_cast<float>(chord_notes[i]);
-
-		// Calculate the frequency for this note in the chord
-		float note_freq = base_frequency * std::pow(2.0f, semitone_offset / 12.0f);
-
-		// Apply a more significant detune to each note for richness and to prevent cancellation
-		float fixed_detune = 3.0f + (i * 2.0f); // Larger fixed detune in cents per note
-		float user_detune = cached_detune * 5.0f * (i + 1); // Amplified user controlled detune
-		float detune_amount = fixed_detune + user_detune;
-		float detune_multiplier = std::pow(2.0f, detune_amount / 1200.0f); // Convert cents to multiplier
-
-		frequencies.push_back(note_freq * detune_multiplier);
-	}
-
-	// Debug output for frequencies
-	if (chord_debug_counter % 100 == 0) {
-		String freq_debug = "Chord notes: ";
-		for (size_t i = 0; i < chord_notes.size(); i++) {
-			freq_debug += String::num(chord_notes[i]) + " ";
-		}
-		UtilityFunctions::print(freq_debug);
-		
-		freq_debug = "Frequencies: ";
-		for (size_t i = 0; i < frequencies.size(); i++) {
-			freq_debug += String::num(frequencies[i]) + " Hz, ";
-		}
-		UtilityFunctions::print(freq_debug);
-		
-		UtilityFunctions::print("Chord type: " + String::num(chord_type_index) + 
-				", Inversion: " + String::num(inversion_index));
+	if (cached_pulse_width != current_table_pulse_width) {
+		update_note_tables(cached_pulse_width);
 	}
 
-	// Debug output - only print occasionally to avoid flooding the console
-	static int chord_freq_debug = 0;
-	if (chord_freq_debug++ % 100 == 0) {
-		UtilityFunctions::print("Root note: " + String::num(context->get_note()) +
-				" Base frequency: " + String::num(base_frequency));
-		for (size_t i = 0; i < frequencies.size(); i++) {
-			UtilityFunctions::print("Chord note offset: " + String::num(chord_notes[i]) +
-					" semitones, Frequency[" + String::num(i) + "]: " + String::num(frequencies[i]) +
-					" Hz, Phase[" + String::num(i) + "]: " + String::num(phases[i]));
-		}
-	}
+	WaveHelperCache *cache = WaveHelperCache::get_singleton();
+	const int resolution = cache ? cache->get_resolution() : 0;
+	const float table_scale = static_cast<float>(resolution);
 
-	// How often to update modulation values (every N samples)
-	const int mod_update_rate = 1; // Update every 8 samples
+	// Calculate time increment per sample
+	double time_increment = 1.0 / sample_rate;
+	double current_time = p_start_time;
 
 	// Generate audio samples
-	for (int i = 0; i < buffer_size; i++) {
+	for (int i = 0; i < p_count; i++) {
 		// Update context time for this sample
 		context->update_time(current_time);
 
-		// Only update modulation values periodically to save CPU
-		if (i % mod_update_rate == 0) {
-			// Get the amplitude parameter (controlled by ADSR)
-			if (parameters.has(ChordSynthConfiguration::PARAM_AMPLITUDE)) {
-				Ref<ModulatedParameter> amp_param = parameters[ChordSynthConfiguration::PARAM_AMPLITUDE];
-				if (amp_param.is_valid()) {
-					cached_amplitude = amp_param->get_value(context);
-				}
-			}
+		// Get the amplitude parameter (controlled by ADSR)
+		if (amp_param.is_valid()) {
+			cached_amplitude = amp_param->get_value(context);
+		}
 
-			// Get the pulse width parameter
-			if (parameters.has(ChordSynthConfiguration::PARAM_PULSE_WIDTH)) {
-				Ref<ModulatedParameter> pw_param = parameters[ChordSynthConfiguration::PARAM_PULSE_WIDTH];
-				if (pw_param.is_valid()) {
-					cached_pulse_width = pw_param->get_value(context);
-				}
+		// Get the pulse width parameter, re-resolving tables only when it moves
+		if (pw_param.is_valid()) {
+			cached_pulse_width = pw_param->get_value(context);
+			if (cached_pulse_width != current_table_pulse_width) {
+				update_note_tables(cached_pulse_width);
 			}
 		}
 
-		// Mix all notes in the chord
+		// Mix all notes in the chord. The bank has a fixed width with silent
+		// unused slots, so both loops run without branches across notes.
 		float mixed_sample = 0.0f;
-		WaveHelperCache *cache = WaveHelperCache::get_singleton();
-
-		// Scale factor to prevent clipping - reduce volume as more notes are added
-		// Use a fixed scale factor to ensure consistent volume
-		float scale_factor = 0.5f; // Increased for better audibility
-
-		// Debug the first few samples of the first buffer
-		bool debug_samples = (chord_debug_counter <= 1 && i < 5);
-		
-		if (debug_samples) {
-			UtilityFunctions::print("--- Sample " + String::num(i) + " ---");
-		}
-
-		for (size_t j = 0; j < frequencies.size(); j++) {
-			float phase_increment = frequencies[j] / sample_rate;
-			phases[j] += phase_increment;
-			if (phases[j] >= 1.0f) {
-				phases[j] -= 1.0f;
-			}
-
-			// Use a different waveform for each note in the chord to prevent cancellation
-			WaveHelper::WaveType note_waveform = waveform;
-			
-			// For sine waves, use different waveforms for each note to prevent cancellation
-			if (waveform == WaveHelper::SINE) {
-				// Use a different waveform for each note in the chord
-				switch (j % 3) {
-					case 0: note_waveform = WaveHelper::SINE; break;
-					case 1: note_waveform = WaveHelper::TRIANGLE; break;
-					case 2: note_waveform = WaveHelper::SINE; break;
-				}
+		if (note_tables[0]) {
+			for (int j = 0; j < MAX_CHORD_NOTES; j++) {
+				int index = std::min(static_cast<int>(note_phases[j] * table_scale), resolution - 1);
+				mixed_sample += note_tables[j][index] * note_gains[j];
 			}
-			
-			// Get sample for this note
-			float note_sample;
-			if (cache) {
-				note_sample = cache->get_sample(phases[j], note_waveform, cached_pulse_width);
-			} else {
-				note_sample = WaveHelper::get_wave_sample(phases[j], note_waveform, cached_pulse_width);
-			}
-			
-			// Debug waveform type occasionally
-			if (i == 0 && j == 0 && chord_debug_counter % 100 == 0) {
-				UtilityFunctions::print("Using waveform types: " + String::num_int64(waveform) + 
-						" (base) and " + String::num_int64(note_waveform) + " (note " + String::num(j) + ")");
-			}
-
-			// Add to mix with proper scaling to avoid clipping
-			mixed_sample += note_sample * scale_factor;
-			
-			if (debug_samples) {
-				UtilityFunctions::print("  Note " + String::num(j) + ": phase=" + 
-						String::num(phases[j]) + ", sample=" + String::num(note_sample));
+		} else {
+			// Fallback to direct calculation if cache is not available
+			for (int j = 0; j < note_count; j++) {
+				mixed_sample += WaveHelper::get_wave_sample(note_phases[j], note_waveforms[j], cached_pulse_width) * note_gains[j];
 			}
 		}
-		
-		if (debug_samples) {
-			UtilityFunctions::print("  Mixed sample: " + String::num(mixed_sample) + 
-					", Amplitude: " + String::num(cached_amplitude));
-		}
-
-		// Apply amplitude (including ADSR envelope)
-		float output_sample = mixed_sample * cached_amplitude * context->get_velocity();
 
-		// Apply effects if available
-		if (effect_chain.is_valid()) {
-			output_sample = effect_chain->process_sample(output_sample, context);
+		for (int j = 0; j < MAX_CHORD_NOTES; j++) {
+			note_phases[j] += note_increments[j];
+			note_phases[j] -= std::floor(note_phases[j]);
 		}
 
-		output_buffer[i] = output_sample;
+		// Apply amplitude (including ADSR envelope)
+		p_output[i] = mixed_sample * cached_amplitude * context->get_velocity();
 
 		// Increment time for next sample
 		current_time += time_increment;
 	}
 
-	return output_buffer;
-}
-
-void ChordOscillatorEngine::initialize_chord_phases(std::vector<float> &phases, size_t count) {
-	// Distribute phases evenly to avoid phase cancellation
-	for (size_t i = 0; i < count; i++) {
-		phases[i] = static_cast<float>(i) / count;
-	}
+	return true;
 }
 
 void ChordOscillatorEngine::reset() {
 	phase = 0.0f;
+	reset_chord_phases();
+	current_chord_index = -1;
+	current_inversion = -1;
 	cached_chord_type = 0.0f;
 	cached_inversion = 0.0f;
 	cached_amplitude = 0.0f;
@@ -485,13 +338,17 @@ void ChordOscillatorEngine::reset() {
 
 void ChordOscillatorEngine::set_root_note_only(bool enabled) {
 	root_note_only = enabled;
-	UtilityFunctions::print("ChordOscillatorEngine: Root note only mode " + String(enabled ? "enabled" : "disabled"));
+	current_chord_index = -1; // Force the bank to be rebuilt
 }
 
 bool ChordOscillatorEngine::get_root_note_only() const {
 	return root_note_only;
 }
 
+bool ChordOscillatorEngine::is_deterministic() const {
+	return waveform != WaveHelper::NOISE;
+}
+
 Ref<AudioStreamGeneratorEngine> ChordOscillatorEngine::duplicate() const {
 	Ref<ChordOscillatorEngine> new_engine = memnew(ChordOscillatorEngine);
 
@@ -512,7 +369,6 @@ Ref<AudioStreamGeneratorEngine> ChordOscillatorEngine::duplicate() const {
 		Ref<ModulatedParameter> param = params[name];
 		if (param.is_valid()) {
 			Ref<ModulatedParameter> new_param = param->duplicate();
-			UtilityFunctions::print("Copy Parameter: " + name);
 			new_engine->set_parameter(name, new_param);
 		}
 	}
@@ -529,6 +385,21 @@ Ref<AudioStreamGeneratorEngine> ChordOscillatorEngine::duplicate() const {
 
 void ChordOscillatorEngine::set_waveform(WaveHelper::WaveType p_type) {
 	waveform = p_type;
+
+	// For sine waves, use a different waveform for every other note to prevent cancellation
+	for (int i = 0; i < MAX_CHORD_NOTES; i++) {
+		note_waveforms[i] = (waveform == WaveHelper::SINE && i % 3 == 1) ? WaveHelper::TRIANGLE : waveform;
+	}
+
+	// Build every pulse width now, so the audio thread only ever looks tables up
+	WaveHelperCache *cache = WaveHelperCache::get_singleton();
+	if (cache) {
+		cache->prepare_waveform(waveform);
+		if (waveform == WaveHelper::SINE) {
+			cache->prepare_waveform(WaveHelper::TRIANGLE);
+		}
+	}
+	current_table_pulse_width = -1.0f; // Force the tables to be resolved again
 }
 
 WaveHelper::WaveType ChordOscillatorEngine::get_waveform() const {
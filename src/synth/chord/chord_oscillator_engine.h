@@ -2,7 +2,6 @@
 #include "../core/audio_stream_generator_engine.h"
 #include "../core/modulated_parameter.h"
 #include "../core/wave_helper.h"
-#include <vector>
 
 namespace godot {
 
@@ -33,6 +32,10 @@ enum ChordType {
 class ChordOscillatorEngine : public AudioStreamGeneratorEngine {
     GDCLASS(ChordOscillatorEngine, AudioStreamGeneratorEngine);
 
+public:
+    // Largest chord in the chord table (root + 4 intervals, e.g. 9th chords)
+    static constexpr int MAX_CHORD_NOTES = 5;
+
 private:
     WaveHelper::WaveType waveform;
     float phase;
@@ -48,13 +51,31 @@ private:
     
     // Debug mode - when true, only plays the root note (no chord)
     bool root_note_only;
-    
-    // Helper methods
-    std::vector<int> get_chord_intervals(int chord_type) const;
-    std::vector<int> apply_inversion(const std::vector<int>& intervals, int inversion) const;
-    
-    // Helper to ensure phases are properly distributed
-    void initialize_chord_phases(std::vector<float>& phases, size_t count);
+
+    // Fixed-capacity oscillator bank, persistent across blocks
+    int note_count;
+    float note_phases[MAX_CHORD_NOTES];
+    float note_increments[MAX_CHORD_NOTES];
+    float note_gains[MAX_CHORD_NOTES];
+    WaveHelper::WaveType note_waveforms[MAX_CHORD_NOTES];
+    const float *note_tables[MAX_CHORD_NOTES];
+
+    // Inputs the bank was last tuned for, so it is only rebuilt on change
+    int current_chord_index;
+    int current_inversion;
+    float current_base_frequency;
+    float current_detune;
+    float current_sample_rate;
+    float current_table_pulse_width;
+
+    // Retune the oscillator bank for a chord voicing
+    void update_chord_bank(int chord_index, int inversion, float base_frequency, float detune);
+
+    // Resolve the wave table of every note for the given pulse width
+    void update_note_tables(float pulse_width);
+
+    // Clear the oscillator phases for a new note
+    void reset_chord_phases();
 
 protected:
     static void _bind_methods();
@@ -75,8 +96,9 @@ public:
     virtual Dictionary get_parameters() const override;
 
     // Override base methods
-    virtual PackedFloat32Array process_block(int buffer_size, const Ref<SynthNoteContext> &context) override;
+    virtual bool render_block(float *p_output, int p_count, double p_start_time, const Ref<SynthNoteContext> &context) override;
     virtual void reset() override;
+    virtual bool is_deterministic() const override;
     
     // Create a duplicate of this engine
     virtual Ref<AudioStreamGeneratorEngine> duplicate() const override;
@@ -84,41 +84,24 @@ ChordSynthConfiguration::~ChordSynthConfiguration() {
 }
 
 Ref<AudioStreamGeneratorEngine> ChordSynthConfiguration::create_engine() const {
-	// Create a Chord engine instance
-	Ref<ChordOscillatorEngine> engine = memnew(ChordOscillatorEngine);
+	Ref<AudioStreamGeneratorEngine> engine = instantiate_engine();
 
 	// Set the sample rate
 	engine->set_sample_rate(44100.0f); // Use a default sample rate
 
-	// Configure the engine with our parameters
-	engine->set_waveform(waveform);
+	// Transfer all parameters and the effect chain to the engine
+	engine->build_modulation_graph(get_parameters(), get_effect_chain());
 
-	// Debug output
-	UtilityFunctions::print("Creating chord engine with waveform: " + String::num_int64((int64_t)waveform));
-
-	// Transfer all parameters to the engine
-	Dictionary params = get_parameters();
-	Array param_names = params.keys();
-	// Debug parameters
-	UtilityFunctions::print("Parameters being set on engine:");
-	for (int i = 0; i < param_names.size(); i++) {
-		String name = param_names[i];
-		Ref<ModulatedParameter> param = params[name];
-		if (param.is_valid()) {
-			// Create a proper duplicate to avoid reference issues
-			Ref<ModulatedParameter> param_copy = param->duplicate();
-			engine->set_parameter(name, param_copy);
-
-			// Debug output for parameter values
-			UtilityFunctions::print("Setting parameter on engine: " + name +
-					" with value: " + String::num(param_copy->get_base_value()));
-		}
-	}
+	return engine;
+}
 
-	// Set effect chain if available
-	if (get_effect_chain().is_valid()) {
-		engine->set_effect_chain(get_effect_chain()->duplicate());
-	}
+Ref<AudioStreamGeneratorEngine> ChordSynthConfiguration::instantiate_engine() const {
+	// Create a Chord engine instance
+	Ref<ChordOscillatorEngine> engine = memnew(ChordOscillatorEngine);
+
+	// Configure the engine with our oscillator settings
+	engine->set_waveform(waveform);
+	engine->set_root_note_only(root_only);
 
 	return engine;
 }
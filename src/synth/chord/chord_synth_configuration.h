@@ -32,6 +32,7 @@ public:
 
 	// Implementation of the abstract method
 	virtual Ref<AudioStreamGeneratorEngine> create_engine() const override;
+	virtual Ref<AudioStreamGeneratorEngine> instantiate_engine() const override;
 
 	// Waveform setter/getter
 	void set_waveform(WaveHelper::WaveType p_type);
@@ -59,7 +60,7 @@ public:
 	// Preset management
 	void set_preset(const Ref<ChordSynthPreset> &p_preset);
 	Ref<ChordSynthPreset> get_preset() const;
-	bool root_only;
+	bool root_only = false;
 	void set_root_note_only(const bool &enabled) { root_only = enabled; }
 	bool get_root_note_only() const { return root_only; }
 };
@@ -99,6 +99,7 @@ public:
 
         // Add a reverb effect for richness
         Ref<Reverb> reverb = memnew(Reverb);
+        reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
         Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
         room_size->set_base_value(0.3f);
         reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
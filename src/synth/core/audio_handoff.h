@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace godot {
+
+// Hands shared snapshots from the main thread to the audio thread without locks.
+// publish() leaves the newest snapshot in a slot, and acquire() swaps it in on the audio
+// thread and queues the snapshot it replaced. collect() frees those on the main thread,
+// so the audio thread neither takes a lock nor drops the last reference to anything.
+template <typename T>
+class AudioHandoff {
+	struct Slot {
+		std::shared_ptr<T> snapshot;
+		uint64_t serial = 0;
+	};
+
+	static constexpr uint32_t RETIRE_CAPACITY = 16;
+
+	std::atomic<Slot *> pending{ nullptr };
+	Slot *retired[RETIRE_CAPACITY] = {};
+	std::atomic<uint32_t> retire_write{ 0 };
+	std::atomic<uint32_t> retire_read{ 0 };
+	uint64_t published_serial = 0; // Main thread
+	std::atomic<uint64_t> acquired_serial{ 0 };
+	std::shared_ptr<T> current; // Audio thread
+
+public:
+	~AudioHandoff() {
+		collect();
+		delete pending.exchange(nullptr);
+	}
+
+	// Main thread. A snapshot published before the audio thread took the last one
+	// replaces it. Returns the serial get_acquired_serial() reaches once it is taken.
+	uint64_t publish(std::shared_ptr<T> p_snapshot) {
+		collect();
+		Slot *slot = new Slot();
+		slot->snapshot = std::move(p_snapshot);
+		slot->serial = ++published_serial;
+		delete pending.exchange(slot);
+		return published_serial;
+	}
+
+	// Main thread, frees the snapshots the audio thread let go of
+	void collect() {
+		uint32_t read = retire_read.load(std::memory_order_relaxed);
+		uint32_t write = retire_write.load(std::memory_order_acquire);
+		for (; read != write; read++) {
+			delete retired[read % RETIRE_CAPACITY];
+		}
+		retire_read.store(read, std::memory_order_release);
+	}
+
+	uint64_t get_acquired_serial() const {
+		return acquired_serial.load();
+	}
+
+	// Audio thread. Returns true when a newer snapshot replaced the current one. While
+	// the main thread hasn't collected, the newer one waits for a later call.
+	bool acquire() {
+		if (pending.load() == nullptr) {
+			return false;
+		}
+		uint32_t write = retire_write.load(std::memory_order_relaxed);
+		if (write - retire_read.load(std::memory_order_acquire) >= RETIRE_CAPACITY) {
+			return false;
+		}
+		Slot *slot = pending.exchange(nullptr);
+		if (slot == nullptr) {
+			return false;
+		}
+		current.swap(slot->snapshot);
+		acquired_serial.store(slot->serial);
+		retired[write % RETIRE_CAPACITY] = slot;
+		retire_write.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Audio thread, the snapshot taken by the last acquire()
+	const std::shared_ptr<T> &get() const {
+		return current;
+	}
+};
+
+} // namespace godot
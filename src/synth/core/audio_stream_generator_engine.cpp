@@ -1,8 +1,8 @@
 #include "audio_stream_generator_engine.h"
 #include "../effects/effect_chain.h"
 #include "modulated_parameter.h"
+#include "patch_program.h"
 #include "synth_note_context.h"
-#include "wave_helper_cache.h"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
@@ -20,45 +20,193 @@ void AudioStreamGeneratorEngine::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "effect_chain", PROPERTY_HINT_RESOURCE_TYPE, "EffectChain"),
 			"set_effect_chain", "get_effect_chain");
 
+	ClassDB::bind_method(D_METHOD("get_modulation_source_count"), &AudioStreamGeneratorEngine::get_modulation_source_count);
+
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "sample_rate"), "set_sample_rate", "get_sample_rate");
 }
 
 AudioStreamGeneratorEngine::AudioStreamGeneratorEngine() {
 	effect_chain = Ref<EffectChain>();
-
-	// Initialize the waveform cache if it doesn't exist
-	if (!WaveHelperCache::get_singleton()) {
-		Ref<WaveHelperCache> cache = memnew(WaveHelperCache);
-		cache->initialize();
-	}
 }
 
 AudioStreamGeneratorEngine::~AudioStreamGeneratorEngine() {
 }
 
 PackedFloat32Array AudioStreamGeneratorEngine::process_block(int buffer_size, const Ref<SynthNoteContext> &context) {
-	// Create a new buffer filled with silence
 	PackedFloat32Array output_buffer;
 	output_buffer.resize(buffer_size);
-	for (int i = 0; i < buffer_size; i++) {
-		output_buffer[i] = 0.0f;
+	float *output = output_buffer.ptrw();
+
+	// Effects run on whole blocks once their last sample is written, with the context
+	// standing at that sample
+	double start_time = context.is_valid() ? context->get_absolute_time() : 0.0;
+	double time_increment = 1.0 / sample_rate;
+	for (int offset = 0; offset < buffer_size; offset += EffectChain::BLOCK_SIZE) {
+		int count = MIN(EffectChain::BLOCK_SIZE, buffer_size - offset);
+		if (render_block(output + offset, count, start_time + offset * time_increment, context) && effect_chain.is_valid()) {
+			effect_chain->process_block(output + offset, count, context);
+		}
 	}
 	return output_buffer;
 }
 
+bool AudioStreamGeneratorEngine::render_block(float *p_output, int p_count, double p_start_time, const Ref<SynthNoteContext> &context) {
+	// Base implementation renders silence
+	for (int i = 0; i < p_count; i++) {
+		p_output[i] = 0.0f;
+	}
+	return false;
+}
+
 void AudioStreamGeneratorEngine::set_effect_chain(const Ref<EffectChain> &p_chain) {
 	effect_chain = p_chain;
+	program.reset();
+	quality_tier = -1; // The new chain still needs the current tier
 
-	// Reset the effect chain when it's set
+	// Reset the effect chain when it's set, and compile it here rather than on the audio thread
 	if (effect_chain.is_valid()) {
+		effect_chain->set_sample_rate(sample_rate);
 		effect_chain->reset();
+		effect_chain->compile();
+	}
+
+	// A running engine needs buffers for the new chain now, a pool binds fresh engines itself
+	if (state_arena) {
+		allocate_state();
+	}
+}
+
+void AudioStreamGeneratorEngine::build_modulation_graph(const Dictionary &p_parameters, const Ref<EffectChain> &p_effect_chain) {
+	modulation_graph.clear();
+
+	Dictionary bound_params = modulation_graph.bind_parameters(p_parameters);
+	Array param_names = bound_params.keys();
+	for (int i = 0; i < param_names.size(); i++) {
+		String name = param_names[i];
+		Ref<ModulatedParameter> param = bound_params[name];
+		set_parameter(name, param);
+	}
+
+	set_effect_chain(modulation_graph.bind_effect_chain(p_effect_chain));
+}
+
+void AudioStreamGeneratorEngine::build_from_program(const PatchProgram &p_program) {
+	modulation_graph.clear();
+
+	const Vector<PatchProgram::ParameterSlot> &program_params = p_program.get_parameters();
+	for (int i = 0; i < program_params.size(); i++) {
+		const PatchProgram::ParameterSlot &slot = program_params[i];
+		set_parameter(slot.name, slot.shared ? slot.parameter : modulation_graph.bind_parameter(slot.parameter));
+	}
+
+	Ref<EffectChain> chain = memnew(EffectChain);
+	const Vector<PatchProgram::EffectSlot> &program_effects = p_program.get_effects();
+	for (int i = 0; i < program_effects.size(); i++) {
+		const PatchProgram::EffectSlot &effect_slot = program_effects[i];
+		// The prototype has no parameters, so this only constructs the effect and the
+		// program's slots are attached once below
+		Ref<SynthAudioEffect> effect = effect_slot.prototype->duplicate();
+		if (!effect.is_valid()) {
+			continue;
+		}
+
+		for (int j = 0; j < effect_slot.parameters.size(); j++) {
+			const PatchProgram::ParameterSlot &slot = effect_slot.parameters[j];
+			effect->set_parameter(slot.name, slot.shared ? slot.parameter : modulation_graph.bind_parameter(slot.parameter));
+		}
+		chain->add_effect(effect);
+	}
+	set_effect_chain(chain);
+	program = p_program.weak_from_this().lock();
+
+	quality_profile = p_program.get_quality_profile();
+	quality_tier = -1;
+}
+
+void AudioStreamGeneratorEngine::advance_virtual(int buffer_size, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid()) {
+		return;
+	}
+
+	context->update_time(context->get_absolute_time() + buffer_size / sample_rate);
+
+	// Envelopes report their level when evaluated, which drives the release states
+	Array names = parameters.keys();
+	for (int i = 0; i < names.size(); i++) {
+		Ref<ModulatedParameter> param = parameters[names[i]];
+		if (param.is_valid()) {
+			param->get_value(context);
+		}
 	}
 }
 
+void AudioStreamGeneratorEngine::apply_quality_tier(int p_tier) {
+	if (p_tier == quality_tier) {
+		return;
+	}
+	quality_tier = p_tier;
+
+	const SynthQualityProfile::Settings &settings = get_quality_settings(p_tier);
+	control_rate_divisor = settings.control_rate_divisor;
+	if (effect_chain.is_valid()) {
+		effect_chain->apply_quality(settings);
+	}
+}
+
+const SynthQualityProfile::Settings &AudioStreamGeneratorEngine::get_quality_settings(int p_tier) const {
+	if (quality_profile.is_valid()) {
+		return quality_profile->get_settings(p_tier);
+	}
+	return SynthQualityProfile::get_default_settings(p_tier);
+}
+
+int AudioStreamGeneratorEngine::get_control_rate_divisor() const {
+	return control_rate_divisor;
+}
+
+int AudioStreamGeneratorEngine::get_modulation_source_count() const {
+	return modulation_graph.get_source_count();
+}
+
 Ref<EffectChain> AudioStreamGeneratorEngine::get_effect_chain() const {
 	return effect_chain;
 }
 
+void AudioStreamGeneratorEngine::update_effects() {
+	if (effect_chain.is_valid()) {
+		effect_chain->update();
+	}
+}
+
+size_t AudioStreamGeneratorEngine::get_state_size() const {
+	if (!effect_chain.is_valid()) {
+		return 0;
+	}
+	return effect_chain->get_state_size();
+}
+
+void AudioStreamGeneratorEngine::bind_state_arena(const std::shared_ptr<VoiceStateArena> &p_arena, int p_voice) {
+	if (!p_arena || !effect_chain.is_valid()) {
+		return;
+	}
+
+	VoiceStateArena::Allocator allocator = p_arena->get_voice_allocator(p_voice);
+	effect_chain->bind_state(allocator);
+	state_arena = p_arena;
+}
+
+void AudioStreamGeneratorEngine::allocate_state() {
+	size_t state_size = get_state_size();
+	if (state_size == 0) {
+		state_arena.reset();
+		return;
+	}
+
+	std::shared_ptr<VoiceStateArena> arena = std::make_shared<VoiceStateArena>();
+	ERR_FAIL_COND_MSG(!arena->allocate(state_size, 1), "Failed to allocate the engine's effect state.");
+	bind_state_arena(arena, 0);
+}
+
 void AudioStreamGeneratorEngine::reset() {
 	// Base implementation does nothing
 
@@ -67,11 +215,25 @@ void AudioStreamGeneratorEngine::reset() {
 		effect_chain->reset();
 	}
 
+	// Reset the per-voice modulation sources
+	modulation_graph.reset();
+
 	// Note: We don't reset the waveform cache as it's shared across all engines
 }
 
 void AudioStreamGeneratorEngine::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate == sample_rate) {
+		return;
+	}
 	sample_rate = p_sample_rate;
+	if (effect_chain.is_valid()) {
+		effect_chain->set_sample_rate(sample_rate);
+
+		// Delay lines are resized for the new rate and lose their storage
+		if (state_arena) {
+			allocate_state();
+		}
+	}
 }
 
 float AudioStreamGeneratorEngine::get_sample_rate() const {
@@ -89,6 +251,10 @@ Ref<ModulatedParameter> AudioStreamGeneratorEngine::get_parameter(const String &
 	return Ref<ModulatedParameter>();
 }
 
+bool AudioStreamGeneratorEngine::is_deterministic() const {
+	return true;
+}
+
 Ref<AudioStreamGeneratorEngine> AudioStreamGeneratorEngine::duplicate() const {
 	// Base implementation - to be overridden by derived classes
 	return nullptr;
@@ -1,13 +1,17 @@
 #pragma once
 #include "../effects/effect_chain.h"
+#include "modulation_graph.h"
+#include "voice_state_arena.h"
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
+#include <memory>
 
 namespace godot {
 
 class SynthNoteContext;
 class ModulatedParameter;
+class PatchProgram;
 
 class AudioStreamGeneratorEngine : public Resource {
 	GDCLASS(AudioStreamGeneratorEngine, Resource);
@@ -17,14 +21,41 @@ protected:
 	float sample_rate = 44100.0f;
 	Dictionary parameters;
 	Ref<EffectChain> effect_chain;
+	ModulationGraph modulation_graph;
+
+	// Slab holding this voice's effect buffers, kept alive while the engine uses it
+	std::shared_ptr<VoiceStateArena> state_arena;
+
+	// Program this engine was built from, null once its effect chain is replaced
+	std::shared_ptr<const PatchProgram> program;
+
+	// Quality tier applied to this engine, -1 until the first block
+	Ref<SynthQualityProfile> quality_profile;
+	int quality_tier = -1;
+	int control_rate_divisor = 1;
 
 public:
 	AudioStreamGeneratorEngine();
 	virtual ~AudioStreamGeneratorEngine();
 
+	// Render buffer_size samples, running the effect chain on every EffectChain::BLOCK_SIZE
+	// samples of oscillator output
 	virtual PackedFloat32Array process_block(int buffer_size, const Ref<SynthNoteContext> &context);
+
+	// Oscillator output for at most one effect block, without effects. p_start_time is the
+	// time of the first sample. Returns false when the voice is silent and its effects
+	// should stay idle.
+	virtual bool render_block(float *p_output, int p_count, double p_start_time, const Ref<SynthNoteContext> &context);
+
+	// Advance a voice that is too quiet to hear by buffer_size samples without rendering.
+	// Time, note state and envelopes move on so the note ends when it would have.
+	virtual void advance_virtual(int buffer_size, const Ref<SynthNoteContext> &context);
 	virtual void reset();
 
+	// Whether a fresh engine renders the same samples for every note with the same note,
+	// velocity and articulation. Oscillators drawing random values override this.
+	virtual bool is_deterministic() const;
+
 	void set_sample_rate(float p_sample_rate);
 	float get_sample_rate() const;
 
@@ -42,9 +73,40 @@ public:
 	// Check if this engine has an active tail
 	bool has_active_tail(const Ref<SynthNoteContext> &context) const;
 
+	// Install parameters and effects from a configuration, sharing each distinct
+	// modulation source between all of its targets within this engine
+	void build_modulation_graph(const Dictionary &p_parameters, const Ref<EffectChain> &p_effect_chain);
+	int get_modulation_source_count() const;
+
+	// Install a compiled patch program. Unmodulated parameters are shared with the
+	// program, modulated ones and the effects get this voice's own copies.
+	void build_from_program(const PatchProgram &p_program);
+
+	// Engines built from the same program have effect chains of the same layout, so
+	// their voices can render together
+	const PatchProgram *get_program() const { return program.get(); }
+
+	// Size in floats of the per-voice state this engine can place in a voice state arena
+	virtual size_t get_state_size() const;
+
+	// Move this engine's buffers into the region of p_voice in a shared arena
+	virtual void bind_state_arena(const std::shared_ptr<VoiceStateArena> &p_arena, int p_voice);
+
+	// Give the engine an arena of its own for its buffers. Engines outside a voice pool
+	// call this once configured, effects never allocate while processing.
+	void allocate_state();
+
+	// Apply a governor tier using this engine's profile, a no-op if it is already applied
+	void apply_quality_tier(int p_tier);
+	const SynthQualityProfile::Settings &get_quality_settings(int p_tier) const;
+	int get_control_rate_divisor() const;
+
 	// Effect chain management
 	void set_effect_chain(const Ref<EffectChain> &p_chain);
 	Ref<EffectChain> get_effect_chain() const;
+
+	// Recompile the effect chain if rendering found it changed, off the audio thread
+	void update_effects();
 };
 
 } // namespace godot
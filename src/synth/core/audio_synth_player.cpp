@@ -1,43 +1,15 @@
 #include "audio_synth_player.h"
-#include "audio_stream_generator_engine.h"
-#include "engine_factory.h"
-#include "modulated_parameter.h"
-#include "synth_audio_stream_playback.h" // Add this include
-#include "synth_configuration.h"
-#include "synth_voice.h"
 #include <godot_cpp/classes/audio_server.hpp>
-#include <godot_cpp/classes/engine.hpp>
-#include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/core/class_db.hpp>
-#include <godot_cpp/variant/utility_functions.hpp>
 
 namespace godot {
 
 void AudioSynthPlayer::_bind_methods() {
-	ClassDB::bind_method(D_METHOD("set_configuration", "config"), &AudioSynthPlayer::set_configuration);
-	ClassDB::bind_method(D_METHOD("get_configuration"), &AudioSynthPlayer::get_configuration);
-
-	ClassDB::bind_method(D_METHOD("get_context"), &AudioSynthPlayer::get_context);
-	ClassDB::bind_method(D_METHOD("stop_all_notes"), &AudioSynthPlayer::stop_all_notes);
-
-	ClassDB::bind_method(D_METHOD("set_parameter", "name", "value"), &AudioSynthPlayer::set_parameter);
-
-	// Add polyphony property
-	ClassDB::bind_method(D_METHOD("set_polyphony", "polyphony"), &AudioSynthPlayer::set_polyphony);
-	ClassDB::bind_method(D_METHOD("get_polyphony"), &AudioSynthPlayer::get_polyphony);
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "polyphony", PROPERTY_HINT_RANGE, "1,32,1"),
-			"set_polyphony", "get_polyphony");
-
-	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "configuration", PROPERTY_HINT_RESOURCE_TYPE, "SynthConfiguration"), "set_configuration", "get_configuration");
+	SynthPlayerCore<AudioSynthPlayer>::bind_methods();
 }
 
 AudioSynthPlayer::AudioSynthPlayer() :
-		sample_rate(44100.0f) {
-	// Create the audio stream
-	stream.instantiate();
-	sample_rate = AudioServer::get_singleton()->get_mix_rate();
-	stream->set_mix_rate(sample_rate);
-
+		core(this) {
 	// Connect to AudioServer signals to update bus options when they change
 	AudioServer::get_singleton()->connect("bus_layout_changed", Callable(this, "notify_property_list_changed"));
 	AudioServer::get_singleton()->connect("bus_renamed", Callable(this, "notify_property_list_changed"));
@@ -52,204 +24,119 @@ AudioSynthPlayer::~AudioSynthPlayer() {
 }
 
 void AudioSynthPlayer::_ready() {
-	// Set the stream when the node enters the tree
-	set_stream(stream);
-
-	// Start playback with explicit volume
-	set_volume_db(0.0); // Ensure volume is at 0 dB (full volume)
-	play();
-
-	// Get the playback interface after starting playback
-	Ref<AudioStreamPlayback> stream_playback = get_stream_playback();
-	if (stream_playback.is_valid()) {
-		playback = static_cast<Ref<SynthAudioStreamPlayback>>(stream_playback.ptr());
+	// Start at full volume unless the voice manager renders the voices
+	if (!core.get_use_voice_manager()) {
+		set_volume_db(0.0);
 	}
-
-	// Initialize the voice pool
-	initialize_voice_pool();
+	core.ready();
 }
 
 void AudioSynthPlayer::_process(double delta) {
-	// Try to get the playback interface if it's not already set
-	if (!playback.is_valid()) {
-		Ref<AudioStreamPlayback> stream_playback = get_stream_playback();
-		if (stream_playback.is_valid()) {
-			playback = static_cast<Ref<SynthAudioStreamPlayback>>(stream_playback.ptr());
-		}
-	}
+	core.process();
 }
 
-void AudioSynthPlayer::set_configuration(const Ref<SynthConfiguration> &p_config) {
-	configuration = p_config;
-
-	// Stop all current voices when configuration changes
-	stop_all_notes();
-
-	// Set the output bus if specified in the configuration
-	if (configuration.is_valid()) {
-		String bus_name = configuration->get_output_bus();
-		// Validate that the bus exists
-		bool bus_found = false;
-		for (int i = 0; i < AudioServer::get_singleton()->get_bus_count(); i++) {
-			if (AudioServer::get_singleton()->get_bus_name(i) == bus_name) {
-				bus_found = true;
-				break;
-			}
-		}
-		// If bus not found, default to "Master"
-		set_bus(bus_found ? bus_name : "Master");
-	}
+void AudioSynthPlayer::_exit_tree() {
+	core.exit_tree();
+}
 
-	// Reinitialize the voice pool with the new configuration
-	initialize_voice_pool();
+void AudioSynthPlayer::set_configuration(const Ref<SynthConfiguration> &p_config) {
+	core.set_configuration(p_config);
 }
 
 Ref<SynthConfiguration> AudioSynthPlayer::get_configuration() const {
-	return configuration;
+	return core.get_configuration();
+}
+
+Error AudioSynthPlayer::set_patch(const Ref<SynthPresetBank> &p_bank, const String &p_name) {
+	return core.set_patch(p_bank, p_name);
 }
 
 void AudioSynthPlayer::set_polyphony(int p_polyphony) {
-	polyphony = Math::clamp(p_polyphony, 1, 32);
-	initialize_voice_pool();
+	core.set_polyphony(p_polyphony);
 }
 
 int AudioSynthPlayer::get_polyphony() const {
-	return polyphony;
+	return core.get_polyphony();
 }
 
-void AudioSynthPlayer::initialize_voice_pool() {
-	// Clear existing pool
-	voice_pool.clear();
-
-	// Create new voices
-	for (int i = 0; i < polyphony; i++) {
-		Ref<SynthVoice> voice;
-		voice.instantiate();
-
-		// If we have a configuration, create an engine for this voice
-		if (configuration.is_valid()) {
-			Ref<AudioStreamGeneratorEngine> engine = EngineFactory::create_engine_from_config(configuration);
-			if (engine.is_valid()) {
-				engine->set_sample_rate(sample_rate);
-				voice->set_engine(engine);
-			}
-		}
-
-		voice_pool.push_back(voice);
-	}
-
-	next_voice_index = 0;
+void AudioSynthPlayer::set_use_voice_manager(bool p_enabled) {
+	core.set_use_voice_manager(p_enabled);
 }
 
-Ref<SynthVoice> AudioSynthPlayer::allocate_voice() {
-	if (voice_pool.size() == 0) {
-		initialize_voice_pool();
-	}
-
-	// Find the next available voice using round-robin
-	int start_index = next_voice_index;
-	bool found_inactive = false;
+bool AudioSynthPlayer::get_use_voice_manager() const {
+	return core.get_use_voice_manager();
+}
 
-	do {
-		Ref<SynthVoice> voice = voice_pool[next_voice_index];
+void AudioSynthPlayer::set_voice_category(SynthVoiceManager::VoiceCategory p_category) {
+	core.set_voice_category(p_category);
+}
 
-		// Move to next voice for next allocation
-		next_voice_index = (next_voice_index + 1) % polyphony;
+SynthVoiceManager::VoiceCategory AudioSynthPlayer::get_voice_category() const {
+	return core.get_voice_category();
+}
 
-		// If voice is not active, use it
-		if (!voice->is_active()) {
-			found_inactive = true;
-			return voice;
-		}
+void AudioSynthPlayer::set_voice_priority(int p_priority) {
+	core.set_voice_priority(p_priority);
+}
 
-	} while (next_voice_index != start_index);
+int AudioSynthPlayer::get_voice_priority() const {
+	return core.get_voice_priority();
+}
 
-	Ref<SynthVoice> voice = voice_pool[next_voice_index];
-	voice->reset(); // Reset the voice before reusing it
-	next_voice_index = (next_voice_index + 1) % polyphony;
-	return voice;
+bool AudioSynthPlayer::is_rebuilding_voices() const {
+	return core.is_rebuilding_voices();
 }
 
 Ref<SynthNoteContext> AudioSynthPlayer::get_context() {
-	if (!configuration.is_valid()) {
-		return nullptr;
-	}
-
-	// Try to get the playback interface if it's not already set
-	if (!playback.is_valid()) {
-		Ref<AudioStreamPlayback> stream_playback = get_stream_playback();
-		if (stream_playback.is_valid()) {
-			playback = static_cast<Ref<SynthAudioStreamPlayback>>(stream_playback.ptr());
-			if (!playback.is_valid()) {
-				return nullptr;
-			}
-		}
-	}
+	return core.get_context();
+}
 
-	if (!playback.is_valid()) {
-		return nullptr;
-	}
+void AudioSynthPlayer::stop_all_notes() {
+	core.stop_all_notes();
+}
 
-	// Make sure we're playing with proper volume
-	if (!is_playing()) {
-		set_volume_db(0.0); // Ensure volume is at 0 dB (full volume)
-		play();
-	}
+void AudioSynthPlayer::kill_all_notes() {
+	core.kill_all_notes();
+}
 
-	// Get a voice from the pool
-	Ref<SynthVoice> voice = allocate_voice();
-
-	// If the voice doesn't have an engine (or it's invalid), create one
-	if (!voice->get_engine().is_valid()) {
-		Ref<AudioStreamGeneratorEngine> engine = EngineFactory::create_engine_from_config(configuration);
-		if (engine.is_valid()) {
-			engine->set_sample_rate(sample_rate);
-			voice->set_engine(engine);
-		} else {
-			return nullptr;
-		}
-	}
+void AudioSynthPlayer::set_max_note_lifetime(float p_seconds) {
+	core.set_max_note_lifetime(p_seconds);
+}
 
-	// Get the context from the voice - this will create a fresh context
-	Ref<SynthNoteContext> context = voice->get_context();
+float AudioSynthPlayer::get_max_note_lifetime() const {
+	return core.get_max_note_lifetime();
+}
 
-	// Get the current playback time instead of system time
-	double current_time = playback->get_current_time();
-	context->set_absolute_time(current_time);
-	context->set_note_time(0.0);
-	context->set_note_on_time(current_time);
+PackedInt64Array AudioSynthPlayer::note_on_batch(const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations) {
+	return core.note_on_batch(p_notes, p_velocities, p_articulations);
+}
 
-	// Make sure the context is in the READY state
-	context->set_note_state(SynthNoteContext::NOTE_STATE_READY);
+void AudioSynthPlayer::note_off_batch(const PackedInt64Array &p_handles) {
+	core.note_off_batch(p_handles);
+}
 
-	// Generate a unique ID for this voice
-	int64_t voice_id = Time::get_singleton()->get_ticks_msec();
+bool AudioSynthPlayer::play_instance(int p_note, float p_velocity, float p_gain, float p_pitch_offset) {
+	return core.play_instance(p_note, p_velocity, p_gain, p_pitch_offset);
+}
 
-	// Add to active voices in the playback
-	playback->add_voice(voice_id, voice);
-	context->set_voice_id(voice_id);
+void AudioSynthPlayer::set_instance_hold(float p_seconds) {
+	core.set_instance_hold(p_seconds);
+}
 
-	return context;
+float AudioSynthPlayer::get_instance_hold() const {
+	return core.get_instance_hold();
 }
 
-void AudioSynthPlayer::stop_all_notes() {
-	if (!playback.is_valid()) {
-		return;
-	}
+void AudioSynthPlayer::set_instance_length(float p_seconds) {
+	core.set_instance_length(p_seconds);
+}
 
-	// Release all active voices
-	playback->release_all_voices();
+float AudioSynthPlayer::get_instance_length() const {
+	return core.get_instance_length();
 }
 
 void AudioSynthPlayer::set_parameter(const String &p_name, float p_value) {
-	if (!configuration.is_valid()) {
-		return;
-	}
-
-	Ref<ModulatedParameter> param = configuration->get_parameter(p_name);
-	if (param.is_valid()) {
-		param->set_base_value(p_value);
-	}
+	core.set_parameter(p_name, p_value);
 }
 
 } // namespace godot
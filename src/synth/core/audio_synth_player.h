@@ -1,32 +1,15 @@
 #pragma once
-#include "synth_audio_stream.h"
-#include "synth_audio_stream_playback.h" // Add this include
-#include "synth_note_context.h"
+#include "synth_player_core.h"
 #include <godot_cpp/classes/audio_stream_player.hpp>
 
 namespace godot {
 
-class SynthConfiguration;
-class SynthVoice;
-class SynthPreset;
-
 class AudioSynthPlayer : public AudioStreamPlayer {
 	GDCLASS(AudioSynthPlayer, AudioStreamPlayer);
 
 private:
-	Ref<SynthConfiguration> configuration;
-	Ref<SynthAudioStream> stream;
-	Ref<SynthAudioStreamPlayback> playback;
-	float sample_rate;
-
-	// Voice pool management
-	int polyphony = 8; // Default polyphony
-	Vector<Ref<SynthVoice>> voice_pool;
-	int next_voice_index = 0; // For round-robin allocation
-
-	// Helper methods for voice pool
-	void initialize_voice_pool();
-	Ref<SynthVoice> allocate_voice();
+	// Stream, voices and playback, shared with AudioSynthPlayer3D
+	SynthPlayerCore<AudioSynthPlayer> core;
 
 protected:
 	static void _bind_methods();
@@ -37,16 +20,58 @@ public:
 
 	void _ready() override;
 	virtual void _process(double delta) override;
+	virtual void _exit_tree() override;
 
 	void set_configuration(const Ref<SynthConfiguration> &p_config);
 	Ref<SynthConfiguration> get_configuration() const;
 
+	// Play a patch from a preset bank, see SynthPlayerVoices::set_patch()
+	Error set_patch(const Ref<SynthPresetBank> &p_bank, const String &p_name);
+
 	// Polyphony management
 	void set_polyphony(int p_polyphony);
 	int get_polyphony() const;
 
+	// Voice manager routing
+	void set_use_voice_manager(bool p_enabled);
+	bool get_use_voice_manager() const;
+
+	void set_voice_category(SynthVoiceManager::VoiceCategory p_category);
+	SynthVoiceManager::VoiceCategory get_voice_category() const;
+
+	void set_voice_priority(int p_priority);
+	int get_voice_priority() const;
+
+	// True while a configuration or polyphony change is being built in the background
+	bool is_rebuilding_voices() const;
+
 	Ref<SynthNoteContext> get_context();
+
+	// Release every note into its envelope release, or fade them all out within a few ms
 	void stop_all_notes();
+	void kill_all_notes();
+
+	// Seconds after which a note that is still sounding is killed, 0 for no limit
+	void set_max_note_lifetime(float p_seconds);
+	float get_max_note_lifetime() const;
+
+	// Start one note per entry of p_notes in a single call. Returns a handle per note, or
+	// -1 where no voice was available. notes_finished reports the handles once per frame
+	// when their notes have ended.
+	PackedInt64Array note_on_batch(const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations);
+	void note_off_batch(const PackedInt64Array &p_handles);
+
+	// Play a one-shot note as an instance of a shared recording, for sounds triggered many
+	// times at once. The note is held for instance_hold seconds and lasts at most
+	// instance_length. Returns false when the patch isn't deterministic, use get_context()
+	// for those.
+	bool play_instance(int p_note, float p_velocity, float p_gain, float p_pitch_offset);
+
+	void set_instance_hold(float p_seconds);
+	float get_instance_hold() const;
+
+	void set_instance_length(float p_seconds);
+	float get_instance_length() const;
 
 	void set_parameter(const String &p_name, float p_value);
 };
@@ -0,0 +1,248 @@
+#include "audio_synth_player_3d.h"
+#include <godot_cpp/classes/audio_listener3d.hpp>
+#include <godot_cpp/classes/camera3d.hpp>
+#include <godot_cpp/classes/viewport.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <cmath>
+
+namespace godot {
+
+// Level a virtual player must climb above its threshold before it renders again
+static const float VIRTUALIZE_HYSTERESIS_DB = 3.0f;
+
+void AudioSynthPlayer3D::_bind_methods() {
+	SynthPlayerCore<AudioSynthPlayer3D>::bind_methods();
+
+	ClassDB::bind_method(D_METHOD("set_virtualize_below_db", "db"), &AudioSynthPlayer3D::set_virtualize_below_db);
+	ClassDB::bind_method(D_METHOD("get_virtualize_below_db"), &AudioSynthPlayer3D::get_virtualize_below_db);
+	ClassDB::bind_method(D_METHOD("set_reduce_quality_below_db", "db"), &AudioSynthPlayer3D::set_reduce_quality_below_db);
+	ClassDB::bind_method(D_METHOD("get_reduce_quality_below_db"), &AudioSynthPlayer3D::get_reduce_quality_below_db);
+	ClassDB::bind_method(D_METHOD("set_distant_quality_tier", "tier"), &AudioSynthPlayer3D::set_distant_quality_tier);
+	ClassDB::bind_method(D_METHOD("get_distant_quality_tier"), &AudioSynthPlayer3D::get_distant_quality_tier);
+	ClassDB::bind_method(D_METHOD("get_audibility_db"), &AudioSynthPlayer3D::get_audibility_db);
+	ClassDB::bind_method(D_METHOD("is_virtualized"), &AudioSynthPlayer3D::is_virtualized);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "virtualize_below_db", PROPERTY_HINT_RANGE, "-120,0,0.1,suffix:dB"), "set_virtualize_below_db", "get_virtualize_below_db");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "reduce_quality_below_db", PROPERTY_HINT_RANGE, "-120,0,0.1,suffix:dB"), "set_reduce_quality_below_db", "get_reduce_quality_below_db");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "distant_quality_tier", PROPERTY_HINT_ENUM, "High,Medium,Low,Minimum"), "set_distant_quality_tier", "get_distant_quality_tier");
+}
+
+AudioSynthPlayer3D::AudioSynthPlayer3D() :
+		core(this) {
+}
+
+AudioSynthPlayer3D::~AudioSynthPlayer3D() {
+}
+
+void AudioSynthPlayer3D::_ready() {
+	core.ready();
+}
+
+void AudioSynthPlayer3D::_process(double delta) {
+	core.process();
+	update_lod();
+}
+
+void AudioSynthPlayer3D::_exit_tree() {
+	core.exit_tree();
+}
+
+float AudioSynthPlayer3D::compute_audibility_db() const {
+	Viewport *viewport = get_viewport();
+	if (viewport == nullptr) {
+		return get_volume_db();
+	}
+
+	// Same listener choice as the audio server: an active listener, else the camera
+	Node3D *listener = viewport->get_audio_listener_3d();
+	if (listener == nullptr) {
+		listener = viewport->get_camera_3d();
+	}
+	if (listener == nullptr) {
+		return get_volume_db();
+	}
+
+	float distance = get_global_position().distance_to(listener->get_global_position());
+	float max_distance = get_max_distance();
+	if (max_distance > 0.0f && distance > max_distance) {
+		return -INFINITY;
+	}
+
+	// Mirrors the attenuation models of AudioStreamPlayer3D
+	float scaled = distance / MAX(get_unit_size(), 0.001f);
+	float attenuation_db = 0.0f;
+	switch (get_attenuation_model()) {
+		case ATTENUATION_INVERSE_DISTANCE:
+			attenuation_db = 20.0f * std::log10(1.0f / (scaled + CMP_EPSILON));
+			break;
+		case ATTENUATION_INVERSE_SQUARE_DISTANCE:
+			attenuation_db = 20.0f * std::log10(1.0f / (scaled * scaled + CMP_EPSILON));
+			break;
+		case ATTENUATION_LOGARITHMIC:
+			attenuation_db = -20.0f * std::log(scaled + CMP_EPSILON);
+			break;
+		default:
+			break;
+	}
+
+	return MIN(attenuation_db + get_volume_db(), get_max_db());
+}
+
+void AudioSynthPlayer3D::update_lod() {
+	audibility_db = compute_audibility_db();
+
+	if (virtualized) {
+		virtualized = audibility_db < virtualize_below_db + VIRTUALIZE_HYSTERESIS_DB;
+	} else {
+		virtualized = audibility_db < virtualize_below_db;
+	}
+
+	// Managed voices render in the manager's playback, which has no level of detail
+	int tier = audibility_db < reduce_quality_below_db ? distant_quality_tier : SynthQualityProfile::TIER_HIGH;
+	Ref<SynthAudioStreamPlayback> playback = core.get_playback();
+	if (playback.is_valid()) {
+		playback->set_lod(tier, virtualized);
+	}
+}
+
+void AudioSynthPlayer3D::prepare_notes() {
+	// Notes started far away begin virtual instead of rendering their first block
+	core.get_target_playback();
+	update_lod();
+}
+
+void AudioSynthPlayer3D::set_configuration(const Ref<SynthConfiguration> &p_config) {
+	core.set_configuration(p_config);
+}
+
+Ref<SynthConfiguration> AudioSynthPlayer3D::get_configuration() const {
+	return core.get_configuration();
+}
+
+Error AudioSynthPlayer3D::set_patch(const Ref<SynthPresetBank> &p_bank, const String &p_name) {
+	return core.set_patch(p_bank, p_name);
+}
+
+void AudioSynthPlayer3D::set_polyphony(int p_polyphony) {
+	core.set_polyphony(p_polyphony);
+}
+
+int AudioSynthPlayer3D::get_polyphony() const {
+	return core.get_polyphony();
+}
+
+bool AudioSynthPlayer3D::is_rebuilding_voices() const {
+	return core.is_rebuilding_voices();
+}
+
+void AudioSynthPlayer3D::set_use_voice_manager(bool p_enabled) {
+	core.set_use_voice_manager(p_enabled);
+}
+
+bool AudioSynthPlayer3D::get_use_voice_manager() const {
+	return core.get_use_voice_manager();
+}
+
+void AudioSynthPlayer3D::set_voice_category(SynthVoiceManager::VoiceCategory p_category) {
+	core.set_voice_category(p_category);
+}
+
+SynthVoiceManager::VoiceCategory AudioSynthPlayer3D::get_voice_category() const {
+	return core.get_voice_category();
+}
+
+void AudioSynthPlayer3D::set_voice_priority(int p_priority) {
+	core.set_voice_priority(p_priority);
+}
+
+int AudioSynthPlayer3D::get_voice_priority() const {
+	return core.get_voice_priority();
+}
+
+void AudioSynthPlayer3D::set_virtualize_below_db(float p_db) {
+	virtualize_below_db = p_db;
+}
+
+float AudioSynthPlayer3D::get_virtualize_below_db() const {
+	return virtualize_below_db;
+}
+
+void AudioSynthPlayer3D::set_reduce_quality_below_db(float p_db) {
+	reduce_quality_below_db = p_db;
+}
+
+float AudioSynthPlayer3D::get_reduce_quality_below_db() const {
+	return reduce_quality_below_db;
+}
+
+void AudioSynthPlayer3D::set_distant_quality_tier(SynthQualityProfile::QualityTier p_tier) {
+	distant_quality_tier = p_tier;
+}
+
+SynthQualityProfile::QualityTier AudioSynthPlayer3D::get_distant_quality_tier() const {
+	return distant_quality_tier;
+}
+
+float AudioSynthPlayer3D::get_audibility_db() const {
+	return audibility_db;
+}
+
+bool AudioSynthPlayer3D::is_virtualized() const {
+	return virtualized;
+}
+
+Ref<SynthNoteContext> AudioSynthPlayer3D::get_context() {
+	prepare_notes();
+	return core.get_context();
+}
+
+void AudioSynthPlayer3D::stop_all_notes() {
+	core.stop_all_notes();
+}
+
+void AudioSynthPlayer3D::kill_all_notes() {
+	core.kill_all_notes();
+}
+
+void AudioSynthPlayer3D::set_max_note_lifetime(float p_seconds) {
+	core.set_max_note_lifetime(p_seconds);
+}
+
+float AudioSynthPlayer3D::get_max_note_lifetime() const {
+	return core.get_max_note_lifetime();
+}
+
+bool AudioSynthPlayer3D::play_instance(int p_note, float p_velocity, float p_gain, float p_pitch_offset) {
+	return core.play_instance(p_note, p_velocity, p_gain, p_pitch_offset);
+}
+
+void AudioSynthPlayer3D::set_instance_hold(float p_seconds) {
+	core.set_instance_hold(p_seconds);
+}
+
+float AudioSynthPlayer3D::get_instance_hold() const {
+	return core.get_instance_hold();
+}
+
+void AudioSynthPlayer3D::set_instance_length(float p_seconds) {
+	core.set_instance_length(p_seconds);
+}
+
+float AudioSynthPlayer3D::get_instance_length() const {
+	return core.get_instance_length();
+}
+
+PackedInt64Array AudioSynthPlayer3D::note_on_batch(const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations) {
+	prepare_notes();
+	return core.note_on_batch(p_notes, p_velocities, p_articulations);
+}
+
+void AudioSynthPlayer3D::note_off_batch(const PackedInt64Array &p_handles) {
+	core.note_off_batch(p_handles);
+}
+
+void AudioSynthPlayer3D::set_parameter(const String &p_name, float p_value) {
+	core.set_parameter(p_name, p_value);
+}
+
+} // namespace godot
@@ -0,0 +1,105 @@
+#pragma once
+#include "synth_player_core.h"
+#include "synth_quality_profile.h"
+#include <godot_cpp/classes/audio_stream_player3d.hpp>
+
+namespace godot {
+
+// Positional synth player with distance based level of detail.
+// Every frame the player estimates how loud it is at the listener from its distance,
+// attenuation model, unit size, max distance and volume. Below virtualize_below_db its
+// voices stop rendering and only advance their notes, so envelopes and note ends stay
+// on time; below reduce_quality_below_db they render at distant_quality_tier. A level
+// can hold hundreds of these emitters while only the audible ones cost DSP time.
+class AudioSynthPlayer3D : public AudioStreamPlayer3D {
+	GDCLASS(AudioSynthPlayer3D, AudioStreamPlayer3D);
+
+private:
+	// Stream, voices and playback, shared with AudioSynthPlayer
+	SynthPlayerCore<AudioSynthPlayer3D> core;
+
+	// Level of detail
+	float virtualize_below_db = -60.0f;
+	float reduce_quality_below_db = -24.0f;
+	SynthQualityProfile::QualityTier distant_quality_tier = SynthQualityProfile::TIER_LOW;
+	float audibility_db = 0.0f;
+	bool virtualized = false;
+
+	float compute_audibility_db() const;
+	void update_lod();
+
+	// Start the playback and apply the current level of detail before notes are added
+	void prepare_notes();
+
+protected:
+	static void _bind_methods();
+
+public:
+	AudioSynthPlayer3D();
+	~AudioSynthPlayer3D();
+
+	void _ready() override;
+	virtual void _process(double delta) override;
+	virtual void _exit_tree() override;
+
+	void set_configuration(const Ref<SynthConfiguration> &p_config);
+	Ref<SynthConfiguration> get_configuration() const;
+
+	// Play a patch from a preset bank, see SynthPlayerVoices::set_patch()
+	Error set_patch(const Ref<SynthPresetBank> &p_bank, const String &p_name);
+
+	void set_polyphony(int p_polyphony);
+	int get_polyphony() const;
+
+	bool is_rebuilding_voices() const;
+
+	// Voice manager routing, as on AudioSynthPlayer. Managed voices are mixed by the
+	// manager's playback, which is not positional and has no level of detail.
+	void set_use_voice_manager(bool p_enabled);
+	bool get_use_voice_manager() const;
+
+	void set_voice_category(SynthVoiceManager::VoiceCategory p_category);
+	SynthVoiceManager::VoiceCategory get_voice_category() const;
+
+	void set_voice_priority(int p_priority);
+	int get_voice_priority() const;
+
+	// Level of detail
+	void set_virtualize_below_db(float p_db);
+	float get_virtualize_below_db() const;
+
+	void set_reduce_quality_below_db(float p_db);
+	float get_reduce_quality_below_db() const;
+
+	void set_distant_quality_tier(SynthQualityProfile::QualityTier p_tier);
+	SynthQualityProfile::QualityTier get_distant_quality_tier() const;
+
+	// Estimated level at the listener, updated every frame
+	float get_audibility_db() const;
+	bool is_virtualized() const;
+
+	Ref<SynthNoteContext> get_context();
+	void stop_all_notes();
+	void kill_all_notes();
+
+	// Seconds after which a sounding note is killed, 0 for no limit
+	void set_max_note_lifetime(float p_seconds);
+	float get_max_note_lifetime() const;
+
+	// Instanced one-shots, as on AudioSynthPlayer. They follow this player's level of detail.
+	bool play_instance(int p_note, float p_velocity, float p_gain, float p_pitch_offset);
+
+	void set_instance_hold(float p_seconds);
+	float get_instance_hold() const;
+
+	void set_instance_length(float p_seconds);
+	float get_instance_length() const;
+
+	// Batched notes, as on AudioSynthPlayer
+	PackedInt64Array note_on_batch(const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations);
+	void note_off_batch(const PackedInt64Array &p_handles);
+
+	void set_parameter(const String &p_name, float p_value);
+};
+
+} // namespace godot
@@ -1,13 +1,17 @@
 #pragma once
 #include "audio_stream_generator_engine.h"
+#include "patch_program.h"
 #include "synth_configuration.h"
 
 namespace godot {
 
 class EngineFactory {
 public:
-	// Create an engine from a configuration
-	static Ref<AudioStreamGeneratorEngine> create_engine_from_config(const Ref<SynthConfiguration> &config);
+	// Create a standalone engine from a configuration, ready to render at sample_rate
+	static Ref<AudioStreamGeneratorEngine> create_engine_from_config(const Ref<SynthConfiguration> &config, float sample_rate);
+
+	// Create a voice engine from a compiled patch program
+	static Ref<AudioStreamGeneratorEngine> create_engine_from_program(const PatchProgram &program, float sample_rate);
 	
 	// Create a duplicate of an existing engine
 	static Ref<AudioStreamGeneratorEngine> duplicate_engine(const Ref<AudioStreamGeneratorEngine> &engine);
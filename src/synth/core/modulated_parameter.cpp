@@ -50,6 +50,7 @@ void ModulatedParameter::_bind_methods() {
 
 void ModulatedParameter::set_base_value(float p_value) {
 	base_value = p_value;
+	invalidate_fold();
 	emit_changed();
 }
 
@@ -59,6 +60,7 @@ float ModulatedParameter::get_base_value() const {
 
 void ModulatedParameter::set_mod_amount(float p_amount) {
 	mod_amount = p_amount;
+	invalidate_fold();
 }
 
 float ModulatedParameter::get_mod_amount() const {
@@ -67,6 +69,7 @@ float ModulatedParameter::get_mod_amount() const {
 
 void ModulatedParameter::set_mod_min(float p_min) {
 	mod_min = p_min;
+	invalidate_fold();
 }
 
 float ModulatedParameter::get_mod_min() const {
@@ -75,6 +78,7 @@ float ModulatedParameter::get_mod_min() const {
 
 void ModulatedParameter::set_mod_max(float p_max) {
 	mod_max = p_max;
+	invalidate_fold();
 }
 
 float ModulatedParameter::get_mod_max() const {
@@ -83,6 +87,8 @@ float ModulatedParameter::get_mod_max() const {
 
 void ModulatedParameter::set_mod_source(const Ref<ModulationSource> &p_source) {
 	mod_source = p_source;
+	source_variability = mod_source.is_valid() ? mod_source->get_variability() : ModulationSource::VARIABILITY_CONSTANT;
+	invalidate_fold();
 }
 
 Ref<ModulationSource> ModulatedParameter::get_mod_source() const {
@@ -91,6 +97,7 @@ Ref<ModulationSource> ModulatedParameter::get_mod_source() const {
 
 void ModulatedParameter::set_mod_type(ModulationType p_type) {
 	mod_type = p_type;
+	invalidate_fold();
 }
 
 ModulationType ModulatedParameter::get_mod_type() const {
@@ -99,43 +106,71 @@ ModulationType ModulatedParameter::get_mod_type() const {
 
 void ModulatedParameter::set_invert_mod(bool p_invert) {
 	invert_mod = p_invert;
+	invalidate_fold();
 }
 
 bool ModulatedParameter::get_invert_mod() const {
 	return invert_mod;
 }
 
-float ModulatedParameter::get_value(const Ref<SynthNoteContext> &context) const {
+void ModulatedParameter::invalidate_fold() {
+	folded_context = nullptr;
+	folded_note_serial = 0;
+	revision.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ModulatedParameter::is_note_constant() const {
+	return source_variability <= ModulationSource::VARIABILITY_PER_NOTE;
+}
+
+float ModulatedParameter::apply_modulation(float mod_value) const {
 	float value = base_value;
-	// Debug base value
-	if (get_mod_source().is_valid() && context.is_valid()) {
-		float mod_value = get_mod_source()->get_value(context);
 
-		// Apply inversion if needed
-		if (invert_mod) {
-			mod_value = 1.0f - mod_value;
-		}
+	// Apply inversion if needed
+	if (invert_mod) {
+		mod_value = 1.0f - mod_value;
+	}
 
-		// Apply modulation based on selected type
-		switch (mod_type) {
-			case MODULATION_ADDITIVE:
-				value += mod_value * mod_amount;
-				break;
-			case MODULATION_MULTIPLICATIVE:
-				value *= 1.0f + (mod_value * mod_amount);
-				break;
-			case MODULATION_ABSOLUTE:
-				value = mod_value * mod_amount;
-				break;
-			case MODULATION_GATE:
-				value = (mod_value > 0.5f) ? base_value + mod_amount : base_value;
-				break;
-		}
+	// Apply modulation based on selected type
+	switch (mod_type) {
+		case MODULATION_ADDITIVE:
+			value += mod_value * mod_amount;
+			break;
+		case MODULATION_MULTIPLICATIVE:
+			value *= 1.0f + (mod_value * mod_amount);
+			break;
+		case MODULATION_ABSOLUTE:
+			value = mod_value * mod_amount;
+			break;
+		case MODULATION_GATE:
+			value = (mod_value > 0.5f) ? base_value + mod_amount : base_value;
+			break;
 	}
 
 	return Math::clamp(value, mod_min, mod_max);
 }
 
+float ModulatedParameter::get_value(const Ref<SynthNoteContext> &context) const {
+	if (!mod_source.is_valid() || !context.is_valid()) {
+		return Math::clamp(base_value, mod_min, mod_max);
+	}
+
+	// Velocity, key tracking and articulation can't change during a note, so
+	// fold them into the value once at note-on and skip the source afterwards
+	if (is_note_constant()) {
+		const SynthNoteContext *ctx = context.ptr();
+		if (folded_context != ctx || folded_note_serial != ctx->get_note_serial()) {
+			folded_value = apply_modulation(mod_source->get_value(context));
+			folded_context = ctx;
+			folded_note_serial = ctx->get_note_serial();
+		}
+		return folded_value;
+	}
+
+	// Shared sources are evaluated once per tick and fanned out to every target
+	return apply_modulation(mod_source->evaluate(context));
+}
+
 Ref<ModulatedParameter> ModulatedParameter::duplicate() const {
 	Ref<ModulatedParameter> new_param = memnew(ModulatedParameter);
 
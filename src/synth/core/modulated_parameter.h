@@ -3,6 +3,7 @@
 #include "synth_note_context.h"
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/variant/variant.hpp>
+#include <atomic>
 
 namespace godot {
 
@@ -26,6 +27,20 @@ private:
 	ModulationType mod_type = MODULATION_ADDITIVE;
 	bool invert_mod = false;
 
+	// Cached variability of mod_source, refreshed in set_mod_source
+	ModulationSource::Variability source_variability = ModulationSource::VARIABILITY_CONSTANT;
+
+	// Note-constant folding: the final value is computed once per note
+	mutable const SynthNoteContext *folded_context = nullptr;
+	mutable uint64_t folded_note_serial = 0;
+	mutable float folded_value = 0.0f;
+
+	// Bumped by every setter, compiled effect chains watch it from the audio thread
+	std::atomic<uint32_t> revision{ 0 };
+
+	float apply_modulation(float mod_value) const;
+	void invalidate_fold();
+
 protected:
 	static void _bind_methods();
 
@@ -56,6 +71,12 @@ public:
 
 	float get_value(const Ref<SynthNoteContext> &context) const;
 
+	// True when the source is constant for a note's lifetime and gets folded at note-on
+	bool is_note_constant() const;
+
+	// Changes whenever a setter runs
+	uint32_t get_revision() const { return revision.load(std::memory_order_relaxed); }
+
 	// Creates a deep copy of this modulated parameter
 	Ref<ModulatedParameter> duplicate() const;
 };
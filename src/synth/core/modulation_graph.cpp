@@ -0,0 +1,93 @@
+#include "modulation_graph.h"
+#include "../effects/synth_audio_effect.h"
+
+namespace godot {
+
+Ref<ModulationSource> ModulationGraph::get_source(const Ref<ModulationSource> &p_source) {
+	if (!p_source.is_valid()) {
+		return Ref<ModulationSource>();
+	}
+
+	const ModulationSource *key = p_source.ptr();
+	if (source_map.has(key)) {
+		return source_map[key];
+	}
+
+	Ref<ModulationSource> copy = p_source->duplicate();
+	source_map.insert(key, copy);
+	if (copy.is_valid()) {
+		sources.push_back(copy);
+	}
+	return copy;
+}
+
+Ref<ModulatedParameter> ModulationGraph::bind_parameter(const Ref<ModulatedParameter> &p_param) {
+	if (!p_param.is_valid()) {
+		return Ref<ModulatedParameter>();
+	}
+
+	Ref<ModulatedParameter> new_param = p_param->duplicate();
+	new_param->set_mod_source(get_source(p_param->get_mod_source()));
+	return new_param;
+}
+
+Dictionary ModulationGraph::bind_parameters(const Dictionary &p_params) {
+	Dictionary bound;
+	Array names = p_params.keys();
+	for (int i = 0; i < names.size(); i++) {
+		Ref<ModulatedParameter> param = p_params[names[i]];
+		if (param.is_valid()) {
+			bound[names[i]] = bind_parameter(param);
+		}
+	}
+	return bound;
+}
+
+Ref<EffectChain> ModulationGraph::bind_effect_chain(const Ref<EffectChain> &p_chain) {
+	if (!p_chain.is_valid()) {
+		return Ref<EffectChain>();
+	}
+
+	Ref<EffectChain> new_chain = memnew(EffectChain);
+	TypedArray<SynthAudioEffect> effects = p_chain->get_effects();
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (!effect.is_valid()) {
+			continue;
+		}
+
+		Ref<SynthAudioEffect> new_effect = effect->duplicate();
+		if (!new_effect.is_valid()) {
+			continue;
+		}
+
+		// Rewire the duplicated parameters onto the shared per-voice sources
+		Dictionary params = effect->get_parameters();
+		Array names = params.keys();
+		for (int j = 0; j < names.size(); j++) {
+			Ref<ModulatedParameter> param = params[names[j]];
+			Ref<ModulatedParameter> new_param = new_effect->get_parameter(names[j]);
+			if (param.is_valid() && new_param.is_valid()) {
+				new_param->set_mod_source(get_source(param->get_mod_source()));
+			}
+		}
+
+		new_chain->add_effect(new_effect);
+	}
+
+	return new_chain;
+}
+
+void ModulationGraph::reset() {
+	for (int i = 0; i < sources.size(); i++) {
+		sources.write[i]->reset();
+		sources.write[i]->invalidate_cache();
+	}
+}
+
+void ModulationGraph::clear() {
+	source_map.clear();
+	sources.clear();
+}
+
+} // namespace godot
@@ -0,0 +1,44 @@
+#pragma once
+#include "../effects/effect_chain.h"
+#include "modulated_parameter.h"
+#include "modulation_source.h"
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/vector.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+namespace godot {
+
+// Per-voice modulation graph.
+// Configurations may assign one ModulationSource to several parameters (for example an
+// ADSR driving both amplitude and filter cutoff). When a voice is built, every distinct
+// source is duplicated exactly once and all of its targets are rewired to that copy, so
+// the voice evaluates each source once per tick and fans the value out to its targets.
+class ModulationGraph {
+private:
+	// Maps a configuration source to this voice's copy of it
+	HashMap<const ModulationSource *, Ref<ModulationSource>> source_map;
+	Vector<Ref<ModulationSource>> sources;
+
+public:
+	// Get this voice's copy of a configuration source, creating it on first use
+	Ref<ModulationSource> get_source(const Ref<ModulationSource> &p_source);
+
+	// Duplicate a parameter, binding its source to the shared per-voice copy
+	Ref<ModulatedParameter> bind_parameter(const Ref<ModulatedParameter> &p_param);
+
+	// Duplicate every parameter in a dictionary through bind_parameter
+	Dictionary bind_parameters(const Dictionary &p_params);
+
+	// Duplicate an effect chain, binding all effect parameters to shared sources
+	Ref<EffectChain> bind_effect_chain(const Ref<EffectChain> &p_chain);
+
+	// Reset the state of every source in the graph
+	void reset();
+
+	void clear();
+
+	int get_source_count() const { return sources.size(); }
+	const Vector<Ref<ModulationSource>> &get_sources() const { return sources; }
+};
+
+} // namespace godot
@@ -7,7 +7,14 @@ namespace godot {
 
 void ModulationSource::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_value", "context"), &ModulationSource::get_value);
+	ClassDB::bind_method(D_METHOD("evaluate", "context"), &ModulationSource::evaluate);
+	ClassDB::bind_method(D_METHOD("get_variability"), &ModulationSource::get_variability);
 	ClassDB::bind_method(D_METHOD("reset"), &ModulationSource::reset);
+
+	BIND_ENUM_CONSTANT(VARIABILITY_CONSTANT);
+	BIND_ENUM_CONSTANT(VARIABILITY_PER_NOTE);
+	BIND_ENUM_CONSTANT(VARIABILITY_PER_BLOCK);
+	BIND_ENUM_CONSTANT(VARIABILITY_AUDIO_RATE);
 }
 
 float ModulationSource::get_value(const Ref<SynthNoteContext> &context) const {
@@ -15,6 +22,50 @@ float ModulationSource::get_value(const Ref<SynthNoteContext> &context) const {
 	return 0.0f;
 }
 
+ModulationSource::Variability ModulationSource::get_variability() const {
+	// Unknown sources are assumed to change every sample
+	return VARIABILITY_AUDIO_RATE;
+}
+
+bool ModulationSource::is_deterministic() const {
+	// Envelopes, LFOs and note trackers all follow the note clock
+	return true;
+}
+
+float ModulationSource::evaluate(const Ref<SynthNoteContext> &context) const {
+	if (!context.is_valid()) {
+		return get_value(context);
+	}
+
+	// Pick the context counter that matches how often this source can change
+	const SynthNoteContext *ctx = context.ptr();
+	uint64_t tick;
+	switch (get_variability()) {
+		case VARIABILITY_CONSTANT:
+		case VARIABILITY_PER_NOTE:
+			tick = ctx->get_note_serial();
+			break;
+		case VARIABILITY_PER_BLOCK:
+			tick = ctx->get_block_serial();
+			break;
+		default:
+			tick = ctx->get_tick();
+			break;
+	}
+
+	if (cached_context != ctx || cached_tick != tick) {
+		cached_value = get_value(context);
+		cached_context = ctx;
+		cached_tick = tick;
+	}
+	return cached_value;
+}
+
+void ModulationSource::invalidate_cache() {
+	cached_context = nullptr;
+	cached_tick = 0;
+}
+
 void ModulationSource::reset() {
 	// Base implementation does nothing, to be overridden by derived classes
 }
@@ -8,6 +8,23 @@ class SynthNoteContext;
 class ModulationSource : public Resource {
 	GDCLASS(ModulationSource, Resource);
 
+public:
+	// How often a source's output can change, from slowest to fastest.
+	// Sources at or below VARIABILITY_PER_NOTE are folded into the parameter
+	// value once per note instead of being evaluated in the hot loop.
+	enum Variability {
+		VARIABILITY_CONSTANT,
+		VARIABILITY_PER_NOTE,
+		VARIABILITY_PER_BLOCK,
+		VARIABILITY_AUDIO_RATE
+	};
+
+private:
+	// Per-tick memo so a source shared by several parameters is evaluated once
+	mutable const SynthNoteContext *cached_context = nullptr;
+	mutable uint64_t cached_tick = 0;
+	mutable float cached_value = 0.0f;
+
 protected:
 	static void _bind_methods();
 
@@ -18,6 +35,19 @@ public:
 	// Get the modulation value at the given context
 	virtual float get_value(const Ref<SynthNoteContext> &context) const;
 
+	// Declare how often this source's output can change
+	virtual Variability get_variability() const;
+
+	// Whether the output depends only on the note and its time, so two notes with the same
+	// inputs see the same values
+	virtual bool is_deterministic() const;
+
+	// Get the modulation value, evaluating the source at most once per context tick
+	float evaluate(const Ref<SynthNoteContext> &context) const;
+
+	// Drop the cached value so the next evaluate() calls get_value() again
+	void invalidate_cache();
+
 	// Reset the modulation source state
 	virtual void reset();
 
@@ -26,3 +56,4 @@ public:
 };
 
 } // namespace godot
+VARIANT_ENUM_CAST(ModulationSource::Variability);
@@ -0,0 +1,156 @@
+#include "patch_program.h"
+#include "../effects/effect_chain.h"
+#include "../va/va_oscillator_engine.h"
+#include "modulation_graph.h"
+
+namespace godot {
+
+PatchProgram::ParameterSlot PatchProgram::compile_parameter(const String &p_name, const Ref<ModulatedParameter> &p_param, ModulationGraph &p_graph) {
+	ParameterSlot slot;
+	slot.name = p_name;
+	slot.parameter = p_graph.bind_parameter(p_param);
+	slot.shared = !slot.parameter->get_mod_source().is_valid();
+	return slot;
+}
+
+std::shared_ptr<const PatchProgram> PatchProgram::compile(const Ref<SynthConfiguration> &p_configuration) {
+	if (!p_configuration.is_valid()) {
+		return nullptr;
+	}
+
+	std::shared_ptr<PatchProgram> program = std::make_shared<PatchProgram>();
+
+	program->engine_prototype = p_configuration->instantiate_engine();
+	if (!program->engine_prototype.is_valid()) {
+		// Default to VA engine if type is unknown
+		Ref<VAOscillatorEngine> va_engine;
+		va_engine.instantiate();
+		program->engine_prototype = va_engine;
+	}
+
+	// One graph for the whole program, so a source driving several targets stays a
+	// single source in the program and in every voice instantiated from it
+	ModulationGraph graph;
+
+	Dictionary params = p_configuration->get_parameters();
+	Array names = params.keys();
+	for (int i = 0; i < names.size(); i++) {
+		Ref<ModulatedParameter> param = params[names[i]];
+		if (!param.is_valid()) {
+			continue;
+		}
+
+		ParameterSlot slot = compile_parameter(names[i], param, graph);
+		if (slot.shared) {
+			program->shared_parameter_count++;
+		}
+		program->parameters.push_back(slot);
+	}
+
+	Ref<EffectChain> chain = p_configuration->get_effect_chain();
+	if (chain.is_valid()) {
+		TypedArray<SynthAudioEffect> chain_effects = chain->get_effects();
+		for (int i = 0; i < chain_effects.size(); i++) {
+			Ref<SynthAudioEffect> effect = chain_effects[i];
+			if (!effect.is_valid()) {
+				continue;
+			}
+
+			EffectSlot effect_slot;
+			effect_slot.prototype = effect->duplicate();
+			if (!effect_slot.prototype.is_valid()) {
+				continue;
+			}
+
+			Dictionary effect_params = effect->get_parameters();
+			Array effect_param_names = effect_params.keys();
+			for (int j = 0; j < effect_param_names.size(); j++) {
+				Ref<ModulatedParameter> param = effect_params[effect_param_names[j]];
+				if (!param.is_valid()) {
+					continue;
+				}
+
+				ParameterSlot slot = compile_parameter(effect_param_names[j], param, graph);
+				if (slot.shared) {
+					program->shared_parameter_count++;
+				}
+				effect_slot.parameters.push_back(slot);
+			}
+
+			// The slots carry the parameters, voices attach them to their own copy
+			effect_slot.prototype->clear_parameters();
+			program->effects.push_back(effect_slot);
+		}
+	}
+
+	// Copied so editing the configuration's profile can't race the audio thread
+	Ref<SynthQualityProfile> profile = p_configuration->get_quality_profile();
+	if (profile.is_valid()) {
+		program->quality_profile = profile->duplicate();
+	}
+
+	program->finish(graph.get_sources());
+	return program;
+}
+
+std::shared_ptr<const PatchProgram> PatchProgram::assemble(const Ref<AudioStreamGeneratorEngine> &p_engine_prototype, const Vector<ParameterSlot> &p_parameters, const Vector<EffectSlot> &p_effects, const Vector<Ref<ModulationSource>> &p_sources, const Ref<SynthQualityProfile> &p_quality_profile) {
+	if (!p_engine_prototype.is_valid()) {
+		return nullptr;
+	}
+
+	std::shared_ptr<PatchProgram> program = std::make_shared<PatchProgram>();
+	program->engine_prototype = p_engine_prototype;
+	program->parameters = p_parameters;
+	program->effects = p_effects;
+	program->quality_profile = p_quality_profile;
+
+	// The slots arrive unclassified, sort them the same way compile() does
+	for (int i = 0; i < program->parameters.size(); i++) {
+		ParameterSlot &slot = program->parameters.write[i];
+		slot.shared = !slot.parameter->get_mod_source().is_valid();
+		if (slot.shared) {
+			program->shared_parameter_count++;
+		}
+	}
+	for (int i = 0; i < program->effects.size(); i++) {
+		program->effects.write[i].prototype->clear_parameters();
+		Vector<ParameterSlot> &effect_parameters = program->effects.write[i].parameters;
+		for (int j = 0; j < effect_parameters.size(); j++) {
+			ParameterSlot &slot = effect_parameters.write[j];
+			slot.shared = !slot.parameter->get_mod_source().is_valid();
+			if (slot.shared) {
+				program->shared_parameter_count++;
+			}
+		}
+	}
+
+	program->finish(p_sources);
+	return program;
+}
+
+void PatchProgram::finish(const Vector<Ref<ModulationSource>> &p_sources) {
+	source_count = 0;
+	deterministic = engine_prototype->is_deterministic();
+	for (const Ref<ModulationSource> &source : p_sources) {
+		if (!source.is_valid()) {
+			continue;
+		}
+		source_count++;
+		if (!source->is_deterministic()) {
+			deterministic = false;
+		}
+	}
+}
+
+Ref<AudioStreamGeneratorEngine> PatchProgram::instantiate(float p_sample_rate) const {
+	Ref<AudioStreamGeneratorEngine> engine = engine_prototype->duplicate();
+	if (!engine.is_valid()) {
+		return engine;
+	}
+
+	engine->set_sample_rate(p_sample_rate);
+	engine->build_from_program(*this);
+	return engine;
+}
+
+} // namespace godot
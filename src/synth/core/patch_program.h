@@ -0,0 +1,73 @@
+#pragma once
+#include "../effects/synth_audio_effect.h"
+#include "audio_stream_generator_engine.h"
+#include "modulated_parameter.h"
+#include "synth_configuration.h"
+#include <godot_cpp/templates/vector.hpp>
+#include <memory>
+
+namespace godot {
+
+// Compiled, read-only form of a SynthConfiguration.
+// A program is compiled once per configuration change and shared by every voice built
+// from it. It snapshots the oscillator settings, every parameter, every distinct
+// modulation source and the effect topology. Parameters without a modulation source
+// have no per-voice behaviour, so all voices reference the program's copy directly;
+// only modulated parameters, their sources and the effects themselves are instantiated
+// per voice.
+class PatchProgram : public std::enable_shared_from_this<PatchProgram> {
+public:
+	struct ParameterSlot {
+		String name;
+		Ref<ModulatedParameter> parameter;
+		// Shared by every voice instead of being copied per voice
+		bool shared = true;
+	};
+
+	struct EffectSlot {
+		// Effect holding its class settings, without parameters
+		Ref<SynthAudioEffect> prototype;
+		Vector<ParameterSlot> parameters;
+	};
+
+private:
+	// Engine of the configuration's type holding its oscillator settings, without
+	// parameters or effects
+	Ref<AudioStreamGeneratorEngine> engine_prototype;
+	Vector<ParameterSlot> parameters;
+	Vector<EffectSlot> effects;
+	int source_count = 0;
+	int shared_parameter_count = 0;
+	bool deterministic = true;
+
+	// Snapshot of the configuration's quality tiers
+	Ref<SynthQualityProfile> quality_profile;
+
+	static ParameterSlot compile_parameter(const String &p_name, const Ref<ModulatedParameter> &p_param, ModulationGraph &p_graph);
+
+	// Count the program's sources and work out whether it is deterministic
+	void finish(const Vector<Ref<ModulationSource>> &p_sources);
+
+public:
+	// Compile a configuration. Returns nullptr for an invalid configuration.
+	static std::shared_ptr<const PatchProgram> compile(const Ref<SynthConfiguration> &p_configuration);
+
+	// Build a program from objects decoded for it alone, such as a preset bank record.
+	// They are taken over instead of copied, so nothing else may keep or edit them.
+	// Every parameter's source must be one of p_sources.
+	static std::shared_ptr<const PatchProgram> assemble(const Ref<AudioStreamGeneratorEngine> &p_engine_prototype, const Vector<ParameterSlot> &p_parameters, const Vector<EffectSlot> &p_effects, const Vector<Ref<ModulationSource>> &p_sources, const Ref<SynthQualityProfile> &p_quality_profile);
+
+	// Create a voice engine running this program
+	Ref<AudioStreamGeneratorEngine> instantiate(float p_sample_rate) const;
+
+	const Vector<ParameterSlot> &get_parameters() const { return parameters; }
+	const Vector<EffectSlot> &get_effects() const { return effects; }
+	int get_source_count() const { return source_count; }
+	int get_shared_parameter_count() const { return shared_parameter_count; }
+	const Ref<SynthQualityProfile> &get_quality_profile() const { return quality_profile; }
+
+	// Every note with the same inputs sounds the same, so one render can stand in for many
+	bool is_deterministic() const { return deterministic; }
+};
+
+} // namespace godot
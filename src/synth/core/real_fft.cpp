@@ -0,0 +1,153 @@
+#include "real_fft.h"
+#include <cmath>
+
+namespace godot {
+
+namespace {
+
+// s butterflies sharing the twiddle w. Without restrict the compiler would need a run
+// time overlap check for every pair of the eight arrays before vectorizing.
+void butterflies(const float *__restrict p_a_re, const float *__restrict p_a_im, const float *__restrict p_b_re, const float *__restrict p_b_im,
+		float *__restrict r_sum_re, float *__restrict r_sum_im, float *__restrict r_diff_re, float *__restrict r_diff_im, float p_w_re, float p_w_im, int p_count) {
+	for (int q = 0; q < p_count; q++) {
+		float d_re = p_a_re[q] - p_b_re[q];
+		float d_im = p_a_im[q] - p_b_im[q];
+		r_sum_re[q] = p_a_re[q] + p_b_re[q];
+		r_sum_im[q] = p_a_im[q] + p_b_im[q];
+		r_diff_re[q] = d_re * p_w_re - d_im * p_w_im;
+		r_diff_im[q] = d_re * p_w_im + d_im * p_w_re;
+	}
+}
+
+} // namespace
+
+void RealFft::setup(int p_size) {
+	size = p_size;
+	half = p_size / 2;
+
+	const double two_pi = 6.283185307179586476925;
+	twiddle_re.resize(half / 2);
+	twiddle_im.resize(half / 2);
+	for (int k = 0; k < half / 2; k++) {
+		double angle = -two_pi * k / half;
+		twiddle_re[k] = static_cast<float>(std::cos(angle));
+		twiddle_im[k] = static_cast<float>(std::sin(angle));
+	}
+
+	unpack_re.resize(half + 1);
+	unpack_im.resize(half + 1);
+	for (int k = 0; k <= half; k++) {
+		double angle = -two_pi * k / size;
+		unpack_re[k] = static_cast<float>(std::cos(angle));
+		unpack_im[k] = static_cast<float>(std::sin(angle));
+	}
+
+	for (int i = 0; i < 2; i++) {
+		work_re[i].assign(half, 0.0f);
+		work_im[i].assign(half, 0.0f);
+	}
+}
+
+int RealFft::transform(bool p_inverse) {
+	// The inverse runs the same passes with conjugated twiddles
+	float sign = p_inverse ? -1.0f : 1.0f;
+	int source = 0;
+
+	// Each pass splits sequences of length n into butterflies m apart and writes them
+	// out in order, s is the number of interleaved sequences
+	int s = 1;
+	for (int n = half; n > 1; n >>= 1, s <<= 1) {
+		int m = n >> 1;
+		const float *x_re = work_re[source].data();
+		const float *x_im = work_im[source].data();
+		float *y_re = work_re[source ^ 1].data();
+		float *y_im = work_im[source ^ 1].data();
+
+		if (s == 1) {
+			// First pass, the butterflies are the loop
+			for (int p = 0; p < m; p++) {
+				float w_re = twiddle_re[p];
+				float w_im = twiddle_im[p] * sign;
+				float a_re = x_re[p];
+				float a_im = x_im[p];
+				float b_re = x_re[p + m];
+				float b_im = x_im[p + m];
+				float d_re = a_re - b_re;
+				float d_im = a_im - b_im;
+				y_re[2 * p] = a_re + b_re;
+				y_im[2 * p] = a_im + b_im;
+				y_re[2 * p + 1] = d_re * w_re - d_im * w_im;
+				y_im[2 * p + 1] = d_re * w_im + d_im * w_re;
+			}
+		} else {
+			for (int p = 0; p < m; p++) {
+				float w_re = twiddle_re[p * s];
+				float w_im = twiddle_im[p * s] * sign;
+				float *sum_re = y_re + s * 2 * p;
+				float *sum_im = y_im + s * 2 * p;
+				butterflies(x_re + s * p, x_im + s * p, x_re + s * (p + m), x_im + s * (p + m), sum_re, sum_im, sum_re + s, sum_im + s, w_re, w_im, s);
+			}
+		}
+		source ^= 1;
+	}
+	return source;
+}
+
+void RealFft::forward(const float *p_input, float *r_re, float *r_im) {
+	// Even samples become the real parts, odd samples the imaginary parts
+	float *z_re = work_re[0].data();
+	float *z_im = work_im[0].data();
+	for (int n = 0; n < half; n++) {
+		z_re[n] = p_input[2 * n];
+		z_im[n] = p_input[2 * n + 1];
+	}
+
+	int result = transform(false);
+	z_re = work_re[result].data();
+	z_im = work_im[result].data();
+
+	// Split Z into the spectra of the even and odd samples and combine them,
+	// X[k] = E[k] + W^k O[k]
+	int mask = half - 1;
+	for (int k = 0; k <= half; k++) {
+		int a = k & mask;
+		int b = (half - k) & mask;
+		float c_re = z_re[b];
+		float c_im = -z_im[b];
+		float e_re = 0.5f * (z_re[a] + c_re);
+		float e_im = 0.5f * (z_im[a] + c_im);
+		float o_re = 0.5f * (z_im[a] - c_im);
+		float o_im = -0.5f * (z_re[a] - c_re);
+		r_re[k] = e_re + unpack_re[k] * o_re - unpack_im[k] * o_im;
+		r_im[k] = e_im + unpack_re[k] * o_im + unpack_im[k] * o_re;
+	}
+}
+
+void RealFft::inverse(const float *p_re, const float *p_im, float *r_output) {
+	// Undo the unpacking, Z[k] = E[k] + i O[k] with O[k] = (X[k] - X*[half - k]) W^-k.
+	// The halves are left out, which doubles the output of the passes to size.
+	float *z_re = work_re[0].data();
+	float *z_im = work_im[0].data();
+	for (int k = 0; k < half; k++) {
+		float b_re = p_re[half - k];
+		float b_im = -p_im[half - k];
+		float e_re = p_re[k] + b_re;
+		float e_im = p_im[k] + b_im;
+		float d_re = p_re[k] - b_re;
+		float d_im = p_im[k] - b_im;
+		float o_re = d_re * unpack_re[k] + d_im * unpack_im[k];
+		float o_im = d_im * unpack_re[k] - d_re * unpack_im[k];
+		z_re[k] = e_re - o_im;
+		z_im[k] = e_im + o_re;
+	}
+
+	int result = transform(true);
+	z_re = work_re[result].data();
+	z_im = work_im[result].data();
+	for (int n = 0; n < half; n++) {
+		r_output[2 * n] = z_re[n];
+		r_output[2 * n + 1] = z_im[n];
+	}
+}
+
+} // namespace godot
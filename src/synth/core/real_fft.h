@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+namespace godot {
+
+// FFT of real signals whose length is a power of two.
+// A real signal of N samples is packed into N / 2 complex values, transformed with radix 2
+// Stockham passes and unpacked into the N / 2 + 1 bins of its spectrum. Spectra are kept
+// as separate real and imaginary arrays and every pass walks its buffers in order, so the
+// butterflies and the complex multiplies that work on these spectra vectorize.
+class RealFft {
+private:
+	int size = 0;
+	int half = 0;
+
+	// exp(-2 pi i k / half) for the complex passes, exp(-2 pi i k / size) for the unpacking
+	std::vector<float> twiddle_re;
+	std::vector<float> twiddle_im;
+	std::vector<float> unpack_re;
+	std::vector<float> unpack_im;
+
+	// Ping pong buffers of the complex passes
+	std::vector<float> work_re[2];
+	std::vector<float> work_im[2];
+
+	// Transform work buffer 0 in place, returns the buffer holding the result
+	int transform(bool p_inverse);
+
+public:
+	// p_size must be a power of two, at least 4
+	void setup(int p_size);
+	int get_size() const { return size; }
+
+	// get_size() samples in, get_size() / 2 + 1 bins out
+	void forward(const float *p_input, float *r_re, float *r_im);
+
+	// Unnormalized, the output is get_size() times the signal the spectrum came from
+	void inverse(const float *p_re, const float *p_im, float *r_output);
+};
+
+} // namespace godot
@@ -0,0 +1,42 @@
+#pragma once
+#include <new>
+#include <vector>
+
+namespace godot {
+
+// Element allocator for the godot HashMap that keeps freed elements for reuse.
+// Once a map has held as many elements as it ever will, inserts and erases stop going
+// to the system allocator, which lets the audio thread own a map.
+template <typename T>
+class RecyclingAllocator {
+	std::vector<T *> free_elements;
+	size_t allocated = 0;
+
+public:
+	~RecyclingAllocator() {
+		for (T *element : free_elements) {
+			::operator delete(element);
+		}
+	}
+
+	T *new_allocation(const T &p_value) {
+		void *memory = nullptr;
+		if (free_elements.empty()) {
+			// The free list can take back every element without growing later
+			allocated++;
+			free_elements.reserve(allocated);
+			memory = ::operator new(sizeof(T));
+		} else {
+			memory = free_elements.back();
+			free_elements.pop_back();
+		}
+		return new (memory) T(p_value);
+	}
+
+	void delete_allocation(T *p_element) {
+		p_element->~T();
+		free_elements.push_back(p_element);
+	}
+};
+
+} // namespace godot
@@ -0,0 +1,79 @@
+#include "render_ahead_ring.h"
+#include <algorithm>
+
+namespace godot {
+
+RenderAheadRing::RenderAheadRing(int p_capacity) {
+	uint32_t capacity = 1;
+	while (capacity < static_cast<uint32_t>(std::max(p_capacity, 1))) {
+		capacity <<= 1;
+	}
+	buffer.resize(capacity, 0.0f);
+	mask = capacity - 1;
+	space_available.instantiate();
+}
+
+int RenderAheadRing::get_capacity() const {
+	return static_cast<int>(buffer.size());
+}
+
+int RenderAheadRing::get_free() const {
+	uint64_t used = write_position.load(std::memory_order_relaxed) - read_position.load(std::memory_order_acquire);
+	return static_cast<int>(buffer.size() - used);
+}
+
+void RenderAheadRing::write(const float *p_samples, int p_count) {
+	uint64_t position = write_position.load(std::memory_order_relaxed);
+	for (int i = 0; i < p_count; i++) {
+		buffer[(position + i) & mask] = p_samples[i];
+	}
+	write_position.store(position + p_count, std::memory_order_release);
+}
+
+void RenderAheadRing::wait_for_space(int p_min_free) {
+	wake_free.store(std::max(p_min_free, 1), std::memory_order_relaxed);
+	// Pairs with the fence in read_add(), one side always sees the other's store
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (get_free() >= p_min_free && wake_free.exchange(0, std::memory_order_relaxed) != 0) {
+		// The space came in before the reader saw the request
+		return;
+	}
+	space_available->wait();
+}
+
+void RenderAheadRing::wake() {
+	wake_free.store(0, std::memory_order_relaxed);
+	space_available->post();
+}
+
+int RenderAheadRing::read_add(float *r_mix, int p_count) {
+	uint64_t position = read_position.load(std::memory_order_relaxed);
+	uint64_t available = write_position.load(std::memory_order_acquire) - position;
+	int count = static_cast<int>(std::min<uint64_t>(available, p_count));
+	for (int i = 0; i < count; i++) {
+		r_mix[i] += buffer[(position + i) & mask];
+	}
+	read_position.store(position + count, std::memory_order_release);
+
+	// Lock free unless the producer sleeps and can now fill a chunk
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int needed = wake_free.load(std::memory_order_relaxed);
+	if (needed > 0 && get_free() >= needed && wake_free.compare_exchange_strong(needed, 0, std::memory_order_relaxed)) {
+		space_available->post();
+	}
+
+	if (count < p_count) {
+		underruns.fetch_add(1, std::memory_order_relaxed);
+	}
+	return count;
+}
+
+int RenderAheadRing::get_available() const {
+	return static_cast<int>(write_position.load(std::memory_order_acquire) - read_position.load(std::memory_order_relaxed));
+}
+
+uint32_t RenderAheadRing::get_underrun_count() const {
+	return underruns.load(std::memory_order_relaxed);
+}
+
+} // namespace godot
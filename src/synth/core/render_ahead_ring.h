@@ -0,0 +1,49 @@
+#pragma once
+#include <godot_cpp/classes/semaphore.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+// Mono audio rendered ahead of the audio thread.
+// One producer thread writes, the audio thread reads, neither ever waits on the other.
+// The capacity is the lookahead: a producer that keeps the ring full stays that far ahead
+// of what is being heard. The producer sleeps on space_available instead of polling.
+// Posting takes the semaphore's mutex, so the audio thread only posts after the producer
+// announced it is asleep and enough space is free for it, once per sleep. The only thread
+// that can hold that mutex then is the producer entering its wait, for a few instructions.
+class RenderAheadRing {
+private:
+	std::vector<float> buffer;
+	Ref<Semaphore> space_available;
+	uint32_t mask = 0;
+	std::atomic<uint64_t> write_position{ 0 };
+	std::atomic<uint64_t> read_position{ 0 };
+	std::atomic<uint32_t> underruns{ 0 };
+
+	// Free space the sleeping producer waits for, 0 while it is awake. Whoever swaps it
+	// back to 0 decides whether the semaphore is posted.
+	std::atomic<int> wake_free{ 0 };
+
+public:
+	// Rounded up to a power of two
+	explicit RenderAheadRing(int p_capacity);
+
+	int get_capacity() const;
+
+	// Producer side. wait_for_space() returns once p_min_free samples are free, or after wake().
+	int get_free() const;
+	void write(const float *p_samples, int p_count);
+	void wait_for_space(int p_min_free);
+	void wake();
+
+	// Consumer side. Adds up to p_count samples to r_mix and returns how many there were,
+	// a short read counts as an underrun.
+	int read_add(float *r_mix, int p_count);
+	int get_available() const;
+
+	uint32_t get_underrun_count() const;
+};
+
+} // namespace godot
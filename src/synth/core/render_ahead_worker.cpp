@@ -0,0 +1,54 @@
+#include "render_ahead_worker.h"
+#include <godot_cpp/core/class_db.hpp>
+#include <algorithm>
+
+namespace godot {
+
+void RenderAheadWorker::_bind_methods() {
+}
+
+RenderAheadWorker::~RenderAheadWorker() {
+	stop();
+}
+
+void RenderAheadWorker::start(const Ref<SynthAudioStreamPlayback> &p_source, const std::shared_ptr<RenderAheadRing> &p_ring) {
+	stop();
+	if (!p_source.is_valid() || !p_ring) {
+		return;
+	}
+	source = p_source;
+	ring = p_ring;
+
+	running.store(true);
+	thread.instantiate();
+	thread->start(callable_mp(this, &RenderAheadWorker::run), Thread::PRIORITY_HIGH);
+}
+
+void RenderAheadWorker::stop() {
+	if (thread.is_valid()) {
+		running.store(false);
+		ring->wake();
+		thread->wait_to_finish();
+		thread.unref();
+	}
+	source.unref();
+	ring.reset();
+}
+
+bool RenderAheadWorker::is_running() const {
+	return running.load();
+}
+
+void RenderAheadWorker::run() {
+	float chunk[CHUNK_FRAMES];
+	while (running.load()) {
+		while (running.load() && ring->get_free() >= CHUNK_FRAMES) {
+			std::fill(chunk, chunk + CHUNK_FRAMES, 0.0f);
+			source->render(chunk, CHUNK_FRAMES);
+			ring->write(chunk, CHUNK_FRAMES);
+		}
+		ring->wait_for_space(CHUNK_FRAMES);
+	}
+}
+
+} // namespace godot
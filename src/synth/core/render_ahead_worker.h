@@ -0,0 +1,44 @@
+#pragma once
+#include "render_ahead_ring.h"
+#include "synth_audio_stream_playback.h"
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/classes/thread.hpp>
+#include <atomic>
+#include <memory>
+
+namespace godot {
+
+// Keeps a RenderAheadRing full from a playback, on a thread of its own.
+// The playback isn't attached to the audio server, so its voices and its scheduler run
+// here instead of in _mix, and a slow frame on the audio thread or the main thread
+// doesn't touch them. What it renders is heard once the ring has played the samples
+// already queued in front of it. Between fills the thread sleeps until the audio thread
+// has read a chunk's worth from the ring.
+class RenderAheadWorker : public RefCounted {
+	GDCLASS(RenderAheadWorker, RefCounted);
+
+public:
+	static constexpr int CHUNK_FRAMES = 256;
+
+private:
+	Ref<SynthAudioStreamPlayback> source;
+	std::shared_ptr<RenderAheadRing> ring;
+	Ref<Thread> thread;
+	std::atomic<bool> running{ false };
+
+	void run();
+
+protected:
+	static void _bind_methods();
+
+public:
+	~RenderAheadWorker();
+
+	void start(const Ref<SynthAudioStreamPlayback> &p_source, const std::shared_ptr<RenderAheadRing> &p_ring);
+
+	// Returns once the thread has finished its current chunk
+	void stop();
+	bool is_running() const;
+};
+
+} // namespace godot
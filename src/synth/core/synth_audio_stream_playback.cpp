@@ -1,7 +1,13 @@
 #include "synth_audio_stream_playback.h"
+#include "audio_stream_generator_engine.h"
+#include "synth_quality_governor.h"
+#include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
+#include <algorithm>
+#include <functional>
 #include <limits>
+#include <thread>
 
 namespace godot {
 
@@ -11,9 +17,30 @@ void SynthAudioStreamPlayback::_bind_methods() {
 SynthAudioStreamPlayback::SynthAudioStreamPlayback() {
 	// Initialize mix buffer with a reasonable size
 	mix_buffer.resize(1024);
+	retired_ids.reserve(VOICE_MAP_RESERVE);
+
+	// Allocate the voice table and its elements here rather than on the audio thread
+	active_voices.reserve(VOICE_MAP_RESERVE * 2);
+	for (int i = 0; i < VOICE_MAP_RESERVE; i++) {
+		active_voices.insert(-1 - i, ActiveVoice());
+	}
+	active_voices.clear();
 }
 
 SynthAudioStreamPlayback::~SynthAudioStreamPlayback() {
+	// Voices still held here, or on their way in, go back to their pools
+	for (const auto &E : active_voices) {
+		if (E.value.voice.is_valid()) {
+			E.value.voice->unclaim();
+		}
+	}
+	uint32_t write = command_write.load(std::memory_order_acquire);
+	for (uint32_t read = command_read.load(std::memory_order_acquire); read != write; read++) {
+		const VoiceCommand &command = commands[read % COMMAND_CAPACITY];
+		if (command.type == VOICE_COMMAND_ADD && command.voice.is_valid()) {
+			command.voice->unclaim();
+		}
+	}
 }
 
 void SynthAudioStreamPlayback::set_generator(const Ref<AudioStreamGenerator> &p_generator) {
@@ -22,6 +49,8 @@ void SynthAudioStreamPlayback::set_generator(const Ref<AudioStreamGenerator> &p_
 
 void SynthAudioStreamPlayback::set_sample_rate(float p_sample_rate) {
 	sample_rate = p_sample_rate;
+	kill_fade_frames = MAX(static_cast<int>(sample_rate * KILL_FADE_TIME), 1);
+	instancer.set_sample_rate(sample_rate, kill_fade_frames);
 }
 
 // Clock management methods
@@ -35,78 +64,379 @@ void SynthAudioStreamPlayback::sync_context_time(const Ref<SynthNoteContext> &co
 	}
 }
 
-Ref<SynthVoice> SynthAudioStreamPlayback::get_voice(int64_t voice_id) const {
-	if (active_voices.has(voice_id)) {
-		return active_voices[voice_id];
+void SynthAudioStreamPlayback::render_voices(float *r_mix, int p_frames, int p_quality_tier, bool p_render) {
+	// Voices built from the same program render as a group, so their effect stages run
+	// across several voices at once. Others render on their own.
+	grouped_voices.clear();
+	for (auto &E : active_voices) {
+		Ref<SynthVoice> voice = E.value.voice;
+		if (!voice.is_valid()) {
+			continue;
+		}
+
+		Ref<AudioStreamGeneratorEngine> engine = voice->get_engine();
+		if (engine.is_valid()) {
+			engine->apply_quality_tier(p_quality_tier);
+		}
+
+		// A voice being killed renders alone, under its fade
+		int &fade = E.value.fade;
+		if (fade >= 0) {
+			if (p_render) {
+				render_fading_voice(voice, fade, r_mix, p_frames);
+			} else {
+				voice->advance_virtual(p_frames);
+				fade = MAX(fade - p_frames, 0);
+			}
+		} else if (!p_render) {
+			voice->advance_virtual(p_frames);
+		} else if (engine.is_valid() && engine->get_program() != nullptr) {
+			grouped_voices.push_back({ engine->get_program(), voice });
+		} else {
+			// Process the voice
+			PackedFloat32Array voice_buffer = voice->process_block(p_frames, current_time);
+
+			// Mix the voice into the output buffer
+			for (int i = 0; i < p_frames && i < voice_buffer.size(); i++) {
+				r_mix[i] += voice_buffer[i];
+			}
+		}
 	}
-	return Ref<SynthVoice>();
-}
 
-int SynthAudioStreamPlayback::_mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
-	if (active_voices.size() == 0) {
-		// Fill with silence
-		for (int i = 0; i < p_frames; i++) {
-			p_buffer[i] = AudioFrame(); // Default constructor creates a silent frame
+	if (!grouped_voices.empty()) {
+		std::sort(grouped_voices.begin(), grouped_voices.end(), [](const GroupedVoice &a, const GroupedVoice &b) {
+			return std::less<const PatchProgram *>()(a.program, b.program);
+		});
+		group_voices.resize(grouped_voices.size());
+		size_t first = 0;
+		while (first < grouped_voices.size()) {
+			size_t last = first;
+			while (last < grouped_voices.size() && grouped_voices[last].program == grouped_voices[first].program) {
+				group_voices[last - first] = grouped_voices[last].voice;
+				last++;
+			}
+			group_renderer.render(group_voices.data(), static_cast<int>(last - first), p_frames, r_mix);
+			first = last;
 		}
-		return p_frames;
+		group_voices.clear();
 	}
+}
 
-	// Ensure mix buffer is large enough
-	if (mix_buffer.size() < p_frames) {
-		mix_buffer.resize(p_frames);
+void SynthAudioStreamPlayback::render_fading_voice(const Ref<SynthVoice> &p_voice, int &r_fade, float *r_mix, int p_frames) {
+	PackedFloat32Array voice_buffer = p_voice->process_block(p_frames, current_time);
+	const float *samples = voice_buffer.ptr();
+	int frames = MIN(p_frames, static_cast<int>(voice_buffer.size()));
+
+	// Linear ramp to silence, whatever is left of the block after it is dropped
+	float step = 1.0f / kill_fade_frames;
+	for (int i = 0; i < frames && r_fade > 0; i++) {
+		r_mix[i] += samples[i] * (r_fade * step);
+		r_fade--;
 	}
+}
 
-	// Clear the mix buffer
-	for (int i = 0; i < p_frames; i++) {
-		mix_buffer[i] = 0.0f;
+void SynthAudioStreamPlayback::start_kill(ActiveVoice &p_active) {
+	if (p_active.fade < 0) {
+		p_active.fade = kill_fade_frames;
 	}
+}
 
-	// Update current time
-	float time_per_frame = 1.0 / sample_rate;
-	current_time += time_per_frame * p_frames;
+void SynthAudioStreamPlayback::release_active_voice(ActiveVoice &p_active) {
+	if (!p_active.voice.is_valid() || !p_active.voice->is_active()) {
+		return;
+	}
+	Ref<SynthNoteContext> context = p_active.voice->get_current_context();
+	if (context.is_valid()) {
+		context->note_off(context->get_absolute_time());
+	}
+}
+
+bool SynthAudioStreamPlayback::push_command(VoiceCommand &p_command) {
+	uint32_t write = command_write.load(std::memory_order_relaxed);
+	ERR_FAIL_COND_V_MSG(write - command_read.load(std::memory_order_acquire) >= COMMAND_CAPACITY, false, "Voice command queue is full, the request was dropped.");
+
+	VoiceCommand &command = commands[write % COMMAND_CAPACITY];
+	command.type = p_command.type;
+	command.voice_id = p_command.voice_id;
+	command.voice = p_command.voice;
+	command.context = p_command.context;
+	command.owner = p_command.owner;
+	command.serial = p_command.serial;
+	command_write.store(write + 1, std::memory_order_release);
+	return true;
+}
 
-	// Process each voice
-	Vector<int64_t> finished_voices;
+void SynthAudioStreamPlayback::apply_commands() {
+	uint32_t read = command_read.load(std::memory_order_relaxed);
+	uint32_t write = command_write.load(std::memory_order_acquire);
+	for (; read != write; read++) {
+		VoiceCommand &command = commands[read % COMMAND_CAPACITY];
+		switch (command.type) {
+			case VOICE_COMMAND_ADD: {
+				// A voice stolen while it played here starts its new note now. The context
+				// it played stays in the command, the main thread drops it with the slot.
+				command.voice->take_context(command.context);
+				insert_voice(command.voice_id, command.voice, command.owner, command.serial);
+			} break;
+			case VOICE_COMMAND_REMOVE: {
+				erase_voice(command.voice_id);
+			} break;
+			case VOICE_COMMAND_RELEASE:
+			case VOICE_COMMAND_KILL: {
+				ActiveVoice *active = active_voices.getptr(command.voice_id);
+				if (active == nullptr) {
+					break;
+				}
+				if (command.type == VOICE_COMMAND_KILL) {
+					start_kill(*active);
+				} else {
+					release_active_voice(*active);
+				}
+			} break;
+			case VOICE_COMMAND_RELEASE_ALL:
+			case VOICE_COMMAND_KILL_ALL: {
+				for (auto &E : active_voices) {
+					if (E.value.serial > command.serial || (command.owner != 0 && E.value.owner != command.owner)) {
+						continue;
+					}
+					if (command.type == VOICE_COMMAND_KILL_ALL) {
+						start_kill(E.value);
+					} else {
+						release_active_voice(E.value);
+					}
+				}
+			} break;
+			case VOICE_COMMAND_CLEAR: {
+				retired_ids.clear();
+				for (const auto &E : active_voices) {
+					retired_ids.push_back(E.key);
+				}
+				for (int64_t voice_id : retired_ids) {
+					erase_voice(voice_id);
+				}
+			} break;
+		}
+	}
+	command_read.store(read, std::memory_order_release);
+	active_voice_count.store(active_voices.size());
+}
+
+void SynthAudioStreamPlayback::insert_voice(int64_t p_id, const Ref<SynthVoice> &p_voice, uint64_t p_owner, uint64_t p_serial) {
+	// Sync the voice's context with our current time
+	Ref<SynthNoteContext> context = p_voice->get_current_context();
+	if (context.is_valid()) {
+		sync_context_time(context);
+	}
 
+	// A voice restarted while its previous note still sounds replaces that entry, otherwise
+	// it would render twice per block
+	int64_t previous_id = p_id;
 	for (const auto &E : active_voices) {
-		int64_t voice_id = E.key;
-		Ref<SynthVoice> voice = E.value;
+		if (E.value.voice == p_voice) {
+			previous_id = E.key;
+			break;
+		}
+	}
+	if (previous_id != p_id) {
+		erase_voice(previous_id, true);
+	}
 
-		if (voice.is_valid()) {
-			// Process the voice
-			PackedFloat32Array voice_buffer = voice->process_block(p_frames, current_time);
+	// Add the voice to the active voices
+	ActiveVoice active;
+	active.voice = p_voice;
+	active.owner = p_owner;
+	active.serial = p_serial;
+	active_voices[p_id] = active;
 
-			// Mix the voice into the output buffer
-			for (int i = 0; i < p_frames && i < voice_buffer.size(); i++) {
-				mix_buffer[i] += voice_buffer[i];
-			}
+	// If we exceed max polyphony, we might need to remove the oldest voice
+	// But only if it doesn't have active delay tails
+	if (active_voices.size() > max_polyphony) {
+		int64_t oldest_id = 0;
+		double oldest_time = std::numeric_limits<double>::max();
+		bool found_removable = false;
 
-			// Check if the voice is completely finished (including tails)
-			if (!voice->is_active() && !has_active_tail(voice)) {
-				finished_voices.push_back(voice_id);
+		// Find the oldest voice without active tails
+		for (const auto &E : active_voices) {
+			Ref<SynthVoice> current_voice = E.value.voice;
+			if (!current_voice->is_active() && !has_active_tail(current_voice)) {
+				// We can't directly access SynthNoteContext methods here
+				// Just use the voice ID as a proxy for age
+				if (E.key < oldest_id || oldest_id == 0) {
+					oldest_id = E.key;
+					found_removable = true;
+				}
 			}
 		}
+
+		// If we found an eligible voice to remove
+		if (found_removable) {
+			erase_voice(oldest_id);
+		}
+	}
+}
+
+void SynthAudioStreamPlayback::retire_voices() {
+	// Killed voices whose fade ended, and voices finished along with their tails
+	retired_ids.clear();
+	for (const auto &E : active_voices) {
+		Ref<SynthVoice> voice = E.value.voice;
+		if (E.value.fade == 0 || (voice.is_valid() && !voice->is_active() && !has_active_tail(voice))) {
+			retired_ids.push_back(E.key);
+		}
 	}
 
-	// Remove completely finished voices
-	for (int i = 0; i < finished_voices.size(); i++) {
-		int64_t voice_id = finished_voices[i];
-		// Get the voice before erasing it
-		Ref<SynthVoice> voice = active_voices[voice_id];
-		if (voice.is_valid()) {
+	for (int64_t voice_id : retired_ids) {
+		ActiveVoice *active = active_voices.getptr(voice_id);
+		if (active->voice.is_valid()) {
+			if (active->fade == 0) {
+				active->voice->reset();
+			}
 			// Clear the context reference in the voice
-			voice->clear_context();
+			active->voice->clear_context();
+		}
+		erase_voice(voice_id);
+	}
+	active_voice_count.store(active_voices.size());
+}
+
+void SynthAudioStreamPlayback::erase_voice(int64_t p_id, bool p_restarting) {
+	ActiveVoice *active = active_voices.getptr(p_id);
+	if (active == nullptr) {
+		return;
+	}
+	Ref<SynthVoice> voice = active->voice;
+	active_voices.erase(p_id);
+
+	uint32_t write = finished_write.load(std::memory_order_relaxed);
+	if (write - finished_read.load(std::memory_order_acquire) < FINISHED_CAPACITY) {
+		finished_ids[write % FINISHED_CAPACITY] = p_id;
+		finished_write.store(write + 1, std::memory_order_release);
+	}
+
+	// From here on the main thread may take the voice for its next note
+	if (voice.is_valid() && !p_restarting) {
+		voice->unclaim();
+	}
+}
+
+bool SynthAudioStreamPlayback::pop_finished_voice(int64_t &r_voice_id) {
+	uint32_t read = finished_read.load(std::memory_order_relaxed);
+	if (read == finished_write.load(std::memory_order_acquire)) {
+		return false;
+	}
+	r_voice_id = finished_ids[read % FINISHED_CAPACITY];
+	finished_read.store(read + 1, std::memory_order_release);
+	return true;
+}
+
+bool SynthAudioStreamPlayback::render(float *r_mix, int p_frames) {
+	rendering.store(true);
+	bool audible = render_block(r_mix, p_frames);
+	rendering.store(false);
+	return audible;
+}
+
+bool SynthAudioStreamPlayback::render_block(float *r_mix, int p_frames) {
+	apply_commands();
+
+	scheduler.acquire();
+	Scheduler *current_scheduler = scheduler.get().get();
+	if (active_voices.size() == 0 && !current_scheduler && instancer.is_idle()) {
+		return false;
+	}
+
+	SynthQualityGovernor *governor = SynthQualityGovernor::get_singleton();
+	int quality_tier = governor != nullptr ? governor->get_tier() : SynthQualityProfile::TIER_HIGH;
+
+	// Distant players lower the tier further, inaudible ones don't render at all
+	quality_tier = MAX(quality_tier, lod_tier.load());
+	bool render_audio = !virtualized.load();
+
+	// Without a scheduler this is one segment. With one, the block splits at its events and
+	// the clock stands at each segment's first frame while the scheduler fires.
+	float time_per_frame = 1.0 / sample_rate;
+	int rendered = 0;
+	while (rendered < p_frames) {
+		int frames = p_frames - rendered;
+		if (current_scheduler) {
+			frames = CLAMP(current_scheduler->fire(*this, frames), 1, frames);
+		}
+		render_voices(r_mix + rendered, frames, quality_tier, render_audio);
+		current_time += time_per_frame * frames;
+		if (current_scheduler) {
+			current_scheduler->advance(frames);
+		}
+		rendered += frames;
+	}
+	instancer.render(r_mix, p_frames, render_audio);
+
+	// Notes past the lifetime limit are leaks, stuck notes nobody released
+	float lifetime = max_note_lifetime.load();
+	if (lifetime > 0.0f) {
+		for (auto &E : active_voices) {
+			Ref<SynthVoice> voice = E.value.voice;
+			if (!voice.is_valid() || !voice->is_active()) {
+				continue;
+			}
+			Ref<SynthNoteContext> context = voice->get_current_context();
+			if (context.is_valid() && context->get_note_time() > lifetime) {
+				start_kill(E.value);
+			}
+		}
+	}
+	retire_voices();
+
+	return true;
+}
+
+int SynthAudioStreamPlayback::_mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
+	// Ensure mix buffer is large enough
+	if (mix_buffer.size() < p_frames) {
+		mix_buffer.resize(p_frames);
+	}
+
+	// Clear the mix buffer
+	float *mix = mix_buffer.ptrw();
+	for (int i = 0; i < p_frames; i++) {
+		mix[i] = 0.0f;
+	}
+
+	uint64_t render_start = Time::get_singleton()->get_ticks_usec();
+	SynthQualityGovernor *governor = SynthQualityGovernor::get_singleton();
+
+	// Live voices render here, music rendered ahead on another thread is only summed
+	bool audible = render(mix, p_frames);
+	render_ahead.acquire();
+	RenderAheadRing *ahead = render_ahead.get().get();
+	if (ahead != nullptr) {
+		ahead->read_add(mix, p_frames);
+		audible = true;
+	}
+
+	if (!audible) {
+		// Fill with silence
+		for (int i = 0; i < p_frames; i++) {
+			p_buffer[i] = AudioFrame(); // Default constructor creates a silent frame
 		}
-		active_voices.erase(voice_id);
+
+		// Idle blocks still count, so quality can recover while nothing plays
+		if (governor != nullptr) {
+			governor->report_block(0);
+		}
+		return p_frames;
 	}
 
 	// Convert mono mix buffer to stereo output and apply limiting
 	for (int i = 0; i < p_frames; i++) {
-		float sample = CLAMP(mix_buffer[i], -1.0f, 1.0f);
+		float sample = CLAMP(mix[i], -1.0f, 1.0f);
 		p_buffer[i].left = sample;
 		p_buffer[i].right = sample;
 	}
 
+	if (governor != nullptr) {
+		governor->report_block(Time::get_singleton()->get_ticks_usec() - render_start);
+	}
+
 	return p_frames;
 }
 
@@ -133,74 +463,146 @@ void SynthAudioStreamPlayback::_start(double p_from_pos) {
 
 void SynthAudioStreamPlayback::_stop() {
 	active = false;
-	// Release all voices
-	release_all_voices();
+	// Nothing renders a release tail once the stream stops, so the voices are killed. The
+	// fade plays out when the stream starts again.
+	kill_all_voices();
 }
 
-void SynthAudioStreamPlayback::add_voice(int64_t id, const Ref<SynthVoice> &voice) {
-	if (!voice.is_valid()) {
+bool SynthAudioStreamPlayback::add_voice(int64_t id, const Ref<SynthVoice> &voice, const Ref<SynthNoteContext> &p_context, uint64_t p_owner) {
+	if (!voice.is_valid() || !p_context.is_valid()) {
+		return false;
+	}
+
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_ADD;
+	command.voice_id = id;
+	command.voice = voice;
+	command.context = p_context;
+	command.owner = p_owner;
+	command.serial = voice_serial.fetch_add(1) + 1;
+	return push_command(command);
+}
+
+void SynthAudioStreamPlayback::add_scheduled_voice(int64_t p_id, const Ref<SynthVoice> &p_voice) {
+	if (p_voice.is_valid()) {
+		insert_voice(p_id, p_voice, 0, voice_serial.fetch_add(1) + 1);
+	}
+}
+
+void SynthAudioStreamPlayback::remove_voice(int64_t id) {
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_REMOVE;
+	command.voice_id = id;
+	push_command(command);
+}
+
+void SynthAudioStreamPlayback::release_voice(const Ref<SynthVoice> &voice) {
+	if (!voice.is_valid() || !voice->is_active()) {
 		return;
 	}
+	Ref<SynthNoteContext> context = voice->get_current_context();
+	if (context.is_valid()) {
+		release_voice_by_id(context->get_voice_id());
+	}
+}
 
-	// Sync the voice's context with our current time
+void SynthAudioStreamPlayback::release_all_voices(uint64_t p_owner) {
+	// Notes started after this call keep playing
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_RELEASE_ALL;
+	command.owner = p_owner;
+	command.serial = voice_serial.load();
+	push_command(command);
+}
+
+void SynthAudioStreamPlayback::kill_voice(const Ref<SynthVoice> &voice) {
+	if (!voice.is_valid()) {
+		return;
+	}
 	Ref<SynthNoteContext> context = voice->get_current_context();
 	if (context.is_valid()) {
-		sync_context_time(context);
+		kill_voice_by_id(context->get_voice_id());
 	}
+}
 
-	// Add the voice to the active voices
-	active_voices[id] = voice;
+void SynthAudioStreamPlayback::kill_voice_by_id(int64_t p_voice_id) {
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_KILL;
+	command.voice_id = p_voice_id;
+	push_command(command);
+}
 
-	// If we exceed max polyphony, we might need to remove the oldest voice
-	// But only if it doesn't have active delay tails
-	if (active_voices.size() > max_polyphony) {
-		int64_t oldest_id = 0;
-		double oldest_time = std::numeric_limits<double>::max();
-		bool found_removable = false;
+void SynthAudioStreamPlayback::release_voice_by_id(int64_t p_voice_id) {
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_RELEASE;
+	command.voice_id = p_voice_id;
+	push_command(command);
+}
 
-		// Find the oldest voice without active tails
-		for (const auto &E : active_voices) {
-			Ref<SynthVoice> current_voice = E.value;
-			if (!current_voice->is_active() && !has_active_tail(current_voice)) {
-				// We can't directly access SynthNoteContext methods here
-				// Just use the voice ID as a proxy for age
-				if (E.key < oldest_id || oldest_id == 0) {
-					oldest_id = E.key;
-					found_removable = true;
-				}
-			}
-		}
+void SynthAudioStreamPlayback::kill_all_voices(uint64_t p_owner) {
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_KILL_ALL;
+	command.owner = p_owner;
+	command.serial = voice_serial.load();
+	push_command(command);
 
-		// If we found an eligible voice to remove
-		if (found_removable) {
-			active_voices.erase(oldest_id);
-		}
+	// Instances have no owner, only a kill for everyone stops them
+	if (p_owner == 0) {
+		instancer.stop_all();
 	}
 }
 
-void SynthAudioStreamPlayback::remove_voice(int64_t id) {
-	active_voices.erase(id);
+void SynthAudioStreamPlayback::set_max_note_lifetime(float p_seconds) {
+	max_note_lifetime.store(MAX(p_seconds, 0.0f));
 }
 
-void SynthAudioStreamPlayback::release_voice(const Ref<SynthVoice> &voice) {
-	if (voice.is_valid()) {
-	}
+float SynthAudioStreamPlayback::get_max_note_lifetime() const {
+	return max_note_lifetime.load();
 }
 
-void SynthAudioStreamPlayback::release_all_voices() {
-	for (const auto &E : active_voices) {
-		Ref<SynthVoice> voice = E.value;
-		if (voice.is_valid() && voice->is_active()) {
-		}
-	}
+VoiceInstancer &SynthAudioStreamPlayback::get_instancer() {
+	return instancer;
 }
 
 void SynthAudioStreamPlayback::clear_voices() {
-	active_voices.clear();
+	VoiceCommand command;
+	command.type = VOICE_COMMAND_CLEAR;
+	push_command(command);
 }
 
 int SynthAudioStreamPlayback::get_active_voice_count() const {
-	return active_voices.size();
+	return active_voice_count.load();
+}
+
+void SynthAudioStreamPlayback::set_lod(int p_quality_tier, bool p_virtual) {
+	lod_tier.store(p_quality_tier);
+	virtualized.store(p_virtual);
+}
+
+bool SynthAudioStreamPlayback::is_virtualized() const {
+	return virtualized.load();
+}
+
+void SynthAudioStreamPlayback::set_max_polyphony(int p_max_polyphony) {
+	max_polyphony = MAX(p_max_polyphony, 1);
+}
+
+int SynthAudioStreamPlayback::get_max_polyphony() const {
+	return max_polyphony;
+}
+
+void SynthAudioStreamPlayback::set_scheduler(const std::shared_ptr<Scheduler> &p_scheduler) {
+	uint64_t serial = scheduler.publish(p_scheduler);
+
+	// A block already rendering may still fire the previous scheduler. The next block takes
+	// the new one before it fires anything, so waiting ends at whichever comes first.
+	while (scheduler.get_acquired_serial() < serial && rendering.load()) {
+		std::this_thread::yield();
+	}
+}
+
+void SynthAudioStreamPlayback::set_render_ahead(const std::shared_ptr<RenderAheadRing> &p_ring) {
+	render_ahead.publish(p_ring);
 }
 
 bool SynthAudioStreamPlayback::has_active_tail(const Ref<SynthVoice> &voice) const {
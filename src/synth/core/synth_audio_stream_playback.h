@@ -1,28 +1,139 @@
 #ifndef SYNTH_AUDIO_STREAM_PLAYBACK_H
 #define SYNTH_AUDIO_STREAM_PLAYBACK_H
 
+#include "audio_handoff.h"
+#include "recycling_allocator.h"
+#include "render_ahead_ring.h"
 #include "synth_note_context.h" // Add this include
 #include "synth_voice.h"
+#include "voice_group_renderer.h"
+#include "voice_instancer.h"
 #include <godot_cpp/classes/audio_stream_generator.hpp>
 #include <godot_cpp/classes/audio_stream_playback.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
 #include <godot_cpp/variant/typed_array.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace godot {
 
+class PatchProgram;
+
 class SynthAudioStreamPlayback : public AudioStreamPlayback {
 	GDCLASS(SynthAudioStreamPlayback, AudioStreamPlayback)
 
+public:
+	// Starts and stops notes from the audio thread, see set_scheduler()
+	class Scheduler {
+	public:
+		virtual ~Scheduler() {}
+
+		// Start and stop the notes due at the playback's current time. Returns how many
+		// frames the playback may render before the next one is due, at most p_max_frames.
+		virtual int fire(SynthAudioStreamPlayback &p_playback, int p_max_frames) = 0;
+
+		// The playback rendered p_frames since the last fire()
+		virtual void advance(int p_frames) = 0;
+	};
+
 private:
 	Ref<AudioStreamGenerator> generator;
-	HashMap<int64_t, Ref<SynthVoice>> active_voices;
+
+	// Voices playing now, audio thread only. The main thread adds and removes them through
+	// commands. The table and elements are allocated up front and recycled, so starting a
+	// note on the audio thread doesn't allocate.
+	struct ActiveVoice {
+		Ref<SynthVoice> voice;
+		uint64_t owner = 0; // Whoever started it, for release_all_voices() on a shared playback
+		uint64_t serial = 0; // Start order, commands for all voices spare later ones
+		int fade = -1; // Frames left of a kill fade, -1 while not being killed
+	};
+	static constexpr int VOICE_MAP_RESERVE = 256;
+	HashMap<int64_t, ActiveVoice, HashMapHasherDefault, HashMapComparatorDefault<int64_t>, RecyclingAllocator<HashMapElement<int64_t, ActiveVoice>>> active_voices;
+	std::atomic<int> active_voice_count{ 0 };
+	std::atomic<uint64_t> voice_serial{ 0 };
+	std::vector<int64_t> retired_ids; // Reused every block
 	double current_time = 0.0;
 	int max_polyphony = 16;
 	PackedFloat32Array mix_buffer;
 	float sample_rate = 44100.0f;
 	bool active = false;
 
+	// Level of detail set by positional players from the main thread
+	std::atomic<int> lod_tier{ 0 };
+	std::atomic<bool> virtualized{ false };
+
+	// Voices waiting to render with the others of their program, reused every block
+	struct GroupedVoice {
+		const PatchProgram *program = nullptr;
+		Ref<SynthVoice> voice;
+	};
+	std::vector<GroupedVoice> grouped_voices;
+	std::vector<Ref<SynthVoice>> group_voices;
+	VoiceGroupRenderer group_renderer;
+
+	AudioHandoff<Scheduler> scheduler;
+	AudioHandoff<RenderAheadRing> render_ahead;
+	std::atomic<bool> rendering{ false }; // Inside render(), see set_scheduler()
+
+	// Voice changes requested by the main thread, applied at the start of _mix. A single
+	// producer ring. Commands name the voice by id so a voice restarted in the meantime
+	// under a new id is left alone, and the ones for all voices carry the serial of the
+	// last voice started before them.
+	enum VoiceCommandType {
+		VOICE_COMMAND_ADD,
+		VOICE_COMMAND_REMOVE,
+		VOICE_COMMAND_RELEASE,
+		VOICE_COMMAND_KILL,
+		VOICE_COMMAND_RELEASE_ALL,
+		VOICE_COMMAND_KILL_ALL,
+		VOICE_COMMAND_CLEAR
+	};
+	struct VoiceCommand {
+		VoiceCommandType type = VOICE_COMMAND_RELEASE;
+		int64_t voice_id = 0;
+		Ref<SynthVoice> voice; // Added voice, overwritten by the main thread only
+		Ref<SynthNoteContext> context; // Its note, holds the context it replaced once applied
+		uint64_t owner = 0; // 0 for all owners
+		uint64_t serial = 0;
+	};
+	static constexpr uint32_t COMMAND_CAPACITY = 1024;
+	VoiceCommand commands[COMMAND_CAPACITY];
+	std::atomic<uint32_t> command_write{ 0 };
+	std::atomic<uint32_t> command_read{ 0 };
+
+	// Ids of voices that left the map, for whoever tracks them from the main thread. A
+	// single producer ring, ids nobody reads are dropped once it is full.
+	static constexpr uint32_t FINISHED_CAPACITY = 1024;
+	int64_t finished_ids[FINISHED_CAPACITY];
+	std::atomic<uint32_t> finished_write{ 0 };
+	std::atomic<uint32_t> finished_read{ 0 };
+
+	// Killed voices fade out over kill_fade_frames and are retired once silent
+	int kill_fade_frames = 220;
+	std::atomic<float> max_note_lifetime{ 0.0f };
+
+	// One-shot notes played as taps into shared recordings, mixed after the voices
+	VoiceInstancer instancer;
+
+	bool push_command(VoiceCommand &p_command);
+	void apply_commands();
+	void insert_voice(int64_t p_id, const Ref<SynthVoice> &p_voice, uint64_t p_owner, uint64_t p_serial);
+	void release_active_voice(ActiveVoice &p_active);
+	void start_kill(ActiveVoice &p_active);
+	void render_fading_voice(const Ref<SynthVoice> &p_voice, int &r_fade, float *r_mix, int p_frames);
+	void retire_voices();
+	// Drop a voice from the map and report its id. The voice goes back to its pool unless
+	// p_restarting, when it is inserted again right away.
+	void erase_voice(int64_t p_id, bool p_restarting = false);
+
+	bool render_block(float *r_mix, int p_frames);
+
+	// Add p_frames of every voice to r_mix, starting at current_time
+	void render_voices(float *r_mix, int p_frames, int p_quality_tier, bool p_render);
+
 	// Helper function to check if a voice has active delay tails
 	bool has_active_tail(const Ref<SynthVoice> &voice) const;
 
@@ -39,7 +150,6 @@ public:
 	// Clock management
 	double get_current_time() const;
 	void sync_context_time(const Ref<SynthNoteContext> &context);
-	Ref<SynthVoice> get_voice(int64_t voice_id) const;
 
 	// AudioStreamPlayback implementation
 	virtual void _start(double p_from_pos = 0.0) override;
@@ -50,13 +160,62 @@ public:
 	virtual void _seek(double p_time) override;
 	virtual int _mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) override;
 
-	// Voice management
-	void add_voice(int64_t id, const Ref<SynthVoice> &voice);
+	// Voice management, from the main thread. The changes are queued and take effect at
+	// the start of the next mixed block. A voice is added with the context its note plays
+	// in, see SynthPlayerVoices::NoteVoice. p_owner tags it for release_all_voices().
+	// Returns false when the queue was full and the voice was not added.
+	bool add_voice(int64_t id, const Ref<SynthVoice> &voice, const Ref<SynthNoteContext> &p_context, uint64_t p_owner = 0);
 	void remove_voice(int64_t id);
-	void release_voice(const Ref<SynthVoice> &voice);
-	void release_all_voices();
 	void clear_voices();
 	int get_active_voice_count() const;
+
+	// Next id of a voice that finished, was killed or was removed, oldest first. Returns
+	// false when there is none. The voice was handed back to its pool before its id was
+	// reported. Main thread.
+	bool pop_finished_voice(int64_t &r_voice_id);
+
+	// Voices started by a scheduler, from the audio thread inside fire()
+	void add_scheduled_voice(int64_t p_id, const Ref<SynthVoice> &p_voice);
+
+	// Lifecycle requests, carried out on the audio thread. Release moves the note into its
+	// envelope release, kill fades it out over KILL_FADE_TIME and then frees the voice.
+	// The requests for all voices only reach voices started before the call, of p_owner
+	// alone unless it's 0. Call from the main thread only.
+	static constexpr double KILL_FADE_TIME = 0.005;
+	void release_voice(const Ref<SynthVoice> &voice);
+	void release_all_voices(uint64_t p_owner = 0);
+	void kill_voice(const Ref<SynthVoice> &voice);
+	void kill_voice_by_id(int64_t p_voice_id);
+	void release_voice_by_id(int64_t p_voice_id);
+	void kill_all_voices(uint64_t p_owner = 0);
+
+	// Notes older than this many seconds are killed, 0 lets them play forever
+	void set_max_note_lifetime(float p_seconds);
+	float get_max_note_lifetime() const;
+
+	// Instanced one-shots, triggered from the main thread
+	VoiceInstancer &get_instancer();
+
+	// Minimum quality tier for every voice, and whether voices only advance without rendering
+	void set_lod(int p_quality_tier, bool p_virtual);
+	bool is_virtualized() const;
+
+	void set_max_polyphony(int p_max_polyphony);
+	int get_max_polyphony() const;
+
+	// _mix renders up to each event the scheduler asks for and lets it fire there, so its
+	// notes start on the exact frame. Pass null to detach it. Returns once the thread
+	// rendering this playback no longer fires the previous scheduler, so it may move to
+	// another playback.
+	void set_scheduler(const std::shared_ptr<Scheduler> &p_scheduler);
+
+	// Audio another thread renders ahead, _mix adds it to the live voices. Pass null to detach it.
+	void set_render_ahead(const std::shared_ptr<RenderAheadRing> &p_ring);
+
+	// Render p_frames of every voice into r_mix and move the clock on, as _mix does but mono
+	// and on the calling thread. Returns false, leaving r_mix alone, when nothing plays.
+	// Lets a playback that isn't attached to the audio server render on a worker.
+	bool render(float *r_mix, int p_frames);
 };
 
 } // namespace godot
@@ -1,6 +1,7 @@
 #include "synth_configuration.h"
 #include "audio_stream_generator_engine.h"
 #include "modulated_parameter.h"
+#include "modulation_graph.h"
 #include <godot_cpp/classes/audio_server.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -15,9 +16,13 @@ void SynthConfiguration::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_output_bus", "bus"), &SynthConfiguration::set_output_bus);
 	ClassDB::bind_method(D_METHOD("get_output_bus"), &SynthConfiguration::get_output_bus);
 
+	ClassDB::bind_method(D_METHOD("set_quality_profile", "profile"), &SynthConfiguration::set_quality_profile);
+	ClassDB::bind_method(D_METHOD("get_quality_profile"), &SynthConfiguration::get_quality_profile);
+
 	ClassDB::bind_method(D_METHOD("create_engine"), &SynthConfiguration::create_engine);
 
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "output_bus", PROPERTY_HINT_ENUM, ""), "set_output_bus", "get_output_bus");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "quality_profile", PROPERTY_HINT_RESOURCE_TYPE, "SynthQualityProfile"), "set_quality_profile", "get_quality_profile");
 
 	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "parameters", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "", "get_parameters");
 }
@@ -68,11 +73,38 @@ String SynthConfiguration::get_output_bus() const {
 	return output_bus;
 }
 
+void SynthConfiguration::set_quality_profile(const Ref<SynthQualityProfile> &p_profile) {
+	quality_profile = p_profile;
+}
+
+Ref<SynthQualityProfile> SynthConfiguration::get_quality_profile() const {
+	return quality_profile;
+}
+
+Ref<SynthConfiguration> SynthConfiguration::snapshot() const {
+	Ref<SynthConfiguration> copy = duplicate(true);
+	if (copy.is_null()) {
+		return copy;
+	}
+
+	// The parameter dictionary has no setter and the effect chain is not a property,
+	// so neither survives duplicate()
+	ModulationGraph graph;
+	copy->parameters = graph.bind_parameters(parameters);
+	copy->effect_chain = graph.bind_effect_chain(effect_chain);
+	return copy;
+}
+
 Ref<AudioStreamGeneratorEngine> SynthConfiguration::create_engine() const {
 	// Base implementation returns null - to be overridden by derived classes
 	return Ref<AudioStreamGeneratorEngine>();
 }
 
+Ref<AudioStreamGeneratorEngine> SynthConfiguration::instantiate_engine() const {
+	// Base implementation returns null - to be overridden by derived classes
+	return Ref<AudioStreamGeneratorEngine>();
+}
+
 void SynthConfiguration::_validate_property(PropertyInfo &property) const {
 	if (property.name == StringName("output_bus")) {
 		String options;
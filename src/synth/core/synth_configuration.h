@@ -1,4 +1,5 @@
 #pragma once
+#include "synth_quality_profile.h"
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/variant/dictionary.hpp>
 
@@ -15,6 +16,7 @@ private:
 	Dictionary parameters;
 	Ref<EffectChain> effect_chain;
 	String output_bus = "Master";
+	Ref<SynthQualityProfile> quality_profile;
 
 protected:
 	static void _bind_methods();
@@ -34,7 +36,19 @@ public:
 	void set_output_bus(const String &p_bus);
 	String get_output_bus() const;
 
+	// Quality tiers for this configuration, the defaults are used when unset
+	void set_quality_profile(const Ref<SynthQualityProfile> &p_profile);
+	Ref<SynthQualityProfile> get_quality_profile() const;
+
+	// Deep copy for building voices off the main thread. Parameters and effects are
+	// rebound through a modulation graph so sources they share stay shared in the copy.
+	Ref<SynthConfiguration> snapshot() const;
+
 	virtual Ref<AudioStreamGeneratorEngine> create_engine() const;
+
+	// Create an engine of this configuration's type with its oscillator settings
+	// applied, but without parameters or effects
+	virtual Ref<AudioStreamGeneratorEngine> instantiate_engine() const;
 };
 
 } // namespace godot
@@ -112,6 +112,7 @@ double SynthNoteContext::get_note_time() const {
 
 void SynthNoteContext::set_note(int p_note) {
 	note = p_note;
+	note_serial++;
 }
 
 int SynthNoteContext::get_note() const {
@@ -120,6 +121,7 @@ int SynthNoteContext::get_note() const {
 
 void SynthNoteContext::set_velocity(float p_velocity) {
 	velocity = p_velocity;
+	note_serial++;
 }
 
 float SynthNoteContext::get_velocity() const {
@@ -128,6 +130,7 @@ float SynthNoteContext::get_velocity() const {
 
 void SynthNoteContext::set_articulation(float p_articulation) {
 	articulation = p_articulation;
+	note_serial++;
 }
 
 float SynthNoteContext::get_articulation() const {
@@ -166,6 +169,7 @@ void SynthNoteContext::note_on(int p_note, float p_velocity) {
 	reset();
 	note = p_note;
 	velocity = p_velocity;
+	note_serial++;
 	is_note_active = true;
 	is_note_triggered = true;
 	note_on_time = absolute_time; // Set note_on_time to current absolute_time
@@ -188,6 +192,11 @@ void SynthNoteContext::note_off(float p_time) {
 }
 
 void SynthNoteContext::update_time(double p_absolute_time) {
+	// Audio-rate sources follow the tick, so they update once per control period
+	if (++control_counter >= control_rate_divisor) {
+		control_counter = 0;
+		tick++;
+	}
 	absolute_time = p_absolute_time;
 	if (note_on_time >= 0.0) {
 		note_time = absolute_time - note_on_time;
@@ -242,6 +251,7 @@ void SynthNoteContext::update_time(double p_absolute_time) {
 
 // New release state methods
 void SynthNoteContext::start_release(double p_time) {
+	tick++;
 	note_off_time = p_time;
 	is_note_active = false;
 	_is_releasing = true;
@@ -337,6 +347,10 @@ bool SynthNoteContext::get_has_active_tail() const {
 }
 
 void SynthNoteContext::reset() {
+	// Never rewind the counters, cached values from the previous note must not match
+	tick++;
+	block_serial++;
+	note_serial++;
 	absolute_time = 0.0;
 	note_on_time = 0.0;
 	note_time = 0.0;
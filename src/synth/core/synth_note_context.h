@@ -50,6 +50,11 @@ private:
 	float current_amplitude = 1.0f; ///< Current amplitude of the note
 	NoteState note_state = NOTE_STATE_READY; ///< Current state in the note lifecycle
 	bool has_active_tail = false; ///< Whether the note has active effect tails (e.g., reverb, delay)
+	uint64_t tick = 1; ///< Evaluation tick, advanced whenever modulation inputs may have changed
+	uint64_t block_serial = 1; ///< Advanced once per processed block
+	uint64_t note_serial = 1; ///< Advanced whenever note, velocity or articulation change
+	int control_rate_divisor = 1; ///< Number of update_time() calls that share one tick
+	int control_counter = 0; ///< update_time() calls since the tick last advanced
 
 protected:
 	static void _bind_methods();
@@ -103,6 +108,56 @@ public:
 	 */
 	double get_note_time() const;
 
+	/**
+	 * @brief Gets the current evaluation tick.
+	 *
+	 * The tick advances on every update_time() call and on any state change that
+	 * modulation sources may observe. Sources use it to memoize their value so a
+	 * source shared by several parameters is evaluated only once per tick.
+	 * @return The current tick.
+	 */
+	uint64_t get_tick() const { return tick; }
+
+	/**
+	 * @brief Gets the block serial, advanced once per processed block.
+	 * @return The current block serial.
+	 */
+	uint64_t get_block_serial() const { return block_serial; }
+
+	/**
+	 * @brief Gets the note serial.
+	 *
+	 * Advances on note_on() and whenever note, velocity or articulation change,
+	 * so per-note modulation folded at note-on is recomputed when its inputs move.
+	 * @return The current note serial.
+	 */
+	uint64_t get_note_serial() const { return note_serial; }
+
+	/**
+	 * @brief Sets how many update_time() calls share one evaluation tick.
+	 *
+	 * With a divisor above 1, audio-rate modulation sources are evaluated every
+	 * p_divisor samples and hold their value in between. Used by the quality
+	 * governor to lower the control rate under load.
+	 * @param p_divisor Samples per modulation update (1 = every sample).
+	 */
+	void set_control_rate_divisor(int p_divisor) { control_rate_divisor = p_divisor < 1 ? 1 : p_divisor; }
+
+	/**
+	 * @brief Gets the control rate divisor.
+	 * @return Samples per modulation update.
+	 */
+	int get_control_rate_divisor() const { return control_rate_divisor; }
+
+	/**
+	 * @brief Marks the start of a new processing block.
+	 */
+	void begin_block() {
+		block_serial++;
+		tick++;
+		control_counter = 0;
+	}
+
 	/**
 	 * @brief Sets the release level (amplitude at start of release).
 	 * @param p_release_level The release level (0.0-1.0).
@@ -0,0 +1,46 @@
+#include "synth_note_handles.h"
+#include "synth_audio_stream_playback.h"
+
+namespace godot {
+
+int64_t SynthNoteHandles::take_voice_id() {
+	return next_voice_id++;
+}
+
+void SynthNoteHandles::note_on(int64_t p_handle, const Ref<SynthNoteContext> &p_context, int p_index, const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations) {
+	// A reused context keeps the last note's articulation, so it is always set
+	p_context->set_articulation(p_index < p_articulations.size() ? p_articulations[p_index] : 1.0f);
+	p_context->note_on(p_notes[p_index], p_index < p_velocities.size() ? p_velocities[p_index] : 1.0f);
+	notes[p_handle] = p_context;
+}
+
+void SynthNoteHandles::note_off(const PackedInt64Array &p_handles, SynthAudioStreamPlayback &p_playback) {
+	for (int i = 0; i < p_handles.size(); i++) {
+		// The playback drops the release if the voice was stolen in the meantime, its
+		// entry under this id is gone
+		if (notes.has(p_handles[i])) {
+			p_playback.release_voice_by_id(p_handles[i]);
+		}
+	}
+}
+
+PackedInt64Array SynthNoteHandles::collect_finished() {
+	PackedInt64Array finished;
+	for (const KeyValue<int64_t, Ref<SynthNoteContext>> &E : notes) {
+		// A voice reset by a stop or a steal goes back to ready without finishing
+		const Ref<SynthNoteContext> &context = E.value;
+		if (context->get_voice_id() != E.key || context->is_note_finished() || context->is_note_ready()) {
+			finished.push_back(E.key);
+		}
+	}
+	for (int i = 0; i < finished.size(); i++) {
+		notes.erase(finished[i]);
+	}
+	return finished;
+}
+
+int SynthNoteHandles::get_note_count() const {
+	return notes.size();
+}
+
+} // namespace godot
@@ -0,0 +1,39 @@
+#pragma once
+#include "synth_note_context.h"
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_int64_array.hpp>
+
+namespace godot {
+
+class SynthAudioStreamPlayback;
+
+// Notes started through a player's batch API, by handle.
+// A handle is the voice id the note was started with, so it is unique per player. The
+// player adds every note it starts, releases them by handle, and once per frame collects
+// the notes that ended: finished, or cut off by a newer note stealing their voice.
+class SynthNoteHandles {
+private:
+	HashMap<int64_t, Ref<SynthNoteContext>> notes;
+	int64_t next_voice_id = 1;
+
+public:
+	// Id for the next voice the player adds to its playback
+	int64_t take_voice_id();
+
+	// Start the note on a context a player just handed out. Missing velocities play at
+	// full velocity and missing articulations at 1.
+	void note_on(int64_t p_handle, const Ref<SynthNoteContext> &p_context, int p_index, const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations);
+
+	// Release the notes still playing under these handles in p_playback, unknown handles
+	// are ignored. The releases are queued for the audio thread like any other.
+	void note_off(const PackedInt64Array &p_handles, SynthAudioStreamPlayback &p_playback);
+
+	// Handles of the notes that ended since the last call, forgotten from then on
+	PackedInt64Array collect_finished();
+
+	int get_note_count() const;
+};
+
+} // namespace godot
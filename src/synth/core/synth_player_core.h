@@ -0,0 +1,381 @@
+#pragma once
+#include "modulated_parameter.h"
+#include "synth_audio_stream.h"
+#include "synth_audio_stream_playback.h"
+#include "synth_configuration.h"
+#include "synth_note_context.h"
+#include "synth_note_handles.h"
+#include "synth_player_voices.h"
+#include "synth_voice_manager.h"
+#include <godot_cpp/classes/audio_server.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+namespace godot {
+
+// Stream, playback and voice plumbing shared by AudioSynthPlayer and AudioSynthPlayer3D.
+// The two nodes derive from different Godot players, so each owns one of these, forwards
+// its lifecycle and bound methods to it and adds only what is its own. TPlayer is the
+// owning node and provides play(), stop(), is_playing(), set_bus(), set_stream() and
+// get_stream_playback() like AudioStreamPlayer does.
+template <typename TPlayer>
+class SynthPlayerCore {
+private:
+	TPlayer *owner = nullptr;
+
+	Ref<SynthAudioStream> stream;
+	Ref<SynthAudioStreamPlayback> playback;
+	float sample_rate = 44100.0f;
+
+	// Voice pool, rebuilt in the background when the configuration or polyphony changes
+	SynthPlayerVoices voices;
+
+	// Notes started by note_on_batch(), and the source of voice ids
+	SynthNoteHandles handles;
+
+	// Render through the global SynthVoiceManager instead of the owner's own playback
+	bool use_voice_manager = false;
+	SynthVoiceManager::VoiceCategory voice_category = SynthVoiceManager::CATEGORY_SFX;
+	int voice_priority = 128;
+
+	// Forwarded to the own playback, managed voices follow the SynthVoiceManager's limit
+	float max_note_lifetime = 0.0f;
+
+	// Instanced one-shots
+	float instance_hold = 0.1f;
+	float instance_length = 2.0f;
+
+	Ref<SynthAudioStreamPlayback> get_manager_playback() const {
+		SynthVoiceManager *manager = SynthVoiceManager::get_singleton();
+		return manager != nullptr ? manager->get_playback() : Ref<SynthAudioStreamPlayback>();
+	}
+
+	void apply_output_bus(const Ref<SynthConfiguration> &p_config) {
+		// Set the output bus if specified in the configuration
+		if (p_config.is_valid()) {
+			String bus_name = p_config->get_output_bus();
+			// Validate that the bus exists
+			bool bus_found = false;
+			for (int i = 0; i < AudioServer::get_singleton()->get_bus_count(); i++) {
+				if (AudioServer::get_singleton()->get_bus_name(i) == bus_name) {
+					bus_found = true;
+					break;
+				}
+			}
+			// If bus not found, default to "Master"
+			owner->set_bus(bus_found ? bus_name : "Master");
+		}
+	}
+
+public:
+	explicit SynthPlayerCore(TPlayer *p_owner) :
+			owner(p_owner) {
+		stream.instantiate();
+		sample_rate = AudioServer::get_singleton()->get_mix_rate();
+		stream->set_mix_rate(sample_rate);
+		voices.set_sample_rate(sample_rate);
+	}
+
+	// Bindings of the shared methods, properties and the notes_finished signal on TPlayer
+	static void bind_methods() {
+		const StringName player = TPlayer::get_class_static();
+
+		ClassDB::bind_method(D_METHOD("set_configuration", "config"), &TPlayer::set_configuration);
+		ClassDB::bind_method(D_METHOD("get_configuration"), &TPlayer::get_configuration);
+		ClassDB::bind_method(D_METHOD("set_patch", "bank", "name"), &TPlayer::set_patch);
+
+		ClassDB::bind_method(D_METHOD("get_context"), &TPlayer::get_context);
+		ClassDB::bind_method(D_METHOD("stop_all_notes"), &TPlayer::stop_all_notes);
+		ClassDB::bind_method(D_METHOD("kill_all_notes"), &TPlayer::kill_all_notes);
+		ClassDB::bind_method(D_METHOD("note_on_batch", "notes", "velocities", "articulations"), &TPlayer::note_on_batch, DEFVAL(PackedFloat32Array()), DEFVAL(PackedFloat32Array()));
+		ClassDB::bind_method(D_METHOD("note_off_batch", "handles"), &TPlayer::note_off_batch);
+		ClassDB::add_signal(player, MethodInfo("notes_finished", PropertyInfo(Variant::PACKED_INT64_ARRAY, "handles")));
+
+		ClassDB::bind_method(D_METHOD("play_instance", "note", "velocity", "gain", "pitch_offset"), &TPlayer::play_instance, DEFVAL(1.0f), DEFVAL(1.0f), DEFVAL(0.0f));
+		ClassDB::bind_method(D_METHOD("set_instance_hold", "seconds"), &TPlayer::set_instance_hold);
+		ClassDB::bind_method(D_METHOD("get_instance_hold"), &TPlayer::get_instance_hold);
+		ClassDB::bind_method(D_METHOD("set_instance_length", "seconds"), &TPlayer::set_instance_length);
+		ClassDB::bind_method(D_METHOD("get_instance_length"), &TPlayer::get_instance_length);
+
+		ClassDB::bind_method(D_METHOD("set_parameter", "name", "value"), &TPlayer::set_parameter);
+
+		ClassDB::bind_method(D_METHOD("set_polyphony", "polyphony"), &TPlayer::set_polyphony);
+		ClassDB::bind_method(D_METHOD("get_polyphony"), &TPlayer::get_polyphony);
+		ClassDB::bind_method(D_METHOD("is_rebuilding_voices"), &TPlayer::is_rebuilding_voices);
+
+		ClassDB::bind_method(D_METHOD("set_max_note_lifetime", "seconds"), &TPlayer::set_max_note_lifetime);
+		ClassDB::bind_method(D_METHOD("get_max_note_lifetime"), &TPlayer::get_max_note_lifetime);
+
+		ClassDB::bind_method(D_METHOD("set_use_voice_manager", "enabled"), &TPlayer::set_use_voice_manager);
+		ClassDB::bind_method(D_METHOD("get_use_voice_manager"), &TPlayer::get_use_voice_manager);
+		ClassDB::bind_method(D_METHOD("set_voice_category", "category"), &TPlayer::set_voice_category);
+		ClassDB::bind_method(D_METHOD("get_voice_category"), &TPlayer::get_voice_category);
+		ClassDB::bind_method(D_METHOD("set_voice_priority", "priority"), &TPlayer::set_voice_priority);
+		ClassDB::bind_method(D_METHOD("get_voice_priority"), &TPlayer::get_voice_priority);
+
+		ClassDB::add_property(player, PropertyInfo(Variant::INT, "polyphony", PROPERTY_HINT_RANGE, "1,32,1"), "set_polyphony", "get_polyphony");
+		ClassDB::add_property(player, PropertyInfo(Variant::FLOAT, "max_note_lifetime", PROPERTY_HINT_RANGE, "0,600,0.1,or_greater,suffix:s"), "set_max_note_lifetime", "get_max_note_lifetime");
+		ClassDB::add_property(player, PropertyInfo(Variant::FLOAT, "instance_hold", PROPERTY_HINT_RANGE, "0.001,10,0.001,suffix:s"), "set_instance_hold", "get_instance_hold");
+		ClassDB::add_property(player, PropertyInfo(Variant::FLOAT, "instance_length", PROPERTY_HINT_RANGE, "0.01,10,0.01,suffix:s"), "set_instance_length", "get_instance_length");
+		ClassDB::add_property(player, PropertyInfo(Variant::BOOL, "use_voice_manager"), "set_use_voice_manager", "get_use_voice_manager");
+		ClassDB::add_property(player, PropertyInfo(Variant::INT, "voice_category", PROPERTY_HINT_ENUM, "UI,SFX,Music,Ambience"), "set_voice_category", "get_voice_category");
+		ClassDB::add_property(player, PropertyInfo(Variant::INT, "voice_priority", PROPERTY_HINT_RANGE, "0,255,1"), "set_voice_priority", "get_voice_priority");
+		ClassDB::add_property(player, PropertyInfo(Variant::OBJECT, "configuration", PROPERTY_HINT_RESOURCE_TYPE, "SynthConfiguration"), "set_configuration", "get_configuration");
+	}
+
+	// From the owner's _ready(): set the stream, start playing unless the voice manager
+	// renders the voices, and build the first voice pool
+	void ready() {
+		owner->set_stream(stream);
+		voices.set_ready(true);
+
+		// Managed players are handles, the manager's playback renders their voices
+		if (!use_voice_manager) {
+			owner->play();
+			get_playback();
+		}
+
+		voices.initialize_voice_pool();
+	}
+
+	// From the owner's _process()
+	void process() {
+		// Publish a voice pool once its background build is done. Instanced recordings of the
+		// previous patch would never be triggered again.
+		std::shared_ptr<const SynthPlayerVoices::VoicePool> previous_pool = voices.get_voice_pool();
+		voices.poll_voice_pool_rebuild(false);
+		voices.update_effects();
+		if (previous_pool && previous_pool != voices.get_voice_pool()) {
+			Ref<SynthAudioStreamPlayback> target = use_voice_manager ? get_manager_playback() : get_playback();
+			if (target.is_valid()) {
+				target->get_instancer().clear_recordings(previous_pool->program);
+			}
+		}
+
+		// Every batched note that ended this frame in one signal
+		PackedInt64Array finished = handles.collect_finished();
+		if (!finished.is_empty()) {
+			owner->emit_signal("notes_finished", finished);
+		}
+
+		if (!use_voice_manager && get_playback().is_valid()) {
+			playback->set_max_note_lifetime(max_note_lifetime);
+			playback->get_instancer().collect();
+		}
+	}
+
+	// From the owner's _exit_tree(). The shared playback outlives the node, notes nobody
+	// released would sustain forever.
+	void exit_tree() {
+		if (use_voice_manager) {
+			stop_all_notes();
+		}
+	}
+
+	// The owner's own playback, fetched once the stream plays. Null while the voice
+	// manager renders the voices.
+	Ref<SynthAudioStreamPlayback> get_playback() {
+		if (!playback.is_valid() && !use_voice_manager) {
+			Ref<AudioStreamPlayback> stream_playback = owner->get_stream_playback();
+			if (stream_playback.is_valid()) {
+				playback = static_cast<Ref<SynthAudioStreamPlayback>>(stream_playback.ptr());
+			}
+		}
+		return playback;
+	}
+
+	// The playback new notes go to: the manager's, or the own one, started if it stopped
+	Ref<SynthAudioStreamPlayback> get_target_playback() {
+		if (use_voice_manager) {
+			return get_manager_playback();
+		}
+
+		if (get_playback().is_valid() && !owner->is_playing()) {
+			owner->play();
+		}
+		return playback;
+	}
+
+	void set_configuration(const Ref<SynthConfiguration> &p_config) {
+		apply_output_bus(p_config);
+
+		// Rebuild the voice pool for the new configuration in the background
+		voices.set_configuration(p_config);
+	}
+
+	Ref<SynthConfiguration> get_configuration() const {
+		return voices.get_configuration();
+	}
+
+	Error set_patch(const Ref<SynthPresetBank> &p_bank, const String &p_name) {
+		ERR_FAIL_COND_V(p_bank.is_null(), ERR_INVALID_PARAMETER);
+		int index = p_bank->find_patch(p_name);
+		ERR_FAIL_COND_V_MSG(index < 0, ERR_DOES_NOT_EXIST, "No patch named '" + p_name + "' in the bank.");
+
+		Error err = voices.set_patch(p_bank, index);
+		if (err == OK) {
+			apply_output_bus(voices.get_configuration());
+		}
+		return err;
+	}
+
+	void set_polyphony(int p_polyphony) { voices.set_polyphony(p_polyphony); }
+	int get_polyphony() const { return voices.get_polyphony(); }
+
+	bool is_rebuilding_voices() const { return voices.is_rebuilding(); }
+
+	void set_use_voice_manager(bool p_enabled) {
+		if (use_voice_manager == p_enabled) {
+			return;
+		}
+		use_voice_manager = p_enabled;
+
+		if (!owner->is_inside_tree()) {
+			return;
+		}
+
+		// Hand rendering over to the manager, or take it back
+		if (use_voice_manager) {
+			owner->stop();
+			playback.unref();
+		} else {
+			owner->play();
+		}
+	}
+	bool get_use_voice_manager() const { return use_voice_manager; }
+
+	void set_voice_category(SynthVoiceManager::VoiceCategory p_category) { voice_category = p_category; }
+	SynthVoiceManager::VoiceCategory get_voice_category() const { return voice_category; }
+
+	void set_voice_priority(int p_priority) { voice_priority = Math::clamp(p_priority, 0, 255); }
+	int get_voice_priority() const { return voice_priority; }
+
+	Ref<SynthNoteContext> get_context() {
+		if (!voices.get_configuration().is_valid()) {
+			return nullptr;
+		}
+
+		Ref<SynthAudioStreamPlayback> target = get_target_playback();
+		if (!target.is_valid()) {
+			return nullptr;
+		}
+
+		// Get a voice from the pool, timed by the playback clock instead of system time
+		SynthPlayerVoices::NoteVoice note_voice = voices.prepare_voice(target->get_current_time());
+		if (!note_voice.voice.is_valid()) {
+			return nullptr;
+		}
+		Ref<SynthNoteContext> context = note_voice.context;
+
+		int64_t voice_id = -1;
+		if (use_voice_manager) {
+			// The manager may steal a voice to make room, or refuse this one
+			voice_id = SynthVoiceManager::get_singleton()->start_voice(note_voice.voice, context, voice_category, voice_priority, owner->get_instance_id());
+		} else {
+			// Unique per player, it doubles as the handle of batched notes
+			voice_id = handles.take_voice_id();
+
+			// Add to active voices in the playback
+			if (!target->add_voice(voice_id, note_voice.voice, context)) {
+				voice_id = -1;
+			}
+		}
+		if (voice_id < 0) {
+			SynthPlayerVoices::give_back(note_voice);
+			return nullptr;
+		}
+		context->set_voice_id(voice_id);
+
+		return context;
+	}
+
+	void stop_all_notes() {
+		if (use_voice_manager) {
+			// The shared playback also holds other players' voices, only release ours. They are
+			// tagged with the owner, so voices of a pool replaced since are released as well.
+			Ref<SynthAudioStreamPlayback> target = get_manager_playback();
+			if (target.is_valid()) {
+				target->release_all_voices(owner->get_instance_id());
+			}
+			return;
+		}
+
+		// Release all active voices
+		if (playback.is_valid()) {
+			playback->release_all_voices();
+		}
+	}
+
+	void kill_all_notes() {
+		if (use_voice_manager) {
+			Ref<SynthAudioStreamPlayback> target = get_manager_playback();
+			if (target.is_valid()) {
+				target->kill_all_voices(owner->get_instance_id());
+			}
+			return;
+		}
+
+		if (playback.is_valid()) {
+			playback->kill_all_voices();
+		}
+	}
+
+	void set_max_note_lifetime(float p_seconds) {
+		max_note_lifetime = MAX(p_seconds, 0.0f);
+		if (playback.is_valid()) {
+			playback->set_max_note_lifetime(max_note_lifetime);
+		}
+	}
+	float get_max_note_lifetime() const { return max_note_lifetime; }
+
+	PackedInt64Array note_on_batch(const PackedInt32Array &p_notes, const PackedFloat32Array &p_velocities, const PackedFloat32Array &p_articulations) {
+		PackedInt64Array note_handles;
+		note_handles.resize(p_notes.size());
+		int64_t *write = note_handles.ptrw();
+		for (int i = 0; i < p_notes.size(); i++) {
+			Ref<SynthNoteContext> context = get_context();
+			if (!context.is_valid()) {
+				write[i] = -1;
+				continue;
+			}
+			write[i] = context->get_voice_id();
+			handles.note_on(write[i], context, i, p_notes, p_velocities, p_articulations);
+		}
+		return note_handles;
+	}
+
+	void note_off_batch(const PackedInt64Array &p_handles) {
+		Ref<SynthAudioStreamPlayback> target = get_target_playback();
+		if (target.is_valid()) {
+			handles.note_off(p_handles, **target);
+		}
+	}
+
+	bool play_instance(int p_note, float p_velocity, float p_gain, float p_pitch_offset) {
+		std::shared_ptr<const SynthPlayerVoices::VoicePool> pool = voices.get_voice_pool();
+		Ref<SynthAudioStreamPlayback> target = get_target_playback();
+		if (!pool || !target.is_valid()) {
+			return false;
+		}
+		return target->get_instancer().trigger(pool->program, p_note, p_velocity, p_gain, p_pitch_offset, instance_hold, instance_length);
+	}
+
+	void set_instance_hold(float p_seconds) { instance_hold = MAX(p_seconds, 0.001f); }
+	float get_instance_hold() const { return instance_hold; }
+
+	void set_instance_length(float p_seconds) { instance_length = MAX(p_seconds, 0.01f); }
+	float get_instance_length() const { return instance_length; }
+
+	void set_parameter(const String &p_name, float p_value) {
+		Ref<SynthConfiguration> configuration = voices.get_configuration();
+		if (!configuration.is_valid()) {
+			return;
+		}
+
+		Ref<ModulatedParameter> param = configuration->get_parameter(p_name);
+		if (param.is_valid()) {
+			param->set_base_value(p_value);
+		}
+	}
+};
+
+} // namespace godot
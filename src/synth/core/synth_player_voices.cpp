@@ -0,0 +1,320 @@
+#include "synth_player_voices.h"
+#include "audio_stream_generator_engine.h"
+#include "engine_factory.h"
+#include "synth_quality_governor.h"
+
+namespace godot {
+
+SynthPlayerVoices::SynthPlayerVoices() {
+}
+
+SynthPlayerVoices::~SynthPlayerVoices() {
+	// The build task points at these voices, let it finish first
+	rebuild_pending = false;
+	poll_voice_pool_rebuild(true);
+}
+
+void SynthPlayerVoices::set_sample_rate(float p_sample_rate) {
+	sample_rate = p_sample_rate;
+}
+
+float SynthPlayerVoices::get_sample_rate() const {
+	return sample_rate;
+}
+
+void SynthPlayerVoices::set_ready(bool p_ready) {
+	ready = p_ready;
+}
+
+void SynthPlayerVoices::set_configuration(const Ref<SynthConfiguration> &p_configuration) {
+	configuration = p_configuration;
+	patch_bank.unref();
+	patch_index = -1;
+
+	// Voices already playing keep their engine until they are released,
+	// new notes use the new configuration once its pool is built
+	request_voice_pool_rebuild();
+}
+
+Ref<SynthConfiguration> SynthPlayerVoices::get_configuration() const {
+	return configuration;
+}
+
+Error SynthPlayerVoices::set_patch(const Ref<SynthPresetBank> &p_bank, int p_index) {
+	ERR_FAIL_COND_V(p_bank.is_null(), ERR_INVALID_PARAMETER);
+	Ref<SynthConfiguration> patch_configuration = p_bank->create_configuration(p_index);
+	if (patch_configuration.is_null()) {
+		return ERR_DOES_NOT_EXIST;
+	}
+
+	configuration = patch_configuration;
+	patch_bank = p_bank;
+	patch_index = p_index;
+	request_voice_pool_rebuild();
+	return OK;
+}
+
+void SynthPlayerVoices::set_polyphony(int p_polyphony) {
+	polyphony = Math::clamp(p_polyphony, 1, 32);
+	request_voice_pool_rebuild();
+}
+
+int SynthPlayerVoices::get_polyphony() const {
+	return polyphony;
+}
+
+bool SynthPlayerVoices::is_rebuilding() const {
+	return build_task_id != -1;
+}
+
+std::shared_ptr<const SynthPlayerVoices::VoicePool> SynthPlayerVoices::get_voice_pool() const {
+	return std::atomic_load(&voice_pool);
+}
+
+void SynthPlayerVoices::update_effects() {
+	std::shared_ptr<const VoicePool> pool = get_voice_pool();
+	if (!pool) {
+		return;
+	}
+	for (const Ref<SynthVoice> &voice : pool->voices) {
+		Ref<AudioStreamGeneratorEngine> engine = voice->get_engine();
+		if (engine.is_valid()) {
+			engine->update_effects();
+		}
+	}
+}
+
+std::shared_ptr<SynthPlayerVoices::VoicePool> SynthPlayerVoices::build_voice_pool(const Ref<SynthConfiguration> &p_configuration, const Ref<SynthPresetBank> &p_patch_bank, int p_patch_index, int p_polyphony, float p_sample_rate) {
+	std::shared_ptr<VoicePool> new_pool = std::make_shared<VoicePool>();
+	new_pool->configuration = p_configuration;
+
+	// Compile the configuration once, every voice engine is built from the same program.
+	// A bank patch is compiled by the bank, once for every player using it.
+	if (p_patch_bank.is_valid()) {
+		new_pool->program = p_patch_bank->compile_patch(p_patch_index);
+	} else {
+		new_pool->program = PatchProgram::compile(p_configuration);
+	}
+
+	// Create new voices, sizing the pool once
+	new_pool->voices.resize(p_polyphony);
+	size_t state_size = 0;
+	for (int i = 0; i < p_polyphony; i++) {
+		Ref<SynthVoice> voice;
+		voice.instantiate();
+
+		// If we have a configuration, create an engine for this voice
+		if (new_pool->program) {
+			Ref<AudioStreamGeneratorEngine> engine = EngineFactory::create_engine_from_program(*new_pool->program, p_sample_rate);
+			if (engine.is_valid()) {
+				voice->set_engine(engine);
+				state_size = MAX(state_size, engine->get_state_size());
+			}
+		}
+
+		new_pool->voices.set(i, voice);
+	}
+
+	// Carve every voice's effect buffers from one slab. If the slab can't be had, each
+	// engine gets its own buffers, here rather than on the audio thread.
+	if (state_size > 0) {
+		std::shared_ptr<VoiceStateArena> arena = std::make_shared<VoiceStateArena>();
+		bool shared = arena->allocate(state_size, p_polyphony);
+		if (shared) {
+			new_pool->state_arena = arena;
+		}
+		for (int i = 0; i < p_polyphony; i++) {
+			Ref<AudioStreamGeneratorEngine> engine = new_pool->voices[i]->get_engine();
+			if (!engine.is_valid()) {
+				continue;
+			}
+			if (shared) {
+				engine->bind_state_arena(arena, i);
+			} else {
+				engine->allocate_state();
+			}
+		}
+	}
+
+	return new_pool;
+}
+
+void SynthPlayerVoices::build_voice_pool_task(void *p_userdata) {
+	SynthPlayerVoices *voices = static_cast<SynthPlayerVoices *>(p_userdata);
+	voices->built_pool = build_voice_pool(voices->build_configuration, voices->build_patch_bank, voices->build_patch_index, voices->build_polyphony, voices->build_sample_rate);
+}
+
+void SynthPlayerVoices::initialize_voice_pool() {
+	// A synchronous build supersedes any background build
+	rebuild_pending = false;
+	poll_voice_pool_rebuild(true);
+
+	std::atomic_store(&voice_pool, std::shared_ptr<const VoicePool>(build_voice_pool(configuration, patch_bank, patch_index, polyphony, sample_rate)));
+	next_voice_index = 0;
+}
+
+void SynthPlayerVoices::request_voice_pool_rebuild() {
+	// Nothing plays before the owner enters the tree, _ready builds the first pool
+	if (!ready) {
+		return;
+	}
+
+	// Only one build runs at a time, the latest settings are built when it finishes
+	if (build_task_id != -1) {
+		rebuild_pending = true;
+		return;
+	}
+
+	// The task builds only from this snapshot, the player's settings can change while it runs
+	// A bank patch is compiled from the bank, its decoded configuration isn't read.
+	if (patch_bank.is_valid()) {
+		build_configuration = configuration;
+	} else {
+		build_configuration = configuration.is_valid() ? configuration->snapshot() : Ref<SynthConfiguration>();
+	}
+	build_patch_bank = patch_bank;
+	build_patch_index = patch_index;
+	build_polyphony = polyphony;
+	build_sample_rate = sample_rate;
+	built_pool.reset();
+	build_task_id = WorkerThreadPool::get_singleton()->add_native_task(&SynthPlayerVoices::build_voice_pool_task, this, false, "Synth player voice pool");
+}
+
+void SynthPlayerVoices::poll_voice_pool_rebuild(bool p_wait) {
+	if (build_task_id == -1) {
+		return;
+	}
+
+	WorkerThreadPool *thread_pool = WorkerThreadPool::get_singleton();
+	if (!p_wait && !thread_pool->is_task_completed(build_task_id)) {
+		return;
+	}
+	thread_pool->wait_for_task_completion(build_task_id);
+	build_task_id = -1;
+
+	// Swap in the new pool. Voices from the previous pool stay referenced by the
+	// playback until their notes end, the pool itself is freed with its last user.
+	if (built_pool) {
+		std::atomic_store(&voice_pool, std::shared_ptr<const VoicePool>(built_pool));
+		next_voice_index = 0;
+	}
+	built_pool.reset();
+	build_configuration.unref();
+	build_patch_bank.unref();
+
+	if (rebuild_pending) {
+		rebuild_pending = false;
+		request_voice_pool_rebuild();
+	}
+}
+
+SynthPlayerVoices::NoteVoice SynthPlayerVoices::take_voice(const VoicePool &p_pool, int &r_next_index, double p_time, bool p_in_place) {
+	NoteVoice note_voice;
+	const Vector<Ref<SynthVoice>> &voices = p_pool.voices;
+	if (voices.size() == 0) {
+		return note_voice;
+	}
+	int voice_count = voices.size();
+
+	// Under load the configuration's profile may cap how many voices this player uses
+	SynthQualityGovernor *governor = SynthQualityGovernor::get_singleton();
+	if (governor != nullptr) {
+		Ref<SynthQualityProfile> profile = p_pool.program ? p_pool.program->get_quality_profile() : Ref<SynthQualityProfile>();
+		const SynthQualityProfile::Settings &settings = profile.is_valid() ? profile->get_settings(governor->get_tier()) : SynthQualityProfile::get_default_settings(governor->get_tier());
+		if (settings.polyphony_limit > 0) {
+			voice_count = MIN(voice_count, settings.polyphony_limit);
+		}
+	}
+	r_next_index = r_next_index % voice_count;
+
+	// Find the next voice no playback holds using round-robin. Voices still rendering a
+	// release or an effect tail are held as well.
+	int start_index = r_next_index;
+	do {
+		Ref<SynthVoice> candidate = voices[r_next_index];
+
+		// Move to next voice for next allocation
+		r_next_index = (r_next_index + 1) % voice_count;
+
+		if (candidate->claim()) {
+			note_voice.voice = candidate;
+			break;
+		}
+	} while (r_next_index != start_index);
+
+	if (note_voice.voice.is_valid()) {
+		// Get the context from the voice - this will create a fresh context
+		note_voice.context = note_voice.voice->get_context();
+	} else {
+		// All voices are held, the next one is stolen
+		note_voice.voice = voices[r_next_index];
+		note_voice.stolen = true;
+		r_next_index = (r_next_index + 1) % voice_count;
+
+		if (p_in_place) {
+			note_voice.voice->reset(); // Reset the voice before reusing it
+			note_voice.context = note_voice.voice->get_context();
+		} else {
+			// The voice may be rendering right now, the playback swaps this context in
+			note_voice.context.instantiate();
+		}
+	}
+
+	Ref<SynthNoteContext> context = note_voice.context;
+	context->set_absolute_time(p_time);
+	context->set_note_time(0.0);
+	context->set_note_on_time(p_time);
+
+	// Make sure the context is in the READY state
+	context->set_note_state(SynthNoteContext::NOTE_STATE_READY);
+
+	return note_voice;
+}
+
+void SynthPlayerVoices::give_back(const NoteVoice &p_note_voice) {
+	if (!p_note_voice.voice.is_valid() || p_note_voice.stolen) {
+		return;
+	}
+	p_note_voice.voice->reset();
+	p_note_voice.voice->unclaim();
+}
+
+SynthPlayerVoices::NoteVoice SynthPlayerVoices::prepare_voice(double p_time) {
+	if (!configuration.is_valid()) {
+		return NoteVoice();
+	}
+
+	std::shared_ptr<const VoicePool> pool = std::atomic_load(&voice_pool);
+	if (!pool || pool->voices.size() == 0) {
+		initialize_voice_pool();
+		pool = std::atomic_load(&voice_pool);
+		if (pool->voices.size() == 0) {
+			return NoteVoice();
+		}
+	}
+	NoteVoice note_voice = take_voice(*pool, next_voice_index, p_time, false);
+	if (!note_voice.voice.is_valid()) {
+		return note_voice;
+	}
+
+	// If the voice doesn't have an engine (or it's invalid), create one from the pool's
+	// program at the running rate, with its buffers allocated before it can render. Such a
+	// voice never reached a playback, so it wasn't stolen.
+	Ref<SynthVoice> voice = note_voice.voice;
+	if (!voice->get_engine().is_valid()) {
+		Ref<AudioStreamGeneratorEngine> engine;
+		if (pool->program) {
+			engine = EngineFactory::create_engine_from_program(*pool->program, sample_rate);
+		}
+		if (!engine.is_valid()) {
+			give_back(note_voice);
+			return NoteVoice();
+		}
+		engine->allocate_state();
+		voice->set_engine(engine);
+	}
+
+	return note_voice;
+}
+
+} // namespace godot
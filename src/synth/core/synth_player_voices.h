@@ -0,0 +1,118 @@
+#pragma once
+#include "patch_program.h"
+#include "synth_audio_stream_playback.h"
+#include "synth_configuration.h"
+#include "synth_note_context.h"
+#include "synth_preset_bank.h"
+#include "synth_voice.h"
+#include "voice_state_arena.h"
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/templates/vector.hpp>
+#include <memory>
+
+namespace godot {
+
+// Voice pool and note allocation of the players, through SynthPlayerCore, and of
+// SynthSequencer. The owner keeps its stream and playback and forwards its lifecycle: it
+// marks the voices ready when it enters the tree, polls background builds from _process
+// and asks for a prepared voice on every note before handing it to a playback.
+class SynthPlayerVoices {
+public:
+	// A built voice pool. Pools are never modified once published: a configuration or
+	// polyphony change builds a new pool and swaps the pointer, so voices handed out from
+	// the old pool keep their engine until they are released.
+	struct VoicePool {
+		Vector<Ref<SynthVoice>> voices;
+		Ref<SynthConfiguration> configuration;
+
+		// Compiled configuration shared read-only by every voice in the pool
+		std::shared_ptr<const PatchProgram> program;
+
+		// One slab holding the effect buffers of every voice in the pool
+		std::shared_ptr<VoiceStateArena> state_arena;
+	};
+
+private:
+	Ref<SynthConfiguration> configuration;
+	float sample_rate = 44100.0f;
+	bool ready = false;
+
+	// Bank patch the voices are compiled from instead of the configuration, if any
+	Ref<SynthPresetBank> patch_bank;
+	int patch_index = -1;
+
+	// Voice pool management
+	int polyphony = 8; // Default polyphony
+	std::shared_ptr<const VoicePool> voice_pool; // Accessed through std::atomic_load/store
+	int next_voice_index = 0; // For round-robin allocation
+
+	// Background pool build
+	WorkerThreadPool::TaskID build_task_id = -1;
+	bool rebuild_pending = false;
+	Ref<SynthConfiguration> build_configuration;
+	Ref<SynthPresetBank> build_patch_bank;
+	int build_patch_index = -1;
+	int build_polyphony = 0;
+	float build_sample_rate = 44100.0f;
+	std::shared_ptr<VoicePool> built_pool;
+
+	static std::shared_ptr<VoicePool> build_voice_pool(const Ref<SynthConfiguration> &p_configuration, const Ref<SynthPresetBank> &p_patch_bank, int p_patch_index, int p_polyphony, float p_sample_rate);
+	static void build_voice_pool_task(void *p_userdata);
+
+public:
+	SynthPlayerVoices();
+	~SynthPlayerVoices();
+
+	void set_sample_rate(float p_sample_rate);
+	float get_sample_rate() const;
+
+	// Rebuilds are requested once the owner is ready, before that _ready builds the first pool
+	void set_ready(bool p_ready);
+
+	void set_configuration(const Ref<SynthConfiguration> &p_configuration);
+	Ref<SynthConfiguration> get_configuration() const;
+
+	// Play a bank patch. The voices run the bank's compiled program, shared with every
+	// player using the patch, and get_configuration() returns a decoded copy whose edits
+	// don't reach them. Setting a configuration leaves the patch.
+	Error set_patch(const Ref<SynthPresetBank> &p_bank, int p_index);
+
+	void set_polyphony(int p_polyphony);
+	int get_polyphony() const;
+
+	// Pool building
+	void initialize_voice_pool();
+	void request_voice_pool_rebuild();
+	void poll_voice_pool_rebuild(bool p_wait);
+	bool is_rebuilding() const;
+
+	std::shared_ptr<const VoicePool> get_voice_pool() const;
+
+	// Recompile the effect chains the audio thread found changed, called from _process
+	void update_effects();
+
+	// A voice handed out for a note, claimed until the playback it is added to retires it.
+	// The note plays in context. That is the voice's own, unless the voice was stolen from
+	// a playback that may still be rendering it: the playback swaps the context in when it
+	// applies the add, and until then only the context may be touched.
+	struct NoteVoice {
+		Ref<SynthVoice> voice;
+		Ref<SynthNoteContext> context;
+		bool stolen = false;
+	};
+
+	// Next voice from the pool, with an engine and a fresh context starting at p_time.
+	// The voice is null when none could be prepared.
+	NoteVoice prepare_voice(double p_time);
+
+	// Next voice of p_pool no playback holds, round robin from r_next_index, with a fresh
+	// context starting at p_time. When all are held the next one is stolen. p_in_place
+	// restarts a stolen voice right away, only for the thread rendering the playback that
+	// holds it: a sequencer on the audio thread, as long as it is the pool's only allocator.
+	static NoteVoice take_voice(const VoicePool &p_pool, int &r_next_index, double p_time, bool p_in_place);
+
+	// Return a voice whose note never reached a playback. A stolen one stays where it plays.
+	static void give_back(const NoteVoice &p_note_voice);
+};
+
+} // namespace godot
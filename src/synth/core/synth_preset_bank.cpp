@@ -0,0 +1,829 @@
+#include "synth_preset_bank.h"
+#include "../chord/chord_synth_configuration.h"
+#include "../chord/chord_synth_preset.h"
+#include "../effects/effect_chain.h"
+#include "../va/va_synth_configuration.h"
+#include "../va/va_synth_preset.h"
+#include "modulated_parameter.h"
+#include "modulation_source.h"
+#include <godot_cpp/classes/class_db_singleton.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <cstring>
+
+namespace godot {
+
+namespace {
+
+const uint8_t BANK_MAGIC[4] = { 'G', 'S', 'P', 'B' };
+constexpr uint32_t HEADER_SIZE = 32;
+constexpr uint32_t PATCH_TABLE_ENTRY_SIZE = 12;
+constexpr uint32_t STRING_TABLE_ENTRY_SIZE = 8;
+
+enum PropertyKind : uint8_t {
+	PROPERTY_FLOAT,
+	PROPERTY_INT,
+	PROPERTY_BOOL,
+	PROPERTY_STRING, // Value is a string index
+	PROPERTY_RESOURCE, // Followed by the embedded object
+	PROPERTY_RESOURCE_PATH, // Value is the string index of the resource's file
+};
+
+// Embedded resources deeper than this are not stored
+constexpr int MAX_NESTING = 4;
+
+void put_u8(std::vector<uint8_t> &p_out, uint8_t p_value) {
+	p_out.push_back(p_value);
+}
+
+void put_u16(std::vector<uint8_t> &p_out, uint16_t p_value) {
+	p_out.push_back(static_cast<uint8_t>(p_value));
+	p_out.push_back(static_cast<uint8_t>(p_value >> 8));
+}
+
+void put_u32(std::vector<uint8_t> &p_out, uint32_t p_value) {
+	for (int i = 0; i < 4; i++) {
+		p_out.push_back(static_cast<uint8_t>(p_value >> (i * 8)));
+	}
+}
+
+void put_f32(std::vector<uint8_t> &p_out, float p_value) {
+	uint32_t bits;
+	std::memcpy(&bits, &p_value, sizeof(bits));
+	put_u32(p_out, bits);
+}
+
+void put_property(std::vector<uint8_t> &p_out, uint32_t p_name, PropertyKind p_kind, uint32_t p_value) {
+	put_u32(p_out, p_name);
+	put_u8(p_out, p_kind);
+	put_u8(p_out, 0);
+	put_u16(p_out, 0);
+	put_u32(p_out, p_value);
+}
+
+void set_u32(std::vector<uint8_t> &p_out, size_t p_offset, uint32_t p_value) {
+	for (int i = 0; i < 4; i++) {
+		p_out[p_offset + i] = static_cast<uint8_t>(p_value >> (i * 8));
+	}
+}
+
+uint32_t checksum(const uint8_t *p_data, size_t p_size) {
+	// FNV-1a, cheap enough to run over the whole bank at load time
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < p_size; i++) {
+		hash = (hash ^ p_data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+// Bounds checked little endian reader. Reads past the end return zero and mark the
+// reader invalid, so decoders check is_valid() once instead of after every field.
+class BankReader {
+private:
+	const uint8_t *data;
+	size_t size;
+	size_t position = 0;
+	bool valid = true;
+
+	bool take(size_t p_count) {
+		if (!valid || position + p_count > size) {
+			valid = false;
+			return false;
+		}
+		return true;
+	}
+
+public:
+	BankReader(const uint8_t *p_data, size_t p_size) :
+			data(p_data), size(p_size) {}
+
+	uint8_t u8() {
+		if (!take(1)) {
+			return 0;
+		}
+		return data[position++];
+	}
+
+	uint16_t u16() {
+		if (!take(2)) {
+			return 0;
+		}
+		uint16_t value = static_cast<uint16_t>(data[position] | (data[position + 1] << 8));
+		position += 2;
+		return value;
+	}
+
+	uint32_t u32() {
+		if (!take(4)) {
+			return 0;
+		}
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++) {
+			value |= static_cast<uint32_t>(data[position + i]) << (i * 8);
+		}
+		position += 4;
+		return value;
+	}
+
+	float f32() {
+		uint32_t bits = u32();
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	void skip(size_t p_count) {
+		if (take(p_count)) {
+			position += p_count;
+		}
+	}
+
+	// Marks the data invalid when a field holds a value the decoder can't use
+	void fail() { valid = false; }
+
+	bool is_valid() const { return valid; }
+};
+
+String string_at(const Vector<String> &p_strings, uint32_t p_index) {
+	if (p_index >= static_cast<uint32_t>(p_strings.size())) {
+		return String();
+	}
+	return p_strings[p_index];
+}
+
+Ref<Resource> decode_object(BankReader &p_reader, const Vector<String> &p_strings, const String &p_base, int p_depth);
+
+// Reads p_count stored properties into p_object. A null object only reads past them.
+void decode_properties(BankReader &p_reader, const Vector<String> &p_strings, Object *p_object, uint16_t p_count, int p_depth) {
+	for (uint16_t i = 0; i < p_count && p_reader.is_valid(); i++) {
+		String name = string_at(p_strings, p_reader.u32());
+		uint8_t kind = p_reader.u8();
+		p_reader.skip(3);
+		uint32_t bits = p_reader.u32();
+
+		Variant value;
+		switch (kind) {
+			case PROPERTY_FLOAT: {
+				float number;
+				std::memcpy(&number, &bits, sizeof(number));
+				value = number;
+			} break;
+			case PROPERTY_INT:
+				value = static_cast<int64_t>(static_cast<int32_t>(bits));
+				break;
+			case PROPERTY_BOOL:
+				value = bits != 0;
+				break;
+			case PROPERTY_STRING:
+				value = string_at(p_strings, bits);
+				break;
+			case PROPERTY_RESOURCE:
+				value = decode_object(p_reader, p_strings, "Resource", p_depth + 1);
+				break;
+			case PROPERTY_RESOURCE_PATH:
+				if (p_object != nullptr) {
+					value = ResourceLoader::get_singleton()->load(string_at(p_strings, bits));
+				}
+				break;
+			default:
+				p_reader.fail();
+				break;
+		}
+
+		if (p_object != nullptr && value.get_type() != Variant::NIL) {
+			p_object->set(name, value);
+		}
+	}
+}
+
+// Reads one object and its properties. Classes that are unknown or don't derive from
+// p_base come back null, after reading past their properties.
+Ref<Resource> decode_object(BankReader &p_reader, const Vector<String> &p_strings, const String &p_base, int p_depth) {
+	String class_name = string_at(p_strings, p_reader.u32());
+	uint16_t property_count = p_reader.u16();
+	p_reader.skip(2);
+	if (p_depth > MAX_NESTING) {
+		p_reader.fail();
+		return Ref<Resource>();
+	}
+
+	ClassDBSingleton *class_db = ClassDBSingleton::get_singleton();
+	Ref<Resource> object;
+	if (class_db->can_instantiate(class_name) && class_db->is_parent_class(class_name, p_base)) {
+		object = class_db->instantiate(class_name);
+	}
+	decode_properties(p_reader, p_strings, object.ptr(), property_count, p_depth);
+	return object;
+}
+
+// Decoded form of a parameter record
+struct ParameterRecord {
+	uint32_t name;
+	Ref<ModulatedParameter> parameter;
+};
+
+ParameterRecord decode_parameter(BankReader &p_reader, const Vector<Ref<ModulationSource>> &p_sources) {
+	ParameterRecord record;
+	record.name = p_reader.u32();
+
+	Ref<ModulatedParameter> param;
+	param.instantiate();
+	param->set_base_value(p_reader.f32());
+	param->set_mod_amount(p_reader.f32());
+	param->set_mod_min(p_reader.f32());
+	param->set_mod_max(p_reader.f32());
+	uint8_t mod_type = p_reader.u8();
+	if (mod_type > MODULATION_GATE) {
+		p_reader.fail();
+		mod_type = MODULATION_ADDITIVE;
+	}
+	param->set_mod_type(static_cast<ModulationType>(mod_type));
+	param->set_invert_mod(p_reader.u8() != 0);
+
+	int16_t source = static_cast<int16_t>(p_reader.u16());
+	if (source >= 0 && source < p_sources.size()) {
+		param->set_mod_source(p_sources[source]);
+	}
+
+	record.parameter = param;
+	return record;
+}
+
+} // namespace
+
+void SynthPresetBank::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("load", "path"), &SynthPresetBank::load);
+	ClassDB::bind_method(D_METHOD("load_from_bytes", "bytes"), &SynthPresetBank::load_from_bytes);
+	ClassDB::bind_method(D_METHOD("save", "path"), &SynthPresetBank::save);
+	ClassDB::bind_method(D_METHOD("to_bytes"), &SynthPresetBank::to_bytes);
+	ClassDB::bind_method(D_METHOD("clear"), &SynthPresetBank::clear);
+
+	ClassDB::bind_method(D_METHOD("add_configuration", "name", "configuration"), &SynthPresetBank::add_configuration);
+	ClassDB::bind_method(D_METHOD("add_preset", "name", "preset"), &SynthPresetBank::add_preset);
+
+	ClassDB::bind_method(D_METHOD("get_patch_count"), &SynthPresetBank::get_patch_count);
+	ClassDB::bind_method(D_METHOD("get_patch_name", "index"), &SynthPresetBank::get_patch_name);
+	ClassDB::bind_method(D_METHOD("find_patch", "name"), &SynthPresetBank::find_patch);
+	ClassDB::bind_method(D_METHOD("create_configuration", "index"), &SynthPresetBank::create_configuration);
+
+	BIND_ENUM_CONSTANT(ENGINE_VA);
+	BIND_ENUM_CONSTANT(ENGINE_CHORD);
+}
+
+SynthPresetBank::SynthPresetBank() {
+}
+
+SynthPresetBank::~SynthPresetBank() {
+}
+
+uint32_t SynthPresetBank::intern(const String &p_string) {
+	if (string_ids.has(p_string)) {
+		return string_ids[p_string];
+	}
+
+	uint32_t id = strings.size();
+	strings.push_back(p_string);
+	string_ids.insert(p_string, id);
+	return id;
+}
+
+String SynthPresetBank::get_string(uint32_t p_index) const {
+	if (p_index >= static_cast<uint32_t>(strings.size())) {
+		return String();
+	}
+	return strings[p_index];
+}
+
+void SynthPresetBank::clear() {
+	records.clear();
+	patches.clear();
+	strings.clear();
+	string_ids.clear();
+	compiled_patches.clear();
+}
+
+Error SynthPresetBank::load(const String &p_path) {
+	// One read for the whole bank
+	PackedByteArray bytes = FileAccess::get_file_as_bytes(p_path);
+	if (bytes.is_empty()) {
+		return ERR_FILE_CANT_READ;
+	}
+	return load_from_bytes(bytes);
+}
+
+Error SynthPresetBank::load_from_bytes(const PackedByteArray &p_bytes) {
+	clear();
+
+	const uint8_t *data = p_bytes.ptr();
+	const size_t size = p_bytes.size();
+	if (size < HEADER_SIZE || std::memcmp(data, BANK_MAGIC, 4) != 0) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	BankReader header(data, size);
+	header.skip(4);
+	uint16_t version = header.u16();
+	uint16_t header_size = header.u16();
+	uint32_t patch_count = header.u32();
+	uint32_t string_count = header.u32();
+	uint32_t patch_table_offset = header.u32();
+	uint32_t string_table_offset = header.u32();
+	uint32_t records_offset = header.u32();
+	uint32_t stored_checksum = header.u32();
+
+	if (version != FORMAT_VERSION || header_size != HEADER_SIZE) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+	if (patch_table_offset + static_cast<uint64_t>(patch_count) * PATCH_TABLE_ENTRY_SIZE > size ||
+			string_table_offset + static_cast<uint64_t>(string_count) * STRING_TABLE_ENTRY_SIZE > size ||
+			records_offset > size) {
+		return ERR_FILE_CORRUPT;
+	}
+	if (checksum(data + HEADER_SIZE, size - HEADER_SIZE) != stored_checksum) {
+		return ERR_FILE_CORRUPT;
+	}
+
+	// Strings
+	BankReader string_table(data + string_table_offset, size - string_table_offset);
+	strings.resize(string_count);
+	for (uint32_t i = 0; i < string_count; i++) {
+		uint32_t offset = string_table.u32();
+		uint32_t length = string_table.u32();
+		if (static_cast<uint64_t>(offset) + length > size) {
+			clear();
+			return ERR_FILE_CORRUPT;
+		}
+		String string = String::utf8(reinterpret_cast<const char *>(data + offset), length);
+		strings.write[i] = string;
+		string_ids.insert(string, i);
+	}
+
+	// Patch table, records are kept encoded until used
+	const uint32_t records_size = static_cast<uint32_t>(size - records_offset);
+	BankReader patch_table(data + patch_table_offset, size - patch_table_offset);
+	patches.resize(patch_count);
+	for (uint32_t i = 0; i < patch_count; i++) {
+		PatchEntry entry;
+		entry.name = patch_table.u32();
+		entry.offset = patch_table.u32();
+		entry.size = patch_table.u32();
+		if (entry.name >= string_count || static_cast<uint64_t>(entry.offset) + entry.size > records_size) {
+			clear();
+			return ERR_FILE_CORRUPT;
+		}
+		patches.write[i] = entry;
+	}
+
+	records.assign(data + records_offset, data + size);
+	compiled_patches.resize(patch_count);
+	return OK;
+}
+
+PackedByteArray SynthPresetBank::to_bytes() const {
+	std::vector<uint8_t> out;
+	out.reserve(HEADER_SIZE + patches.size() * PATCH_TABLE_ENTRY_SIZE + strings.size() * 16 + records.size());
+
+	// Header, offsets and checksum are filled in at the end
+	out.insert(out.end(), BANK_MAGIC, BANK_MAGIC + 4);
+	put_u16(out, FORMAT_VERSION);
+	put_u16(out, HEADER_SIZE);
+	put_u32(out, patches.size());
+	put_u32(out, strings.size());
+	out.resize(HEADER_SIZE, 0);
+
+	const uint32_t patch_table_offset = out.size();
+	for (int i = 0; i < patches.size(); i++) {
+		put_u32(out, patches[i].name);
+		put_u32(out, patches[i].offset);
+		put_u32(out, patches[i].size);
+	}
+
+	const uint32_t string_table_offset = out.size();
+	Vector<CharString> encoded;
+	encoded.resize(strings.size());
+	uint32_t string_data_offset = string_table_offset + strings.size() * STRING_TABLE_ENTRY_SIZE;
+	for (int i = 0; i < strings.size(); i++) {
+		encoded.write[i] = strings[i].utf8();
+		put_u32(out, string_data_offset);
+		put_u32(out, encoded[i].length());
+		string_data_offset += encoded[i].length();
+	}
+	for (int i = 0; i < encoded.size(); i++) {
+		out.insert(out.end(), encoded[i].get_data(), encoded[i].get_data() + encoded[i].length());
+	}
+
+	const uint32_t records_offset = out.size();
+	out.insert(out.end(), records.begin(), records.end());
+
+	set_u32(out, 16, patch_table_offset);
+	set_u32(out, 20, string_table_offset);
+	set_u32(out, 24, records_offset);
+	set_u32(out, 28, checksum(out.data() + HEADER_SIZE, out.size() - HEADER_SIZE));
+
+	PackedByteArray bytes;
+	bytes.resize(out.size());
+	std::memcpy(bytes.ptrw(), out.data(), out.size());
+	return bytes;
+}
+
+Error SynthPresetBank::save(const String &p_path) const {
+	Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE);
+	if (!file.is_valid()) {
+		return FileAccess::get_open_error();
+	}
+	file->store_buffer(to_bytes());
+	return OK;
+}
+
+void SynthPresetBank::encode_object(std::vector<uint8_t> &p_out, const Object *p_object, const Dictionary &p_skip, int p_depth) {
+	put_u32(p_out, intern(p_object->get_class()));
+	size_t count_offset = p_out.size();
+	put_u16(p_out, 0);
+	put_u16(p_out, 0);
+
+	// Stored properties, through reflection so new sources and effects need no
+	// format changes
+	uint16_t count = 0;
+	TypedArray<Dictionary> properties = p_object->get_property_list();
+	for (int i = 0; i < properties.size(); i++) {
+		Dictionary property = properties[i];
+		int usage = property["usage"];
+		if (!(usage & PROPERTY_USAGE_STORAGE)) {
+			continue;
+		}
+
+		// Resource bookkeeping is not part of a patch
+		String name = property["name"];
+		if (p_skip.has(name) || name.begins_with("resource_")) {
+			continue;
+		}
+
+		Variant value = p_object->get(name);
+		switch (static_cast<int>(property["type"])) {
+			case Variant::FLOAT: {
+				float number = value;
+				uint32_t bits;
+				std::memcpy(&bits, &number, sizeof(bits));
+				put_property(p_out, intern(name), PROPERTY_FLOAT, bits);
+			} break;
+			case Variant::INT:
+				put_property(p_out, intern(name), PROPERTY_INT, static_cast<uint32_t>(static_cast<int32_t>(static_cast<int64_t>(value))));
+				break;
+			case Variant::BOOL:
+				put_property(p_out, intern(name), PROPERTY_BOOL, static_cast<bool>(value) ? 1 : 0);
+				break;
+			case Variant::STRING:
+			case Variant::STRING_NAME:
+				put_property(p_out, intern(name), PROPERTY_STRING, intern(static_cast<String>(value)));
+				break;
+			case Variant::OBJECT: {
+				// Parameters and effect chains have records of their own
+				Ref<Resource> resource = value;
+				if (resource.is_null() || resource->is_class("ModulatedParameter") || resource->is_class("EffectChain")) {
+					continue;
+				}
+
+				String path = resource->get_path();
+				if (!path.is_empty() && path.find("::") < 0) {
+					put_property(p_out, intern(name), PROPERTY_RESOURCE_PATH, intern(path));
+				} else if (p_depth < MAX_NESTING && !resource->is_class("Script")) {
+					put_property(p_out, intern(name), PROPERTY_RESOURCE, 0);
+					encode_object(p_out, resource.ptr(), Dictionary(), p_depth + 1);
+				} else {
+					continue;
+				}
+			} break;
+			default:
+				continue;
+		}
+		count++;
+	}
+
+	p_out[count_offset] = static_cast<uint8_t>(count);
+	p_out[count_offset + 1] = static_cast<uint8_t>(count >> 8);
+}
+
+void SynthPresetBank::encode_parameter(std::vector<uint8_t> &p_out, const String &p_name, const Ref<ModulatedParameter> &p_param, int p_source) {
+	put_u32(p_out, intern(p_name));
+	put_f32(p_out, p_param->get_base_value());
+	put_f32(p_out, p_param->get_mod_amount());
+	put_f32(p_out, p_param->get_mod_min());
+	put_f32(p_out, p_param->get_mod_max());
+	put_u8(p_out, static_cast<uint8_t>(p_param->get_mod_type()));
+	put_u8(p_out, p_param->get_invert_mod() ? 1 : 0);
+	put_u16(p_out, static_cast<uint16_t>(static_cast<int16_t>(p_source)));
+}
+
+Error SynthPresetBank::add_configuration(const String &p_name, const Ref<SynthConfiguration> &p_configuration) {
+	ERR_FAIL_COND_V(p_configuration.is_null(), ERR_INVALID_PARAMETER);
+
+	std::vector<uint8_t> record;
+
+	// Engine kind and oscillator settings
+	Ref<VASynthConfiguration> va_config = p_configuration;
+	Ref<ChordSynthConfiguration> chord_config = p_configuration;
+	if (va_config.is_valid()) {
+		put_u8(record, ENGINE_VA);
+		put_u8(record, va_config->get_bottom_waveform());
+		put_u8(record, va_config->get_middle_waveform());
+		put_u8(record, va_config->get_top_waveform());
+	} else if (chord_config.is_valid()) {
+		put_u8(record, ENGINE_CHORD);
+		put_u8(record, chord_config->get_waveform());
+		put_u8(record, 0);
+		put_u8(record, 0);
+	} else {
+		return ERR_INVALID_PARAMETER;
+	}
+
+	// Gather parameters and effects, numbering each distinct source once
+	Dictionary params = p_configuration->get_parameters();
+	Array param_names = params.keys();
+	TypedArray<SynthAudioEffect> effects;
+	Ref<EffectChain> chain = p_configuration->get_effect_chain();
+	if (chain.is_valid()) {
+		effects = chain->get_effects();
+	}
+
+	HashMap<const ModulationSource *, int> source_ids;
+	Vector<Ref<ModulationSource>> sources;
+	auto source_id = [&](const Ref<ModulatedParameter> &p_param) -> int {
+		Ref<ModulationSource> source = p_param->get_mod_source();
+		if (source.is_null()) {
+			return -1;
+		}
+		if (!source_ids.has(source.ptr())) {
+			source_ids.insert(source.ptr(), sources.size());
+			sources.push_back(source);
+		}
+		return source_ids[source.ptr()];
+	};
+
+	std::vector<uint8_t> body;
+	uint16_t param_count = 0;
+	for (int i = 0; i < param_names.size(); i++) {
+		Ref<ModulatedParameter> param = params[param_names[i]];
+		if (param.is_valid()) {
+			encode_parameter(body, param_names[i], param, source_id(param));
+			param_count++;
+		}
+	}
+
+	uint16_t effect_count = 0;
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (effect.is_null()) {
+			continue;
+		}
+
+		// Scalar properties that mirror a parameter's base value are restored
+		// through the parameter itself
+		Dictionary effect_params = effect->get_parameters();
+		encode_object(body, effect.ptr(), effect_params);
+
+		Array effect_param_names = effect_params.keys();
+		size_t count_offset = body.size();
+		put_u16(body, 0);
+		put_u16(body, 0);
+		uint16_t effect_param_count = 0;
+		for (int j = 0; j < effect_param_names.size(); j++) {
+			Ref<ModulatedParameter> param = effect_params[effect_param_names[j]];
+			if (param.is_valid()) {
+				encode_parameter(body, effect_param_names[j], param, source_id(param));
+				effect_param_count++;
+			}
+		}
+		body[count_offset] = static_cast<uint8_t>(effect_param_count);
+		body[count_offset + 1] = static_cast<uint8_t>(effect_param_count >> 8);
+		effect_count++;
+	}
+
+	put_u16(record, sources.size());
+	put_u16(record, param_count);
+	put_u16(record, effect_count);
+	put_u16(record, 0);
+
+	// Remaining configuration settings such as the quality profile. The oscillator
+	// settings are in the header, the rest and the scalars mirroring parameters have
+	// records of their own.
+	Dictionary configuration_skip = params.duplicate();
+	const char *recorded[] = { "parameters", "effect_chain", "preset", "waveform", "bottom_waveform", "middle_waveform", "top_waveform" };
+	for (const char *name : recorded) {
+		configuration_skip[name] = true;
+	}
+	encode_object(record, p_configuration.ptr(), configuration_skip);
+
+	for (int i = 0; i < sources.size(); i++) {
+		encode_object(record, sources[i].ptr(), Dictionary());
+	}
+	record.insert(record.end(), body.begin(), body.end());
+
+	// A replaced record is cut out so re-exporting a patch doesn't grow the bank.
+	// Players may be compiling from the bank meanwhile.
+	std::lock_guard<std::mutex> lock(compile_mutex);
+	int existing = find_patch(p_name);
+	if (existing >= 0) {
+		const PatchEntry old_entry = patches[existing];
+		records.erase(records.begin() + old_entry.offset, records.begin() + old_entry.offset + old_entry.size);
+		for (int i = 0; i < patches.size(); i++) {
+			if (patches[i].offset > old_entry.offset) {
+				patches.write[i].offset -= old_entry.size;
+			}
+		}
+	}
+
+	PatchEntry entry;
+	entry.name = intern(p_name);
+	entry.offset = records.size();
+	entry.size = record.size();
+	records.insert(records.end(), record.begin(), record.end());
+
+	// Replace a patch with the same name, otherwise append
+	if (existing >= 0) {
+		patches.write[existing] = entry;
+		compiled_patches[existing].reset();
+	} else {
+		patches.push_back(entry);
+		compiled_patches.emplace_back();
+	}
+	return OK;
+}
+
+Error SynthPresetBank::add_preset(const String &p_name, const Ref<SynthPreset> &p_preset) {
+	ERR_FAIL_COND_V(p_preset.is_null(), ERR_INVALID_PARAMETER);
+
+	// Presets are applied to a configuration of their engine type and exported from there
+	Ref<VASynthPreset> va_preset = p_preset;
+	if (va_preset.is_valid()) {
+		Ref<VASynthConfiguration> config;
+		config.instantiate();
+		config->set_preset(va_preset);
+		return add_configuration(p_name, config);
+	}
+
+	Ref<ChordSynthPreset> chord_preset = p_preset;
+	if (chord_preset.is_valid()) {
+		Ref<ChordSynthConfiguration> config;
+		config.instantiate();
+		config->set_preset(chord_preset);
+		return add_configuration(p_name, config);
+	}
+
+	return ERR_INVALID_PARAMETER;
+}
+
+int SynthPresetBank::get_patch_count() const {
+	return patches.size();
+}
+
+String SynthPresetBank::get_patch_name(int p_index) const {
+	if (p_index < 0 || p_index >= patches.size()) {
+		return String();
+	}
+	return get_string(patches[p_index].name);
+}
+
+int SynthPresetBank::find_patch(const String &p_name) const {
+	if (!string_ids.has(p_name)) {
+		return -1;
+	}
+
+	uint32_t name = string_ids[p_name];
+	for (int i = 0; i < patches.size(); i++) {
+		if (patches[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool SynthPresetBank::decode_patch(int p_index, DecodedPatch &r_patch) const {
+	if (p_index < 0 || p_index >= patches.size()) {
+		return false;
+	}
+
+	const PatchEntry &entry = patches[p_index];
+	BankReader reader(records.data() + entry.offset, entry.size);
+
+	uint8_t engine_kind = reader.u8();
+	uint8_t waveforms[3];
+	for (int i = 0; i < 3; i++) {
+		waveforms[i] = reader.u8();
+	}
+	uint16_t source_count = reader.u16();
+	uint16_t param_count = reader.u16();
+	uint16_t effect_count = reader.u16();
+	reader.skip(2);
+
+	// Bytes outside the enums would be cast into values the engines can't handle
+	if (engine_kind != ENGINE_VA && engine_kind != ENGINE_CHORD) {
+		return false;
+	}
+	for (int i = 0; i < 3; i++) {
+		if (waveforms[i] >= WaveHelper::WAVE_TYPE_MAX) {
+			return false;
+		}
+	}
+
+	Ref<Resource> configuration = decode_object(reader, strings, "SynthConfiguration", 0);
+	if (engine_kind == ENGINE_VA) {
+		Ref<VASynthConfiguration> va_config = configuration;
+		if (va_config.is_null()) {
+			return false;
+		}
+		va_config->set_bottom_waveform(static_cast<WaveHelper::WaveType>(waveforms[0]));
+		va_config->set_middle_waveform(static_cast<WaveHelper::WaveType>(waveforms[1]));
+		va_config->set_top_waveform(static_cast<WaveHelper::WaveType>(waveforms[2]));
+		r_patch.configuration = va_config;
+	} else {
+		Ref<ChordSynthConfiguration> chord_config = configuration;
+		if (chord_config.is_null()) {
+			return false;
+		}
+		chord_config->set_waveform(static_cast<WaveHelper::WaveType>(waveforms[0]));
+		r_patch.configuration = chord_config;
+	}
+
+	for (uint16_t i = 0; i < source_count && reader.is_valid(); i++) {
+		Ref<ModulationSource> source = decode_object(reader, strings, "ModulationSource", 0);
+		r_patch.sources.push_back(source);
+	}
+
+	for (uint16_t i = 0; i < param_count && reader.is_valid(); i++) {
+		ParameterRecord record = decode_parameter(reader, r_patch.sources);
+		PatchProgram::ParameterSlot slot;
+		slot.name = get_string(record.name);
+		slot.parameter = record.parameter;
+		r_patch.parameters.push_back(slot);
+	}
+
+	for (uint16_t i = 0; i < effect_count && reader.is_valid(); i++) {
+		PatchProgram::EffectSlot effect_slot;
+		effect_slot.prototype = decode_object(reader, strings, "SynthAudioEffect", 0);
+
+		uint16_t effect_param_count = reader.u16();
+		reader.skip(2);
+		for (uint16_t j = 0; j < effect_param_count && reader.is_valid(); j++) {
+			ParameterRecord record = decode_parameter(reader, r_patch.sources);
+			PatchProgram::ParameterSlot slot;
+			slot.name = get_string(record.name);
+			slot.parameter = record.parameter;
+			effect_slot.parameters.push_back(slot);
+		}
+
+		// Unknown effect classes are skipped, the rest of the chain still loads
+		if (effect_slot.prototype.is_valid()) {
+			r_patch.effects.push_back(effect_slot);
+		}
+	}
+
+	return reader.is_valid();
+}
+
+Ref<SynthConfiguration> SynthPresetBank::create_configuration(int p_index) const {
+	DecodedPatch patch;
+	if (!decode_patch(p_index, patch)) {
+		return Ref<SynthConfiguration>();
+	}
+
+	Ref<SynthConfiguration> config = patch.configuration;
+	for (const PatchProgram::ParameterSlot &slot : patch.parameters) {
+		config->set_parameter(slot.name, slot.parameter);
+	}
+
+	Ref<EffectChain> chain;
+	chain.instantiate();
+	for (const PatchProgram::EffectSlot &effect_slot : patch.effects) {
+		for (const PatchProgram::ParameterSlot &slot : effect_slot.parameters) {
+			effect_slot.prototype->set_parameter(slot.name, slot.parameter);
+		}
+		chain->add_effect(effect_slot.prototype);
+	}
+	config->set_effect_chain(chain);
+
+	return config;
+}
+
+std::shared_ptr<const PatchProgram> SynthPresetBank::compile_patch(int p_index) const {
+	std::lock_guard<std::mutex> lock(compile_mutex);
+	if (p_index < 0 || p_index >= patches.size()) {
+		return nullptr;
+	}
+
+	if (compiled_patches[p_index]) {
+		return compiled_patches[p_index];
+	}
+
+	// The decoded objects belong to the program alone, so they become its slots
+	// directly instead of being built into a configuration for compile() to copy
+	DecodedPatch patch;
+	if (!decode_patch(p_index, patch)) {
+		return nullptr;
+	}
+
+	compiled_patches[p_index] = PatchProgram::assemble(patch.configuration->instantiate_engine(), patch.parameters, patch.effects, patch.sources, patch.configuration->get_quality_profile());
+	return compiled_patches[p_index];
+}
+
+} // namespace godot
@@ -0,0 +1,113 @@
+#pragma once
+#include "patch_program.h"
+#include "synth_configuration.h"
+#include "synth_preset.h"
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/vector.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace godot {
+
+// A bank of patches in a compact, versioned binary format.
+// The whole bank is read with a single file read and validated with one checksum pass.
+// Loading creates no Godot objects: patches stay encoded until create_configuration()
+// or compile_patch() decodes the one that is asked for. compile_patch() decodes straight
+// into the program's slots without building a configuration first. Banks are built by adding
+// configurations or presets and saved with save().
+//
+// File layout (little endian):
+//   header        magic "GSPB", version, counts, section offsets, total size, checksum
+//   patch table   per patch: name string, record offset, record size
+//   string table  per string: offset, length, followed by the UTF-8 bytes
+//   records       per patch: engine kind and oscillator settings, configuration properties,
+//                 modulation sources, parameters and effects, with names and classes as
+//                 string indices
+// Objects are stored through their property lists: numbers, booleans and strings by value,
+// embedded resources inline and resources saved to their own file by path.
+class SynthPresetBank : public Resource {
+	GDCLASS(SynthPresetBank, Resource);
+
+public:
+	static constexpr uint32_t FORMAT_VERSION = 2;
+
+	enum EngineKind {
+		ENGINE_VA,
+		ENGINE_CHORD,
+	};
+
+private:
+	struct PatchEntry {
+		uint32_t name = 0;
+		uint32_t offset = 0; // Into records
+		uint32_t size = 0;
+	};
+
+	std::vector<uint8_t> records;
+	Vector<PatchEntry> patches;
+	Vector<String> strings;
+	HashMap<String, uint32_t> string_ids;
+
+	// One record decoded into fresh objects that nothing else holds yet
+	struct DecodedPatch {
+		// Engine settings and scalar properties, without parameters or effects
+		Ref<SynthConfiguration> configuration;
+		Vector<Ref<ModulationSource>> sources;
+		Vector<PatchProgram::ParameterSlot> parameters;
+		// Effect prototypes keep their parameters in the slots beside them
+		Vector<PatchProgram::EffectSlot> effects;
+	};
+
+	// Decoded programs, filled on first use of each patch. Players compile from the
+	// thread that rebuilds their voices, so the cache is filled under a lock.
+	mutable std::vector<std::shared_ptr<const PatchProgram>> compiled_patches;
+	mutable std::mutex compile_mutex;
+
+	uint32_t intern(const String &p_string);
+	String get_string(uint32_t p_index) const;
+
+	bool decode_patch(int p_index, DecodedPatch &r_patch) const;
+
+	void encode_object(std::vector<uint8_t> &p_out, const Object *p_object, const Dictionary &p_skip, int p_depth = 0);
+	void encode_parameter(std::vector<uint8_t> &p_out, const String &p_name, const Ref<ModulatedParameter> &p_param, int p_source);
+
+protected:
+	static void _bind_methods();
+
+public:
+	SynthPresetBank();
+	~SynthPresetBank();
+
+	// Loading
+	Error load(const String &p_path);
+	Error load_from_bytes(const PackedByteArray &p_bytes);
+
+	// Saving
+	Error save(const String &p_path) const;
+	PackedByteArray to_bytes() const;
+
+	void clear();
+
+	// Export into the bank
+	Error add_configuration(const String &p_name, const Ref<SynthConfiguration> &p_configuration);
+	Error add_preset(const String &p_name, const Ref<SynthPreset> &p_preset);
+
+	// Patch lookup
+	int get_patch_count() const;
+	String get_patch_name(int p_index) const;
+	int find_patch(const String &p_name) const;
+
+	// Import from the bank
+	Ref<SynthConfiguration> create_configuration(int p_index) const;
+
+	// Compiled program for a patch, shared by every caller asking for the same patch
+	std::shared_ptr<const PatchProgram> compile_patch(int p_index) const;
+};
+
+} // namespace godot
+
+VARIANT_ENUM_CAST(SynthPresetBank::EngineKind);
@@ -0,0 +1,172 @@
+#include "synth_quality_governor.h"
+#include "synth_voice_manager.h"
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+namespace godot {
+
+SynthQualityGovernor *SynthQualityGovernor::singleton = nullptr;
+
+void SynthQualityGovernor::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_tier"), &SynthQualityGovernor::get_tier);
+	ClassDB::bind_method(D_METHOD("get_dsp_load"), &SynthQualityGovernor::get_dsp_load);
+	ClassDB::bind_method(D_METHOD("force_tier", "tier"), &SynthQualityGovernor::force_tier);
+	ClassDB::bind_method(D_METHOD("get_forced_tier"), &SynthQualityGovernor::get_forced_tier);
+
+	ClassDB::bind_method(D_METHOD("set_enabled", "enabled"), &SynthQualityGovernor::set_enabled);
+	ClassDB::bind_method(D_METHOD("is_enabled"), &SynthQualityGovernor::is_enabled);
+	ClassDB::bind_method(D_METHOD("set_downgrade_threshold", "threshold"), &SynthQualityGovernor::set_downgrade_threshold);
+	ClassDB::bind_method(D_METHOD("get_downgrade_threshold"), &SynthQualityGovernor::get_downgrade_threshold);
+	ClassDB::bind_method(D_METHOD("set_upgrade_threshold", "threshold"), &SynthQualityGovernor::set_upgrade_threshold);
+	ClassDB::bind_method(D_METHOD("get_upgrade_threshold"), &SynthQualityGovernor::get_upgrade_threshold);
+	ClassDB::bind_method(D_METHOD("set_recovery_windows", "windows"), &SynthQualityGovernor::set_recovery_windows);
+	ClassDB::bind_method(D_METHOD("get_recovery_windows"), &SynthQualityGovernor::get_recovery_windows);
+	ClassDB::bind_method(D_METHOD("set_window_msec", "msec"), &SynthQualityGovernor::set_window_msec);
+	ClassDB::bind_method(D_METHOD("get_window_msec"), &SynthQualityGovernor::get_window_msec);
+	ClassDB::bind_method(D_METHOD("_notify_tier_changed", "tier"), &SynthQualityGovernor::_notify_tier_changed);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "enabled"), "set_enabled", "is_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "downgrade_threshold", PROPERTY_HINT_RANGE, "0.1,1.0,0.01"), "set_downgrade_threshold", "get_downgrade_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "upgrade_threshold", PROPERTY_HINT_RANGE, "0.0,1.0,0.01"), "set_upgrade_threshold", "get_upgrade_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "recovery_windows", PROPERTY_HINT_RANGE, "1,100,1"), "set_recovery_windows", "get_recovery_windows");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "window_msec", PROPERTY_HINT_RANGE, "10,1000,1"), "set_window_msec", "get_window_msec");
+
+	ADD_SIGNAL(MethodInfo("tier_changed", PropertyInfo(Variant::INT, "tier")));
+}
+
+SynthQualityGovernor::SynthQualityGovernor() {
+	singleton = this;
+}
+
+SynthQualityGovernor::~SynthQualityGovernor() {
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+SynthQualityGovernor *SynthQualityGovernor::get_singleton() {
+	return singleton;
+}
+
+void SynthQualityGovernor::report_block(uint64_t p_render_usec) {
+	uint64_t now = Time::get_singleton()->get_ticks_usec();
+	if (window_start_usec == 0) {
+		window_start_usec = now;
+	}
+	window_render_usec += p_render_usec;
+
+	uint64_t elapsed = now - window_start_usec;
+	if (elapsed < static_cast<uint64_t>(window_msec) * 1000) {
+		return;
+	}
+
+	float load = static_cast<float>(window_render_usec) / static_cast<float>(elapsed);
+	dsp_load.store(load);
+	window_start_usec = now;
+	window_render_usec = 0;
+
+	if (!enabled || forced_tier.load() >= 0) {
+		calm_windows = 0;
+		return;
+	}
+
+	int current = tier.load();
+	if (load > downgrade_threshold) {
+		calm_windows = 0;
+		if (current < SynthQualityProfile::TIER_MAX - 1) {
+			set_tier_from_audio_thread(current + 1);
+		}
+	} else if (load < upgrade_threshold) {
+		calm_windows++;
+		if (calm_windows >= recovery_windows && current > SynthQualityProfile::TIER_HIGH) {
+			calm_windows = 0;
+			set_tier_from_audio_thread(current - 1);
+		}
+	} else {
+		calm_windows = 0;
+	}
+}
+
+void SynthQualityGovernor::set_tier_from_audio_thread(int p_tier) {
+	tier.store(p_tier);
+
+	// Signals and voice stealing belong on the main thread
+	call_deferred("_notify_tier_changed", p_tier);
+}
+
+void SynthQualityGovernor::_notify_tier_changed(int p_tier) {
+	SynthVoiceManager *manager = SynthVoiceManager::get_singleton();
+	if (manager != nullptr) {
+		manager->apply_quality_tier(p_tier);
+	}
+	emit_signal("tier_changed", p_tier);
+}
+
+SynthQualityProfile::QualityTier SynthQualityGovernor::get_tier() const {
+	return static_cast<SynthQualityProfile::QualityTier>(tier.load());
+}
+
+float SynthQualityGovernor::get_dsp_load() const {
+	return dsp_load.load();
+}
+
+void SynthQualityGovernor::force_tier(int p_tier) {
+	if (p_tier < 0) {
+		forced_tier.store(-1);
+		return;
+	}
+
+	p_tier = MIN(p_tier, SynthQualityProfile::TIER_MAX - 1);
+	forced_tier.store(p_tier);
+	if (tier.load() != p_tier) {
+		tier.store(p_tier);
+		_notify_tier_changed(p_tier);
+	}
+}
+
+int SynthQualityGovernor::get_forced_tier() const {
+	return forced_tier.load();
+}
+
+void SynthQualityGovernor::set_enabled(bool p_enabled) {
+	enabled = p_enabled;
+}
+
+bool SynthQualityGovernor::is_enabled() const {
+	return enabled;
+}
+
+void SynthQualityGovernor::set_downgrade_threshold(float p_threshold) {
+	downgrade_threshold = p_threshold;
+}
+
+float SynthQualityGovernor::get_downgrade_threshold() const {
+	return downgrade_threshold;
+}
+
+void SynthQualityGovernor::set_upgrade_threshold(float p_threshold) {
+	// Recovering above the downgrade point would flip straight back
+	upgrade_threshold = MIN(p_threshold, downgrade_threshold);
+}
+
+float SynthQualityGovernor::get_upgrade_threshold() const {
+	return upgrade_threshold;
+}
+
+void SynthQualityGovernor::set_recovery_windows(int p_windows) {
+	recovery_windows = MAX(p_windows, 1);
+}
+
+int SynthQualityGovernor::get_recovery_windows() const {
+	return recovery_windows;
+}
+
+void SynthQualityGovernor::set_window_msec(int p_msec) {
+	window_msec = CLAMP(p_msec, 10, 1000);
+}
+
+int SynthQualityGovernor::get_window_msec() const {
+	return window_msec;
+}
+
+} // namespace godot
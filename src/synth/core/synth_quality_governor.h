@@ -0,0 +1,77 @@
+#pragma once
+#include "synth_quality_profile.h"
+#include <godot_cpp/classes/object.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace godot {
+
+// Protects the audio deadline by trading quality for CPU.
+// Every synth playback reports how long it took to render each block. Over a short
+// window the governor turns that into a DSP load: render time divided by the wall time
+// that passed. When the load crosses downgrade_threshold the quality tier steps down
+// one level; it only steps back up after the load has stayed below upgrade_threshold
+// for recovery_windows windows in a row, so the tier doesn't flap around a threshold.
+// What each tier means is decided per configuration by its SynthQualityProfile.
+class SynthQualityGovernor : public Object {
+	GDCLASS(SynthQualityGovernor, Object);
+
+private:
+	static SynthQualityGovernor *singleton;
+
+	bool enabled = true;
+	float downgrade_threshold = 0.75f;
+	float upgrade_threshold = 0.45f;
+	int recovery_windows = 10;
+	int window_msec = 100;
+
+	// Written from the audio thread
+	std::atomic<int> tier{ SynthQualityProfile::TIER_HIGH };
+	std::atomic<float> dsp_load{ 0.0f };
+	std::atomic<int> forced_tier{ -1 };
+
+	// Audio thread only
+	uint64_t window_start_usec = 0;
+	uint64_t window_render_usec = 0;
+	int calm_windows = 0;
+
+	void set_tier_from_audio_thread(int p_tier);
+	void _notify_tier_changed(int p_tier);
+
+protected:
+	static void _bind_methods();
+
+public:
+	SynthQualityGovernor();
+	~SynthQualityGovernor();
+
+	static SynthQualityGovernor *get_singleton();
+
+	// Called by playbacks after rendering a block
+	void report_block(uint64_t p_render_usec);
+
+	// Current tier, safe to read from any thread
+	SynthQualityProfile::QualityTier get_tier() const;
+	float get_dsp_load() const;
+
+	// Pin the tier, or pass -1 to let the governor decide again
+	void force_tier(int p_tier);
+	int get_forced_tier() const;
+
+	void set_enabled(bool p_enabled);
+	bool is_enabled() const;
+
+	void set_downgrade_threshold(float p_threshold);
+	float get_downgrade_threshold() const;
+
+	void set_upgrade_threshold(float p_threshold);
+	float get_upgrade_threshold() const;
+
+	void set_recovery_windows(int p_windows);
+	int get_recovery_windows() const;
+
+	void set_window_msec(int p_msec);
+	int get_window_msec() const;
+};
+
+} // namespace godot
@@ -0,0 +1,124 @@
+#include "synth_quality_profile.h"
+#include <godot_cpp/core/class_db.hpp>
+
+namespace godot {
+
+namespace {
+
+SynthQualityProfile::Settings make_settings(int p_oversampling, int p_divisor, int p_polyphony, int p_steal, bool p_cheap_reverb) {
+	SynthQualityProfile::Settings settings;
+	settings.max_oversampling = p_oversampling;
+	settings.control_rate_divisor = p_divisor;
+	settings.polyphony_limit = p_polyphony;
+	settings.steal_priority_below = p_steal;
+	settings.cheap_reverb = p_cheap_reverb;
+	return settings;
+}
+
+// Each tier roughly halves the cost of the one above
+const SynthQualityProfile::Settings default_tiers[SynthQualityProfile::TIER_MAX] = {
+	make_settings(8, 1, 0, 0, false),
+	make_settings(2, 2, 0, 0, false),
+	make_settings(1, 4, 8, 64, true),
+	make_settings(1, 8, 4, 128, true),
+};
+
+int clamp_tier(int p_tier) {
+	return CLAMP(p_tier, 0, SynthQualityProfile::TIER_MAX - 1);
+}
+
+} // namespace
+
+void SynthQualityProfile::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_max_oversampling", "tier", "value"), &SynthQualityProfile::set_max_oversampling);
+	ClassDB::bind_method(D_METHOD("get_max_oversampling", "tier"), &SynthQualityProfile::get_max_oversampling);
+	ClassDB::bind_method(D_METHOD("set_control_rate_divisor", "tier", "value"), &SynthQualityProfile::set_control_rate_divisor);
+	ClassDB::bind_method(D_METHOD("get_control_rate_divisor", "tier"), &SynthQualityProfile::get_control_rate_divisor);
+	ClassDB::bind_method(D_METHOD("set_polyphony_limit", "tier", "value"), &SynthQualityProfile::set_polyphony_limit);
+	ClassDB::bind_method(D_METHOD("get_polyphony_limit", "tier"), &SynthQualityProfile::get_polyphony_limit);
+	ClassDB::bind_method(D_METHOD("set_steal_priority_below", "tier", "value"), &SynthQualityProfile::set_steal_priority_below);
+	ClassDB::bind_method(D_METHOD("get_steal_priority_below", "tier"), &SynthQualityProfile::get_steal_priority_below);
+	ClassDB::bind_method(D_METHOD("set_cheap_reverb", "tier", "value"), &SynthQualityProfile::set_cheap_reverb);
+	ClassDB::bind_method(D_METHOD("get_cheap_reverb", "tier"), &SynthQualityProfile::get_cheap_reverb);
+
+	// One property per tier and setting, grouped by tier in the inspector
+	const char *tier_names[TIER_MAX] = { "high", "medium", "low", "minimum" };
+	for (int i = 0; i < TIER_MAX; i++) {
+		String prefix = String(tier_names[i]) + "/";
+		ADD_PROPERTYI(PropertyInfo(Variant::INT, prefix + "max_oversampling", PROPERTY_HINT_RANGE, "1,8,1"), "set_max_oversampling", "get_max_oversampling", i);
+		ADD_PROPERTYI(PropertyInfo(Variant::INT, prefix + "control_rate_divisor", PROPERTY_HINT_RANGE, "1,32,1"), "set_control_rate_divisor", "get_control_rate_divisor", i);
+		ADD_PROPERTYI(PropertyInfo(Variant::INT, prefix + "polyphony_limit", PROPERTY_HINT_RANGE, "0,32,1"), "set_polyphony_limit", "get_polyphony_limit", i);
+		ADD_PROPERTYI(PropertyInfo(Variant::INT, prefix + "steal_priority_below", PROPERTY_HINT_RANGE, "0,256,1"), "set_steal_priority_below", "get_steal_priority_below", i);
+		ADD_PROPERTYI(PropertyInfo(Variant::BOOL, prefix + "cheap_reverb"), "set_cheap_reverb", "get_cheap_reverb", i);
+	}
+
+	BIND_ENUM_CONSTANT(TIER_HIGH);
+	BIND_ENUM_CONSTANT(TIER_MEDIUM);
+	BIND_ENUM_CONSTANT(TIER_LOW);
+	BIND_ENUM_CONSTANT(TIER_MINIMUM);
+	BIND_ENUM_CONSTANT(TIER_MAX);
+}
+
+SynthQualityProfile::SynthQualityProfile() {
+	for (int i = 0; i < TIER_MAX; i++) {
+		tiers[i] = default_tiers[i];
+	}
+}
+
+SynthQualityProfile::~SynthQualityProfile() {
+}
+
+const SynthQualityProfile::Settings &SynthQualityProfile::get_settings(int p_tier) const {
+	return tiers[clamp_tier(p_tier)];
+}
+
+const SynthQualityProfile::Settings &SynthQualityProfile::get_default_settings(int p_tier) {
+	return default_tiers[clamp_tier(p_tier)];
+}
+
+void SynthQualityProfile::set_max_oversampling(int p_tier, int p_value) {
+	tiers[clamp_tier(p_tier)].max_oversampling = CLAMP(p_value, 1, 8);
+	emit_changed();
+}
+
+int SynthQualityProfile::get_max_oversampling(int p_tier) const {
+	return tiers[clamp_tier(p_tier)].max_oversampling;
+}
+
+void SynthQualityProfile::set_control_rate_divisor(int p_tier, int p_value) {
+	tiers[clamp_tier(p_tier)].control_rate_divisor = CLAMP(p_value, 1, 32);
+	emit_changed();
+}
+
+int SynthQualityProfile::get_control_rate_divisor(int p_tier) const {
+	return tiers[clamp_tier(p_tier)].control_rate_divisor;
+}
+
+void SynthQualityProfile::set_polyphony_limit(int p_tier, int p_value) {
+	tiers[clamp_tier(p_tier)].polyphony_limit = CLAMP(p_value, 0, 32);
+	emit_changed();
+}
+
+int SynthQualityProfile::get_polyphony_limit(int p_tier) const {
+	return tiers[clamp_tier(p_tier)].polyphony_limit;
+}
+
+void SynthQualityProfile::set_steal_priority_below(int p_tier, int p_value) {
+	tiers[clamp_tier(p_tier)].steal_priority_below = CLAMP(p_value, 0, 256);
+	emit_changed();
+}
+
+int SynthQualityProfile::get_steal_priority_below(int p_tier) const {
+	return tiers[clamp_tier(p_tier)].steal_priority_below;
+}
+
+void SynthQualityProfile::set_cheap_reverb(int p_tier, bool p_value) {
+	tiers[clamp_tier(p_tier)].cheap_reverb = p_value;
+	emit_changed();
+}
+
+bool SynthQualityProfile::get_cheap_reverb(int p_tier) const {
+	return tiers[clamp_tier(p_tier)].cheap_reverb;
+}
+
+} // namespace godot
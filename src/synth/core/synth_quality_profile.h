@@ -0,0 +1,65 @@
+#pragma once
+#include <godot_cpp/classes/resource.hpp>
+
+namespace godot {
+
+// What each quality tier costs for one configuration.
+// The SynthQualityGovernor picks the tier from the measured DSP load, the profile of each
+// configuration decides what that tier means for its voices: filter oversampling, reverb
+// mode, how many samples share one modulation update, a polyphony cap and the priority
+// below which managed voices are stolen.
+class SynthQualityProfile : public Resource {
+	GDCLASS(SynthQualityProfile, Resource);
+
+public:
+	enum QualityTier {
+		TIER_HIGH,
+		TIER_MEDIUM,
+		TIER_LOW,
+		TIER_MINIMUM,
+		TIER_MAX
+	};
+
+	// Settings of one tier, as applied to engines and effects
+	struct Settings {
+		int max_oversampling = 8;
+		int control_rate_divisor = 1;
+		int polyphony_limit = 0; // 0 keeps the player's polyphony
+		int steal_priority_below = 0;
+		bool cheap_reverb = false;
+	};
+
+private:
+	Settings tiers[TIER_MAX];
+
+protected:
+	static void _bind_methods();
+
+public:
+	SynthQualityProfile();
+	~SynthQualityProfile();
+
+	const Settings &get_settings(int p_tier) const;
+
+	// Profile used by configurations that don't set their own
+	static const Settings &get_default_settings(int p_tier);
+
+	void set_max_oversampling(int p_tier, int p_value);
+	int get_max_oversampling(int p_tier) const;
+
+	void set_control_rate_divisor(int p_tier, int p_value);
+	int get_control_rate_divisor(int p_tier) const;
+
+	void set_polyphony_limit(int p_tier, int p_value);
+	int get_polyphony_limit(int p_tier) const;
+
+	void set_steal_priority_below(int p_tier, int p_value);
+	int get_steal_priority_below(int p_tier) const;
+
+	void set_cheap_reverb(int p_tier, bool p_value);
+	bool get_cheap_reverb(int p_tier) const;
+};
+
+} // namespace godot
+
+VARIANT_ENUM_CAST(SynthQualityProfile::QualityTier);
@@ -71,9 +71,53 @@ bool SynthVoice::has_active_tail() const {
 	return false;
 }
 
+bool SynthVoice::claim() {
+	bool expected = false;
+	return claimed.compare_exchange_strong(expected, true, std::memory_order_acquire);
+}
+
+void SynthVoice::unclaim() {
+	claimed.store(false, std::memory_order_release);
+}
+
+bool SynthVoice::is_claimed() const {
+	return claimed.load(std::memory_order_acquire);
+}
+
+void SynthVoice::take_context(Ref<SynthNoteContext> &r_context) {
+	if (r_context == context) {
+		return;
+	}
+
+	// The previous context stays referenced through r_context, so nothing is freed here
+	Ref<SynthNoteContext> previous = context;
+	context = r_context;
+	r_context = previous;
+	active = true;
+}
+
+bool SynthVoice::begin_render() {
+	if (!active || !engine.is_valid() || !context.is_valid()) {
+		return false;
+	}
+
+	// Check for active tails and update context
+	context->set_has_active_tail(engine->has_active_tail(context));
+	context->set_control_rate_divisor(engine->get_control_rate_divisor());
+	context->begin_block();
+	return true;
+}
+
+void SynthVoice::end_render() {
+	// Check if we should deactivate the voice
+	if (context.is_valid() && context->is_note_finished()) {
+		active = false;
+	}
+}
+
 PackedFloat32Array SynthVoice::process_block(int buffer_size, double p_time) {
 	PackedFloat32Array output_buffer;
-	if (!active || !engine.is_valid() || !context.is_valid()) {
+	if (!begin_render()) {
 		// Return empty buffer if voice is not active
 		output_buffer.resize(buffer_size);
 		for (int i = 0; i < buffer_size; i++) {
@@ -82,22 +126,25 @@ PackedFloat32Array SynthVoice::process_block(int buffer_size, double p_time) {
 		return output_buffer;
 	}
 
-	// Check for active tails and update context
-	bool has_tail = false;
-	if (engine.is_valid()) {
-		has_tail = engine->has_active_tail(context);
-	}
-	context->set_has_active_tail(has_tail);
-
 	// Process audio through the engine and get the output buffer
 	output_buffer = engine->process_block(buffer_size, context);
+	end_render();
+
+	return output_buffer;
+}
+
+void SynthVoice::advance_virtual(int buffer_size) {
+	if (!active || !engine.is_valid() || !context.is_valid()) {
+		return;
+	}
+
+	context->set_has_active_tail(engine->has_active_tail(context));
+	context->begin_block();
+	engine->advance_virtual(buffer_size, context);
 
-	// Check if we should deactivate the voice
 	if (context->is_note_finished()) {
 		active = false;
 	}
-
-	return output_buffer;
 }
 
 } // namespace godot
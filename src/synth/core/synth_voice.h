@@ -2,6 +2,7 @@
 #include "synth_note_context.h" // Include the full definition instead of forward declaration
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
+#include <atomic>
 
 namespace godot {
 
@@ -15,6 +16,10 @@ private:
 	Ref<AudioStreamGeneratorEngine> engine;
 	Ref<SynthNoteContext> context;
 
+	// Set from the moment the voice is handed out for a note until the playback drops it
+	// from its map. Only the playback holding it touches a claimed voice.
+	std::atomic<bool> claimed{ false };
+
 protected:
 	static void _bind_methods();
 
@@ -30,6 +35,16 @@ public:
 	// Check if the voice has an active delay tail
 	bool has_active_tail() const;
 
+	// Take the voice for a new note, false while a playback still holds it
+	bool claim();
+	// Hand the voice back to the pool, once it left the playback holding it
+	void unclaim();
+	bool is_claimed() const;
+
+	// Play the next note in r_context, which gets the previous context back. For the
+	// playback restarting a voice that was stolen while it rendered.
+	void take_context(Ref<SynthNoteContext> &r_context);
+
 	Ref<SynthNoteContext> get_context() {
 		// Create a fresh context if needed
 		if (context.is_null()) {
@@ -60,6 +75,14 @@ public:
 	}
 
 	PackedFloat32Array process_block(int buffer_size, double p_time);
+
+	// The steps around the engine in process_block, for renderers that drive the engine
+	// themselves. begin_render returns false when the voice renders nothing this block.
+	bool begin_render();
+	void end_render();
+
+	// Keep an inaudible voice's note moving without rendering it
+	void advance_virtual(int buffer_size);
 };
 
 } // namespace godot
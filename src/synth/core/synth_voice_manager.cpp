@@ -0,0 +1,329 @@
+#include "synth_voice_manager.h"
+#include "audio_stream_generator_engine.h"
+#include "synth_quality_governor.h"
+#include <godot_cpp/classes/audio_server.hpp>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/window.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+namespace godot {
+
+SynthVoiceManager *SynthVoiceManager::singleton = nullptr;
+
+void SynthVoiceManager::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_max_voices", "max_voices"), &SynthVoiceManager::set_max_voices);
+	ClassDB::bind_method(D_METHOD("get_max_voices"), &SynthVoiceManager::get_max_voices);
+	ClassDB::bind_method(D_METHOD("set_category_limit", "category", "limit"), &SynthVoiceManager::set_category_limit);
+	ClassDB::bind_method(D_METHOD("get_category_limit", "category"), &SynthVoiceManager::get_category_limit);
+	ClassDB::bind_method(D_METHOD("set_output_bus", "bus"), &SynthVoiceManager::set_output_bus);
+	ClassDB::bind_method(D_METHOD("get_output_bus"), &SynthVoiceManager::get_output_bus);
+	ClassDB::bind_method(D_METHOD("set_max_note_lifetime", "seconds"), &SynthVoiceManager::set_max_note_lifetime);
+	ClassDB::bind_method(D_METHOD("get_max_note_lifetime"), &SynthVoiceManager::get_max_note_lifetime);
+
+	ClassDB::bind_method(D_METHOD("stop_all_voices"), &SynthVoiceManager::stop_all_voices);
+	ClassDB::bind_method(D_METHOD("get_active_voice_count"), &SynthVoiceManager::get_active_voice_count);
+	ClassDB::bind_method(D_METHOD("get_category_voice_count", "category"), &SynthVoiceManager::get_category_voice_count);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_voices", PROPERTY_HINT_RANGE, "1,256,1"), "set_max_voices", "get_max_voices");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "output_bus"), "set_output_bus", "get_output_bus");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_note_lifetime", PROPERTY_HINT_RANGE, "0,600,0.1,or_greater,suffix:s"), "set_max_note_lifetime", "get_max_note_lifetime");
+
+	BIND_ENUM_CONSTANT(CATEGORY_UI);
+	BIND_ENUM_CONSTANT(CATEGORY_SFX);
+	BIND_ENUM_CONSTANT(CATEGORY_MUSIC);
+	BIND_ENUM_CONSTANT(CATEGORY_AMBIENCE);
+	BIND_ENUM_CONSTANT(CATEGORY_MAX);
+}
+
+SynthVoiceManager::SynthVoiceManager() {
+	singleton = this;
+
+	stream.instantiate();
+	stream->set_mix_rate(AudioServer::get_singleton()->get_mix_rate());
+}
+
+SynthVoiceManager::~SynthVoiceManager() {
+	// The host player belongs to the scene tree and is freed with it
+	voices.clear();
+	playback.unref();
+	stream.unref();
+
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
+
+SynthVoiceManager *SynthVoiceManager::get_singleton() {
+	return singleton;
+}
+
+void SynthVoiceManager::ensure_host() {
+	if (host_id != 0) {
+		if (Object::cast_to<AudioStreamPlayer>(ObjectDB::get_instance(host_id)) != nullptr) {
+			return;
+		}
+
+		// The host was freed with the tree, its playback and voices went with it
+		host_id = 0;
+		playback.unref();
+		voices.clear();
+	}
+
+	SceneTree *tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+	if (tree == nullptr || tree->get_root() == nullptr) {
+		return;
+	}
+
+	AudioStreamPlayer *host = memnew(AudioStreamPlayer);
+	host->set_name("SynthVoiceManager");
+	host->set_stream(stream);
+	host->set_bus(output_bus);
+	host->set_autoplay(true);
+	host_id = host->get_instance_id();
+
+	// Players usually ask for voices while the root is still adding their scene
+	tree->get_root()->call_deferred("add_child", host);
+}
+
+AudioStreamPlayer *SynthVoiceManager::get_host() const {
+	if (host_id == 0) {
+		return nullptr;
+	}
+	return Object::cast_to<AudioStreamPlayer>(ObjectDB::get_instance(host_id));
+}
+
+Ref<SynthAudioStreamPlayback> SynthVoiceManager::get_playback() {
+	ensure_host();
+
+	AudioStreamPlayer *host = get_host();
+	if (host == nullptr || !host->is_inside_tree()) {
+		return Ref<SynthAudioStreamPlayback>();
+	}
+
+	if (!host->is_playing()) {
+		host->play();
+		playback.unref();
+		voices.clear();
+	}
+
+	if (!playback.is_valid()) {
+		Ref<AudioStreamPlayback> stream_playback = host->get_stream_playback();
+		if (stream_playback.is_valid()) {
+			playback = static_cast<Ref<SynthAudioStreamPlayback>>(stream_playback.ptr());
+			if (playback.is_valid()) {
+				// The manager enforces its own limits, the playback must not evict on its own
+				playback->set_max_polyphony(max_voices);
+				playback->set_max_note_lifetime(max_note_lifetime);
+			}
+		}
+	}
+
+	return playback;
+}
+
+void SynthVoiceManager::prune_finished_voices() {
+	if (!playback.is_valid()) {
+		voices.clear();
+		return;
+	}
+
+	// The playback reports voices once they and their tails have finished, or their kill
+	// fade has ended
+	int64_t finished_id = 0;
+	while (playback->pop_finished_voice(finished_id)) {
+		for (int i = 0; i < voices.size(); i++) {
+			if (voices[i].id == finished_id) {
+				voices.remove_at(i);
+				break;
+			}
+		}
+	}
+}
+
+int SynthVoiceManager::count_category(VoiceCategory p_category) const {
+	int count = 0;
+	for (int i = 0; i < voices.size(); i++) {
+		if (voices[i].category == p_category) {
+			count++;
+		}
+	}
+	return count;
+}
+
+int SynthVoiceManager::find_victim(int p_category, int p_priority) const {
+	int victim = -1;
+	int victim_priority = 0;
+	bool victim_released = false;
+
+	// Lowest priority first, released notes before held ones, then the oldest
+	for (int i = 0; i < voices.size(); i++) {
+		const VoiceRecord &record = voices[i];
+		if (p_category >= 0 && record.category != p_category) {
+			continue;
+		}
+		if (record.priority > p_priority) {
+			continue;
+		}
+
+		bool released = !record.voice->is_active();
+		if (victim == -1 || record.priority < victim_priority ||
+				(record.priority == victim_priority && released && !victim_released)) {
+			victim = i;
+			victim_priority = record.priority;
+			victim_released = released;
+		}
+	}
+
+	return victim;
+}
+
+void SynthVoiceManager::stop_voice_at(int p_index) {
+	// The voice fades out and is freed on the audio thread, a hard stop would click
+	if (playback.is_valid()) {
+		playback->kill_voice_by_id(voices[p_index].id);
+	}
+	voices.remove_at(p_index);
+}
+
+int64_t SynthVoiceManager::start_voice(const Ref<SynthVoice> &p_voice, const Ref<SynthNoteContext> &p_context, VoiceCategory p_category, int p_priority, uint64_t p_owner) {
+	if (!p_voice.is_valid() || p_category < 0 || p_category >= CATEGORY_MAX) {
+		return -1;
+	}
+
+	Ref<SynthAudioStreamPlayback> target = get_playback();
+	if (!target.is_valid()) {
+		return -1;
+	}
+
+	prune_finished_voices();
+
+	// Under load, voices the profile considers unimportant aren't started at all
+	SynthQualityGovernor *governor = SynthQualityGovernor::get_singleton();
+	Ref<AudioStreamGeneratorEngine> engine = p_voice->get_engine();
+	if (governor != nullptr && engine.is_valid() && p_priority < engine->get_quality_settings(governor->get_tier()).steal_priority_below) {
+		return -1;
+	}
+
+	// A player reusing one of its voices restarts it, the old note is gone. The playback
+	// replaces its entry when it adds the voice again.
+	int64_t restarted_id = -1;
+	for (int i = 0; i < voices.size(); i++) {
+		if (voices[i].voice == p_voice) {
+			restarted_id = voices[i].id;
+			voices.remove_at(i);
+			break;
+		}
+	}
+
+	// Make room, first within the category and then within the total budget
+	bool admitted = true;
+	while (admitted && count_category(p_category) >= category_limits[p_category]) {
+		int victim = find_victim(p_category, p_priority);
+		if (victim < 0) {
+			admitted = false;
+		} else {
+			stop_voice_at(victim);
+		}
+	}
+	while (admitted && voices.size() >= max_voices) {
+		int victim = find_victim(-1, p_priority);
+		if (victim < 0) {
+			admitted = false;
+		} else {
+			stop_voice_at(victim);
+		}
+	}
+
+	VoiceRecord record;
+	record.id = next_voice_id++;
+	record.voice = p_voice;
+	record.category = p_category;
+	record.priority = p_priority;
+	if (!admitted || !target->add_voice(record.id, p_voice, p_context, p_owner)) {
+		// A restarted voice that can't start again isn't tracked anymore, it fades out
+		if (restarted_id >= 0) {
+			target->kill_voice_by_id(restarted_id);
+		}
+		return -1;
+	}
+	voices.push_back(record);
+	return record.id;
+}
+
+void SynthVoiceManager::stop_all_voices() {
+	while (voices.size() > 0) {
+		stop_voice_at(voices.size() - 1);
+	}
+}
+
+void SynthVoiceManager::apply_quality_tier(int p_tier) {
+	prune_finished_voices();
+	for (int i = voices.size() - 1; i >= 0; i--) {
+		Ref<AudioStreamGeneratorEngine> engine = voices[i].voice->get_engine();
+		if (engine.is_valid() && voices[i].priority < engine->get_quality_settings(p_tier).steal_priority_below) {
+			stop_voice_at(i);
+		}
+	}
+}
+
+void SynthVoiceManager::set_max_voices(int p_max_voices) {
+	max_voices = Math::clamp(p_max_voices, 1, 256);
+	if (playback.is_valid()) {
+		playback->set_max_polyphony(max_voices);
+	}
+}
+
+int SynthVoiceManager::get_max_voices() const {
+	return max_voices;
+}
+
+void SynthVoiceManager::set_category_limit(VoiceCategory p_category, int p_limit) {
+	if (p_category < 0 || p_category >= CATEGORY_MAX) {
+		return;
+	}
+	// A limit of 0 mutes the category
+	category_limits[p_category] = MAX(p_limit, 0);
+}
+
+int SynthVoiceManager::get_category_limit(VoiceCategory p_category) const {
+	if (p_category < 0 || p_category >= CATEGORY_MAX) {
+		return 0;
+	}
+	return category_limits[p_category];
+}
+
+void SynthVoiceManager::set_output_bus(const String &p_bus) {
+	output_bus = p_bus;
+	AudioStreamPlayer *host = get_host();
+	if (host != nullptr) {
+		host->set_bus(output_bus);
+	}
+}
+
+String SynthVoiceManager::get_output_bus() const {
+	return output_bus;
+}
+
+void SynthVoiceManager::set_max_note_lifetime(float p_seconds) {
+	max_note_lifetime = MAX(p_seconds, 0.0f);
+	if (playback.is_valid()) {
+		playback->set_max_note_lifetime(max_note_lifetime);
+	}
+}
+
+float SynthVoiceManager::get_max_note_lifetime() const {
+	return max_note_lifetime;
+}
+
+int SynthVoiceManager::get_active_voice_count() {
+	prune_finished_voices();
+	return voices.size();
+}
+
+int SynthVoiceManager::get_category_voice_count(VoiceCategory p_category) {
+	prune_finished_voices();
+	return count_category(p_category);
+}
+
+} // namespace godot
@@ -0,0 +1,102 @@
+#pragma once
+#include "synth_audio_stream.h"
+#include "synth_audio_stream_playback.h"
+#include "synth_voice.h"
+#include <godot_cpp/classes/audio_stream_player.hpp>
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/templates/vector.hpp>
+
+namespace godot {
+
+// Global voice budget shared by every AudioSynthPlayer that opts in.
+// All managed voices render through one stream and one playback, hosted by a single
+// AudioStreamPlayer the manager adds to the scene tree, so the AudioServer mixes one
+// synth stream no matter how many emitters exist. Voices are admitted against a total
+// limit and a per-category limit; when a limit is reached the lowest priority voice is
+// stolen, oldest first, as long as it is not more important than the new one.
+class SynthVoiceManager : public Object {
+	GDCLASS(SynthVoiceManager, Object);
+
+public:
+	enum VoiceCategory {
+		CATEGORY_UI,
+		CATEGORY_SFX,
+		CATEGORY_MUSIC,
+		CATEGORY_AMBIENCE,
+		CATEGORY_MAX
+	};
+
+private:
+	static SynthVoiceManager *singleton;
+
+	struct VoiceRecord {
+		int64_t id = 0;
+		Ref<SynthVoice> voice;
+		VoiceCategory category = CATEGORY_SFX;
+		int priority = 0;
+	};
+
+	int max_voices = 32;
+	int category_limits[CATEGORY_MAX] = { 4, 16, 16, 8 };
+	String output_bus = "Master";
+	float max_note_lifetime = 0.0f;
+
+	Ref<SynthAudioStream> stream;
+	// The host player lives in the scene tree, which may free it first
+	uint64_t host_id = 0;
+	Ref<SynthAudioStreamPlayback> playback;
+
+	// Admitted voices, oldest first
+	Vector<VoiceRecord> voices;
+	int64_t next_voice_id = 1;
+
+	void ensure_host();
+	AudioStreamPlayer *get_host() const;
+	void prune_finished_voices();
+	int count_category(VoiceCategory p_category) const;
+	int find_victim(int p_category, int p_priority) const;
+	void stop_voice_at(int p_index);
+
+protected:
+	static void _bind_methods();
+
+public:
+	SynthVoiceManager();
+	~SynthVoiceManager();
+
+	static SynthVoiceManager *get_singleton();
+
+	// Limits
+	void set_max_voices(int p_max_voices);
+	int get_max_voices() const;
+
+	void set_category_limit(VoiceCategory p_category, int p_limit);
+	int get_category_limit(VoiceCategory p_category) const;
+
+	void set_output_bus(const String &p_bus);
+	String get_output_bus() const;
+
+	// Managed notes still sounding after this many seconds are killed, 0 for no limit
+	void set_max_note_lifetime(float p_seconds);
+	float get_max_note_lifetime() const;
+
+	// Shared playback, null until the host player is in the tree and playing
+	Ref<SynthAudioStreamPlayback> get_playback();
+
+	// Admit a voice whose note plays in p_context, stealing a less important one if a limit
+	// is reached. p_owner tags it in the playback, so a player can release all of its
+	// voices. Returns the voice id, or -1 when the voice was rejected.
+	int64_t start_voice(const Ref<SynthVoice> &p_voice, const Ref<SynthNoteContext> &p_context, VoiceCategory p_category, int p_priority, uint64_t p_owner = 0);
+
+	void stop_all_voices();
+
+	// Steal voices whose priority is below what their profile keeps at this tier
+	void apply_quality_tier(int p_tier);
+
+	int get_active_voice_count();
+	int get_category_voice_count(VoiceCategory p_category);
+};
+
+} // namespace godot
+
+VARIANT_ENUM_CAST(SynthVoiceManager::VoiceCategory);
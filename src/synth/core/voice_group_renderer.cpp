@@ -0,0 +1,78 @@
+#include "voice_group_renderer.h"
+#include "../effects/effect_chain.h"
+#include "audio_stream_generator_engine.h"
+#include <godot_cpp/core/math.hpp>
+
+namespace godot {
+
+void VoiceGroupRenderer::render(const Ref<SynthVoice> *p_voices, int p_count, int p_frames, float *r_mix) {
+	for (int first = 0; first < p_count; first += EffectLanes::MAX_LANES) {
+		render_lanes(p_voices + first, MIN(EffectLanes::MAX_LANES, p_count - first), p_frames, r_mix);
+	}
+}
+
+void VoiceGroupRenderer::render_lanes(const Ref<SynthVoice> *p_voices, int p_count, int p_frames, float *r_mix) {
+	const int block_size = EffectChain::BLOCK_SIZE;
+	static_assert(EffectChain::BLOCK_SIZE <= EffectLanes::MAX_SAMPLES, "Lanes must hold an effect block");
+
+	SynthVoice *voices[EffectLanes::MAX_LANES];
+	AudioStreamGeneratorEngine *engines[EffectLanes::MAX_LANES];
+	Ref<SynthNoteContext> contexts[EffectLanes::MAX_LANES];
+	double start_times[EffectLanes::MAX_LANES];
+	double time_increments[EffectLanes::MAX_LANES];
+	int voice_count = 0;
+	for (int i = 0; i < p_count; i++) {
+		SynthVoice *voice = p_voices[i].ptr();
+		if (voice == nullptr || !voice->begin_render()) {
+			continue;
+		}
+		Ref<AudioStreamGeneratorEngine> engine = voice->get_engine();
+		voices[voice_count] = voice;
+		engines[voice_count] = engine.ptr();
+		contexts[voice_count] = voice->get_current_context();
+		start_times[voice_count] = contexts[voice_count]->get_absolute_time();
+		time_increments[voice_count] = 1.0 / engine->get_sample_rate();
+		voice_count++;
+	}
+	if (voice_count == 0) {
+		return;
+	}
+
+	buffers.resize(EffectLanes::MAX_LANES * block_size);
+	EffectChain *chains[EffectLanes::MAX_LANES];
+	EffectLanes lanes;
+	for (int offset = 0; offset < p_frames; offset += block_size) {
+		int count = MIN(block_size, p_frames - offset);
+
+		// Oscillators first, then every effect stage across the voices that sound
+		lanes.lane_count = 0;
+		lanes.sample_count = count;
+		for (int v = 0; v < voice_count; v++) {
+			float *output = buffers.data() + v * block_size;
+			bool sounding = engines[v]->render_block(output, count, start_times[v] + offset * time_increments[v], contexts[v]);
+			Ref<EffectChain> chain = engines[v]->get_effect_chain();
+			if (sounding && chain.is_valid()) {
+				int lane = lanes.lane_count++;
+				chains[lane] = chain.ptr();
+				lanes.buffers[lane] = output;
+				lanes.contexts[lane] = contexts[v];
+			}
+		}
+		if (lanes.lane_count > 0) {
+			EffectChain::process_lanes(chains, lanes);
+		}
+
+		for (int v = 0; v < voice_count; v++) {
+			const float *output = buffers.data() + v * block_size;
+			for (int n = 0; n < count; n++) {
+				r_mix[offset + n] += output[n];
+			}
+		}
+	}
+
+	for (int v = 0; v < voice_count; v++) {
+		voices[v]->end_render();
+	}
+}
+
+} // namespace godot
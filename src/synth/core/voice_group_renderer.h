@@ -0,0 +1,25 @@
+#pragma once
+#include "../effects/effect_lanes.h"
+#include "synth_voice.h"
+#include <vector>
+
+namespace godot {
+
+// Renders voices built from the same PatchProgram side by side.
+// Every voice renders its oscillators for one effect block, then each stage of the
+// effect chains runs across up to EffectLanes::MAX_LANES voices at once through
+// SynthAudioEffect::process_lanes, so a recursive filter steps all voices in one vector
+// operation. Each voice keeps its own effect state and parameters, and sounds the same
+// as when it renders alone.
+class VoiceGroupRenderer {
+private:
+	std::vector<float> buffers;
+
+	void render_lanes(const Ref<SynthVoice> *p_voices, int p_count, int p_frames, float *r_mix);
+
+public:
+	// Render p_frames of p_count voices sharing one program and add them to r_mix
+	void render(const Ref<SynthVoice> *p_voices, int p_count, int p_frames, float *r_mix);
+};
+
+} // namespace godot
@@ -0,0 +1,263 @@
+#include "voice_instancer.h"
+#include "audio_stream_generator_engine.h"
+#include "engine_factory.h"
+#include "patch_program.h"
+#include <cmath>
+
+namespace godot {
+
+VoiceInstancer::VoiceInstancer() {
+	// The audio thread never grows the list
+	instances.reserve(MAX_INSTANCES);
+}
+
+void VoiceInstancer::set_sample_rate(float p_sample_rate, int p_fade_frames) {
+	sample_rate = p_sample_rate;
+	fade_frames = MAX(p_fade_frames, 1);
+}
+
+bool VoiceInstancer::push(Instance &p_trigger) {
+	uint32_t write = trigger_write.load(std::memory_order_relaxed);
+	if (write - trigger_read.load(std::memory_order_acquire) >= TRIGGER_CAPACITY) {
+		return false;
+	}
+	triggers[write % TRIGGER_CAPACITY] = std::move(p_trigger);
+	trigger_write.store(write + 1, std::memory_order_release);
+	return true;
+}
+
+bool VoiceInstancer::trigger(const std::shared_ptr<const PatchProgram> &p_program, int p_note, float p_velocity, float p_gain, float p_pitch_offset, float p_hold, float p_length) {
+	if (!p_program || !p_program->is_deterministic()) {
+		return false;
+	}
+	collect();
+
+	int hold_frames = MAX(static_cast<int>(p_hold * sample_rate), 1);
+	int capacity = MAX(static_cast<int>(p_length * sample_rate), 1);
+
+	std::shared_ptr<Recording> recording;
+	for (const std::shared_ptr<Recording> &candidate : recordings) {
+		if (candidate->program == p_program && candidate->note == p_note && candidate->velocity == p_velocity &&
+				candidate->hold_frames == hold_frames && candidate->capacity == capacity) {
+			recording = candidate;
+			break;
+		}
+	}
+
+	if (!recording) {
+		Ref<AudioStreamGeneratorEngine> engine = EngineFactory::create_engine_from_program(*p_program, sample_rate);
+		if (!engine.is_valid()) {
+			return false;
+		}
+		engine->allocate_state();
+
+		recording = std::make_shared<Recording>();
+		recording->program = p_program;
+		recording->note = p_note;
+		recording->velocity = p_velocity;
+		recording->hold_frames = hold_frames;
+		recording->capacity = capacity;
+		recording->history.resize(capacity);
+		recording->voice.instantiate();
+		recording->voice->set_engine(engine);
+		recording->voice->get_context()->note_on(p_note, p_velocity);
+
+		// Make room by dropping the recording used longest ago
+		if (recordings.size() >= MAX_RECORDINGS) {
+			size_t oldest = 0;
+			for (size_t i = 1; i < recordings.size(); i++) {
+				if (recordings[i]->last_used < recordings[oldest]->last_used) {
+					oldest = i;
+				}
+			}
+			recordings.erase(recordings.begin() + oldest);
+		}
+		recordings.push_back(recording);
+	}
+	recording->last_used = ++use_counter;
+
+	Instance instance;
+	instance.recording = recording;
+	instance.rate = std::pow(2.0f, p_pitch_offset / 12.0f);
+	instance.gain = p_gain;
+	return push(instance);
+}
+
+void VoiceInstancer::stop_all() {
+	Instance stop;
+	push(stop);
+}
+
+void VoiceInstancer::clear_recordings(const std::shared_ptr<const PatchProgram> &p_program) {
+	collect();
+	if (!p_program) {
+		recordings.clear();
+		return;
+	}
+	for (size_t i = recordings.size(); i > 0; i--) {
+		if (recordings[i - 1]->program == p_program) {
+			recordings.erase(recordings.begin() + (i - 1));
+		}
+	}
+}
+
+void VoiceInstancer::collect() {
+	uint32_t read = retire_read.load(std::memory_order_relaxed);
+	uint32_t write = retire_write.load(std::memory_order_acquire);
+	for (; read != write; read++) {
+		retired[read % RETIRE_CAPACITY].reset();
+	}
+	retire_read.store(read, std::memory_order_release);
+}
+
+bool VoiceInstancer::retire(std::shared_ptr<Recording> &p_recording) {
+	uint32_t write = retire_write.load(std::memory_order_relaxed);
+	if (write - retire_read.load(std::memory_order_acquire) >= RETIRE_CAPACITY) {
+		return false;
+	}
+	retired[write % RETIRE_CAPACITY] = std::move(p_recording);
+	retire_write.store(write + 1, std::memory_order_release);
+	return true;
+}
+
+void VoiceInstancer::pull_triggers() {
+	uint32_t read = trigger_read.load(std::memory_order_relaxed);
+	uint32_t write = trigger_write.load(std::memory_order_acquire);
+	for (; read != write; read++) {
+		Instance &trigger = triggers[read % TRIGGER_CAPACITY];
+		if (!trigger.recording) {
+			for (Instance &instance : instances) {
+				if (instance.fade < 0) {
+					instance.fade = fade_frames;
+				}
+			}
+		} else if (instances.size() < MAX_INSTANCES) {
+			instances.push_back(std::move(trigger));
+		}
+		// A dropped trigger keeps its recording until the main thread reuses the slot
+	}
+	trigger_read.store(read, std::memory_order_release);
+}
+
+void VoiceInstancer::record(Recording &p_recording, int p_frames) {
+	int target = MIN(p_frames, p_recording.capacity);
+	int fade_start = p_recording.capacity - fade_frames;
+
+	while (!p_recording.complete && p_recording.length < target) {
+		// Blocks end at the hold time, so the release starts on its exact frame
+		int frames = target - p_recording.length;
+		if (p_recording.length < p_recording.hold_frames) {
+			frames = MIN(frames, p_recording.hold_frames - p_recording.length);
+		}
+
+		PackedFloat32Array block = p_recording.voice->process_block(frames, 0.0);
+		const float *samples = block.ptr();
+		int available = MIN(frames, static_cast<int>(block.size()));
+		float *history = p_recording.history.data() + p_recording.length;
+		for (int i = 0; i < frames; i++) {
+			float sample = i < available ? samples[i] : 0.0f;
+
+			// A note still ringing when the recording is full is cut with a short fade
+			int frame = p_recording.length + i;
+			if (frame >= fade_start) {
+				sample *= static_cast<float>(p_recording.capacity - frame) / fade_frames;
+			}
+			history[i] = sample;
+		}
+		p_recording.length += frames;
+
+		if (p_recording.length == p_recording.hold_frames) {
+			Ref<SynthNoteContext> context = p_recording.voice->get_current_context();
+			if (context.is_valid()) {
+				context->note_off(context->get_absolute_time());
+			}
+		}
+		if (!p_recording.voice->is_active() || p_recording.length >= p_recording.capacity) {
+			p_recording.complete = true;
+		}
+	}
+}
+
+bool VoiceInstancer::tap(Instance &p_instance, float *r_mix, int p_frames, bool p_mix) {
+	const Recording &recording = *p_instance.recording;
+	const float *history = recording.history.data();
+
+	// Unpitched instances read the recording as is
+	if (p_instance.rate == 1.0f && p_instance.fade < 0) {
+		int index = static_cast<int>(p_instance.position);
+		int count = MIN(p_frames, recording.length - index);
+		if (p_mix) {
+			for (int i = 0; i < count; i++) {
+				r_mix[i] += history[index + i] * p_instance.gain;
+			}
+		}
+		p_instance.position += count;
+		return count == p_frames;
+	}
+
+	// Linear interpolation between neighbours, the last frame has no neighbour to reach
+	int last = recording.length - 1;
+	double position = p_instance.position;
+	float step = 1.0f / fade_frames;
+	for (int i = 0; i < p_frames; i++) {
+		int index = static_cast<int>(position);
+		if (index >= last || p_instance.fade == 0) {
+			return false;
+		}
+
+		float gain = p_instance.gain;
+		if (p_instance.fade > 0) {
+			gain *= p_instance.fade * step;
+			p_instance.fade--;
+		}
+		if (p_mix) {
+			float fraction = static_cast<float>(position - index);
+			r_mix[i] += (history[index] + (history[index + 1] - history[index]) * fraction) * gain;
+		}
+		position += p_instance.rate;
+	}
+	p_instance.position = position;
+	return true;
+}
+
+void VoiceInstancer::render(float *r_mix, int p_frames, bool p_mix) {
+	pull_triggers();
+	if (instances.empty()) {
+		return;
+	}
+
+	// Each master renders as far as the instance reading furthest into it needs
+	for (Instance &instance : instances) {
+		instance.recording->required = 0;
+	}
+	for (Instance &instance : instances) {
+		int end = static_cast<int>(instance.position + static_cast<double>(instance.rate) * p_frames) + 2;
+		instance.recording->required = MAX(instance.recording->required, end);
+	}
+	for (Instance &instance : instances) {
+		record(*instance.recording, instance.recording->required);
+	}
+
+	// Finished instances are swapped out with the last one. An instance whose recording
+	// can't go back to the main thread yet stays, silent, until it can.
+	size_t i = 0;
+	while (i < instances.size()) {
+		if (tap(instances[i], r_mix, p_frames, p_mix)) {
+			i++;
+			continue;
+		}
+		if (!retire(instances[i].recording)) {
+			instances[i].fade = 0;
+			i++;
+			continue;
+		}
+		instances[i] = std::move(instances.back());
+		instances.pop_back();
+	}
+}
+
+bool VoiceInstancer::is_idle() const {
+	return instances.empty() && trigger_read.load(std::memory_order_relaxed) == trigger_write.load(std::memory_order_acquire);
+}
+
+} // namespace godot
@@ -0,0 +1,110 @@
+#pragma once
+#include "synth_voice.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace godot {
+
+class PatchProgram;
+
+// Plays many triggers of one note from a single render.
+// The first trigger of a deterministic patch at a given note and velocity records a
+// master voice into a history buffer. Every trigger, the first included, is a tap into
+// that history with its own start, gain and playback rate, so overlapping raindrops or
+// shots cost one voice render plus one interpolated read each. The master renders just
+// ahead of the tap reading furthest, and the finished recording is kept for later
+// triggers until its player swaps patches or newer recordings push it out.
+//
+// trigger(), stop_all(), clear_recordings() and collect() belong to the main thread,
+// render() to the audio thread. Recordings the audio thread is done with go back to the
+// main thread to be freed.
+class VoiceInstancer {
+public:
+	static constexpr int MAX_RECORDINGS = 32;
+	static constexpr int MAX_INSTANCES = 256;
+
+private:
+	struct Recording {
+		// Key. Holding the program keeps its address from being reused by another patch.
+		std::shared_ptr<const PatchProgram> program;
+		int note = 60;
+		float velocity = 1.0f;
+		int hold_frames = 0;
+		int capacity = 0;
+
+		// Written by the audio thread only
+		Ref<SynthVoice> voice;
+		std::vector<float> history; // Sized to capacity when the recording is made
+		int length = 0;
+		int required = 0;
+		bool complete = false;
+
+		uint64_t last_used = 0; // Main thread
+	};
+
+	struct Instance {
+		std::shared_ptr<Recording> recording;
+		double position = 0.0;
+		float rate = 1.0f;
+		float gain = 1.0f;
+		int fade = -1; // Frames left of a stop fade, -1 while playing
+	};
+
+	// A trigger without a recording stops the instances started before it
+	static constexpr uint32_t TRIGGER_CAPACITY = 512;
+	Instance triggers[TRIGGER_CAPACITY];
+	std::atomic<uint32_t> trigger_write{ 0 };
+	std::atomic<uint32_t> trigger_read{ 0 };
+
+	float sample_rate = 44100.0f;
+	int fade_frames = 220;
+
+	// Main thread
+	std::vector<std::shared_ptr<Recording>> recordings;
+	uint64_t use_counter = 0;
+
+	// Audio thread
+	std::vector<Instance> instances;
+
+	// Recordings of finished instances, on their way to the main thread
+	static constexpr uint32_t RETIRE_CAPACITY = 512;
+	std::shared_ptr<Recording> retired[RETIRE_CAPACITY];
+	std::atomic<uint32_t> retire_write{ 0 };
+	std::atomic<uint32_t> retire_read{ 0 };
+
+	bool push(Instance &p_trigger);
+	bool retire(std::shared_ptr<Recording> &p_recording);
+	void pull_triggers();
+	void record(Recording &p_recording, int p_frames);
+	bool tap(Instance &p_instance, float *r_mix, int p_frames, bool p_mix);
+
+public:
+	VoiceInstancer();
+
+	void set_sample_rate(float p_sample_rate, int p_fade_frames);
+
+	// Start an instance of p_note on p_program. The recorded note is held for p_hold
+	// seconds and cut at p_length, with a short fade, if it rings longer. A pitch offset
+	// in semitones reads the recording faster or slower. Returns false when the program
+	// isn't deterministic or too many triggers are waiting.
+	bool trigger(const std::shared_ptr<const PatchProgram> &p_program, int p_note, float p_velocity, float p_gain, float p_pitch_offset, float p_hold, float p_length);
+
+	// Fade out every instance started so far
+	void stop_all();
+
+	// Forget the kept recordings, of p_program only when it is set. Instances still
+	// playing keep theirs.
+	void clear_recordings(const std::shared_ptr<const PatchProgram> &p_program = nullptr);
+
+	// Free the recordings the audio thread let go of
+	void collect();
+
+	// Add p_frames of every instance to r_mix. With p_mix false the instances only move on.
+	void render(float *r_mix, int p_frames, bool p_mix);
+
+	// Nothing playing and nothing waiting, audio thread only
+	bool is_idle() const;
+};
+
+} // namespace godot
@@ -0,0 +1,59 @@
+#include "voice_state_arena.h"
+#include <cstring>
+#include <new>
+
+namespace godot {
+
+float *VoiceStateArena::Allocator::allocate(size_t p_count) {
+	size_t aligned = VoiceStateArena::align_size(p_count);
+	if (base == nullptr || aligned == 0 || used + aligned > capacity) {
+		return nullptr;
+	}
+
+	float *block = base + used;
+	used += aligned;
+	return block;
+}
+
+VoiceStateArena::~VoiceStateArena() {
+	release();
+}
+
+bool VoiceStateArena::allocate(size_t p_floats_per_voice, int p_voice_count) {
+	release();
+
+	if (p_floats_per_voice == 0 || p_voice_count <= 0) {
+		return false;
+	}
+
+	size_t stride = align_size(p_floats_per_voice);
+	size_t bytes = stride * p_voice_count * sizeof(float);
+	void *memory = ::operator new(bytes, std::align_val_t(CACHE_LINE_SIZE), std::nothrow);
+	if (memory == nullptr) {
+		return false;
+	}
+
+	std::memset(memory, 0, bytes);
+	slab = static_cast<float *>(memory);
+	voice_stride = stride;
+	voice_count = p_voice_count;
+	return true;
+}
+
+void VoiceStateArena::release() {
+	if (slab != nullptr) {
+		::operator delete(slab, std::align_val_t(CACHE_LINE_SIZE));
+	}
+	slab = nullptr;
+	voice_stride = 0;
+	voice_count = 0;
+}
+
+VoiceStateArena::Allocator VoiceStateArena::get_voice_allocator(int p_voice) const {
+	if (slab == nullptr || p_voice < 0 || p_voice >= voice_count) {
+		return Allocator();
+	}
+	return Allocator(slab + voice_stride * p_voice, voice_stride);
+}
+
+} // namespace godot
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+
+namespace godot {
+
+// Contiguous storage for the bulk DSP state of a voice pool.
+// Delay lines and reverb tanks are the largest per-voice state. Instead of each effect
+// allocating its own buffers, the player measures the state of one configured voice and
+// carves every voice's state from a single cache-line aligned slab, one fixed-size
+// region per voice, so rendering many voices walks memory that sits together.
+class VoiceStateArena {
+public:
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+	static constexpr size_t FLOATS_PER_CACHE_LINE = CACHE_LINE_SIZE / sizeof(float);
+
+	// Bump allocator over the region of a single voice
+	class Allocator {
+	private:
+		float *base = nullptr;
+		size_t capacity = 0;
+		size_t used = 0;
+
+	public:
+		Allocator() = default;
+		Allocator(float *p_base, size_t p_capacity) :
+				base(p_base), capacity(p_capacity) {}
+
+		// Take p_count floats from the region, rounded up to whole cache lines.
+		// Returns nullptr when the region is exhausted.
+		float *allocate(size_t p_count);
+
+		size_t get_used() const { return used; }
+		size_t get_capacity() const { return capacity; }
+	};
+
+	// Round a float count up to whole cache lines
+	static size_t align_size(size_t p_count) {
+		return (p_count + FLOATS_PER_CACHE_LINE - 1) / FLOATS_PER_CACHE_LINE * FLOATS_PER_CACHE_LINE;
+	}
+
+private:
+	float *slab = nullptr;
+	size_t voice_stride = 0;
+	int voice_count = 0;
+
+public:
+	VoiceStateArena() = default;
+	~VoiceStateArena();
+
+	VoiceStateArena(const VoiceStateArena &) = delete;
+	VoiceStateArena &operator=(const VoiceStateArena &) = delete;
+
+	// Allocate one zeroed slab holding p_voice_count regions of p_floats_per_voice floats
+	bool allocate(size_t p_floats_per_voice, int p_voice_count);
+	void release();
+
+	// Allocator over the region reserved for one voice
+	Allocator get_voice_allocator(int p_voice) const;
+
+	size_t get_voice_stride() const { return voice_stride; }
+	int get_voice_count() const { return voice_count; }
+	size_t get_size_bytes() const { return voice_stride * voice_count * sizeof(float); }
+};
+
+} // namespace godot
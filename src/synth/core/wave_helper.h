@@ -2,6 +2,7 @@
 #ifndef WAVE_HELPER_H
 #define WAVE_HELPER_H
 
+#include "dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -38,8 +39,8 @@ public:
 			case SINE: {
 				// Apply pulse width by stretching/compressing the sine wave
 				float adjusted_phase = phase < pulse_width ? (phase / pulse_width) * 0.5f : 0.5f + ((phase - pulse_width) / (1.0f - pulse_width)) * 0.5f;
-				return unipolar ? 0.5f * (1.0f + std::sin(2.0f * Math_PI * adjusted_phase))
-								: std::sin(2.0f * Math_PI * adjusted_phase);
+				return unipolar ? 0.5f * (1.0f + DspMath::sin_turns(adjusted_phase))
+								: DspMath::sin_turns(adjusted_phase);
 			}
 
 			case SQUARE:
@@ -62,15 +63,15 @@ public:
 			case LOG_SAW: {
 				// Adjust logarithmic saw based on pulse width
 				float log_phase = phase < pulse_width ? (phase / pulse_width) * 0.5f : 0.5f + ((phase - pulse_width) / (1.0f - pulse_width)) * 0.5f;
-				return unipolar ? std::log(1.0f + 9.0f * log_phase) / std::log(10.0f)
-								: 2.0f * (std::log(1.0f + 9.0f * log_phase) / std::log(10.0f)) - 1.0f;
+				float log_value = DspMath::log2(1.0f + 9.0f * log_phase) * (1.0f / 3.32192809f); // log10
+				return unipolar ? log_value : 2.0f * log_value - 1.0f;
 			}
 
 			case EXP_SAW: {
 				// Adjust exponential saw based on pulse width
 				float exp_phase = phase < pulse_width ? (phase / pulse_width) * 0.5f : 0.5f + ((phase - pulse_width) / (1.0f - pulse_width)) * 0.5f;
-				return unipolar ? std::exp(exp_phase) / std::exp(1.0f)
-								: 2.0f * (std::exp(exp_phase) / std::exp(1.0f)) - 1.0f;
+				float exp_value = DspMath::exp(exp_phase - 1.0f); // e^phase / e
+				return unipolar ? exp_value : 2.0f * exp_value - 1.0f;
 			}
 
 			case PULSE:
@@ -126,7 +127,7 @@ public:
 				// Sine fold - sine wave that folds back when exceeding threshold
 				// pulse_width controls folding threshold (lower = more folding)
 				float threshold = 0.1f + 0.8f * pulse_width; // Maps 0.01-0.99 to 0.108-0.892
-				float sine_val = std::sin(2.0f * Math_PI * phase);
+				float sine_val = DspMath::sin_turns(phase);
 
 				// Apply folding
 				while (std::abs(sine_val) > threshold) {
@@ -153,7 +154,7 @@ public:
 				for (int i = 1; i <= num_harmonics; i++) {
 					// Amplitude decreases for higher harmonics
 					float harmonic_amp = 1.0f / i;
-					result += harmonic_amp * std::sin(2.0f * Math_PI * phase * i);
+					result += harmonic_amp * DspMath::sin_turns(phase * i);
 					amp_sum += harmonic_amp;
 				}
 
@@ -1,9 +1,11 @@
 #include "wave_helper_cache.h"
+#include <algorithm>
 #include <cmath>
 
 namespace godot {
 
 WaveHelperCache *WaveHelperCache::singleton = nullptr;
+Ref<WaveHelperCache> WaveHelperCache::singleton_ref;
 
 void WaveHelperCache::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("initialize", "resolution", "pulse_width_step"), &WaveHelperCache::initialize, DEFVAL(4096), DEFVAL(0.01f));
@@ -13,7 +15,14 @@ void WaveHelperCache::_bind_methods() {
 
 WaveHelperCache::WaveHelperCache() :
 		resolution(4096), pulse_width_step(0.01f) {
-	singleton = this;
+	for (auto &type_tables : tables) {
+		for (std::atomic<const float *> &table : type_tables) {
+			table.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+	if (singleton == nullptr) {
+		singleton = this;
+	}
 }
 
 WaveHelperCache::~WaveHelperCache() {
@@ -23,42 +32,48 @@ WaveHelperCache::~WaveHelperCache() {
 }
 
 void WaveHelperCache::initialize(int p_resolution, float p_pulse_width_step) {
-	resolution = p_resolution;
-	pulse_width_step = p_pulse_width_step;
+	{
+		std::lock_guard<std::mutex> lock(build_mutex);
+		ERR_FAIL_COND_MSG(!storage.empty(), "WaveHelperCache can only be initialized while it holds no tables, call clear_cache() first.");
+		ERR_FAIL_COND(p_resolution < 2);
+		resolution = p_resolution;
+		pulse_width_step = std::max(p_pulse_width_step, 1.0f / MAX_PULSE_WIDTH_KEYS);
+	}
 
 	// Pre-generate common waveforms with default pulse width
-	generate_waveform(WaveHelper::SINE, 0.5f);
-	generate_waveform(WaveHelper::TRIANGLE, 0.5f);
-	generate_waveform(WaveHelper::SAW, 0.5f);
-	generate_waveform(WaveHelper::SQUARE, 0.5f);
+	get_table(WaveHelper::SINE, 0.5f);
+	get_table(WaveHelper::TRIANGLE, 0.5f);
+	get_table(WaveHelper::SAW, 0.5f);
+	get_table(WaveHelper::SQUARE, 0.5f);
 
 	// For square and pulse, generate a few common pulse widths
 	for (float pw = 0.1f; pw <= 0.9f; pw += 0.2f) {
-		generate_waveform(WaveHelper::SQUARE, pw);
-		generate_waveform(WaveHelper::PULSE, pw);
+		get_table(WaveHelper::SQUARE, pw);
+		get_table(WaveHelper::PULSE, pw);
 	}
 }
 
-void WaveHelperCache::generate_waveform(WaveHelper::WaveType type, float pulse_width) {
-	int pw_key = get_pulse_width_key(pulse_width);
-
-	// Check if this waveform is already cached
-	if (wave_cache.find(type) != wave_cache.end() &&
-			wave_cache[type].find(pw_key) != wave_cache[type].end()) {
-		return;
+const float *WaveHelperCache::generate_waveform(WaveHelper::WaveType type, int pw_key) {
+	// Another thread may have built it while this one waited for the lock
+	const float *existing = tables[type][pw_key].load(std::memory_order_acquire);
+	if (existing) {
+		return existing;
 	}
 
-	// Create a new vector for this waveform
-	std::vector<float> samples(resolution);
+	std::unique_ptr<float[]> samples(new float[resolution]);
 
 	// Generate the waveform
+	float pulse_width = pw_key * pulse_width_step;
 	for (int i = 0; i < resolution; i++) {
 		float phase = static_cast<float>(i) / resolution;
 		samples[i] = WaveHelper::get_wave_sample(phase, type, pulse_width);
 	}
 
-	// Store in cache
-	wave_cache[type][pw_key] = std::move(samples);
+	// Publish only once the samples are written
+	const float *table = samples.get();
+	storage.push_back(std::move(samples));
+	tables[type][pw_key].store(table, std::memory_order_release);
+	return table;
 }
 
 float WaveHelperCache::get_sample(float phase, WaveHelper::WaveType type, float pulse_width) {
@@ -67,36 +82,83 @@ float WaveHelperCache::get_sample(float phase, WaveHelper::WaveType type, float
 	if (phase < 0.0f)
 		phase += 1.0f;
 
-	int pw_key = get_pulse_width_key(pulse_width);
-
-	// Check if we need to generate this waveform
-	if (wave_cache.find(type) == wave_cache.end() ||
-			wave_cache[type].find(pw_key) == wave_cache[type].end()) {
-		generate_waveform(type, pulse_width);
+	const float *samples = find_table(type, pulse_width);
+	if (!samples) {
+		return WaveHelper::get_wave_sample(phase, type, pulse_width);
 	}
 
-	// Get the sample from the cache
-	const std::vector<float> &samples = wave_cache[type][pw_key];
-
-	// Convert phase to sample index
-	int index = static_cast<int>(phase * resolution);
+	// Interpolate between the two nearest samples, close to the computed waveform
+	float position = phase * resolution;
+	int index = static_cast<int>(position);
 	if (index >= resolution)
 		index = 0; // Safety check
+	int next = index + 1 < resolution ? index + 1 : 0;
+	float frac = position - static_cast<float>(index);
+
+	return samples[index] + (samples[next] - samples[index]) * frac;
+}
+
+const float *WaveHelperCache::find_table(WaveHelper::WaveType type, float pulse_width) const {
+	if (type < 0 || type >= WaveHelper::WAVE_TYPE_MAX) {
+		return nullptr;
+	}
+	return tables[type][get_pulse_width_key(pulse_width)].load(std::memory_order_acquire);
+}
+
+const float *WaveHelperCache::get_table(WaveHelper::WaveType type, float pulse_width) {
+	const float *table = find_table(type, pulse_width);
+	if (table || type < 0 || type >= WaveHelper::WAVE_TYPE_MAX) {
+		return table;
+	}
 
-	return samples[index];
+	std::lock_guard<std::mutex> lock(build_mutex);
+	return generate_waveform(type, get_pulse_width_key(pulse_width));
+}
+
+void WaveHelperCache::prepare_waveform(WaveHelper::WaveType type) {
+	ERR_FAIL_INDEX(type, WaveHelper::WAVE_TYPE_MAX);
+
+	std::lock_guard<std::mutex> lock(build_mutex);
+	int key_count = get_pulse_width_key_count();
+	for (int key = 0; key < key_count; key++) {
+		generate_waveform(type, key);
+	}
 }
 
 int WaveHelperCache::get_pulse_width_key(float pulse_width) const {
 	// Quantize pulse width to reduce cache size
-	return static_cast<int>(round(pulse_width / pulse_width_step));
+	float clamped = std::min(std::max(pulse_width, 0.0f), 1.0f);
+	return static_cast<int>(std::round(clamped / pulse_width_step));
+}
+
+int WaveHelperCache::get_pulse_width_key_count() const {
+	return get_pulse_width_key(1.0f) + 1;
 }
 
 void WaveHelperCache::clear_cache() {
-	wave_cache.clear();
+	std::lock_guard<std::mutex> lock(build_mutex);
+	for (auto &type_tables : tables) {
+		for (std::atomic<const float *> &table : type_tables) {
+			table.store(nullptr, std::memory_order_release);
+		}
+	}
+	storage.clear();
 }
 
 WaveHelperCache *WaveHelperCache::get_singleton() {
 	return singleton;
 }
 
+void WaveHelperCache::create_singleton() {
+	if (singleton_ref.is_valid()) {
+		return;
+	}
+	singleton_ref.instantiate();
+	singleton_ref->initialize();
+}
+
+void WaveHelperCache::free_singleton() {
+	singleton_ref.unref();
+}
+
 } // namespace godot
@@ -4,32 +4,47 @@
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <unordered_map>
 #include "../core/wave_helper.h"
 
 namespace godot {
 
+// One cycle tables of every waveform, keyed by quantized pulse width.
+// Tables are built at configuration time and never move or change until clear_cache().
+// Building takes a mutex and publishes the table with a release store; lookups from the
+// audio thread are a single acquire load and never build anything.
 class WaveHelperCache : public RefCounted {
     GDCLASS(WaveHelperCache, RefCounted);
 
 private:
     static WaveHelperCache *singleton;
-    
-    // Cache structure: waveform type -> pulse width -> samples
-    std::unordered_map<int, std::unordered_map<int, std::vector<float>>> wave_cache;
-    
+    static Ref<WaveHelperCache> singleton_ref;
+
+    // Most pulse width keys a waveform can have, limits how fine pulse_width_step can be
+    static constexpr int MAX_PULSE_WIDTH_KEYS = 1024;
+
+    // Published tables by waveform type and pulse width key, null until built
+    std::atomic<const float *> tables[WaveHelper::WAVE_TYPE_MAX][MAX_PULSE_WIDTH_KEYS + 1];
+
+    // Storage of every built table, and the lock held while building
+    std::vector<std::unique_ptr<float[]>> storage;
+    std::mutex build_mutex;
+
     // Resolution of the cached waveforms (number of samples per cycle)
     int resolution;
     
     // Quantization step for pulse width (to limit cache size)
     float pulse_width_step;
     
-    // Generate a waveform and store it in the cache
-    void generate_waveform(WaveHelper::WaveType type, float pulse_width);
+    // Generate a waveform and publish it, with build_mutex held
+    const float *generate_waveform(WaveHelper::WaveType type, int pw_key);
     
     // Get the quantized pulse width key
     int get_pulse_width_key(float pulse_width) const;
+    int get_pulse_width_key_count() const;
 
 protected:
     static void _bind_methods();
@@ -38,17 +53,36 @@ public:
     WaveHelperCache();
     ~WaveHelperCache();
     
-    // Initialize the cache with a specific resolution
+    // Set the resolution and pre-generate the common waveforms. The layout can only change
+    // while the cache holds no tables.
     void initialize(int p_resolution = 4096, float p_pulse_width_step = 0.01f);
     
-    // Get a sample from the cached waveform
+    // Get a linearly interpolated sample from the cached waveform, or computed directly if
+    // its table isn't built
     float get_sample(float phase, WaveHelper::WaveType type, float pulse_width);
     
-    // Clear the cache
+    // Whole cycle (get_resolution() samples) if its table is built, else null. Lock free,
+    // safe on the audio thread.
+    const float *find_table(WaveHelper::WaveType type, float pulse_width) const;
+
+    // Whole cycle, building the table if needed. Configuration time only.
+    const float *get_table(WaveHelper::WaveType type, float pulse_width);
+
+    // Build the tables of every pulse width of a waveform, for oscillators whose pulse
+    // width is modulated. Configuration time only.
+    void prepare_waveform(WaveHelper::WaveType type);
+
+    int get_resolution() const { return resolution; }
+
+    // Drop every table. Engines keep pointers into them, so only while nothing renders.
     void clear_cache();
     
     // Get the singleton instance
     static WaveHelperCache *get_singleton();
+
+    // Created with the extension's singletons, before any engine exists
+    static void create_singleton();
+    static void free_singleton();
 };
 
 } // namespace godot
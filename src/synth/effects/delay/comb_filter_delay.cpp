@@ -33,11 +33,8 @@ void CombFilterDelay::_bind_methods() {
 			"set_polarity_parameter", "get_polarity_parameter");
 }
 
-CombFilterDelay::CombFilterDelay() {
-	// Initialize with a default buffer size (1 second at 44.1kHz)
-	buffer_position = 0;
-	comb_buffer.resize(44100, 0.0f);
-
+CombFilterDelay::CombFilterDelay() :
+		DelayEffect(MAX_DELAY_TIME) {
 	// Create default parameters
 	Ref<ModulatedParameter> delay_time_param = memnew(ModulatedParameter);
 	delay_time_param->set_base_value(0.01f); // 10ms delay (good for comb filtering)
@@ -110,13 +107,7 @@ float CombFilterDelay::process_sample(float sample, const Ref<SynthNoteContext>
 		polarity = polarity_param->get_value(context);
 	}
 
-	// Calculate delay in samples (assuming 44.1kHz sample rate)
-	int delay_samples = static_cast<int>(delay_time * 44100.0f);
-	if (delay_samples < 1)
-		delay_samples = 1;
-	if (delay_samples >= comb_buffer.size()) {
-		delay_samples = comb_buffer.size() - 1;
-	}
+	float delay_samples = delay_line.clamp_delay(delay_time * sample_rate);
 
 	// Determine polarity sign (positive or negative comb filter)
 	float polarity_sign = (polarity >= 0.5f) ? -1.0f : 1.0f;
@@ -126,38 +117,35 @@ float CombFilterDelay::process_sample(float sample, const Ref<SynthNoteContext>
 
 	float input = sample;
 
-	// Calculate read position with wraparound
-	int read_pos = buffer_position - delay_samples;
-	if (read_pos < 0) {
-		read_pos += comb_buffer.size();
-	}
-
-	// Read delayed sample
-	float delayed_sample = comb_buffer[read_pos];
+	// Read delayed sample. Allpass interpolation keeps the comb's fractional
+	// tuning exact without the high frequency loss of linear interpolation.
+	float delayed_sample = delay_line.read_allpass(delay_samples);
 
 	// Calculate comb filtered output
 	// For positive comb: input + delayed_sample
 	// For negative comb: input - delayed_sample
 	float comb_output = input + polarity_sign * delayed_sample;
 
-	// Write to delay buffer with feedback
-	comb_buffer[buffer_position] = input + delayed_sample * effective_feedback;
-
-	// Increment and wrap buffer position
-	buffer_position = (buffer_position + 1) % comb_buffer.size();
+	// Write to delay line with feedback
+	delay_line.write(input + delayed_sample * effective_feedback);
 
 	// Mix dry and wet signals
 	return input * (1.0f - mix) + comb_output * mix;
 }
 
+void CombFilterDelay::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	// Sample by sample, the block path of DelayEffect is for the plain delay
+	SynthAudioEffect::process_block(p_buffer, p_count, context);
+}
+
 void CombFilterDelay::reset() {
 	// Clear comb buffer
-	std::fill(comb_buffer.begin(), comb_buffer.end(), 0.0f);
-	buffer_position = 0;
+	delay_line.clear();
 }
 
 Ref<SynthAudioEffect> CombFilterDelay::duplicate() const {
 	Ref<CombFilterDelay> new_filter = memnew(CombFilterDelay);
+	new_filter->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
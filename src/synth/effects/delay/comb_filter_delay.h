@@ -9,9 +9,8 @@ class CombFilterDelay : public DelayEffect {
 	GDCLASS(CombFilterDelay, DelayEffect)
 
 private:
-	// Delay buffer for comb filtering
-	std::vector<float> comb_buffer;
-	int buffer_position;
+	// The inherited delay_time property reaches 1 second
+	static constexpr float MAX_DELAY_TIME = 1.0f;
 
 public:
 	// Parameter names
@@ -29,6 +28,7 @@ public:
 	~CombFilterDelay();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
 
 	// Create a duplicate of this effect
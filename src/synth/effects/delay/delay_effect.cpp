@@ -1,4 +1,5 @@
 #include "delay_effect.h"
+#include "../effect_chain.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -47,10 +48,13 @@ void DelayEffect::_bind_methods() {
 			"set_mix_parameter", "get_mix_parameter");
 }
 
-DelayEffect::DelayEffect() {
-	// Initialize delay buffer (2 seconds at 44.1kHz)
-	delay_buffer.resize(88200, 0.0f);
-	buffer_position = 0;
+DelayEffect::DelayEffect() :
+		DelayEffect(MAX_DELAY_TIME) {
+}
+
+DelayEffect::DelayEffect(float p_max_delay_time) :
+		max_delay_time(p_max_delay_time) {
+	size_delay_line();
 
 	// Create default parameters
 	Ref<ModulatedParameter> delay_time_param = memnew(ModulatedParameter);
@@ -76,14 +80,11 @@ DelayEffect::~DelayEffect() {
 	// Clean up resources
 }
 
-float DelayEffect::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-	if (!context.is_valid())
-		return sample; // Return original sample if context is invalid
-
+void DelayEffect::read_settings(const Ref<SynthNoteContext> &context, float &r_delay_samples, float &r_feedback, float &r_mix) const {
 	// Get parameter values
 	float delay_time = 0.5f; // Default: 500ms
-	float feedback = 0.3f; // Default: 30%
-	float mix = 0.5f; // Default: 50% wet/dry
+	r_feedback = 0.3f; // Default: 30%
+	r_mix = 0.5f; // Default: 50% wet/dry
 
 	Ref<ModulatedParameter> delay_param = get_parameter(PARAM_DELAY_TIME);
 	if (delay_param.is_valid()) {
@@ -92,47 +93,80 @@ float DelayEffect::process_sample(float sample, const Ref<SynthNoteContext> &con
 
 	Ref<ModulatedParameter> fb_param = get_parameter(PARAM_FEEDBACK);
 	if (fb_param.is_valid()) {
-		feedback = fb_param->get_value(context);
+		r_feedback = fb_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> mix_param = get_parameter(PARAM_MIX);
 	if (mix_param.is_valid()) {
-		mix = mix_param->get_value(context);
+		r_mix = mix_param->get_value(context);
 	}
 
-	// Calculate delay in samples (assuming 44.1kHz sample rate)
-	int delay_samples = int(delay_time * 44100.0f);
-	if (delay_samples >= delay_buffer.size()) {
-		delay_samples = delay_buffer.size() - 1;
-	}
+	r_delay_samples = delay_line.clamp_delay(delay_time * sample_rate);
+}
 
-	// Calculate read position with wraparound
-	int read_pos = buffer_position - delay_samples;
-	if (read_pos < 0) {
-		read_pos += delay_buffer.size();
-	}
+float DelayEffect::process_sample(float sample, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid())
+		return sample; // Return original sample if context is invalid
 
-	// Read delayed sample
-	float delayed_sample = delay_buffer[read_pos];
+	float delay_samples;
+	float feedback;
+	float mix;
+	read_settings(context, delay_samples, feedback, mix);
 
-	// Write to delay buffer with feedback
-	delay_buffer[buffer_position] = sample + delayed_sample * feedback;
+	// Read delayed sample, interpolated so delay time modulation doesn't zipper
+	float delayed_sample = delay_line.read_linear(delay_samples);
 
-	// Increment and wrap buffer position
-	buffer_position = (buffer_position + 1) % delay_buffer.size();
+	// Write to delay line with feedback
+	delay_line.write(sample + delayed_sample * feedback);
 
 	// Mix dry and wet signals
 	return sample * (1.0f - mix) + delayed_sample * mix;
 }
 
+void DelayEffect::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid())
+		return;
+
+	float delay_samples;
+	float feedback;
+	float mix;
+	read_settings(context, delay_samples, feedback, mix);
+
+	// A delay of at least one block reads nothing the block writes, so the whole block
+	// can be read first and written back after, which vectorizes in time
+	if (p_count > EffectChain::BLOCK_SIZE || delay_samples < p_count ||
+			delay_samples + p_count + 1.0f > delay_line.get_capacity()) {
+		SynthAudioEffect::process_block(p_buffer, p_count, context);
+		return;
+	}
+
+	float delayed[EffectChain::BLOCK_SIZE];
+	float feedback_block[EffectChain::BLOCK_SIZE];
+	delay_line.read_block_linear(delayed, p_count, delay_samples, delay_samples);
+	for (int i = 0; i < p_count; i++) {
+		feedback_block[i] = p_buffer[i] + delayed[i] * feedback;
+		p_buffer[i] = p_buffer[i] * (1.0f - mix) + delayed[i] * mix;
+	}
+	delay_line.write_block(feedback_block, p_count);
+}
+
 void DelayEffect::reset() {
 	// Clear delay buffer
-	std::fill(delay_buffer.begin(), delay_buffer.end(), 0.0f);
-	buffer_position = 0;
+	delay_line.clear();
 
 	// Log that the delay effect has been reset
 }
 
+bool DelayEffect::get_constant_gain(float &r_gain) const {
+	// sample * (1 - mix) + delayed * mix, the feedback only reaches the wet side
+	r_gain = 1.0f;
+	return has_constant_value(PARAM_MIX, 0.0f);
+}
+
+bool DelayEffect::is_linear() const {
+	return true;
+}
+
 float DelayEffect::get_tail_length() const {
 	// Get the delay time parameter
 	float delay_time = 0.5f; // Default: 500ms
@@ -170,8 +204,21 @@ float DelayEffect::get_tail_length() const {
 	return delay_time * repeats;
 }
 
+void DelayEffect::size_delay_line() {
+	delay_line.resize(static_cast<int>(std::ceil(max_delay_time * sample_rate)));
+}
+
+void DelayEffect::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+		return;
+	}
+	sample_rate = p_sample_rate;
+	size_delay_line();
+}
+
 Ref<SynthAudioEffect> DelayEffect::duplicate() const {
 	Ref<DelayEffect> new_delay = memnew(DelayEffect);
+	new_delay->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
@@ -264,4 +311,12 @@ float DelayEffect::get_mix_base_value() const {
 	return 0.0f;
 }
 
+size_t DelayEffect::get_state_size() const {
+	return VoiceStateArena::align_size(delay_line.get_capacity());
+}
+
+void DelayEffect::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	delay_line.bind_storage(p_allocator.allocate(delay_line.get_capacity()));
+}
+
 } // namespace godot
@@ -4,7 +4,7 @@
 #include "../../core/modulated_parameter.h"
 #include "../../core/synth_note_context.h"
 #include "../synth_audio_effect.h"
-#include <vector>
+#include "delay_line.h"
 
 namespace godot {
 
@@ -12,9 +12,23 @@ class DelayEffect : public SynthAudioEffect {
 	GDCLASS(DelayEffect, SynthAudioEffect)
 
 private:
-	// Delay buffer
-	std::vector<float> delay_buffer;
-	int buffer_position = 0;
+	// Longest delay in seconds, 2 seconds unless a derived effect asks for another
+	static constexpr float MAX_DELAY_TIME = 2.0f;
+	float max_delay_time;
+
+protected:
+	// Delay line, shared with the derived delay effects
+	DelayLine<float> delay_line;
+	float sample_rate = 44100.0f;
+
+	// Derived effects pass the longest delay in seconds their line has to hold
+	explicit DelayEffect(float p_max_delay_time);
+
+	// Size the line for the longest delay at the current sample rate
+	void size_delay_line();
+
+	// Delay in samples, feedback and mix at the context's position
+	void read_settings(const Ref<SynthNoteContext> &context, float &r_delay_samples, float &r_feedback, float &r_mix) const;
 
 public:
 	// Parameter names
@@ -30,13 +44,19 @@ public:
 	virtual ~DelayEffect();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
+	bool is_linear() const override;
+	void set_sample_rate(float p_sample_rate) override;
 
 	// Returns the tail length based on delay time and feedback
 	float get_tail_length() const override;
 
 	// Create a duplicate of this effect
 	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
 
 	// Parameter accessors
 	void set_delay_time_parameter(const Ref<ModulatedParameter> &param);
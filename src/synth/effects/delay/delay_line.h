@@ -0,0 +1,258 @@
+#ifndef DELAY_LINE_H
+#define DELAY_LINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+// Shared ring buffer for delay based effects.
+// Capacity is rounded up to a power of two so wrapping is a single mask instead of a
+// modulo. Reads are relative to the write head: read(d) returns the sample written d
+// writes ago, so effects read first and then write the new input for the sample.
+// resize() only records the capacity. A line bound with bind_storage() lives in external
+// memory, such as a region of a VoiceStateArena. Lines never allocate while processing:
+// an unbound line drops its writes and reads silence.
+template <typename T = float>
+class DelayLine {
+public:
+	enum Interpolation {
+		INTERPOLATION_NONE,
+		INTERPOLATION_LINEAR,
+		INTERPOLATION_HERMITE,
+		INTERPOLATION_ALLPASS
+	};
+
+private:
+	std::vector<T> owned;
+	T *buffer = &silence;
+	uint32_t size = 0;
+	uint32_t mask = 0;
+	uint32_t write_index = 0;
+
+	// Allpass interpolator memory
+	T allpass_state = T(0);
+
+	// Lines without storage point here with a zero mask, so every read returns silence
+	static inline T silence = T(0);
+
+	// Extra samples kept past the maximum delay for the interpolation kernels
+	static constexpr int INTERPOLATION_MARGIN = 4;
+
+	static uint32_t next_power_of_two(uint32_t p_value) {
+		uint32_t size = 1;
+		while (size < p_value) {
+			size <<= 1;
+		}
+		return size;
+	}
+
+	T at(int p_delay) const {
+		return buffer[(write_index - static_cast<uint32_t>(p_delay)) & mask];
+	}
+
+	bool has_storage() const { return buffer != &silence; }
+
+public:
+	DelayLine() = default;
+	explicit DelayLine(int p_max_delay) { resize(p_max_delay); }
+
+	// Copies own their buffer, even when the source is bound to external storage.
+	// Copies of a line without storage have none either.
+	DelayLine(const DelayLine &p_other) { *this = p_other; }
+	DelayLine &operator=(const DelayLine &p_other) {
+		if (this != &p_other) {
+			if (p_other.has_storage()) {
+				owned.assign(p_other.buffer, p_other.buffer + p_other.size);
+				buffer = owned.data();
+			} else {
+				std::vector<T>().swap(owned);
+				buffer = &silence;
+			}
+			size = p_other.size;
+			mask = p_other.mask;
+			write_index = p_other.write_index;
+			allpass_state = p_other.allpass_state;
+		}
+		return *this;
+	}
+
+	// Number of samples of storage a line with p_max_delay samples of delay needs
+	static int get_storage_size(int p_max_delay) {
+		return static_cast<int>(next_power_of_two(static_cast<uint32_t>(std::max(p_max_delay, 1) + INTERPOLATION_MARGIN)));
+	}
+
+	// Set the capacity for at least p_max_delay samples of delay and clear the line.
+	// Storage is dropped, the line is silent until it is bound again.
+	void resize(int p_max_delay) {
+		size = static_cast<uint32_t>(get_storage_size(p_max_delay));
+		std::vector<T>().swap(owned);
+		buffer = &silence;
+		mask = 0;
+		write_index = 0;
+		allpass_state = T(0);
+	}
+
+	// Move the line into external storage of get_capacity() samples and clear it.
+	// The storage must outlive the line, or the line must be resized or rebound first.
+	void bind_storage(T *p_storage) {
+		if (p_storage == nullptr || size == 0) {
+			return;
+		}
+		buffer = p_storage;
+		mask = size - 1;
+		std::vector<T>().swap(owned);
+		clear();
+	}
+
+	bool is_bound() const { return has_storage() && owned.empty(); }
+
+	void clear() {
+		if (has_storage()) {
+			std::fill(buffer, buffer + size, T(0));
+		}
+		write_index = 0;
+		allpass_state = T(0);
+	}
+
+	int get_capacity() const { return static_cast<int>(size); }
+
+	// Longest delay that can be read with every interpolation mode
+	int get_max_delay() const { return std::max(static_cast<int>(size) - INTERPOLATION_MARGIN, 1); }
+
+	// Clamp a delay in samples to the range the line can serve
+	float clamp_delay(float p_delay) const {
+		return std::min(std::max(p_delay, 1.0f), static_cast<float>(get_max_delay()));
+	}
+
+	// Push one sample and advance the write head
+	void write(T p_sample) {
+		if (!has_storage()) {
+			return;
+		}
+		buffer[write_index] = p_sample;
+		write_index = (write_index + 1) & mask;
+	}
+
+	// Push a block of samples, copying in at most two contiguous runs
+	void write_block(const T *p_samples, int p_count) {
+		if (!has_storage()) {
+			return;
+		}
+		while (p_count > 0) {
+			int run = std::min(p_count, static_cast<int>(size - write_index));
+			std::copy(p_samples, p_samples + run, buffer + write_index);
+			write_index = (write_index + run) & mask;
+			p_samples += run;
+			p_count -= run;
+		}
+	}
+
+	// Integer delay read
+	T read(int p_delay) const {
+		return at(p_delay);
+	}
+
+	// Read p_count consecutive samples starting p_delay samples behind the write head,
+	// oldest first, as they were written
+	void read_block(T *p_output, int p_count, int p_delay) const {
+		if (!has_storage()) {
+			std::fill(p_output, p_output + p_count, T(0));
+			return;
+		}
+		uint32_t index = (write_index - static_cast<uint32_t>(p_delay)) & mask;
+		while (p_count > 0) {
+			int run = std::min(p_count, static_cast<int>(size - index));
+			std::copy(buffer + index, buffer + index + run, p_output);
+			index = (index + run) & mask;
+			p_output += run;
+			p_count -= run;
+		}
+	}
+
+	// Read p_count samples for a block that will be written after the read, with the
+	// delay gliding from p_start_delay at the first sample towards p_end_delay.
+	// Delays count from the write head as it will be when that sample is written, and
+	// must stay above p_count.
+	void read_block_linear(T *p_output, int p_count, float p_start_delay, float p_end_delay) const {
+		float step = (p_end_delay - p_start_delay) / static_cast<float>(p_count);
+		for (int i = 0; i < p_count; i++) {
+			p_output[i] = read_linear(p_start_delay + (step - 1.0f) * static_cast<float>(i));
+		}
+	}
+
+	// Fractional delay read with linear interpolation
+	T read_linear(float p_delay) const {
+		int whole = static_cast<int>(p_delay);
+		float frac = p_delay - whole;
+		T a = at(whole);
+		T b = at(whole + 1);
+		return a + (b - a) * frac;
+	}
+
+	// Fractional delay read with 4-point, 3rd-order Hermite interpolation.
+	// Flatter pass band than linear, useful for modulated delays (chorus, tape wow).
+	T read_hermite(float p_delay) const {
+		int whole = static_cast<int>(p_delay);
+		float frac = p_delay - whole;
+		T xm1 = at(std::max(whole - 1, 1));
+		T x0 = at(whole);
+		T x1 = at(whole + 1);
+		T x2 = at(whole + 2);
+
+		T c1 = (x1 - xm1) * 0.5f;
+		T c2 = xm1 - x0 * 2.5f + x1 * 2.0f - x2 * 0.5f;
+		T c3 = (x2 - xm1) * 0.5f + (x0 - x1) * 1.5f;
+		return ((c3 * frac + c2) * frac + c1) * frac + x0;
+	}
+
+	// Fractional delay read through a first-order allpass interpolator.
+	// Unity gain at all frequencies, which keeps feedback loops (combs, reverb
+	// tanks) from losing highs, but it carries state so call it once per sample.
+	T read_allpass(float p_delay) {
+		int whole = static_cast<int>(p_delay);
+		float frac = p_delay - whole;
+		// Keep the coefficient away from the pole at frac == 0
+		if (frac < 0.1f && whole > 1) {
+			whole -= 1;
+			frac += 1.0f;
+		}
+		float eta = (1.0f - frac) / (1.0f + frac);
+		allpass_state = at(whole + 1) + (at(whole) - allpass_state) * eta;
+		return allpass_state;
+	}
+
+	T read_interpolated(float p_delay, Interpolation p_mode) {
+		switch (p_mode) {
+			case INTERPOLATION_LINEAR:
+				return read_linear(p_delay);
+			case INTERPOLATION_HERMITE:
+				return read_hermite(p_delay);
+			case INTERPOLATION_ALLPASS:
+				return read_allpass(p_delay);
+			default:
+				return read(static_cast<int>(p_delay));
+		}
+	}
+
+	// Gather several taps at once with linear interpolation
+	void read_taps(const float *p_delays, T *p_output, int p_count) const {
+		for (int i = 0; i < p_count; i++) {
+			p_output[i] = read_linear(p_delays[i]);
+		}
+	}
+
+	// Gather several taps and sum them with per-tap gains
+	T read_taps_mixed(const float *p_delays, const float *p_gains, int p_count) const {
+		T sum = T(0);
+		for (int i = 0; i < p_count; i++) {
+			sum += read_linear(p_delays[i]) * p_gains[i];
+		}
+		return sum;
+	}
+};
+
+} // namespace godot
+
+#endif // DELAY_LINE_H
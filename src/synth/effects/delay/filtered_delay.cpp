@@ -1,4 +1,5 @@
 #include "filtered_delay.h"
+#include "../../core/dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -73,9 +74,7 @@ void FilteredDelay::_bind_methods() {
 }
 
 FilteredDelay::FilteredDelay() {
-	// Initialize delay buffer (2 seconds at 44.1kHz)
-	delay_buffer.resize(88200, 0.0f);
-	buffer_position = 0;
+	size_delay_line();
 
 	// Initialize filter states
 	lp_state = 0.0f;
@@ -165,36 +164,24 @@ float FilteredDelay::process_sample(float sample, const Ref<SynthNoteContext> &c
 		resonance = res_param->get_value(context);
 	}
 
-	// Calculate sample rate (assuming 44.1kHz)
-	const float sample_rate = 44100.0f;
-
 	// Calculate delay in samples
-	int delay_samples = static_cast<int>(delay_time * sample_rate);
-	if (delay_samples >= delay_buffer.size()) {
-		delay_samples = delay_buffer.size() - 1;
-	}
+	float delay_samples = delay_line.clamp_delay(delay_time * sample_rate);
 
 	// Map normalized parameter values to filter frequencies
 	float lp_cutoff = 500.0f + lp_freq * 11500.0f; // 500Hz to 12kHz
 	float hp_cutoff = 20.0f + hp_freq * 1980.0f; // 20Hz to 2kHz
 
 	// Calculate filter coefficients
-	float lp_coeff = std::exp(-2.0f * Math_PI * lp_cutoff / sample_rate);
-	float hp_coeff = std::exp(-2.0f * Math_PI * hp_cutoff / sample_rate);
+	float lp_coeff = DspMath::one_pole_coefficient(lp_cutoff, sample_rate);
+	float hp_coeff = DspMath::one_pole_coefficient(hp_cutoff, sample_rate);
 
 	// Resonance factor (1.0 to 4.0)
 	float res_factor = 1.0f + resonance * 3.0f;
 
 	float input = sample;
 
-	// Calculate read position with wraparound
-	int read_pos = buffer_position - delay_samples;
-	if (read_pos < 0) {
-		read_pos += delay_buffer.size();
-	}
-
 	// Read delayed sample
-	float delayed_sample = delay_buffer[read_pos];
+	float delayed_sample = delay_line.read_linear(delay_samples);
 
 	// Apply filters to the feedback path
 	// Low-pass filter
@@ -209,29 +196,31 @@ float FilteredDelay::process_sample(float sample, const Ref<SynthNoteContext> &c
 		// Simple resonance implementation - boost around cutoff
 		filtered_sample = filtered_sample * res_factor;
 		// Soft clip to prevent excessive resonance
-		filtered_sample = std::tanh(filtered_sample);
+		filtered_sample = DspMath::tanh(filtered_sample);
 	}
 
-	// Write to delay buffer with feedback
-	delay_buffer[buffer_position] = input + filtered_sample * feedback;
-
-	// Increment and wrap buffer position
-	buffer_position = (buffer_position + 1) % delay_buffer.size();
+	// Write to delay line with feedback
+	delay_line.write(input + filtered_sample * feedback);
 
 	// Mix dry and wet signals
 	return input * (1.0f - mix) + filtered_sample * mix;
 }
 
 void FilteredDelay::reset() {
-	// Clear delay buffer
-	std::fill(delay_buffer.begin(), delay_buffer.end(), 0.0f);
-	buffer_position = 0;
+	// Clear delay line
+	delay_line.clear();
 
 	// Reset filter states
 	lp_state = 0.0f;
 	hp_state = 0.0f;
 }
 
+bool FilteredDelay::get_constant_gain(float &r_gain) const {
+	// The filter and saturation sit on the wet path only
+	r_gain = 1.0f;
+	return has_constant_value(PARAM_MIX, 0.0f);
+}
+
 float FilteredDelay::get_tail_length() const {
 	// Get the delay time and feedback parameters
 	float delay_time = 0.5f; // Default: 500ms
@@ -262,8 +251,21 @@ float FilteredDelay::get_tail_length() const {
 	return delay_time * repeats;
 }
 
+void FilteredDelay::size_delay_line() {
+	delay_line.resize(static_cast<int>(std::ceil(MAX_DELAY_TIME * sample_rate)));
+}
+
+void FilteredDelay::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+		return;
+	}
+	sample_rate = p_sample_rate;
+	size_delay_line();
+}
+
 Ref<SynthAudioEffect> FilteredDelay::duplicate() const {
 	Ref<FilteredDelay> new_delay = memnew(FilteredDelay);
+	new_delay->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
@@ -441,4 +443,12 @@ float FilteredDelay::get_resonance_base_value() const {
 	return 0.0f;
 }
 
+size_t FilteredDelay::get_state_size() const {
+	return VoiceStateArena::align_size(delay_line.get_capacity());
+}
+
+void FilteredDelay::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	delay_line.bind_storage(p_allocator.allocate(delay_line.get_capacity()));
+}
+
 } // namespace godot
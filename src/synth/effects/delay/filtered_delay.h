@@ -4,7 +4,7 @@
 #include "../../core/modulated_parameter.h"
 #include "../../core/synth_note_context.h"
 #include "../synth_audio_effect.h"
-#include <vector>
+#include "delay_line.h"
 
 namespace godot {
 
@@ -12,9 +12,15 @@ class FilteredDelay : public SynthAudioEffect {
 	GDCLASS(FilteredDelay, SynthAudioEffect)
 
 private:
-	// Delay buffer
-	std::vector<float> delay_buffer;
-	int buffer_position = 0;
+	// Longest delay_time in seconds
+	static constexpr float MAX_DELAY_TIME = 2.0f;
+
+	// Delay line
+	DelayLine<float> delay_line;
+	float sample_rate = 44100.0f;
+
+	// Size the line for the longest delay at the current sample rate
+	void size_delay_line();
 
 	// Filter state variables
 	float lp_state = 0.0f;
@@ -38,12 +44,16 @@ public:
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
+	void set_sample_rate(float p_sample_rate) override;
 
 	// Returns the tail length based on delay time and feedback
 	float get_tail_length() const override;
 
 	// Create a duplicate of this effect
 	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
 
 	// Parameter accessors
 	void set_delay_time_parameter(const Ref<ModulatedParameter> &param);
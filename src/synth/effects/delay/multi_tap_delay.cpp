@@ -73,9 +73,7 @@ void MultiTapDelay::_bind_methods() {
 }
 
 MultiTapDelay::MultiTapDelay() {
-	// Initialize delay buffer (3 seconds at 44.1kHz)
-	delay_buffer.resize(132300, 0.0f);
-	buffer_position = 0;
+	size_delay_line();
 
 	// Create default parameters
 	Ref<ModulatedParameter> base_delay_param = memnew(ModulatedParameter);
@@ -175,8 +173,8 @@ float MultiTapDelay::process_sample(float sample, const Ref<SynthNoteContext> &c
 	Ref<ModulatedParameter> taps_param = get_parameter(PARAM_TAPS);
 	if (taps_param.is_valid()) {
 		num_taps = static_cast<int>(taps_param->get_value(context));
-		// Ensure we have at least 2 taps
-		num_taps = std::max(2, num_taps);
+		// Ensure we have between 2 and MAX_TAPS taps
+		num_taps = std::min(std::max(2, num_taps), MAX_TAPS);
 	}
 
 	Ref<ModulatedParameter> decay_param = get_parameter(PARAM_DECAY);
@@ -187,44 +185,35 @@ float MultiTapDelay::process_sample(float sample, const Ref<SynthNoteContext> &c
 	// Update taps if parameters have changed
 	update_taps(base_delay, spread, num_taps, decay);
 
-	// Calculate sample rate (assuming 44.1kHz)
-	const float sample_rate = 44100.0f;
-
 	float input = sample;
 	float output = 0.0f;
 
-	// Process each tap
-	for (size_t t = 0; t < taps.size(); t++) {
-		// Calculate delay in samples
-		int delay_samples = static_cast<int>(taps[t].delay_time * sample_rate);
-		if (delay_samples >= delay_buffer.size()) {
-			delay_samples = delay_buffer.size() - 1;
-		}
-
-		// Calculate read position with wraparound
-		int read_pos = buffer_position - delay_samples;
-		if (read_pos < 0) {
-			read_pos += delay_buffer.size();
-		}
-
-		// Read delayed sample and add to output
-		output += delay_buffer[read_pos] * taps[t].level;
+	// Gather all taps in one pass
+	float tap_delays[MAX_TAPS];
+	float tap_levels[MAX_TAPS];
+	int tap_count = std::min(static_cast<int>(taps.size()), MAX_TAPS);
+	for (int t = 0; t < tap_count; t++) {
+		tap_delays[t] = delay_line.clamp_delay(taps[t].delay_time * sample_rate);
+		tap_levels[t] = taps[t].level;
 	}
+	output = delay_line.read_taps_mixed(tap_delays, tap_levels, tap_count);
 
-	// Write to delay buffer with feedback
-	delay_buffer[buffer_position] = input + output * feedback;
-
-	// Increment and wrap buffer position
-	buffer_position = (buffer_position + 1) % delay_buffer.size();
+	// Write to delay line with feedback
+	delay_line.write(input + output * feedback);
 
 	// Mix dry and wet signals
 	return input * (1.0f - mix) + output * mix;
 }
 
 void MultiTapDelay::reset() {
-	// Clear delay buffer
-	std::fill(delay_buffer.begin(), delay_buffer.end(), 0.0f);
-	buffer_position = 0;
+	// Clear delay line
+	delay_line.clear();
+}
+
+bool MultiTapDelay::get_constant_gain(float &r_gain) const {
+	// Every tap is summed into the wet signal
+	r_gain = 1.0f;
+	return has_constant_value(PARAM_MIX, 0.0f);
 }
 
 float MultiTapDelay::get_tail_length() const {
@@ -273,8 +262,21 @@ float MultiTapDelay::get_tail_length() const {
 	return longest_tap * repeats;
 }
 
+void MultiTapDelay::size_delay_line() {
+	delay_line.resize(static_cast<int>(std::ceil(MAX_DELAY_TIME * sample_rate)));
+}
+
+void MultiTapDelay::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+		return;
+	}
+	sample_rate = p_sample_rate;
+	size_delay_line();
+}
+
 Ref<SynthAudioEffect> MultiTapDelay::duplicate() const {
 	Ref<MultiTapDelay> new_delay = memnew(MultiTapDelay);
+	new_delay->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
@@ -480,4 +482,12 @@ float MultiTapDelay::get_decay_base_value() const {
 	return 0.0f;
 }
 
+size_t MultiTapDelay::get_state_size() const {
+	return VoiceStateArena::align_size(delay_line.get_capacity());
+}
+
+void MultiTapDelay::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	delay_line.bind_storage(p_allocator.allocate(delay_line.get_capacity()));
+}
+
 } // namespace godot
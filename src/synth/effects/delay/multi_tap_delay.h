@@ -4,6 +4,7 @@
 #include "../../core/modulated_parameter.h"
 #include "../../core/synth_note_context.h"
 #include "../synth_audio_effect.h"
+#include "delay_line.h"
 #include <vector>
 
 namespace godot {
@@ -12,9 +13,15 @@ class MultiTapDelay : public SynthAudioEffect {
 	GDCLASS(MultiTapDelay, SynthAudioEffect)
 
 private:
-	// Delay buffer
-	std::vector<float> delay_buffer;
-	int buffer_position = 0;
+	// Longest tap in seconds, taps spread further out are clamped to it
+	static constexpr float MAX_DELAY_TIME = 3.0f;
+
+	// Delay line
+	DelayLine<float> delay_line;
+	float sample_rate = 44100.0f;
+
+	// Size the line for the longest delay at the current sample rate
+	void size_delay_line();
 
 	// Define multiple taps with different times and levels
 	struct DelayTap {
@@ -22,6 +29,8 @@ private:
 		float level;
 	};
 
+	static constexpr int MAX_TAPS = 8;
+
 	std::vector<DelayTap> taps;
 
 public:
@@ -42,12 +51,16 @@ public:
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
+	void set_sample_rate(float p_sample_rate) override;
 
 	// Returns the tail length based on delay time and feedback
 	float get_tail_length() const override;
 
 	// Create a duplicate of this effect
 	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
 
 	// Parameter accessors
 	void set_base_delay_parameter(const Ref<ModulatedParameter> &param);
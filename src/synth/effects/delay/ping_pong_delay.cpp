@@ -42,11 +42,7 @@ void PingPongDelay::_bind_methods() {
 }
 
 PingPongDelay::PingPongDelay() {
-    // Initialize delay buffers (2 seconds at 44.1kHz)
-    delay_buffer_1.resize(88200, 0.0f);
-    delay_buffer_2.resize(88200, 0.0f);
-    buffer_position_1 = 0;
-    buffer_position_2 = 0;
+    size_delay_lines();
     
     // Create default parameters
     Ref<ModulatedParameter> delay_time_param = memnew(ModulatedParameter);
@@ -120,45 +116,21 @@ float PingPongDelay::process_sample(float sample, const Ref<SynthNoteContext> &c
         offset = offset_param->get_value(context);
     }
     
-    // Calculate sample rate (assuming 44.1kHz)
-    const float sample_rate = 44100.0f;
-    
     // Calculate delay in samples
-    int delay_samples_1 = static_cast<int>(delay_time * sample_rate);
-    if (delay_samples_1 >= delay_buffer_1.size()) {
-        delay_samples_1 = delay_buffer_1.size() - 1;
-    }
+    float delay_samples_1 = delay_line_1.clamp_delay(delay_time * sample_rate);
     
     // Calculate second delay with offset
-    int delay_samples_2 = static_cast<int>(delay_time * (1.0f + offset * 0.5f) * sample_rate);
-    if (delay_samples_2 >= delay_buffer_2.size()) {
-        delay_samples_2 = delay_buffer_2.size() - 1;
-    }
+    float delay_samples_2 = delay_line_2.clamp_delay(delay_time * (1.0f + offset * 0.5f) * sample_rate);
     
     float input = sample;
     
-    // Calculate read positions with wraparound
-    int read_pos_1 = buffer_position_1 - delay_samples_1;
-    if (read_pos_1 < 0) {
-        read_pos_1 += delay_buffer_1.size();
-    }
-    
-    int read_pos_2 = buffer_position_2 - delay_samples_2;
-    if (read_pos_2 < 0) {
-        read_pos_2 += delay_buffer_2.size();
-    }
-    
     // Read delayed samples
-    float delayed_sample_1 = delay_buffer_1[read_pos_1];
-    float delayed_sample_2 = delay_buffer_2[read_pos_2];
-    
-    // Write to delay buffers with cross-feedback
-    delay_buffer_1[buffer_position_1] = input + delayed_sample_2 * feedback * cross_feedback;
-    delay_buffer_2[buffer_position_2] = delayed_sample_1 * feedback;
+    float delayed_sample_1 = delay_line_1.read_linear(delay_samples_1);
+    float delayed_sample_2 = delay_line_2.read_linear(delay_samples_2);
     
-    // Increment and wrap buffer positions
-    buffer_position_1 = (buffer_position_1 + 1) % delay_buffer_1.size();
-    buffer_position_2 = (buffer_position_2 + 1) % delay_buffer_2.size();
+    // Write to delay lines with cross-feedback
+    delay_line_1.write(input + delayed_sample_2 * feedback * cross_feedback);
+    delay_line_2.write(delayed_sample_1 * feedback);
     
     // Mix dry and wet signals
     // For ping-pong effect, we combine both delay lines
@@ -167,14 +139,18 @@ float PingPongDelay::process_sample(float sample, const Ref<SynthNoteContext> &c
 }
 
 void PingPongDelay::reset() {
-    // Clear delay buffers
-    std::fill(delay_buffer_1.begin(), delay_buffer_1.end(), 0.0f);
-    std::fill(delay_buffer_2.begin(), delay_buffer_2.end(), 0.0f);
-    buffer_position_1 = 0;
-    buffer_position_2 = 0;
+    // Clear delay lines
+    delay_line_1.clear();
+    delay_line_2.clear();
     
 }
 
+bool PingPongDelay::get_constant_gain(float &r_gain) const {
+    // Dry mix, the bouncing taps are never heard
+    r_gain = 1.0f;
+    return has_constant_value(PARAM_MIX, 0.0f);
+}
+
 float PingPongDelay::get_tail_length() const {
     // Get the delay time and feedback parameters
     float delay_time = 0.4f;  // Default: 400ms
@@ -214,8 +190,22 @@ float PingPongDelay::get_tail_length() const {
     return longest_delay * repeats;
 }
 
+void PingPongDelay::size_delay_lines() {
+    delay_line_1.resize(static_cast<int>(std::ceil(MAX_DELAY_TIME * sample_rate)));
+    delay_line_2.resize(static_cast<int>(std::ceil(MAX_DELAY_TIME * 1.5f * sample_rate)));
+}
+
+void PingPongDelay::set_sample_rate(float p_sample_rate) {
+    if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+        return;
+    }
+    sample_rate = p_sample_rate;
+    size_delay_lines();
+}
+
 Ref<SynthAudioEffect> PingPongDelay::duplicate() const {
     Ref<PingPongDelay> new_delay = memnew(PingPongDelay);
+    new_delay->set_sample_rate(sample_rate);
     
     // Copy parameters
     Dictionary params = get_parameters();
@@ -293,4 +283,14 @@ Ref<ModulatedParameter> PingPongDelay::get_offset_parameter() const {
     return get_parameter(PARAM_OFFSET);
 }
 
+size_t PingPongDelay::get_state_size() const {
+    return VoiceStateArena::align_size(delay_line_1.get_capacity()) +
+            VoiceStateArena::align_size(delay_line_2.get_capacity());
+}
+
+void PingPongDelay::bind_state(VoiceStateArena::Allocator &p_allocator) {
+    delay_line_1.bind_storage(p_allocator.allocate(delay_line_1.get_capacity()));
+    delay_line_2.bind_storage(p_allocator.allocate(delay_line_2.get_capacity()));
+}
+
 } // namespace godot
@@ -4,7 +4,7 @@
 #include "../../core/modulated_parameter.h"
 #include "../../core/synth_note_context.h"
 #include "../synth_audio_effect.h"
-#include <vector>
+#include "delay_line.h"
 
 namespace godot {
 
@@ -12,11 +12,16 @@ class PingPongDelay : public SynthAudioEffect {
 	GDCLASS(PingPongDelay, SynthAudioEffect)
 
 private:
-	// Two delay buffers for ping-pong effect
-	std::vector<float> delay_buffer_1;
-	std::vector<float> delay_buffer_2;
-	int buffer_position_1 = 0;
-	int buffer_position_2 = 0;
+	// Longest delay_time in seconds, the offset line reaches 1.5 times further
+	static constexpr float MAX_DELAY_TIME = 1.5f;
+
+	// Two delay lines for ping-pong effect
+	DelayLine<float> delay_line_1;
+	DelayLine<float> delay_line_2;
+	float sample_rate = 44100.0f;
+
+	// Size both lines for the longest delays at the current sample rate
+	void size_delay_lines();
 
 public:
 	// Parameter names
@@ -35,12 +40,16 @@ public:
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
+	void set_sample_rate(float p_sample_rate) override;
 
 	// Returns the tail length based on delay time and feedback
 	float get_tail_length() const override;
 
 	// Create a duplicate of this effect
 	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
 
 	// Parameter accessors
 	void set_delay_time_parameter(const Ref<ModulatedParameter> &param);
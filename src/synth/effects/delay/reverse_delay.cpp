@@ -1,4 +1,5 @@
 #include "reverse_delay.h"
+#include <algorithm>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -23,13 +24,10 @@ void ReverseDelay::_bind_methods() {
 			"set_crossfade_parameter", "get_crossfade_parameter");
 }
 
-ReverseDelay::ReverseDelay() {
-	// Initialize with a default buffer size (2 seconds at 44.1kHz)
-	buffer_size = 88200;
-	reverse_buffer.resize(buffer_size, 0.0f);
-	write_position = 0;
-	read_position = 0;
-	is_recording = true;
+ReverseDelay::ReverseDelay() :
+		DelayEffect(MAX_DELAY_TIME) {
+	segment_position = 0;
+	segment_length = 0;
 
 	// Create default parameters
 	Ref<ModulatedParameter> delay_time_param = memnew(ModulatedParameter);
@@ -91,74 +89,64 @@ float ReverseDelay::process_sample(float sample, const Ref<SynthNoteContext> &co
 		crossfade = crossfade_param->get_value(context);
 	}
 
-	// Calculate delay in samples (assuming 44.1kHz sample rate)
-	int delay_samples = static_cast<int>(delay_time * 44100.0f);
-	if (delay_samples >= buffer_size) {
-		delay_samples = buffer_size - 1;
+	int delay_samples = static_cast<int>(delay_time * sample_rate);
+	delay_samples = std::max(1, std::min(delay_samples, delay_line.get_max_delay() / 2));
+
+	// Latch the segment length at segment boundaries so a moving delay time
+	// never tears a segment apart
+	if (segment_position == 0 || segment_length <= 0) {
+		segment_length = delay_samples;
 	}
 
 	// Calculate crossfade samples
-	int crossfade_samples = static_cast<int>(crossfade * delay_samples);
+	int crossfade_samples = static_cast<int>(crossfade * segment_length);
 
 	float input = sample;
-	float output = 0.0f;
-
-	// Store input in reverse buffer
-	reverse_buffer[write_position] = input;
 
-	// Check if we need to switch between recording and playback
-	if (is_recording && write_position >= delay_samples - 1) {
-		is_recording = false;
-		read_position = write_position; // Start reading from the end
-	}
+	// Play the previous segment backwards: at offset c into this segment the
+	// sample written c + 1 samples before the segment started is 2c + 1 behind
+	float delayed_sample = delay_line.read(2 * segment_position + 1);
 
-	if (!is_recording) {
-		// Read from reverse buffer (backwards)
-		float delayed_sample = reverse_buffer[read_position];
+	// Apply crossfade if near the boundaries
+	float fade_factor = 1.0f;
+	int distance_from_start = segment_position;
+	int distance_from_end = segment_length - 1 - segment_position;
 
-		// Apply crossfade if near the boundaries
-		float fade_factor = 1.0f;
-		int distance_from_start = read_position;
-		int distance_from_end = delay_samples - 1 - read_position;
-
-		if (distance_from_start < crossfade_samples) {
-			fade_factor = static_cast<float>(distance_from_start) / crossfade_samples;
-		} else if (distance_from_end < crossfade_samples) {
-			fade_factor = static_cast<float>(distance_from_end) / crossfade_samples;
-		}
+	if (distance_from_start < crossfade_samples) {
+		fade_factor = static_cast<float>(distance_from_start) / crossfade_samples;
+	} else if (distance_from_end < crossfade_samples) {
+		fade_factor = static_cast<float>(distance_from_end) / crossfade_samples;
+	}
 
-		// Apply fade factor
-		output = delayed_sample * fade_factor;
+	float output = delayed_sample * fade_factor;
 
-		// Move read position backwards (with wraparound)
-		read_position--;
-		if (read_position < 0) {
-			read_position = delay_samples - 1;
+	// Feed the reversed signal back into the line
+	delay_line.write(input + output * feedback);
 
-			// Apply feedback by copying the buffer with attenuation
-			for (int j = 0; j < delay_samples; j++) {
-				reverse_buffer[j] *= feedback;
-			}
-		}
+	segment_position++;
+	if (segment_position >= segment_length) {
+		segment_position = 0;
 	}
 
-	// Increment write position with wraparound
-	write_position = (write_position + 1) % buffer_size;
-
 	// Mix dry and wet signals
 	return input * (1.0f - mix) + output * mix;
 }
 
+void ReverseDelay::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	// Sample by sample, the block path of DelayEffect is for the plain delay
+	SynthAudioEffect::process_block(p_buffer, p_count, context);
+}
+
 void ReverseDelay::reset() {
 	// Clear reverse buffer
-	std::fill(reverse_buffer.begin(), reverse_buffer.end(), 0.0f);
-	write_position = 0;
-	read_position = 0;
-	is_recording = true;
+	delay_line.clear();
+	segment_position = 0;
+	segment_length = 0;
 }
 
 Ref<SynthAudioEffect> ReverseDelay::duplicate() const {
 	Ref<ReverseDelay> new_delay = memnew(ReverseDelay);
+	new_delay->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
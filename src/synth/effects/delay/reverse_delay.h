@@ -9,12 +9,12 @@ class ReverseDelay : public DelayEffect {
 	GDCLASS(ReverseDelay, DelayEffect)
 
 private:
-	// Delay buffer for reverse playback
-	std::vector<float> reverse_buffer;
-	int write_position;
-	int read_position;
-	int buffer_size;
-	bool is_recording;
+	// Reversing a segment of up to 2 seconds needs twice that much history
+	static constexpr float MAX_DELAY_TIME = 2.0f * 2.0f;
+
+	// Reverse playback position within the current segment
+	int segment_position;
+	int segment_length;
 
 public:
 	// Parameter names
@@ -31,6 +31,7 @@ public:
 	~ReverseDelay();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
 
 	// Create a duplicate of this effect
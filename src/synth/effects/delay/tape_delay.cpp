@@ -1,4 +1,5 @@
 #include "tape_delay.h"
+#include "../../core/dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -48,10 +49,7 @@ void TapeDelay::_bind_methods() {
 }
 
 TapeDelay::TapeDelay() {
-	// Initialize delay buffer (2 seconds at 44.1kHz)
-	delay_buffer.resize(88200, 0.0f);
-	write_position = 0;
-	read_position = 0.0f;
+	size_delay_line();
 	last_delay_time = 0.5f;
 
 	// Initialize filter states
@@ -145,16 +143,13 @@ float TapeDelay::process_sample(float sample, const Ref<SynthNoteContext> &conte
 		filtering = filter_param->get_value(context);
 	}
 
-	// Calculate sample rate (assuming 44.1kHz)
-	const float sample_rate = 44100.0f;
-
 	// Calculate time change rate for pitch shifting effect
 	float time_change_rate = (delay_time - last_delay_time) / sample_rate;
 	last_delay_time = delay_time;
 
 	// Calculate filter coefficients
-	float lp_coeff = std::exp(-2.0f * Math_PI * (1000.0f + 7000.0f * (1.0f - filtering)) / sample_rate);
-	float hp_coeff = std::exp(-2.0f * Math_PI * (20.0f + 300.0f * filtering) / sample_rate);
+	float lp_coeff = DspMath::one_pole_coefficient(1000.0f + 7000.0f * (1.0f - filtering), sample_rate);
+	float hp_coeff = DspMath::one_pole_coefficient(20.0f + 300.0f * filtering, sample_rate);
 
 	// Update wow and flutter
 	wow_phase += 2.0f * Math_PI * 0.5f / sample_rate; // 0.5 Hz LFO
@@ -162,26 +157,15 @@ float TapeDelay::process_sample(float sample, const Ref<SynthNoteContext> &conte
 		wow_phase -= 2.0f * Math_PI;
 	}
 
-	float wow_mod = wow_amount * 0.005f * std::sin(wow_phase); // +/- 0.5% variation
+	float wow_mod = wow_amount * 0.005f * DspMath::sin(wow_phase); // +/- 0.5% variation
 	float current_delay_time = delay_time * (1.0f + wow_mod);
 
 	// Calculate delay in samples
 	float delay_samples = current_delay_time * sample_rate;
 
-	// Calculate read position with wraparound
-	float read_pos = write_position - delay_samples;
-	while (read_pos < 0) {
-		read_pos += delay_buffer.size();
-	}
-
-	// Fractional read with linear interpolation
-	int read_pos_int = static_cast<int>(read_pos);
-	float frac = read_pos - read_pos_int;
-	int read_pos_next = (read_pos_int + 1) % delay_buffer.size();
-
-	// Read delayed sample with interpolation
-	float delayed_sample = delay_buffer[read_pos_int] * (1.0f - frac) +
-			delay_buffer[read_pos_next] * frac;
+	// Read delayed sample with Hermite interpolation, wow and flutter sweep the
+	// delay continuously so a smooth fractional read avoids zipper noise
+	float delayed_sample = delay_line.read_hermite(delay_line.clamp_delay(delay_samples));
 
 	// Apply filtering (tape-like EQ)
 	// Low-pass filter
@@ -196,24 +180,19 @@ float TapeDelay::process_sample(float sample, const Ref<SynthNoteContext> &conte
 	if (saturation > 0.0f) {
 		// Soft clipping with variable amount
 		float drive = 1.0f + 3.0f * saturation;
-		delayed_sample = std::tanh(delayed_sample * drive) / drive;
+		delayed_sample = DspMath::tanh(delayed_sample * drive) / drive;
 	}
 
-	// Write to delay buffer with feedback
-	delay_buffer[write_position] = sample + delayed_sample * feedback;
-
-	// Increment and wrap write position
-	write_position = (write_position + 1) % delay_buffer.size();
+	// Write to delay line with feedback
+	delay_line.write(sample + delayed_sample * feedback);
 
 	// Mix dry and wet signals
 	return sample * (1.0f - mix) + delayed_sample * mix;
 }
 
 void TapeDelay::reset() {
-	// Clear delay buffer
-	std::fill(delay_buffer.begin(), delay_buffer.end(), 0.0f);
-	write_position = 0;
-	read_position = 0.0f;
+	// Clear delay line
+	delay_line.clear();
 	last_delay_time = 0.5f;
 
 	// Reset filter states
@@ -224,6 +203,12 @@ void TapeDelay::reset() {
 	wow_phase = 0.0f;
 }
 
+bool TapeDelay::get_constant_gain(float &r_gain) const {
+	// Wow, flutter and saturation only colour the delayed signal
+	r_gain = 1.0f;
+	return has_constant_value(PARAM_MIX, 0.0f);
+}
+
 float TapeDelay::get_tail_length() const {
 	// Get the delay time parameter
 	float delay_time = 0.5f; // Default: 500ms
@@ -260,8 +245,21 @@ float TapeDelay::get_tail_length() const {
 	return delay_time * repeats;
 }
 
+void TapeDelay::size_delay_line() {
+	delay_line.resize(static_cast<int>(std::ceil(MAX_DELAY_TIME * (1.0f + MAX_WOW_DEPTH) * sample_rate)));
+}
+
+void TapeDelay::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+		return;
+	}
+	sample_rate = p_sample_rate;
+	size_delay_line();
+}
+
 Ref<SynthAudioEffect> TapeDelay::duplicate() const {
 	Ref<TapeDelay> new_delay = memnew(TapeDelay);
+	new_delay->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
@@ -349,4 +347,12 @@ Ref<ModulatedParameter> TapeDelay::get_filtering_parameter() const {
 	return get_parameter(PARAM_FILTERING);
 }
 
+size_t TapeDelay::get_state_size() const {
+	return VoiceStateArena::align_size(delay_line.get_capacity());
+}
+
+void TapeDelay::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	delay_line.bind_storage(p_allocator.allocate(delay_line.get_capacity()));
+}
+
 } // namespace godot
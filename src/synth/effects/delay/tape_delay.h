@@ -4,7 +4,7 @@
 #include "../../core/modulated_parameter.h"
 #include "../../core/synth_note_context.h"
 #include "../synth_audio_effect.h"
-#include <vector>
+#include "delay_line.h"
 
 namespace godot {
 
@@ -12,10 +12,16 @@ class TapeDelay : public SynthAudioEffect {
 	GDCLASS(TapeDelay, SynthAudioEffect)
 
 private:
-	// Delay buffer
-	std::vector<float> delay_buffer;
-	float read_position = 0.0f; // Fractional read position for smooth time changes
-	int write_position = 0;
+	// Longest delay_time in seconds, the line holds it plus the deepest wow
+	static constexpr float MAX_DELAY_TIME = 2.0f;
+	static constexpr float MAX_WOW_DEPTH = 0.0025f;
+
+	// Delay line
+	DelayLine<float> delay_line;
+	float sample_rate = 44100.0f;
+
+	// Size the line for the longest delay at the current sample rate
+	void size_delay_line();
 	float last_delay_time = 0.5f; // Track previous delay time for smooth transitions
 
 	// Low/high pass filter state variables
@@ -43,12 +49,16 @@ public:
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
+	void set_sample_rate(float p_sample_rate) override;
 
 	// Returns the tail length based on delay time and feedback
 	float get_tail_length() const override;
 
 	// Create a duplicate of this effect
 	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
 
 	// Parameter accessors
 	void set_delay_time_parameter(const Ref<ModulatedParameter> &param);
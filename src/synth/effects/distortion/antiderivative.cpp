@@ -0,0 +1,241 @@
+#include "antiderivative.h"
+#include "../../core/dsp_math.h"
+
+namespace godot {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const double SQRT_3 = 1.73205080756887729353;
+
+double tanh_function(double p_u) {
+	return std::tanh(p_u);
+}
+
+float fast_tanh_function(float p_u) {
+	return DspMath::tanh(p_u);
+}
+
+// tanh is flat to double precision well before 20. Built when the library loads so
+// the audio thread never pays for it.
+const AntiderivativeTable tanh_table(&tanh_function, &fast_tanh_function, 20.0, 64);
+
+} // namespace
+
+AntiderivativeTable::AntiderivativeTable(double (*p_build_function)(double), float (*p_function)(float), double p_range, int p_points_per_unit) {
+	function = p_function;
+	range = p_range;
+	step = 1.0 / p_points_per_unit;
+
+	int points = static_cast<int>(p_range * p_points_per_unit) + 1;
+	for (int i = 0; i < 3; i++) {
+		values[i].resize(points);
+	}
+
+	// Simpson's rule on a finer grid, F1 at the fine midpoints comes from integrating
+	// f over the first half of each fine cell
+	const int substeps = 4;
+	double h = step / substeps;
+	double f1 = 0.0;
+	double f2 = 0.0;
+	values[0][0] = p_build_function(0.0);
+	values[1][0] = 0.0;
+	values[2][0] = 0.0;
+	for (int i = 1; i < points; i++) {
+		for (int j = 0; j < substeps; j++) {
+			double x = (i - 1) * step + j * h;
+			double fa = p_build_function(x);
+			double fq = p_build_function(x + h * 0.25);
+			double fm = p_build_function(x + h * 0.5);
+			double fr = p_build_function(x + h * 0.75);
+			double fb = p_build_function(x + h);
+
+			double f1_mid = f1 + h / 12.0 * (fa + 4.0 * fq + fm);
+			double f1_end = f1_mid + h / 12.0 * (fm + 4.0 * fr + fb);
+			f2 += h / 6.0 * (f1 + 4.0 * f1_mid + f1_end);
+			f1 = f1_end;
+		}
+		values[0][i] = p_build_function(i * step);
+		values[1][i] = f1;
+		values[2][i] = f2;
+	}
+}
+
+double AntiderivativeTable::evaluate(double p_u, int p_order) const {
+	if (p_order == 0) {
+		return function(static_cast<float>(p_u));
+	}
+
+	// f is odd, so F1 is even and F2 is odd
+	double a = std::abs(p_u);
+	double sign = (p_order == 2 && p_u < 0.0) ? -1.0 : 1.0;
+
+	const std::vector<double> &value = values[p_order];
+	const std::vector<double> &slope = values[p_order - 1];
+	int last = static_cast<int>(value.size()) - 1;
+
+	if (a >= range) {
+		double d = a - range;
+		double f0 = values[0][last];
+		if (p_order == 1) {
+			return value[last] + f0 * d;
+		}
+		return sign * (value[last] + values[1][last] * d + 0.5 * f0 * d * d);
+	}
+
+	int i = static_cast<int>(a / step);
+	if (i >= last) {
+		i = last - 1;
+	}
+	double t = a / step - i;
+	double t2 = t * t;
+	double t3 = t2 * t;
+	double result = (2.0 * t3 - 3.0 * t2 + 1.0) * value[i] + (t3 - 2.0 * t2 + t) * slope[i] * step + (-2.0 * t3 + 3.0 * t2) * value[i + 1] + (t3 - t2) * slope[i + 1] * step;
+	return sign * result;
+}
+
+double Antiderivatives::clamp(double p_u, double p_low, double p_high, int p_order) {
+	double edge = p_u > p_high ? p_high : (p_u < p_low ? p_low : 0.0);
+	bool clipped = p_u > p_high || p_u < p_low;
+	switch (p_order) {
+		case 0:
+			return clipped ? edge : p_u;
+		case 1:
+			return clipped ? edge * p_u - 0.5 * edge * edge : 0.5 * p_u * p_u;
+		default:
+			return clipped ? 0.5 * edge * p_u * p_u - 0.5 * edge * edge * p_u + edge * edge * edge / 6.0 : p_u * p_u * p_u / 6.0;
+	}
+}
+
+double Antiderivatives::rectify(double p_u, double p_positive, double p_negative, int p_order) {
+	double gain = p_u > 0.0 ? p_positive : p_negative;
+	switch (p_order) {
+		case 0:
+			return gain * p_u;
+		case 1:
+			return gain * p_u * p_u * 0.5;
+		default:
+			return gain * p_u * p_u * p_u / 6.0;
+	}
+}
+
+double Antiderivatives::ratio(double p_u, double p_b, int p_order) {
+	double a = std::abs(p_u);
+	double sign = p_u < 0.0 ? -1.0 : 1.0;
+	switch (p_order) {
+		case 0:
+			return p_u / (a + p_b);
+		case 1:
+			return a - p_b * std::log1p(a / p_b);
+		default:
+			return sign * (0.5 * a * a - p_b * ((a + p_b) * std::log1p(a / p_b) - a));
+	}
+}
+
+double Antiderivatives::fast_tanh(double p_u, int p_order) {
+	double u2 = p_u * p_u;
+	switch (p_order) {
+		case 0:
+			return p_u * (27.0 + u2) / (27.0 + 9.0 * u2);
+		case 1:
+			// u / 9 + 8 u / (3 (u^2 + 3))
+			return u2 / 18.0 + 4.0 / 3.0 * std::log1p(u2 / 3.0);
+		default:
+			return u2 * p_u / 54.0 + 4.0 / 3.0 * (p_u * std::log1p(u2 / 3.0) - 2.0 * p_u + 2.0 * SQRT_3 * std::atan(p_u / SQRT_3));
+	}
+}
+
+double Antiderivatives::tanh(double p_u, int p_order) {
+	// log(cosh(u)) and the second antiderivative, which needs the dilogarithm, come from
+	// the table. Its error is smooth, so it cancels in the divided differences where the
+	// rounding of a float log1p would not.
+	return tanh_table.evaluate(p_u, p_order);
+}
+
+double Antiderivatives::exp_saturate(double p_u, int p_order) {
+	double a = std::abs(p_u);
+	double sign = p_u < 0.0 ? -1.0 : 1.0;
+	switch (p_order) {
+		case 0:
+			return sign * (1.0f - DspMath::exp(static_cast<float>(-a)));
+		case 1:
+			return a + std::expm1(-a);
+		default:
+			return sign * (0.5 * a * a - a - std::expm1(-a));
+	}
+}
+
+double Antiderivatives::sine(double p_u, int p_order) {
+	double w = PI * 0.5;
+	switch (p_order) {
+		case 0:
+			// sin(pi u / 2) is a quarter turn per unit
+			return DspMath::sin_turns(static_cast<float>(0.25 * p_u));
+		case 1:
+			return (1.0 - std::cos(w * p_u)) / w;
+		default:
+			return p_u / w - std::sin(w * p_u) / (w * w);
+	}
+}
+
+double Antiderivatives::cubic(double p_u, int p_order) {
+	double u2 = p_u * p_u;
+	switch (p_order) {
+		case 0:
+			return 1.5 * p_u - 0.5 * u2 * p_u;
+		case 1:
+			return 0.75 * u2 - 0.125 * u2 * u2;
+		default:
+			return 0.25 * u2 * p_u - 0.025 * u2 * u2 * p_u;
+	}
+}
+
+double Antiderivatives::arctan(double p_u, int p_order) {
+	double k = PI * 0.5;
+	double scale = 2.0 / PI;
+	double angle = std::atan(k * p_u);
+	switch (p_order) {
+		case 0:
+			return scale * angle;
+		case 1:
+			return scale * (p_u * angle - std::log1p(k * k * p_u * p_u) / (2.0 * k));
+		default:
+			return scale * ((0.5 * p_u * p_u - 0.5 / (k * k)) * angle + p_u / (2.0 * k) - p_u * std::log1p(k * k * p_u * p_u) / (2.0 * k));
+	}
+}
+
+double Antiderivatives::foldback(double p_u, double p_threshold, int p_folds, int p_order) {
+	double t = p_threshold;
+	double a = std::abs(p_u);
+	double sign = p_u < 0.0 ? -1.0 : 1.0;
+
+	// Segment k spans [(2k - 1) t, (2k + 1) t] and holds k reflections, the last one
+	// continues past its end
+	int k = static_cast<int>((a + t) / (2.0 * t));
+	if (k > p_folds) {
+		k = p_folds;
+	}
+	double v = a - 2.0 * k * t;
+	double direction = (k & 1) ? -1.0 : 1.0;
+
+	switch (p_order) {
+		case 0:
+			return sign * direction * v;
+		case 1:
+			return 0.5 * t * t + direction * 0.5 * (v * v - t * t);
+		default: {
+			if (k == 0) {
+				return sign * a * a * a / 6.0;
+			}
+
+			// Whole segments before this one, then the part of this one up to a
+			double t3 = t * t * t;
+			double alternating = ((k - 1) & 1) ? -1.0 : 0.0;
+			double before = t3 / 6.0 + (k - 1) * t3 - 2.0 / 3.0 * t3 * alternating;
+			double partial = 0.5 * t * t * (v + t) + direction * ((v * v * v + t3) / 6.0 - 0.5 * t * t * (v + t));
+			return sign * (before + partial);
+		}
+	}
+}
+
+} // namespace godot
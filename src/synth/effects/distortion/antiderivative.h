@@ -0,0 +1,179 @@
+#ifndef ANTIDERIVATIVE_H
+#define ANTIDERIVATIVE_H
+
+#include <cmath>
+#include <vector>
+
+namespace godot {
+
+// Antiderivative anti-aliasing (ADAA) for memoryless waveshapers.
+// Instead of sampling f(x), first order ADAA outputs the average of f over the segment
+// between two input samples, (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1]), and second order
+// does the same with the second antiderivative F2 over three samples. The averaging
+// acts as a lowpass on the harmonics the waveshaper creates, before they alias.
+//
+// Shapers are evaluated through a callback eval(u, order) returning f(u) for order 0,
+// F1(u) for order 1 and F2(u) for order 2. When consecutive inputs are too close the
+// divided differences lose their precision, so the shaper falls back to evaluating a
+// lower order at the midpoint. First order delays the signal by half a sample and
+// second order by one sample.
+class AntiderivativeShaper {
+public:
+	enum Order {
+		ORDER_NONE,
+		ORDER_FIRST,
+		ORDER_SECOND
+	};
+
+private:
+	// Below these input differences the fallbacks take over
+	static constexpr double FIRST_ORDER_TOLERANCE = 1.0e-5;
+	static constexpr double SECOND_ORDER_TOLERANCE = 1.0e-3;
+
+	double x1 = 0.0;
+	double x2 = 0.0;
+	double ad1 = 0.0; // Antiderivative at x1, of the current order
+	double diff1 = 0.0; // Second order: divided difference of F2 over x1, x2
+	Order order = ORDER_NONE;
+
+public:
+	void set_order(Order p_order) {
+		if (p_order != order) {
+			order = p_order;
+			reset();
+		}
+	}
+	Order get_order() const { return order; }
+
+	void reset() {
+		x1 = 0.0;
+		x2 = 0.0;
+		ad1 = 0.0;
+		diff1 = 0.0;
+	}
+
+	// Delay added by the current order, in samples
+	float get_delay() const { return static_cast<float>(order) * 0.5f; }
+
+	template <typename F>
+	float process(float p_input, F &&p_eval) {
+		double x0 = p_input;
+		switch (order) {
+			case ORDER_FIRST: {
+				double ad0 = p_eval(x0, 1);
+				double delta = x0 - x1;
+				double out = std::abs(delta) < FIRST_ORDER_TOLERANCE ? p_eval(0.5 * (x0 + x1), 0) : (ad0 - ad1) / delta;
+				x1 = x0;
+				ad1 = ad0;
+				return static_cast<float>(out);
+			}
+			case ORDER_SECOND: {
+				double ad0 = p_eval(x0, 2);
+				double delta = x0 - x1;
+				double diff0 = std::abs(delta) < SECOND_ORDER_TOLERANCE ? p_eval(0.5 * (x0 + x1), 1) : (ad0 - ad1) / delta;
+
+				double out;
+				double span = x0 - x2;
+				if (std::abs(span) >= SECOND_ORDER_TOLERANCE) {
+					out = 2.0 * (diff0 - diff1) / span;
+				} else {
+					// x0 and x2 coincide, average around their midpoint instead
+					double mid = 0.5 * (x0 + x2);
+					double offset = mid - x1;
+					if (std::abs(offset) < SECOND_ORDER_TOLERANCE) {
+						out = p_eval(0.5 * (mid + x1), 0);
+					} else {
+						out = 2.0 / offset * (p_eval(mid, 1) + (ad1 - p_eval(mid, 2)) / offset);
+					}
+				}
+
+				x2 = x1;
+				x1 = x0;
+				ad1 = ad0;
+				diff1 = diff0;
+				return static_cast<float>(out);
+			}
+			default:
+				return static_cast<float>(p_eval(x0, 0));
+		}
+	}
+};
+
+// Antiderivatives of a smooth odd waveshaper without a closed form, precomputed on a
+// grid and read back with cubic Hermite interpolation. The slopes at the grid points
+// are exact (F2' = F1, F1' = f), which keeps the interpolation error well below what
+// the divided differences can resolve. Past the grid the shaper must be flat, so the
+// antiderivatives continue as a line and a parabola. The double precision function only
+// builds the table, f itself is evaluated with the float version.
+class AntiderivativeTable {
+private:
+	std::vector<double> values[3]; // f, F1 and F2 at every grid point, for u >= 0
+	double range = 0.0;
+	double step = 0.0;
+	float (*function)(float) = nullptr;
+
+public:
+	AntiderivativeTable(double (*p_build_function)(double), float (*p_function)(float), double p_range, int p_points_per_unit);
+
+	double evaluate(double p_u, int p_order) const;
+};
+
+// Closed form antiderivatives of the waveshapers used by the distortions.
+// Every function returns f(u), F1(u) or F2(u) for p_order 0, 1 or 2, with F1(0) = F2(0) = 0.
+// f is only ever output, so it uses DspMath where that is within a float step or two.
+// F1 and F2 stay in double: the shaper divides their differences by input steps down to
+// 1e-5, which would turn a float rounding error into an audible one.
+class Antiderivatives {
+public:
+	// Clamp to [p_low, p_high], p_low <= 0 <= p_high
+	static double clamp(double p_u, double p_low, double p_high, int p_order);
+
+	// p_positive * u above zero, p_negative * u below
+	static double rectify(double p_u, double p_positive, double p_negative, int p_order);
+
+	// u / (|u| + b)
+	static double ratio(double p_u, double p_b, int p_order);
+
+	// Rational tanh approximation u (27 + u^2) / (27 + 9 u^2)
+	static double fast_tanh(double p_u, int p_order);
+
+	static double tanh(double p_u, int p_order);
+
+	// sign(u) (1 - e^-|u|)
+	static double exp_saturate(double p_u, int p_order);
+
+	// sin(pi u / 2)
+	static double sine(double p_u, int p_order);
+
+	// 1.5 u - 0.5 u^3
+	static double cubic(double p_u, int p_order);
+
+	// 2 / pi atan(pi u / 2)
+	static double arctan(double p_u, int p_order);
+
+	// Shaper p_function held flat outside [-p_limit, p_limit]
+	template <typename F>
+	static double limit(double p_u, double p_limit, int p_order, F &&p_function) {
+		if (std::abs(p_u) <= p_limit) {
+			return p_function(p_u, p_order);
+		}
+		double edge = p_u > 0.0 ? p_limit : -p_limit;
+		double d = p_u - edge;
+		double f0 = p_function(edge, 0);
+		switch (p_order) {
+			case 0:
+				return f0;
+			case 1:
+				return p_function(edge, 1) + f0 * d;
+			default:
+				return p_function(edge, 2) + p_function(edge, 1) * d + 0.5 * f0 * d * d;
+		}
+	}
+
+	// Foldback at threshold t with at most p_folds reflections
+	static double foldback(double p_u, double p_threshold, int p_folds, int p_order);
+};
+
+} // namespace godot
+
+#endif // ANTIDERIVATIVE_H
@@ -1,4 +1,5 @@
 #include "bitcrush_distortion.h"
+#include "../../core/dsp_math.h"
 #include "distortion_effect.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
@@ -148,7 +149,7 @@ float BitcrushDistortion::process_sample(float sample, const Ref<SynthNoteContex
 	float bit_depth_value = 1.0f + bit_depth * 15.0f;
 
 	// Calculate the number of possible values
-	float steps = powf(2.0f, bit_depth_value) - 1.0f;
+	float steps = DspMath::exp2(bit_depth_value) - 1.0f;
 
 	// Apply sample rate reduction (sample_rate is 0-1, where 0 is extreme reduction)
 	// Map sample_rate to a meaningful range (1-44100/2)
@@ -102,81 +102,136 @@ ClipDistortion::~ClipDistortion() {
 	// Clean up resources
 }
 
-// Fast approximation of tanh that's suitable for audio
-inline float fast_tanh(float x) {
-	float x2 = x * x;
-	return x * (27.0f + x2) / (27.0f + 9.0f * x2);
-}
-
-float ClipDistortion::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-	if (!context.is_valid())
-		return sample; // Return original sample if context is invalid
-
+ClipDistortion::Settings ClipDistortion::read_settings(const Ref<SynthNoteContext> &context) const {
 	// Get parameter values
-	float drive = 0.5f; // Default: 50% drive
-	float mix = 1.0f; // Default: 100% wet
-	float output_gain = 0.7f; // Default: 70% output gain
-	float threshold = 0.5f; // Default: medium threshold
-	float hardness = 0.5f; // Default: medium hardness
+	Settings settings;
 
 	Ref<ModulatedParameter> drive_param = get_parameter(PARAM_DRIVE);
 	if (drive_param.is_valid()) {
-		drive = drive_param->get_value(context);
+		settings.drive = drive_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> mix_param = get_parameter(PARAM_MIX);
 	if (mix_param.is_valid()) {
-		mix = mix_param->get_value(context);
+		settings.mix = mix_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> output_gain_param = get_parameter(PARAM_OUTPUT_GAIN);
 	if (output_gain_param.is_valid()) {
-		output_gain = output_gain_param->get_value(context);
+		settings.output_gain = output_gain_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> threshold_param = get_parameter(PARAM_THRESHOLD);
 	if (threshold_param.is_valid()) {
-		threshold = threshold_param->get_value(context);
+		settings.threshold = threshold_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> hardness_param = get_parameter(PARAM_HARDNESS);
 	if (hardness_param.is_valid()) {
-		hardness = hardness_param->get_value(context);
+		settings.hardness = hardness_param->get_value(context);
 	}
+	return settings;
+}
+
+float ClipDistortion::process_sample(float sample, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid())
+		return sample; // Return original sample if context is invalid
+
+	Settings settings = read_settings(context);
+	float mix = settings.mix;
+	float output_gain = settings.output_gain;
+	float hardness = settings.hardness;
 
 	// Scale drive to get more extreme effect at higher values
-	float scaled_drive = 1.0f + drive * 19.0f; // Range 1-20
+	float scaled_drive = 1.0f + settings.drive * 19.0f; // Range 1-20
 
 	// Apply threshold
-	float clip_level = threshold * 0.9f + 0.1f; // Range 0.1-1.0
+	float clip_level = settings.threshold * 0.9f + 0.1f; // Range 0.1-1.0
 
 	float input = sample;
-	float amplified = input * scaled_drive;
-	float distorted;
-
-	// Interpolate between soft and hard clipping based on hardness
-	if (hardness < 0.01f) {
-		// Pure soft clipping (tanh)
-		distorted = fast_tanh(amplified);
-	} else if (hardness > 0.99f) {
-		// Pure hard clipping
-		distorted = Math::clamp(amplified, -clip_level, clip_level);
-	} else {
-		// Mix between soft and hard clipping
-		float soft_clip = fast_tanh(amplified);
-		float hard_clip = Math::clamp(amplified, -clip_level, clip_level);
-		distorted = soft_clip * (1.0f - hardness) + hard_clip * hardness;
-	}
+	float distorted = oversample(input, [&](float x) {
+		return shape(x * scaled_drive, [&](double u, int order) {
+			// Interpolate between soft and hard clipping based on hardness
+			if (hardness < 0.01f) {
+				// Pure soft clipping (tanh)
+				return Antiderivatives::fast_tanh(u, order);
+			} else if (hardness > 0.99f) {
+				// Pure hard clipping
+				return Antiderivatives::clamp(u, -clip_level, clip_level, order);
+			}
+
+			// Mix between soft and hard clipping
+			double soft_clip = Antiderivatives::fast_tanh(u, order);
+			double hard_clip = Antiderivatives::clamp(u, -clip_level, clip_level, order);
+			return soft_clip * (1.0f - hardness) + hard_clip * hardness;
+		});
+	});
 
 	// Mix dry/wet
-	float output = input * (1.0f - mix) + distorted * mix;
+	float output = align_dry(input) * (1.0f - mix) + distorted * mix;
 
 	// Apply output gain
 	return output * output_gain;
 }
 
+void ClipDistortion::Kernel::begin(ClipDistortion *p_effect, int p_count, const Ref<SynthNoteContext> &context) {
+	Settings settings = p_effect->read_settings(context);
+	drive = 1.0f + settings.drive * 19.0f;
+	level = settings.threshold * 0.9f + 0.1f;
+	soft_weight = settings.hardness < 0.01f ? 1.0 : (settings.hardness > 0.99f ? 0.0 : 1.0f - settings.hardness);
+	hard_weight = settings.hardness < 0.01f ? 0.0 : (settings.hardness > 0.99f ? 1.0 : settings.hardness);
+	dry_gain = 1.0f - settings.mix;
+	wet_gain = settings.mix;
+	output_gain = settings.output_gain;
+}
+
+void ClipDistortion::process_lanes(const EffectLanes &p_lanes) {
+	constexpr int LANES = EffectLanes::MAX_LANES;
+	if (!is_plain_path(p_lanes)) {
+		SynthAudioEffect::process_lanes(p_lanes);
+		return;
+	}
+
+	// Each lane's kernel settings side by side, so lanes with different settings share one loop
+	float drive[LANES] = {};
+	double level[LANES] = {};
+	double soft_weight[LANES] = {};
+	double hard_weight[LANES] = {};
+	float dry_gain[LANES] = {};
+	float wet_gain[LANES] = {};
+	float output_gain[LANES] = {};
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		Kernel kernel;
+		kernel.begin(p_lanes.get_effect<ClipDistortion>(l), p_lanes.sample_count, p_lanes.contexts[l]);
+		drive[l] = kernel.drive;
+		level[l] = kernel.level;
+		soft_weight[l] = kernel.soft_weight;
+		hard_weight[l] = kernel.hard_weight;
+		dry_gain[l] = kernel.dry_gain;
+		wet_gain[l] = kernel.wet_gain;
+		output_gain[l] = kernel.output_gain;
+	}
+
+	float frames[EffectLanes::MAX_SAMPLES * LANES];
+	p_lanes.interleave(frames);
+	for (int n = 0; n < p_lanes.sample_count; n++) {
+		float *frame = frames + n * LANES;
+		for (int l = 0; l < LANES; l++) {
+			float input = frame[l];
+			double u = input * drive[l];
+			double u2 = u * u;
+			double soft_clip = u * (27.0 + u2) / (27.0 + 9.0 * u2);
+			double hard_clip = u > level[l] ? level[l] : (u < -level[l] ? -level[l] : u);
+			float distorted = static_cast<float>(soft_clip * soft_weight[l] + hard_clip * hard_weight[l]);
+			frame[l] = (input * dry_gain[l] + distorted * wet_gain[l]) * output_gain[l];
+		}
+	}
+	p_lanes.deinterleave(frames);
+}
+
 void ClipDistortion::reset() {
-	// No state to reset for this effect
+	// Only the oversampler keeps state for this effect
+	DistortionEffect::reset();
 }
 
 float ClipDistortion::get_tail_length() const {
@@ -209,6 +264,8 @@ Ref<SynthAudioEffect> ClipDistortion::duplicate() const {
 		}
 	}
 
+	copy_oversampling(new_effect.ptr());
+
 	return new_effect;
 }
 
@@ -1,12 +1,12 @@
 #ifndef CLIP_DISTORTION_H
 #define CLIP_DISTORTION_H
 
-#include "../synth_audio_effect.h"
+#include "distortion_effect.h"
 
 namespace godot {
 
-class ClipDistortion : public SynthAudioEffect {
-	GDCLASS(ClipDistortion, SynthAudioEffect)
+class ClipDistortion : public DistortionEffect {
+	GDCLASS(ClipDistortion, DistortionEffect)
 
 public:
 	// Parameter names
@@ -16,6 +16,46 @@ public:
 	static const char *PARAM_THRESHOLD;
 	static const char *PARAM_HARDNESS;
 
+private:
+	struct Settings {
+		float drive = 0.5f; // Default: 50% drive
+		float mix = 1.0f; // Default: 100% wet
+		float output_gain = 0.7f; // Default: 70% output gain
+		float threshold = 0.5f; // Default: medium threshold
+		float hardness = 0.5f; // Default: medium hardness
+	};
+
+	Settings read_settings(const Ref<SynthNoteContext> &context) const;
+
+public:
+	// The plain path of process_sample with the settings read once per block, for
+	// StaticEffectChain and the lane kernel
+	struct Kernel {
+		using Effect = ClipDistortion;
+
+		float drive = 1.0f;
+		double level = 1.0;
+		double soft_weight = 1.0;
+		double hard_weight = 0.0;
+		float dry_gain = 0.0f;
+		float wet_gain = 1.0f;
+		float output_gain = 1.0f;
+
+		static bool can_run(const ClipDistortion *p_effect) { return p_effect->is_plain(); }
+		void begin(ClipDistortion *p_effect, int p_count, const Ref<SynthNoteContext> &context);
+		void end() {}
+
+		// Both clippers run and the hardness picks the blend
+		float process(float p_input) const {
+			double u = p_input * drive;
+			double u2 = u * u;
+			double soft_clip = u * (27.0 + u2) / (27.0 + 9.0 * u2);
+			double hard_clip = u > level ? level : (u < -level ? -level : u);
+			float distorted = static_cast<float>(soft_clip * soft_weight + hard_clip * hard_weight);
+			return (p_input * dry_gain + distorted * wet_gain) * output_gain;
+		}
+	};
+
 protected:
 	static void _bind_methods();
 
@@ -35,6 +75,7 @@ public:
 	float get_hardness_base_value() const;
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_lanes(const EffectLanes &p_lanes) override;
 	void reset() override;
 	float get_tail_length() const override;
 	Ref<SynthAudioEffect> duplicate() const override;
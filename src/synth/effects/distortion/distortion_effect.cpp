@@ -1,6 +1,7 @@
 #include "distortion_effect.h"
 
 #include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/math.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
 namespace godot {
@@ -28,6 +29,135 @@ DistortionEffect::~DistortionEffect() {
 }
 
 void DistortionEffect::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_oversampling", "factor"), &DistortionEffect::set_oversampling);
+	ClassDB::bind_method(D_METHOD("get_oversampling"), &DistortionEffect::get_oversampling);
+	ClassDB::bind_method(D_METHOD("set_oversampling_phase", "phase"), &DistortionEffect::set_oversampling_phase);
+	ClassDB::bind_method(D_METHOD("get_oversampling_phase"), &DistortionEffect::get_oversampling_phase);
+	ClassDB::bind_method(D_METHOD("set_antialiasing", "antialiasing"), &DistortionEffect::set_antialiasing);
+	ClassDB::bind_method(D_METHOD("get_antialiasing"), &DistortionEffect::get_antialiasing);
+	ClassDB::bind_method(D_METHOD("get_latency_samples"), &DistortionEffect::get_latency_samples);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "oversampling", PROPERTY_HINT_ENUM, "1x:1,2x:2,4x:4,8x:8"),
+			"set_oversampling", "get_oversampling");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "oversampling_phase", PROPERTY_HINT_ENUM, "Linear,Minimum"),
+			"set_oversampling_phase", "get_oversampling_phase");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "antialiasing", PROPERTY_HINT_ENUM, "None,ADAA First Order,ADAA Second Order"),
+			"set_antialiasing", "get_antialiasing");
+
+	BIND_ENUM_CONSTANT(OVERSAMPLING_LINEAR_PHASE);
+	BIND_ENUM_CONSTANT(OVERSAMPLING_MINIMUM_PHASE);
+	BIND_ENUM_CONSTANT(ANTIALIASING_NONE);
+	BIND_ENUM_CONSTANT(ANTIALIASING_ADAA_FIRST_ORDER);
+	BIND_ENUM_CONSTANT(ANTIALIASING_ADAA_SECOND_ORDER);
+}
+
+void DistortionEffect::update_antialiasing() {
+	int factor = Oversampler::get_supported_factor(MIN(oversampling, max_oversampling));
+	Oversampler::Phase phase = static_cast<Oversampler::Phase>(oversampling_phase);
+	if (factor != oversampler.get_factor() || phase != oversampler.get_phase()) {
+		oversampler.setup(factor, phase);
+	}
+	antiderivative.set_order(static_cast<AntiderivativeShaper::Order>(antialiasing));
+	revision.fetch_add(1, std::memory_order_relaxed);
+
+	// The dry path waits for the wet one, to the nearest sample
+	int length = MIN(static_cast<int>(Math::round(get_latency_samples())), MAX_DRY_DELAY);
+	if (length == dry_delay_length) {
+		return;
+	}
+	dry_delay_length = length;
+	dry_delay_pos = 0;
+	for (int i = 0; i < MAX_DRY_DELAY; i++) {
+		dry_delay[i] = 0.0f;
+	}
+}
+
+float DistortionEffect::align_dry(float p_sample) {
+	if (dry_delay_length == 0) {
+		return p_sample;
+	}
+	float delayed = dry_delay[dry_delay_pos];
+	dry_delay[dry_delay_pos] = p_sample;
+	dry_delay_pos = (dry_delay_pos + 1) % dry_delay_length;
+	return delayed;
+}
+
+void DistortionEffect::copy_oversampling(DistortionEffect *p_target) const {
+	p_target->set_oversampling(oversampling);
+	p_target->set_oversampling_phase(oversampling_phase);
+	p_target->set_antialiasing(antialiasing);
+}
+
+void DistortionEffect::reset() {
+	oversampler.reset();
+	antiderivative.reset();
+	dry_delay_pos = 0;
+	for (int i = 0; i < MAX_DRY_DELAY; i++) {
+		dry_delay[i] = 0.0f;
+	}
+}
+
+void DistortionEffect::apply_quality(const SynthQualityProfile::Settings &p_settings) {
+	max_oversampling = p_settings.max_oversampling;
+	update_antialiasing();
+}
+
+void DistortionEffect::set_oversampling(int p_factor) {
+	oversampling = Oversampler::get_supported_factor(p_factor);
+	update_antialiasing();
+}
+
+int DistortionEffect::get_oversampling() const {
+	return oversampling;
+}
+
+void DistortionEffect::set_oversampling_phase(OversamplingPhase p_phase) {
+	oversampling_phase = p_phase;
+	update_antialiasing();
+}
+
+DistortionEffect::OversamplingPhase DistortionEffect::get_oversampling_phase() const {
+	return oversampling_phase;
+}
+
+void DistortionEffect::set_antialiasing(Antialiasing p_antialiasing) {
+	antialiasing = p_antialiasing;
+	update_antialiasing();
+}
+
+DistortionEffect::Antialiasing DistortionEffect::get_antialiasing() const {
+	return antialiasing;
+}
+
+bool DistortionEffect::is_constantly_dry() const {
+	// With latency the dry signal comes out delayed
+	return get_latency_samples() == 0.0f && has_constant_value(PARAM_MIX, 0.0f);
+}
+
+bool DistortionEffect::get_constant_gain(float &r_gain) const {
+	// Only the output gain is left of (dry * (1 - mix) + wet * mix) * output_gain
+	return is_constantly_dry() && get_constant_parameter(PARAM_OUTPUT_GAIN, r_gain);
+}
+
+bool DistortionEffect::is_plain_path(const EffectLanes &p_lanes) {
+	if (p_lanes.sample_count > EffectLanes::MAX_SAMPLES) {
+		return false;
+	}
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		if (!p_lanes.contexts[l].is_valid() || !p_lanes.get_effect<DistortionEffect>(l)->is_plain()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DistortionEffect::is_plain() const {
+	return oversampler.get_factor() == 1 && antiderivative.get_order() == AntiderivativeShaper::ORDER_NONE;
+}
+
+float DistortionEffect::get_latency_samples() const {
+	// The antiderivative shaper runs at the oversampled rate
+	return oversampler.get_latency() + antiderivative.get_delay() / oversampler.get_factor();
 }
 
 } //namespace godot
@@ -1,6 +1,8 @@
 #ifndef DISTORTION_EFFECT_H
 #define DISTORTION_EFFECT_H
 
+#include "../oversampler.h"
+#include "antiderivative.h"
 #include "../synth_audio_effect.h"
 
 namespace godot {
@@ -17,19 +19,80 @@ enum DistortionType {
 	RECTIFY_FULL
 };
 
+// Base of the waveshaping distortions.
+// Subclasses run their nonlinear core through oversample() so it can be evaluated at
+// 2x, 4x or 8x the sample rate, pass the waveshaper inside it through shape() so it can
+// use antiderivative anti-aliasing, and blend their dry signal through align_dry() so
+// it stays in time with the delayed wet signal.
 class DistortionEffect : public SynthAudioEffect {
 	GDCLASS(DistortionEffect, SynthAudioEffect)
 
+public:
+	enum OversamplingPhase {
+		OVERSAMPLING_LINEAR_PHASE = Oversampler::PHASE_LINEAR,
+		OVERSAMPLING_MINIMUM_PHASE = Oversampler::PHASE_MINIMUM
+	};
+
+	enum Antialiasing {
+		ANTIALIASING_NONE = AntiderivativeShaper::ORDER_NONE,
+		ANTIALIASING_ADAA_FIRST_ORDER = AntiderivativeShaper::ORDER_FIRST,
+		ANTIALIASING_ADAA_SECOND_ORDER = AntiderivativeShaper::ORDER_SECOND
+	};
+
 private:
 	// Bitcrushing state
 	float sample_hold = 0.0f;
 	int sample_counter = 0;
 
+	// Oversampling
+	Oversampler oversampler;
+	int oversampling = 1;
+	OversamplingPhase oversampling_phase = OVERSAMPLING_LINEAR_PHASE;
+	int max_oversampling = Oversampler::MAX_FACTOR; // Upper bound set by the quality tier
+
+	// Antiderivative anti-aliasing
+	AntiderivativeShaper antiderivative;
+	Antialiasing antialiasing = ANTIALIASING_NONE;
+
+	// Dry signal delay matching the oversampler latency
+	static constexpr int MAX_DRY_DELAY = 32;
+	float dry_delay[MAX_DRY_DELAY] = {};
+	int dry_delay_length = 0;
+	int dry_delay_pos = 0;
+
+	void update_antialiasing();
+
 	// Parameter names
 
 protected:
 	static void _bind_methods();
 
+	// Evaluate p_core on the oversampled input and return it at the original rate
+	template <typename F>
+	float oversample(float p_sample, F &&p_core) {
+		return oversampler.process(p_sample, p_core);
+	}
+
+	// Waveshaper given as p_eval(u, order): f(u), its first or its second antiderivative
+	// for order 0, 1 or 2. See Antiderivatives for the shapes used by the distortions.
+	template <typename F>
+	float shape(float p_input, F &&p_eval) {
+		return antiderivative.process(p_input, p_eval);
+	}
+
+	// Delay a dry sample by the latency of the wet path
+	float align_dry(float p_sample);
+
+	// Copy the oversampling settings onto a duplicate
+	void copy_oversampling(DistortionEffect *p_target) const;
+
+	// Whether every lane runs the plain path, without oversampling, antialiasing or dry
+	// delay, which is the one lane kernels vectorize across voices
+	static bool is_plain_path(const EffectLanes &p_lanes);
+
+	// Whether the mix stays at 0 and the dry signal passes without delay
+	bool is_constantly_dry() const;
+
 public:
 	static const char *PARAM_DRIVE;
 	static const char *PARAM_MIX;
@@ -38,8 +101,32 @@ public:
 	~DistortionEffect();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override = 0;
+	void reset() override;
+	void apply_quality(const SynthQualityProfile::Settings &p_settings) override;
+	bool get_constant_gain(float &r_gain) const override;
+
+	// Oversampling factor of the nonlinear core: 1, 2, 4 or 8
+	void set_oversampling(int p_factor);
+	int get_oversampling() const;
+
+	void set_oversampling_phase(OversamplingPhase p_phase);
+	OversamplingPhase get_oversampling_phase() const;
+
+	// Cheaper alternative or complement to oversampling
+	void set_antialiasing(Antialiasing p_antialiasing);
+	Antialiasing get_antialiasing() const;
+
+	// Delay added by oversampling and antialiasing, in samples
+	float get_latency_samples() const;
+
+	// Without oversampling or antialiasing, so the core runs once per sample and the dry
+	// signal isn't delayed
+	bool is_plain() const;
 };
 
 } // namespace godot
 
+VARIANT_ENUM_CAST(DistortionEffect::OversamplingPhase);
+VARIANT_ENUM_CAST(DistortionEffect::Antialiasing);
+
 #endif // DISTORTION_EFFECT_H
@@ -147,33 +147,23 @@ float FoldbackDistortion::process_sample(float sample, const Ref<SynthNoteContex
 	int max_iterations = 1 + static_cast<int>(iterations_norm * 9.0f);
 
 	float input = sample;
-	float x = input * scaled_drive;
-
-	// Apply foldback distortion with multiple iterations
-	for (int iter = 0; iter < max_iterations; iter++) {
-		if (x > t || x < -t) {
-			if (x > t) {
-				x = 2.0f * t - x;
-			} else if (x < -t) {
-				x = -2.0f * t - x;
-			}
-		} else {
-			// If we're within threshold, no need for more iterations
-			break;
-		}
-	}
-
-	float distorted = x;
+	float distorted = oversample(input, [&](float x) {
+		// Reflect at the threshold up to max_iterations times
+		return shape(x * scaled_drive, [&](double u, int order) {
+			return Antiderivatives::foldback(u, t, max_iterations, order);
+		});
+	});
 
 	// Mix dry/wet
-	float output = input * (1.0f - mix) + distorted * mix;
+	float output = align_dry(input) * (1.0f - mix) + distorted * mix;
 
 	// Apply output gain
 	return output * output_gain;
 }
 
 void FoldbackDistortion::reset() {
-	// No state to reset for this effect
+	// Only the oversampler keeps state for this effect
+	DistortionEffect::reset();
 }
 
 float FoldbackDistortion::get_tail_length() const {
@@ -206,6 +196,8 @@ Ref<SynthAudioEffect> FoldbackDistortion::duplicate() const {
 		}
 	}
 
+	copy_oversampling(new_effect.ptr());
+
 	return new_effect;
 }
 
@@ -1,12 +1,12 @@
 #ifndef FOLDBACK_DISTORTION_H
 #define FOLDBACK_DISTORTION_H
 
-#include "../synth_audio_effect.h"
+#include "distortion_effect.h"
 
 namespace godot {
 
-class FoldbackDistortion : public SynthAudioEffect {
-	GDCLASS(FoldbackDistortion, SynthAudioEffect)
+class FoldbackDistortion : public DistortionEffect {
+	GDCLASS(FoldbackDistortion, DistortionEffect)
 
 public:
 	// Parameter names
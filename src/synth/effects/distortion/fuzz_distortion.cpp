@@ -1,4 +1,6 @@
 #include "fuzz_distortion.h"
+#include "../../core/dsp_math.h"
+#include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -110,6 +112,55 @@ FuzzDistortion::~FuzzDistortion() {
 	// Cleanup if needed
 }
 
+namespace {
+
+// Double precision for building the table, float for the shaper output
+double modern_fuzz(double p_u) {
+	double shaped = std::tanh(p_u);
+	return shaped * 0.7 + std::tanh(shaped * shaped * shaped) * 0.3;
+}
+
+float fast_modern_fuzz(float p_u) {
+	float shaped = DspMath::tanh(p_u);
+	return shaped * 0.7f + DspMath::tanh(shaped * shaped * shaped) * 0.3f;
+}
+
+const AntiderivativeTable modern_fuzz_table(&modern_fuzz, &fast_modern_fuzz, 20.0, 64);
+
+// tanh(c v), F1 and F2 scale by 1 / c and 1 / c^2
+double scaled_tanh(double p_v, double p_c, int p_order) {
+	if (std::abs(p_c) < 1.0e-6) {
+		// tanh is linear this close to zero
+		return p_order == 0 ? p_c * p_v : (p_order == 1 ? p_c * p_v * p_v * 0.5 : p_c * p_v * p_v * p_v / 6.0);
+	}
+	double scale = p_order == 0 ? 1.0 : (p_order == 1 ? p_c : p_c * p_c);
+	return Antiderivatives::tanh(p_c * p_v, p_order) / scale;
+}
+
+// Silent below the gate threshold, clipped to +-1 above it
+double gated_clip(double p_v, double p_drive, int p_order) {
+	const double threshold = 0.1;
+	double a = std::abs(p_v);
+	if (a <= threshold) {
+		return 0.0;
+	}
+	if (p_order == 0) {
+		return Antiderivatives::clamp(p_v * p_drive, -1.0, 1.0, 0);
+	}
+
+	// Integrate from the gate threshold, F1 is even and F2 is odd
+	double edge1 = Antiderivatives::clamp(threshold * p_drive, -1.0, 1.0, 1) / p_drive;
+	double f1 = Antiderivatives::clamp(a * p_drive, -1.0, 1.0, 1) / p_drive - edge1;
+	if (p_order == 1) {
+		return f1;
+	}
+	double edge2 = Antiderivatives::clamp(threshold * p_drive, -1.0, 1.0, 2) / (p_drive * p_drive);
+	double f2 = Antiderivatives::clamp(a * p_drive, -1.0, 1.0, 2) / (p_drive * p_drive) - edge2 - edge1 * (a - threshold);
+	return p_v < 0.0 ? -f2 : f2;
+}
+
+} // namespace
+
 float FuzzDistortion::process_sample(float sample, const Ref<SynthNoteContext> &context) {
 	if (!context.is_valid())
 		return sample; // Return original sample if context is invalid
@@ -159,62 +210,38 @@ float FuzzDistortion::process_sample(float sample, const Ref<SynthNoteContext> &
 	float scaled_drive = drive * 40.0f + 1.0f; // Scale drive for more extreme effect
 
 	float input = sample;
-	float wet_signal = 0.0f;
-
-	// Apply different fuzz algorithms based on type
-	switch (fuzz_type) {
-		case FUZZ_CLASSIC: {
-			// Classic fuzz: hard clipping with asymmetry
-			float asymmetry = 0.2f;
-			float clipped = input * scaled_drive;
-
-			// Apply asymmetric clipping
-			if (clipped > 1.0f) {
-				clipped = 1.0f;
-			} else if (clipped < -1.0f + asymmetry) {
-				clipped = -1.0f + asymmetry;
-			}
-
-			wet_signal = clipped;
-			break;
+	float wet_signal = oversample(input, [&](float x) {
+		// Apply different fuzz algorithms based on type
+		switch (fuzz_type) {
+			case FUZZ_CLASSIC:
+				// Classic fuzz: hard clipping with asymmetry
+				return shape(x * scaled_drive, [&](double u, int order) {
+					float asymmetry = 0.2f;
+					return Antiderivatives::clamp(u, -1.0 + asymmetry, 1.0, order);
+				});
+
+			case FUZZ_MODERN:
+				// Modern fuzz: smoother distortion with more harmonics
+				return shape(x * scaled_drive, [&](double u, int order) {
+					return modern_fuzz_table.evaluate(u, order);
+				});
+
+			case FUZZ_OCTAVE:
+				// Octave fuzz: adds upper octave by mixing in the rectified signal,
+				// tanh(2 (0.6 x + 0.4 drive |x|)) has a different slope either side of zero
+				return shape(x, [&](double v, int order) {
+					double slope = v > 0.0 ? 0.6 + 0.4 * scaled_drive : 0.6 - 0.4 * scaled_drive;
+					return scaled_tanh(v, slope * 2.0, order);
+				});
+
+			case FUZZ_GATED:
+				// Gated fuzz: creates a "sputtery" sound with a noise gate
+				return shape(x, [&](double v, int order) {
+					return gated_clip(v, scaled_drive, order);
+				});
 		}
-
-		case FUZZ_MODERN: {
-			// Modern fuzz: smoother distortion with more harmonics
-			float shaped = Math::tanh(input * scaled_drive);
-
-			// Add some higher harmonics
-			wet_signal = shaped * 0.7f + Math::tanh(shaped * shaped * shaped) * 0.3f;
-			break;
-		}
-
-		case FUZZ_OCTAVE: {
-			// Octave fuzz: adds upper octave by rectifying
-			float rectified = Math::abs(input); // Full-wave rectification
-
-			// Mix original signal with rectified signal
-			wet_signal = input * 0.6f + rectified * 0.4f * scaled_drive;
-
-			// Apply soft clipping
-			wet_signal = Math::tanh(wet_signal * 2.0f);
-			break;
-		}
-
-		case FUZZ_GATED: {
-			// Gated fuzz: creates a "sputtery" sound with a noise gate
-			float threshold = 0.1f;
-			float gated = (Math::abs(input) > threshold) ? input * scaled_drive : 0.0f;
-
-			// Apply hard clipping
-			if (gated > 1.0f)
-				gated = 1.0f;
-			if (gated < -1.0f)
-				gated = -1.0f;
-
-			wet_signal = gated;
-			break;
-		}
-	}
+		return 0.0f;
+	});
 
 	// Apply tone control (simple low-pass and high-pass filtering)
 	lp_state = lp_state * lp_coeff + wet_signal * (1.0f - lp_coeff);
@@ -226,15 +253,26 @@ float FuzzDistortion::process_sample(float sample, const Ref<SynthNoteContext> &
 	wet_signal *= output_gain * 2.0f; // Scale output gain
 
 	// Mix dry and wet signals
-	return input * (1.0f - mix) + wet_signal * mix;
+	return align_dry(input) * (1.0f - mix) + wet_signal * mix;
 }
 
 void FuzzDistortion::reset() {
+	DistortionEffect::reset();
+
 	// Reset filter states
 	lp_state = 0.0f;
 	hp_state = 0.0f;
 }
 
+bool FuzzDistortion::get_constant_gain(float &r_gain) const {
+	// The output gain only scales the wet signal, a dry mix passes the input unchanged
+	if (!is_constantly_dry()) {
+		return false;
+	}
+	r_gain = 1.0f;
+	return true;
+}
+
 Ref<SynthAudioEffect> FuzzDistortion::duplicate() const {
 	Ref<FuzzDistortion> new_effect = memnew(FuzzDistortion);
 
@@ -250,6 +288,8 @@ Ref<SynthAudioEffect> FuzzDistortion::duplicate() const {
 		}
 	}
 
+	copy_oversampling(new_effect.ptr());
+
 	return new_effect;
 }
 
@@ -49,6 +49,7 @@ public:
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
 	Ref<SynthAudioEffect> duplicate() const override;
 
 	// Parameter accessors
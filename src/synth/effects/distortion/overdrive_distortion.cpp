@@ -1,4 +1,5 @@
 #include "overdrive_distortion.h"
+#include "../../core/dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -151,36 +152,36 @@ float OverdriveDistortion::process_sample(float sample, const Ref<SynthNoteConte
 	float lp_freq = 1000.0f + tone * 15000.0f; // 1kHz to 16kHz
 	float hp_freq = 20.0f + (1.0f - tone) * 980.0f; // 20Hz to 1kHz
 
-	float lp_coeff = std::exp(-2.0f * Math_PI * lp_freq / sample_rate);
-	float hp_coeff = std::exp(-2.0f * Math_PI * hp_freq / sample_rate);
+	float lp_coeff = DspMath::one_pole_coefficient(lp_freq, sample_rate);
+	float hp_coeff = DspMath::one_pole_coefficient(hp_freq, sample_rate);
 
 	float input = sample;
 
-	// Apply drive
-	float x = input * scaled_drive;
-
-	float distorted;
-
-	// Apply different overdrive algorithms based on character
-	if (character < 0.33f) {
-		// Smooth overdrive: y = x/(1+|x|)
-		float character_factor = character * 3.0f; // 0 to 1 within this range
-		float smooth = x / (1.0f + std::abs(x));
-		float medium = x / (1.0f + std::abs(x) * 0.5f);
-		distorted = smooth * (1.0f - character_factor) + medium * character_factor;
-	} else if (character < 0.66f) {
-		// Medium overdrive: y = x/(1+|x|*0.5)
-		float character_factor = (character - 0.33f) * 3.0f; // 0 to 1 within this range
-		float medium = x / (1.0f + std::abs(x) * 0.5f);
-		float hard = std::tanh(x);
-		distorted = medium * (1.0f - character_factor) + hard * character_factor;
-	} else {
-		// Aggressive overdrive: y = tanh(x)
-		float character_factor = (character - 0.66f) * 3.0f; // 0 to 1 within this range
-		float hard = std::tanh(x);
-		float very_hard = x > 0.0f ? 1.0f - std::exp(-x) : -1.0f + std::exp(x);
-		distorted = hard * (1.0f - character_factor) + very_hard * character_factor;
-	}
+	float distorted = oversample(input, [&](float x) {
+		// Apply drive
+		return shape(x * scaled_drive, [&](double u, int order) {
+			// Apply different overdrive algorithms based on character
+			if (character < 0.33f) {
+				// Smooth overdrive: y = x/(1+|x|)
+				double character_factor = character * 3.0f; // 0 to 1 within this range
+				double smooth = Antiderivatives::ratio(u, 1.0, order);
+				double medium = 2.0 * Antiderivatives::ratio(u, 2.0, order);
+				return smooth * (1.0 - character_factor) + medium * character_factor;
+			} else if (character < 0.66f) {
+				// Medium overdrive: y = x/(1+|x|*0.5)
+				double character_factor = (character - 0.33f) * 3.0f; // 0 to 1 within this range
+				double medium = 2.0 * Antiderivatives::ratio(u, 2.0, order);
+				double hard = Antiderivatives::tanh(u, order);
+				return medium * (1.0 - character_factor) + hard * character_factor;
+			}
+
+			// Aggressive overdrive: y = tanh(x)
+			double character_factor = (character - 0.66f) * 3.0f; // 0 to 1 within this range
+			double hard = Antiderivatives::tanh(u, order);
+			double very_hard = Antiderivatives::exp_saturate(u, order);
+			return hard * (1.0 - character_factor) + very_hard * character_factor;
+		});
+	});
 
 	// Apply tone control (simple high/low pass filtering)
 	// Low-pass filter
@@ -192,13 +193,15 @@ float OverdriveDistortion::process_sample(float sample, const Ref<SynthNoteConte
 	distorted = hp_state;
 
 	// Mix dry/wet
-	float output = input * (1.0f - mix) + distorted * mix;
+	float output = align_dry(input) * (1.0f - mix) + distorted * mix;
 
 	// Apply output gain
 	return output * output_gain;
 }
 
 void OverdriveDistortion::reset() {
+	DistortionEffect::reset();
+
 	// Reset filter states
 	lp_state = 0.0f;
 	hp_state = 0.0f;
@@ -234,6 +237,8 @@ Ref<SynthAudioEffect> OverdriveDistortion::duplicate() const {
 		}
 	}
 
+	copy_oversampling(new_effect.ptr());
+
 	return new_effect;
 }
 
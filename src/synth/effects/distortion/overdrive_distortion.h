@@ -1,12 +1,12 @@
 #ifndef OVERDRIVE_DISTORTION_H
 #define OVERDRIVE_DISTORTION_H
 
-#include "../synth_audio_effect.h"
+#include "distortion_effect.h"
 
 namespace godot {
 
-class OverdriveDistortion : public SynthAudioEffect {
-	GDCLASS(OverdriveDistortion, SynthAudioEffect)
+class OverdriveDistortion : public DistortionEffect {
+	GDCLASS(OverdriveDistortion, DistortionEffect)
 
 public:
 	// Parameter names
@@ -106,85 +106,144 @@ RectifierDistortion::~RectifierDistortion() {
 	// Nothing to clean up
 }
 
-float RectifierDistortion::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-	if (!context.is_valid())
-		return sample; // Return original sample if context is invalid
-
+RectifierDistortion::Settings RectifierDistortion::read_settings(const Ref<SynthNoteContext> &context) const {
 	// Get parameter values
-	int mode = HALF_WAVE; // Default mode
-	float asymmetry = 0.5f; // Default asymmetry (symmetric)
-	float drive = 0.5f; // Default drive
-	float mix = 1.0f; // Default mix (100% wet)
-	float output_gain = 1.0f; // Default output gain
+	Settings settings;
 
 	Ref<ModulatedParameter> mode_param = get_parameter(PARAM_MODE);
 	if (mode_param.is_valid()) {
-		mode = static_cast<int>(mode_param->get_value(context));
+		settings.mode = static_cast<int>(mode_param->get_value(context));
 	}
 
 	Ref<ModulatedParameter> asymmetry_param = get_parameter(PARAM_ASYMMETRY);
 	if (asymmetry_param.is_valid()) {
-		asymmetry = asymmetry_param->get_value(context);
+		settings.asymmetry = asymmetry_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> drive_param = get_parameter(PARAM_DRIVE);
 	if (drive_param.is_valid()) {
-		drive = drive_param->get_value(context);
+		settings.drive = drive_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> mix_param = get_parameter(PARAM_MIX);
 	if (mix_param.is_valid()) {
-		mix = mix_param->get_value(context);
+		settings.mix = mix_param->get_value(context);
 	}
 
 	Ref<ModulatedParameter> output_gain_param = get_parameter(PARAM_OUTPUT_GAIN);
 	if (output_gain_param.is_valid()) {
-		output_gain = output_gain_param->get_value(context);
+		settings.output_gain = output_gain_param->get_value(context);
 	}
+	return settings;
+}
 
-	// Scale drive for more useful range (0.1 to 10)
-	drive = 0.1f + drive * 9.9f;
-
-	float input = sample;
-	float dry = input;
-
-	// Apply drive (pre-gain)
-	input *= drive;
-
-	// Apply rectification based on mode
-	switch (mode) {
+void RectifierDistortion::get_slopes(const Settings &p_settings, double &r_positive, double &r_negative) {
+	switch (p_settings.mode) {
 		case HALF_WAVE:
 			// Half-wave rectification (keep only positive values)
-			input = input > 0.0f ? input : 0.0f;
+			r_positive = 1.0;
+			r_negative = 0.0;
 			break;
 
 		case FULL_WAVE:
 			// Full-wave rectification (convert negative to positive)
-			input = std::abs(input);
+			r_positive = 1.0;
+			r_negative = -1.0;
 			break;
 
 		case ASYMMETRIC:
-			// Asymmetric rectification (different scaling for positive and negative)
-			if (input > 0.0f) {
-				// Scale positive values by asymmetry
-				input *= asymmetry * 2.0f;
-			} else {
-				// Scale negative values by (1-asymmetry)
-				input *= (1.0f - asymmetry) * 2.0f;
-				input = -input; // Flip to positive
-			}
+			// Asymmetric rectification: positive values scaled by asymmetry,
+			// negative values by (1-asymmetry) and flipped to positive
+			r_positive = p_settings.asymmetry * 2.0;
+			r_negative = -(1.0 - p_settings.asymmetry) * 2.0;
+			break;
+
+		default:
+			r_positive = 1.0;
+			r_negative = 1.0;
 			break;
 	}
+}
+
+float RectifierDistortion::process_sample(float sample, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid())
+		return sample; // Return original sample if context is invalid
+
+	Settings settings = read_settings(context);
+	float mix = settings.mix;
+
+	// Scale drive for more useful range (0.1 to 10)
+	float drive = 0.1f + settings.drive * 9.9f;
+
+	double positive;
+	double negative;
+	get_slopes(settings, positive, negative);
+
+	float dry = align_dry(sample);
+
+	float input = oversample(sample, [&](float x) {
+		// Apply drive (pre-gain)
+		return shape(x * drive, [&](double u, int order) {
+			return Antiderivatives::rectify(u, positive, negative, order);
+		});
+	});
 
 	// Apply output gain
-	input *= output_gain;
+	input *= settings.output_gain;
 
 	// Mix dry and wet signals
 	return dry * (1.0f - mix) + input * mix;
 }
 
+void RectifierDistortion::process_lanes(const EffectLanes &p_lanes) {
+	constexpr int LANES = EffectLanes::MAX_LANES;
+	if (!is_plain_path(p_lanes)) {
+		SynthAudioEffect::process_lanes(p_lanes);
+		return;
+	}
+
+	// The mode only picks the two slopes, so lanes in different modes share one loop
+	float drive[LANES] = {};
+	double positive[LANES] = {};
+	double negative[LANES] = {};
+	float dry_gain[LANES] = {};
+	float wet_gain[LANES] = {};
+	float output_gain[LANES] = {};
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		Settings settings = p_lanes.get_effect<RectifierDistortion>(l)->read_settings(p_lanes.contexts[l]);
+		drive[l] = 0.1f + settings.drive * 9.9f;
+		get_slopes(settings, positive[l], negative[l]);
+		dry_gain[l] = 1.0f - settings.mix;
+		wet_gain[l] = settings.mix;
+		output_gain[l] = settings.output_gain;
+	}
+
+	float frames[EffectLanes::MAX_SAMPLES * LANES];
+	p_lanes.interleave(frames);
+	for (int n = 0; n < p_lanes.sample_count; n++) {
+		float *frame = frames + n * LANES;
+		for (int l = 0; l < LANES; l++) {
+			float input = frame[l];
+			double u = input * drive[l];
+			float wet = static_cast<float>((u > 0.0 ? positive[l] : negative[l]) * u) * output_gain[l];
+			frame[l] = input * dry_gain[l] + wet * wet_gain[l];
+		}
+	}
+	p_lanes.deinterleave(frames);
+}
+
 void RectifierDistortion::reset() {
-	// No internal state to reset
+	// Only the oversampler keeps state for this effect
+	DistortionEffect::reset();
+}
+
+bool RectifierDistortion::get_constant_gain(float &r_gain) const {
+	// Output gain is applied before the mix, so a dry mix leaves the input as it is
+	if (!is_constantly_dry()) {
+		return false;
+	}
+	r_gain = 1.0f;
+	return true;
 }
 
 float RectifierDistortion::get_tail_length() const {
@@ -208,6 +267,8 @@ Ref<SynthAudioEffect> RectifierDistortion::duplicate() const {
 		}
 	}
 
+	copy_oversampling(copy.ptr());
+
 	return copy;
 }
 
@@ -24,11 +24,29 @@ public:
 		ASYMMETRIC
 	};
 
+private:
+	struct Settings {
+		int mode = HALF_WAVE; // Default mode
+		float asymmetry = 0.5f; // Default asymmetry (symmetric)
+		float drive = 0.5f; // Default drive
+		float mix = 1.0f; // Default mix (100% wet)
+		float output_gain = 1.0f; // Default output gain
+	};
+
+	Settings read_settings(const Ref<SynthNoteContext> &context) const;
+
+	// Gains above and below zero for the mode
+	static void get_slopes(const Settings &p_settings, double &r_positive, double &r_negative);
+
+public:
+
 	RectifierDistortion();
 	~RectifierDistortion();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_lanes(const EffectLanes &p_lanes) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
 	float get_tail_length() const override;
 	Ref<SynthAudioEffect> duplicate() const override;
 
@@ -143,49 +143,51 @@ float WaveShaperDistortion::process_sample(float sample, const Ref<SynthNoteCont
 
 	// Apply symmetry (bias the input signal)
 	float symmetry_offset = (symmetry - 0.5f) * 0.5f; // Range -0.25 to 0.25
-	float biased_input = input + symmetry_offset;
-
-	// Apply drive
-	float x = biased_input * scaled_drive;
-
-	// Clamp input to prevent extreme values
-	x = Math::clamp(x, -1.5f, 1.5f);
-
-	float distorted;
-
-	// Apply different waveshaping functions based on shape parameter
-	if (shape < 0.33f) {
-		// Sine-like shape (softer)
-		// y = sin(x * π/2)
-		float shape_factor = shape * 3.0f; // 0 to 1 within this range
-		float sine_shape = std::sin(x * Math_PI * 0.5f);
-		float cubic_shape = 1.5f * x - 0.5f * x * x * x;
-		distorted = sine_shape * (1.0f - shape_factor) + cubic_shape * shape_factor;
-	} else if (shape < 0.66f) {
-		// Cubic shape (medium)
-		// y = 1.5x - 0.5x³
-		float shape_factor = (shape - 0.33f) * 3.0f; // 0 to 1 within this range
-		float cubic_shape = 1.5f * x - 0.5f * x * x * x;
-		float arctan_shape = (2.0f / Math_PI) * std::atan(x * Math_PI * 0.5f);
-		distorted = cubic_shape * (1.0f - shape_factor) + arctan_shape * shape_factor;
-	} else {
-		// Arctangent shape (harder)
-		// y = (2/π) * atan(x * π/2)
-		float shape_factor = (shape - 0.66f) * 3.0f; // 0 to 1 within this range
-		float arctan_shape = (2.0f / Math_PI) * std::atan(x * Math_PI * 0.5f);
-		float hard_shape = x / (std::abs(x) + 0.2f); // More aggressive shape
-		distorted = arctan_shape * (1.0f - shape_factor) + hard_shape * shape_factor;
-	}
+
+	float distorted = oversample(input, [&](float x) {
+		float biased_input = x + symmetry_offset;
+
+		// Apply drive
+		return DistortionEffect::shape(biased_input * scaled_drive, [&](double u, int order) {
+			// Clamp input to prevent extreme values
+			return Antiderivatives::limit(u, 1.5, order, [&](double v, int limited_order) {
+				// Apply different waveshaping functions based on shape parameter
+				if (shape < 0.33f) {
+					// Sine-like shape (softer)
+					// y = sin(x * π/2)
+					double shape_factor = shape * 3.0f; // 0 to 1 within this range
+					double sine_shape = Antiderivatives::sine(v, limited_order);
+					double cubic_shape = Antiderivatives::cubic(v, limited_order);
+					return sine_shape * (1.0 - shape_factor) + cubic_shape * shape_factor;
+				} else if (shape < 0.66f) {
+					// Cubic shape (medium)
+					// y = 1.5x - 0.5x³
+					double shape_factor = (shape - 0.33f) * 3.0f; // 0 to 1 within this range
+					double cubic_shape = Antiderivatives::cubic(v, limited_order);
+					double arctan_shape = Antiderivatives::arctan(v, limited_order);
+					return cubic_shape * (1.0 - shape_factor) + arctan_shape * shape_factor;
+				}
+
+				// Arctangent shape (harder)
+				// y = (2/π) * atan(x * π/2)
+				double shape_factor = (shape - 0.66f) * 3.0f; // 0 to 1 within this range
+				double arctan_shape = Antiderivatives::arctan(v, limited_order);
+				double hard_shape = Antiderivatives::ratio(v, 0.2, limited_order); // More aggressive shape
+				return arctan_shape * (1.0 - shape_factor) + hard_shape * shape_factor;
+			});
+		});
+	});
 
 	// Mix dry/wet
-	float output = input * (1.0f - mix) + distorted * mix;
+	float output = align_dry(input) * (1.0f - mix) + distorted * mix;
 
 	// Apply output gain
 	return output * output_gain;
 }
 
 void WaveShaperDistortion::reset() {
-	// No state to reset for this effect
+	// Only the oversampler keeps state for this effect
+	DistortionEffect::reset();
 }
 
 float WaveShaperDistortion::get_tail_length() const {
@@ -218,6 +220,8 @@ Ref<SynthAudioEffect> WaveShaperDistortion::duplicate() const {
 		}
 	}
 
+	copy_oversampling(new_effect.ptr());
+
 	return new_effect;
 }
 
@@ -1,12 +1,12 @@
 #ifndef WAVE_SHAPER_DISTORTION_H
 #define WAVE_SHAPER_DISTORTION_H
 
-#include "../synth_audio_effect.h"
+#include "distortion_effect.h"
 
 namespace godot {
 
-class WaveShaperDistortion : public SynthAudioEffect {
-	GDCLASS(WaveShaperDistortion, SynthAudioEffect)
+class WaveShaperDistortion : public DistortionEffect {
+	GDCLASS(WaveShaperDistortion, DistortionEffect)
 
 public:
 	// Parameter names
@@ -3,6 +3,7 @@
 #include "synth_audio_effect.h"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
+#include <typeinfo>
 
 namespace godot {
 
@@ -13,6 +14,8 @@ void EffectChain::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_effects"), &EffectChain::get_effects);
 	ClassDB::bind_method(D_METHOD("add_effect", "effect"), &EffectChain::add_effect);
 	ClassDB::bind_method(D_METHOD("get_max_tail_length"), &EffectChain::get_max_tail_length);
+	ClassDB::bind_method(D_METHOD("compile"), &EffectChain::compile);
+	ClassDB::bind_method(D_METHOD("get_stage_count"), &EffectChain::get_stage_count);
 
 	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "effects", PROPERTY_HINT_TYPE_STRING, String::num(Variant::OBJECT) + "/" + String::num(PROPERTY_HINT_RESOURCE_TYPE) + ":SynthAudioEffect"),
 			"set_effects", "get_effects");
@@ -28,6 +31,7 @@ EffectChain::~EffectChain() {
 
 void EffectChain::set_effects(const TypedArray<SynthAudioEffect> &p_effects) {
 	effects = p_effects;
+	stale.store(true, std::memory_order_relaxed);
 }
 
 TypedArray<SynthAudioEffect> EffectChain::get_effects() const {
@@ -37,6 +41,7 @@ TypedArray<SynthAudioEffect> EffectChain::get_effects() const {
 void EffectChain::add_effect(const Ref<SynthAudioEffect> &effect) {
 	if (effect.is_valid()) {
 		effects.push_back(effect);
+		stale.store(true, std::memory_order_relaxed);
 	}
 }
 
@@ -86,6 +91,237 @@ float EffectChain::process_sample(const float &sample, const Ref<SynthNoteContex
 	return processed_sample;
 }
 
+void EffectChain::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	const Plan &plan = refresh();
+	if (!plan.compiled) {
+		for (int i = 0; i < effects.size(); i++) {
+			Ref<SynthAudioEffect> effect = effects[i];
+			if (effect.is_valid()) {
+				effect->process_block(p_buffer, p_count, context);
+			}
+		}
+		return;
+	}
+
+	if (plan.static_kernel != nullptr && plan.static_kernel(plan.stage_effects.data(), p_buffer, p_count, context)) {
+		return;
+	}
+	for (const Stage &stage : plan.stages) {
+		if (stage.kind == Stage::KIND_GAIN) {
+			for (int i = 0; i < p_count; i++) {
+				p_buffer[i] *= stage.gain;
+			}
+		} else if (stage.count == 1) {
+			plan.stage_effects[stage.first]->process_block(p_buffer, p_count, context);
+		} else {
+			plan.stage_effects[stage.first]->process_fused(&plan.stage_effects[stage.first], stage.count, p_buffer, p_count, context);
+		}
+	}
+}
+
+void EffectChain::process_lanes(EffectChain *const *p_chains, EffectLanes &p_lanes) {
+	// Chains of one patch compile to the same stages, anything else runs voice by voice
+	const Plan *lane_plans[EffectLanes::MAX_LANES];
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		lane_plans[l] = &p_chains[l]->refresh();
+	}
+
+	// A single voice gains nothing from lanes, its static kernel does better
+	const Plan &plan = *lane_plans[0];
+	if (p_lanes.lane_count == 1 && plan.static_kernel != nullptr) {
+		p_chains[0]->process_block(p_lanes.buffers[0], p_lanes.sample_count, p_lanes.contexts[0]);
+		return;
+	}
+
+	// Lane kernels cast every lane's effect to the class of the first lane's, so the
+	// effects must match class by class and not only in count
+	const std::vector<Stage> &stages = plan.stages;
+	bool matching = plan.compiled;
+	for (int l = 1; l < p_lanes.lane_count && matching; l++) {
+		const std::vector<Stage> &lane_stages = lane_plans[l]->stages;
+		matching = lane_plans[l]->compiled && lane_stages.size() == stages.size();
+		for (size_t s = 0; s < stages.size() && matching; s++) {
+			matching = lane_stages[s].kind == stages[s].kind && lane_stages[s].count == stages[s].count;
+		}
+		for (size_t e = 0; e < plan.stage_effects.size() && matching; e++) {
+			matching = typeid(*lane_plans[l]->stage_effects[e]) == typeid(*plan.stage_effects[e]);
+		}
+	}
+	if (!matching) {
+		for (int l = 0; l < p_lanes.lane_count; l++) {
+			p_chains[l]->process_block(p_lanes.buffers[l], p_lanes.sample_count, p_lanes.contexts[l]);
+		}
+		return;
+	}
+
+	// Fused runs split back into single effects, the lanes already cover the voices
+	for (size_t s = 0; s < stages.size(); s++) {
+		const Stage &stage = stages[s];
+		if (stage.kind == Stage::KIND_GAIN) {
+			for (int l = 0; l < p_lanes.lane_count; l++) {
+				float gain = lane_plans[l]->stages[s].gain;
+				for (int i = 0; i < p_lanes.sample_count; i++) {
+					p_lanes.buffers[l][i] *= gain;
+				}
+			}
+			continue;
+		}
+		for (int e = stage.first; e < stage.first + stage.count; e++) {
+			for (int l = 0; l < p_lanes.lane_count; l++) {
+				p_lanes.effects[l] = lane_plans[l]->stage_effects[e];
+			}
+			p_lanes.effects[0]->process_lanes(p_lanes);
+		}
+	}
+}
+
+uint32_t EffectChain::get_signature(const Slot &p_slot) {
+	// Revisions only grow, so their sum moves whenever any of them does
+	uint32_t signature = p_slot.effect->get_revision();
+	for (const Ref<ModulatedParameter> &parameter : p_slot.parameters) {
+		signature += parameter->get_revision();
+	}
+	return signature;
+}
+
+void EffectChain::watch(Slot &r_slot) {
+	r_slot.parameters.clear();
+	Array values = r_slot.effect->get_parameters().values();
+	for (int i = 0; i < values.size(); i++) {
+		Ref<ModulatedParameter> parameter = values[i];
+		if (parameter.is_valid()) {
+			r_slot.parameters.push_back(parameter);
+		}
+	}
+
+	// Signed before asking, a change landing in between shows up on the next block
+	r_slot.signature = get_signature(r_slot);
+	r_slot.gain = 1.0f;
+	r_slot.reduced = r_slot.effect->get_constant_gain(r_slot.gain);
+	if (!r_slot.reduced) {
+		r_slot.gain = 1.0f;
+	}
+}
+
+void EffectChain::build_stages(Plan &r_plan) {
+	std::vector<Stage> &stages = r_plan.stages;
+	std::vector<SynthAudioEffect *> &stage_effects = r_plan.stage_effects;
+	stages.clear();
+	stage_effects.clear();
+
+	float pending_gain = 1.0f;
+	for (const Slot &slot : r_plan.slots) {
+		if (slot.reduced) {
+			pending_gain *= slot.gain;
+			continue;
+		}
+
+		// A constant gain commutes with linear effects, so it waits to merge with later ones
+		SynthAudioEffect *effect = slot.effect.ptr();
+		if (pending_gain != 1.0f && !effect->is_linear()) {
+			Stage gain_stage;
+			gain_stage.kind = Stage::KIND_GAIN;
+			gain_stage.gain = pending_gain;
+			stages.push_back(gain_stage);
+			pending_gain = 1.0f;
+		}
+
+		bool fuse = !stages.empty() && stages.back().kind == Stage::KIND_EFFECTS && stages.back().count < MAX_FUSED && stage_effects.back()->can_fuse(effect);
+		if (fuse) {
+			stages.back().count++;
+		} else {
+			Stage effect_stage;
+			effect_stage.first = static_cast<int>(stage_effects.size());
+			effect_stage.count = 1;
+			stages.push_back(effect_stage);
+		}
+		stage_effects.push_back(effect);
+	}
+
+	if (pending_gain != 1.0f) {
+		Stage gain_stage;
+		gain_stage.kind = Stage::KIND_GAIN;
+		gain_stage.gain = pending_gain;
+		stages.push_back(gain_stage);
+	}
+
+	// Only effect stages, a kernel has no place for the gains
+	r_plan.static_kernel = nullptr;
+	bool effects_only = true;
+	for (const Stage &stage : stages) {
+		effects_only = effects_only && stage.kind == Stage::KIND_EFFECTS;
+	}
+	if (effects_only && !stage_effects.empty()) {
+		r_plan.static_kernel = StaticEffectChains::find(stage_effects.data(), static_cast<int>(stage_effects.size()));
+	}
+}
+
+void EffectChain::compile() {
+	// A change landing while this runs marks the chain stale again
+	stale.store(false, std::memory_order_relaxed);
+
+	const int active = active_plan.load(std::memory_order_relaxed);
+	const Plan &previous = plans[active];
+	Plan &plan = plans[1 - active];
+	plan.slots.clear();
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (!effect.is_valid()) {
+			continue;
+		}
+		plan.slots.emplace_back();
+		Slot &slot = plan.slots.back();
+		slot.effect = effect;
+		watch(slot);
+
+		// The effect skipped the blocks it was dropped for, so it starts over. The audio
+		// thread doesn't run it while it is dropped.
+		for (const Slot &previous_slot : previous.slots) {
+			if (previous_slot.effect == effect && previous_slot.reduced && !slot.reduced) {
+				effect->reset();
+			}
+		}
+	}
+	build_stages(plan);
+	plan.compiled = true;
+
+	active_plan.store(1 - active, std::memory_order_release);
+}
+
+void EffectChain::update() {
+	if (!stale.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	// The inactive plan is free once the audio thread has picked up the active one
+	int acknowledged = acknowledged_plan.load(std::memory_order_acquire);
+	if (acknowledged != -1 && acknowledged != active_plan.load(std::memory_order_relaxed)) {
+		return;
+	}
+	compile();
+}
+
+const EffectChain::Plan &EffectChain::refresh() {
+	const int active = active_plan.load(std::memory_order_acquire);
+	acknowledged_plan.store(active, std::memory_order_release);
+
+	// Only checked here, recompiling is left to update()
+	const Plan &plan = plans[active];
+	if (!stale.load(std::memory_order_relaxed)) {
+		for (const Slot &slot : plan.slots) {
+			if (get_signature(slot) != slot.signature) {
+				stale.store(true, std::memory_order_relaxed);
+				break;
+			}
+		}
+	}
+	return plan;
+}
+
+int EffectChain::get_stage_count() const {
+	return static_cast<int>(plans[active_plan.load(std::memory_order_acquire)].stages.size());
+}
+
 void EffectChain::reset() {
 	// Reset all effects in the chain
 	for (int i = 0; i < effects.size(); i++) {
@@ -96,4 +332,42 @@ void EffectChain::reset() {
 	}
 }
 
+size_t EffectChain::get_state_size() const {
+	size_t state_size = 0;
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (effect.is_valid()) {
+			state_size += effect->get_state_size();
+		}
+	}
+	return state_size;
+}
+
+void EffectChain::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (effect.is_valid()) {
+			effect->bind_state(p_allocator);
+		}
+	}
+}
+
+void EffectChain::apply_quality(const SynthQualityProfile::Settings &p_settings) {
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (effect.is_valid()) {
+			effect->apply_quality(p_settings);
+		}
+	}
+}
+
+void EffectChain::set_sample_rate(float p_sample_rate) {
+	for (int i = 0; i < effects.size(); i++) {
+		Ref<SynthAudioEffect> effect = effects[i];
+		if (effect.is_valid()) {
+			effect->set_sample_rate(p_sample_rate);
+		}
+	}
+}
+
 } // namespace godot
@@ -2,10 +2,13 @@
 #define EFFECT_CHAIN_H
 
 #include "../core/synth_note_context.h"
+#include "static_effect_chain.h"
 #include "synth_audio_effect.h"
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
+#include <atomic>
+#include <vector>
 
 namespace godot {
 
@@ -15,10 +18,67 @@ class EffectChain : public Resource {
 private:
 	TypedArray<SynthAudioEffect> effects;
 
+	// What compile() made of one effect, with the parameters its reduction depends on
+	struct Slot {
+		Ref<SynthAudioEffect> effect;
+		std::vector<Ref<ModulatedParameter>> parameters;
+		uint32_t signature = 0;
+		bool reduced = false;
+		float gain = 1.0f;
+	};
+
+	// One step of the compiled chain: a run of effects, fused when longer than one, or a
+	// gain standing in for the reduced effects before it
+	struct Stage {
+		enum Kind {
+			KIND_EFFECTS,
+			KIND_GAIN
+		};
+		Kind kind = KIND_EFFECTS;
+		int first = 0;
+		int count = 0;
+		float gain = 1.0f;
+	};
+
+	// What compile() made of the whole chain
+	struct Plan {
+		std::vector<Slot> slots;
+		std::vector<Stage> stages;
+		std::vector<SynthAudioEffect *> stage_effects;
+		bool compiled = false;
+
+		// Set when the stages are a topology StaticEffectChains has prebuilt
+		StaticEffectChains::Kernel static_kernel = nullptr;
+	};
+
+	// The audio thread runs the active plan while compile() builds the other one and
+	// swaps them, so recompiling never allocates or waits on the audio thread
+	Plan plans[2];
+	std::atomic<int> active_plan{ 0 };
+	// Plan the audio thread last picked up, -1 before its first block
+	std::atomic<int> acknowledged_plan{ -1 };
+	// Set when the effects or a parameter of a compiled effect changed
+	std::atomic<bool> stale{ false };
+
+	static uint32_t get_signature(const Slot &p_slot);
+	static void watch(Slot &r_slot);
+	static void build_stages(Plan &r_plan);
+
+	// The plan for this block. Marks the chain stale when an effect or one of its
+	// parameters changed since it was compiled.
+	const Plan &refresh();
+
 protected:
 	static void _bind_methods();
 
 public:
+	// Engines hand the chain at most this many samples at a time, which sets the
+	// control rate of effects that read their parameters once per block
+	static constexpr int BLOCK_SIZE = 32;
+
+	// Longest run of effects that process_fused() takes at once
+	static constexpr int MAX_FUSED = 8;
+
 	EffectChain();
 	~EffectChain();
 
@@ -36,8 +96,44 @@ public:
 	// Create a duplicate of this effect chain with new effect instances
 	Ref<EffectChain> duplicate() const;
 
+	// Every effect as written, one sample at a time
 	float process_sample(const float &sample, const Ref<SynthNoteContext> &context);
+
+	// The compiled chain, see compile()
+	void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context);
+
+	// Drop the effects that only apply a constant gain under their unmodulated parameters,
+	// merge those gains and move them past linear effects, and group adjacent effects that
+	// can_fuse() into one pass. Chains that come out as one of the StaticEffectChains run
+	// through its kernel. Until the first compile, process_block() runs every effect as
+	// written. Only for chains no voice is playing yet, live chains recompile in update().
+	void compile();
+
+	// Recompile a chain the audio thread found stale, such as after a parameter change.
+	// Does nothing until the audio thread has let go of the plan compile() would replace.
+	// A dropped effect that comes back starts over from reset. Not for the audio thread.
+	void update();
+
+	// Steps of the compiled chain, gains included
+	int get_stage_count() const;
+
+	// Run the chains of several voices built from the same patch stage by stage, each
+	// stage across all lanes at once. p_lanes brings the buffers, contexts and counts.
+	// Chains whose stages or effect classes differ fall back to running voice by voice.
+	static void process_lanes(EffectChain *const *p_chains, EffectLanes &p_lanes);
 	void reset();
+
+	// Total size in floats of the effect buffers that can live in a voice state arena
+	size_t get_state_size() const;
+
+	// Move every effect's buffers into storage taken from a voice state arena
+	void bind_state(VoiceStateArena::Allocator &p_allocator);
+
+	// Pass a quality tier's settings to every effect
+	void apply_quality(const SynthQualityProfile::Settings &p_settings);
+
+	// Pass the engine's sample rate to every effect
+	void set_sample_rate(float p_sample_rate);
 };
 
 } // namespace godot
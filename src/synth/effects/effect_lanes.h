@@ -0,0 +1,51 @@
+#ifndef EFFECT_LANES_H
+#define EFFECT_LANES_H
+
+#include "../core/synth_note_context.h"
+
+namespace godot {
+
+class SynthAudioEffect;
+
+// One effect stage of several voices that run the same patch, processed together.
+// Lane l holds voice l's copy of the effect, its block and its context, which stands at
+// the block's last sample. Lane kernels interleave the blocks into frames of MAX_LANES
+// samples and keep the states of all lanes side by side, so every step of a recursive
+// filter runs as one vector operation across the voices. Unused lanes are zero.
+struct EffectLanes {
+	static constexpr int MAX_LANES = 8;
+	static constexpr int MAX_SAMPLES = 32;
+
+	SynthAudioEffect *effects[MAX_LANES] = {};
+	float *buffers[MAX_LANES] = {};
+	Ref<SynthNoteContext> contexts[MAX_LANES];
+	int lane_count = 0;
+	int sample_count = 0;
+
+	// r_frames[n * MAX_LANES + l] = sample n of lane l
+	void interleave(float *r_frames) const {
+		for (int n = 0; n < sample_count; n++) {
+			float *frame = r_frames + n * MAX_LANES;
+			for (int l = 0; l < MAX_LANES; l++) {
+				frame[l] = l < lane_count ? buffers[l][n] : 0.0f;
+			}
+		}
+	}
+
+	void deinterleave(const float *p_frames) const {
+		for (int l = 0; l < lane_count; l++) {
+			for (int n = 0; n < sample_count; n++) {
+				buffers[l][n] = p_frames[n * MAX_LANES + l];
+			}
+		}
+	}
+
+	template <typename T>
+	T *get_effect(int p_lane) const {
+		return static_cast<T *>(effects[p_lane]);
+	}
+};
+
+} // namespace godot
+
+#endif // EFFECT_LANES_H
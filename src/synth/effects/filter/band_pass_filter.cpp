@@ -17,6 +17,7 @@ BandPassFilter::~BandPassFilter() {
 
 Ref<SynthAudioEffect> BandPassFilter::duplicate() const {
     Ref<BandPassFilter> new_filter = memnew(BandPassFilter);
+    new_filter->set_sample_rate(sample_rate);
     
     // Copy parameters
     Dictionary params = get_parameters();
@@ -0,0 +1,285 @@
+#include "filter_core.h"
+#include "../../core/dsp_math.h"
+
+namespace godot {
+
+FilterCore::Coefficients FilterCore::compute(Mode p_mode, float p_cutoff, float p_q, float p_gain_db, float p_sample_rate) {
+	// Keep the tangent finite, just below Nyquist
+	float normalized = p_cutoff / p_sample_rate;
+	normalized = normalized < 1.0e-5f ? 1.0e-5f : (normalized > 0.49f ? 0.49f : normalized);
+	float q = p_q < 0.05f ? 0.05f : p_q;
+
+	// tan(pi fc / fs) from the turn based sine and cosine
+	float half_turn = normalized * 0.5f;
+	float g = DspMath::sin_turns(half_turn) / DspMath::cos_turns(half_turn);
+
+	Coefficients c;
+	c.g = g;
+	c.k = 1.0f / q;
+
+	// Peak and shelf gains are split in two, A^2 is the gain in the boost band
+	float a = DspMath::db_to_gain(p_gain_db * 0.5f);
+	switch (p_mode) {
+		case MODE_LOWPASS:
+			c.m2 = 1.0f;
+			break;
+		case MODE_HIGHPASS:
+			c.m0 = 1.0f;
+			c.m1 = -c.k;
+			c.m2 = -1.0f;
+			break;
+		case MODE_BANDPASS:
+			c.m1 = 1.0f;
+			break;
+		case MODE_NOTCH:
+			c.m0 = 1.0f;
+			c.m1 = -c.k;
+			break;
+		case MODE_PEAK:
+			c.k = 1.0f / (q * a);
+			c.m0 = 1.0f;
+			c.m1 = c.k * (a * a - 1.0f);
+			break;
+		case MODE_LOW_SHELF:
+			c.g = g / DspMath::db_to_gain(p_gain_db * 0.25f);
+			c.m0 = 1.0f;
+			c.m1 = c.k * (a - 1.0f);
+			c.m2 = a * a - 1.0f;
+			break;
+		case MODE_HIGH_SHELF:
+			c.g = g * DspMath::db_to_gain(p_gain_db * 0.25f);
+			c.m0 = a * a;
+			c.m1 = c.k * (1.0f - a) * a;
+			c.m2 = 1.0f - a * a;
+			break;
+		case MODE_ALLPASS:
+			c.m0 = 1.0f;
+			c.m1 = -2.0f * c.k;
+			break;
+	}
+	return c;
+}
+
+void FilterCore::set_target(Mode p_mode, float p_cutoff, float p_q, float p_gain_db, float p_sample_rate, int p_ramp_samples) {
+	target = compute(p_mode, p_cutoff, p_q, p_gain_db, p_sample_rate);
+
+	// Unchanged parameters land where the filter already is, a glide of zero steps would
+	// only keep it from the settled path
+	bool unchanged = target.g == current.g && target.k == current.k && target.m0 == current.m0 && target.m1 == current.m1 && target.m2 == current.m2;
+	if (!primed || p_ramp_samples <= 1 || unchanged) {
+		current = target;
+		ramp_remaining = 0;
+		primed = true;
+		return;
+	}
+
+	float scale = 1.0f / static_cast<float>(p_ramp_samples);
+	step.g = (target.g - current.g) * scale;
+	step.k = (target.k - current.k) * scale;
+	step.m0 = (target.m0 - current.m0) * scale;
+	step.m1 = (target.m1 - current.m1) * scale;
+	step.m2 = (target.m2 - current.m2) * scale;
+	ramp_remaining = p_ramp_samples;
+}
+
+void FilterCore::reset() {
+	ic1 = 0.0f;
+	ic2 = 0.0f;
+	ramp_remaining = 0;
+	primed = false;
+}
+
+void FilterCore::process_block(const float *p_input, float *p_output, int p_count) {
+	int n = 0;
+
+	// Gliding part, coefficients move every sample
+	for (; n < p_count && ramp_remaining > 0; n++) {
+		p_output[n] = process(p_input[n]);
+	}
+
+	// Settled part, the loop gains are computed once and everything stays in registers
+	float a1 = 1.0f / (1.0f + current.g * (current.g + current.k));
+	float a2 = current.g * a1;
+	float a3 = current.g * a2;
+	float m0 = current.m0;
+	float m1 = current.m1;
+	float m2 = current.m2;
+	float s1 = ic1;
+	float s2 = ic2;
+	for (; n < p_count; n++) {
+		float input = p_input[n];
+		float v3 = input - s2;
+		float band = a1 * s1 + a2 * v3;
+		float low = s2 + a2 * s1 + a3 * v3;
+		s1 = 2.0f * band - s1;
+		s2 = 2.0f * low - s2;
+		p_output[n] = m0 * input + m1 * band + m2 * low;
+	}
+	ic1 = s1;
+	ic2 = s2;
+}
+
+void FilterCore::process_lanes(FilterCore *const *p_cores, int p_lanes, float *p_frames, int p_count) {
+	constexpr int W = LANE_WIDTH;
+
+	// Coefficients, their glide and the states side by side, idle lanes stay settled at zero
+	float g[W] = {}, k[W] = {}, m0[W] = {}, m1[W] = {}, m2[W] = {};
+	float dg[W] = {}, dk[W] = {}, dm0[W] = {}, dm1[W] = {}, dm2[W] = {};
+	float tg[W] = {}, tk[W] = {}, tm0[W] = {}, tm1[W] = {}, tm2[W] = {};
+	float remaining[W] = {};
+	float s1[W] = {}, s2[W] = {};
+	bool gliding = false;
+	for (int l = 0; l < p_lanes; l++) {
+		const FilterCore &core = *p_cores[l];
+		g[l] = core.current.g;
+		k[l] = core.current.k;
+		m0[l] = core.current.m0;
+		m1[l] = core.current.m1;
+		m2[l] = core.current.m2;
+		s1[l] = core.ic1;
+		s2[l] = core.ic2;
+		if (core.ramp_remaining > 0) {
+			dg[l] = core.step.g;
+			dk[l] = core.step.k;
+			dm0[l] = core.step.m0;
+			dm1[l] = core.step.m1;
+			dm2[l] = core.step.m2;
+			tg[l] = core.target.g;
+			tk[l] = core.target.k;
+			tm0[l] = core.target.m0;
+			tm1[l] = core.target.m1;
+			tm2[l] = core.target.m2;
+			remaining[l] = static_cast<float>(core.ramp_remaining);
+			gliding = true;
+		}
+	}
+
+	if (gliding) {
+		// Same steps as process(): every sample rebuilds the loop gains, then the glide
+		// advances and lands exactly on the target
+		for (int n = 0; n < p_count; n++) {
+			float *frame = p_frames + n * W;
+			float next = static_cast<float>(n + 1);
+			for (int l = 0; l < W; l++) {
+				float a1 = 1.0f / (1.0f + g[l] * (g[l] + k[l]));
+				float a2 = g[l] * a1;
+				float a3 = g[l] * a2;
+				float input = frame[l];
+				float v3 = input - s2[l];
+				float band = a1 * s1[l] + a2 * v3;
+				float low = s2[l] + a2 * s1[l] + a3 * v3;
+				s1[l] = 2.0f * band - s1[l];
+				s2[l] = 2.0f * low - s2[l];
+				frame[l] = m0[l] * input + m1[l] * band + m2[l] * low;
+
+				bool step = next < remaining[l];
+				bool land = next == remaining[l];
+				g[l] = step ? g[l] + dg[l] : (land ? tg[l] : g[l]);
+				k[l] = step ? k[l] + dk[l] : (land ? tk[l] : k[l]);
+				m0[l] = step ? m0[l] + dm0[l] : (land ? tm0[l] : m0[l]);
+				m1[l] = step ? m1[l] + dm1[l] : (land ? tm1[l] : m1[l]);
+				m2[l] = step ? m2[l] + dm2[l] : (land ? tm2[l] : m2[l]);
+			}
+		}
+	} else {
+		float a1[W], a2[W], a3[W];
+		for (int l = 0; l < W; l++) {
+			a1[l] = 1.0f / (1.0f + g[l] * (g[l] + k[l]));
+			a2[l] = g[l] * a1[l];
+			a3[l] = g[l] * a2[l];
+		}
+		for (int n = 0; n < p_count; n++) {
+			float *frame = p_frames + n * W;
+			for (int l = 0; l < W; l++) {
+				float input = frame[l];
+				float v3 = input - s2[l];
+				float band = a1[l] * s1[l] + a2[l] * v3;
+				float low = s2[l] + a2[l] * s1[l] + a3[l] * v3;
+				s1[l] = 2.0f * band - s1[l];
+				s2[l] = 2.0f * low - s2[l];
+				frame[l] = m0[l] * input + m1[l] * band + m2[l] * low;
+			}
+		}
+	}
+
+	for (int l = 0; l < p_lanes; l++) {
+		FilterCore &core = *p_cores[l];
+		core.current.g = g[l];
+		core.current.k = k[l];
+		core.current.m0 = m0[l];
+		core.current.m1 = m1[l];
+		core.current.m2 = m2[l];
+		core.ramp_remaining = core.ramp_remaining > p_count ? core.ramp_remaining - p_count : 0;
+		core.ic1 = s1[l];
+		core.ic2 = s2[l];
+	}
+}
+
+template <int STAGES>
+void FilterCore::process_settled(FilterCore *const *p_cores, float *p_buffer, int p_count) {
+	float a1[STAGES], a2[STAGES], a3[STAGES];
+	float m0[STAGES], m1[STAGES], m2[STAGES];
+	float s1[STAGES], s2[STAGES];
+	for (int s = 0; s < STAGES; s++) {
+		const FilterCore &core = *p_cores[s];
+		a1[s] = 1.0f / (1.0f + core.current.g * (core.current.g + core.current.k));
+		a2[s] = core.current.g * a1[s];
+		a3[s] = core.current.g * a2[s];
+		m0[s] = core.current.m0;
+		m1[s] = core.current.m1;
+		m2[s] = core.current.m2;
+		s1[s] = core.ic1;
+		s2[s] = core.ic2;
+	}
+
+	for (int n = 0; n < p_count; n++) {
+		float sample = p_buffer[n];
+		for (int s = 0; s < STAGES; s++) {
+			float v3 = sample - s2[s];
+			float band = a1[s] * s1[s] + a2[s] * v3;
+			float low = s2[s] + a2[s] * s1[s] + a3[s] * v3;
+			s1[s] = 2.0f * band - s1[s];
+			s2[s] = 2.0f * low - s2[s];
+			sample = m0[s] * sample + m1[s] * band + m2[s] * low;
+		}
+		p_buffer[n] = sample;
+	}
+
+	for (int s = 0; s < STAGES; s++) {
+		p_cores[s]->ic1 = s1[s];
+		p_cores[s]->ic2 = s2[s];
+	}
+}
+
+void FilterCore::process_cascade(FilterCore *const *p_cores, int p_stages, float *p_buffer, int p_count) {
+	int first = 0;
+	while (first < p_stages) {
+		// A gliding stage runs alone, the settled ones after it are fused in groups of four
+		if (p_cores[first]->ramp_remaining > 0) {
+			p_cores[first]->process_block(p_buffer, p_buffer, p_count);
+			first++;
+			continue;
+		}
+		int settled = 1;
+		while (settled < 4 && first + settled < p_stages && p_cores[first + settled]->ramp_remaining == 0) {
+			settled++;
+		}
+		switch (settled) {
+			case 4:
+				process_settled<4>(p_cores + first, p_buffer, p_count);
+				break;
+			case 3:
+				process_settled<3>(p_cores + first, p_buffer, p_count);
+				break;
+			case 2:
+				process_settled<2>(p_cores + first, p_buffer, p_count);
+				break;
+			default:
+				p_cores[first]->process_block(p_buffer, p_buffer, p_count);
+				break;
+		}
+		first += settled;
+	}
+}
+
+} // namespace godot
@@ -0,0 +1,186 @@
+#ifndef FILTER_CORE_H
+#define FILTER_CORE_H
+
+namespace godot {
+
+// Topology preserving (zero delay feedback) state variable filter shared by the
+// low pass, high pass, band pass, notch, peak and shelf filters.
+// One pass produces the low, band and high outputs, and every mode is a mix of the
+// input and those outputs, so switching or blending modes costs nothing extra.
+//
+// Coefficients involve a tangent and are meant to be set at control rate through
+// set_target(). The filter then glides the prewarped cutoff, damping and mix
+// linearly over the given number of samples and rebuilds the loop gains from them
+// each sample, which stays stable under fast sweeps where interpolated biquad
+// coefficients can blow up.
+class FilterCore {
+public:
+	enum Mode {
+		MODE_LOWPASS,
+		MODE_HIGHPASS,
+		MODE_BANDPASS,
+		MODE_NOTCH,
+		MODE_PEAK,
+		MODE_LOW_SHELF,
+		MODE_HIGH_SHELF,
+		MODE_ALLPASS
+	};
+
+	struct Outputs {
+		float low = 0.0f;
+		float band = 0.0f;
+		float high = 0.0f;
+	};
+
+private:
+	// Prewarped cutoff g, damping k = 1 / Q and the output mix
+	// y = m0 * input + m1 * band + m2 * low
+	struct Coefficients {
+		float g = 0.0f;
+		float k = 0.0f;
+		float m0 = 0.0f;
+		float m1 = 0.0f;
+		float m2 = 0.0f;
+	};
+
+	Coefficients current;
+	Coefficients target;
+	Coefficients step;
+	int ramp_remaining = 0;
+	bool primed = false;
+
+	// Trapezoidal integrator states
+	float ic1 = 0.0f;
+	float ic2 = 0.0f;
+
+	static Coefficients compute(Mode p_mode, float p_cutoff, float p_q, float p_gain_db, float p_sample_rate);
+
+	// Up to four settled stages in one pass, their states stay in registers
+	template <int STAGES>
+	static void process_settled(FilterCore *const *p_cores, float *p_buffer, int p_count);
+
+	// One sample with the current coefficients, v1 is band and v2 is low
+	void tick(float p_input, float &r_band, float &r_low) {
+		float a1 = 1.0f / (1.0f + current.g * (current.g + current.k));
+		float a2 = current.g * a1;
+		float a3 = current.g * a2;
+		float v3 = p_input - ic2;
+		r_band = a1 * ic1 + a2 * v3;
+		r_low = ic2 + a2 * ic1 + a3 * v3;
+		ic1 = 2.0f * r_band - ic1;
+		ic2 = 2.0f * r_low - ic2;
+	}
+
+	void advance_ramp() {
+		if (ramp_remaining == 0) {
+			return;
+		}
+		if (--ramp_remaining == 0) {
+			current = target;
+			return;
+		}
+		current.g += step.g;
+		current.k += step.k;
+		current.m0 += step.m0;
+		current.m1 += step.m1;
+		current.m2 += step.m2;
+	}
+
+public:
+	// Cutoff in Hz, Q of the resonance, gain in dB for the peak and shelf modes.
+	// The first target after a reset is applied at once, later ones glide over
+	// p_ramp_samples.
+	void set_target(Mode p_mode, float p_cutoff, float p_q, float p_gain_db, float p_sample_rate, int p_ramp_samples);
+
+	void reset();
+
+	float process(float p_input) {
+		float band;
+		float low;
+		tick(p_input, band, low);
+		float output = current.m0 * p_input + current.m1 * band + current.m2 * low;
+		advance_ramp();
+		return output;
+	}
+
+	// Low, band and high outputs of the same pass, independent of the mode
+	Outputs process_outputs(float p_input) {
+		Outputs outputs;
+		tick(p_input, outputs.band, outputs.low);
+		outputs.high = p_input - current.k * outputs.band - outputs.low;
+		advance_ramp();
+		return outputs;
+	}
+
+	// p_output may alias p_input
+	void process_block(const float *p_input, float *p_output, int p_count);
+
+	// Run p_lanes filters together on interleaved frames, p_frames[n * LANE_WIDTH + l] is
+	// sample n of filter l. Each filter behaves exactly as with process_block, lanes past
+	// p_lanes are computed on whatever they hold and thrown away.
+	static constexpr int LANE_WIDTH = 8;
+	static void process_lanes(FilterCore *const *p_cores, int p_lanes, float *p_frames, int p_count);
+
+	// Run p_stages filters in series over p_buffer in place, exactly as process_block on each
+	// in turn. Settled stages run together sample by sample, so the stages of one sample
+	// overlap with those of the next instead of each making its own pass.
+	static void process_cascade(FilterCore *const *p_cores, int p_stages, float *p_buffer, int p_count);
+
+	// process_block one sample per call, for loops that interleave the core with other
+	// work. Once the glide ends the loop gains and states are held here until end().
+	class Stepper {
+		FilterCore *core = nullptr;
+		bool gliding = false;
+		float a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+		float m0 = 0.0f, m1 = 0.0f, m2 = 0.0f;
+		float s1 = 0.0f, s2 = 0.0f;
+
+		void settle() {
+			gliding = false;
+			a1 = 1.0f / (1.0f + core->current.g * (core->current.g + core->current.k));
+			a2 = core->current.g * a1;
+			a3 = core->current.g * a2;
+			m0 = core->current.m0;
+			m1 = core->current.m1;
+			m2 = core->current.m2;
+			s1 = core->ic1;
+			s2 = core->ic2;
+		}
+
+	public:
+		void begin(FilterCore *p_core) {
+			core = p_core;
+			gliding = core->ramp_remaining > 0;
+			if (!gliding) {
+				settle();
+			}
+		}
+
+		float process(float p_input) {
+			if (gliding) {
+				float output = core->process(p_input);
+				if (core->ramp_remaining == 0) {
+					settle();
+				}
+				return output;
+			}
+			float v3 = p_input - s2;
+			float band = a1 * s1 + a2 * v3;
+			float low = s2 + a2 * s1 + a3 * v3;
+			s1 = 2.0f * band - s1;
+			s2 = 2.0f * low - s2;
+			return m0 * p_input + m1 * band + m2 * low;
+		}
+
+		void end() {
+			if (!gliding) {
+				core->ic1 = s1;
+				core->ic2 = s2;
+			}
+		}
+	};
+};
+
+} // namespace godot
+
+#endif // FILTER_CORE_H
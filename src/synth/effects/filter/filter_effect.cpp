@@ -75,8 +75,15 @@ void FilterEffect::reset() {
 	z1 = z2 = 0.0f; // Reset filter state
 }
 
+void FilterEffect::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate > 0.0f) {
+		sample_rate = p_sample_rate;
+	}
+}
+
 void FilterEffect::set_filter_type(int type) {
 	filter_type = (FilterType)type;
+	revision.fetch_add(1, std::memory_order_relaxed);
 }
 
 int FilterEffect::get_filter_type() const {
@@ -26,6 +26,10 @@ private:
 	float z1, z2;
 	FilterType filter_type;
 
+protected:
+	// Rate of the engine running the filter, coefficients are computed for it
+	float sample_rate = 44100.0f;
+
 	// Parameter names
 public:
 	static const char *PARAM_CUTOFF;
@@ -41,6 +45,7 @@ public:
 	// Make process_sample pure virtual to force derived classes to implement it
 	virtual float process_sample(float sample, const Ref<SynthNoteContext> &context) override { return 0.0f; }
 	virtual void reset() override;
+	void set_sample_rate(float p_sample_rate) override;
 
 	// Filter type
 	void set_filter_type(int type);
@@ -1,4 +1,5 @@
 #include "formant_filter.h"
+#include "../../core/dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -50,15 +51,20 @@ FormantFilter::FormantFilter() {
 		bands[i].x1 = bands[i].x2 = bands[i].y1 = bands[i].y2 = 0.0f;
 	}
 
-	// Initialize with default sample rate
-	update_coefficients(44100.0f);
+	// Coefficients for the default rate until the engine sets its own
+	update_coefficients();
 }
 
 FormantFilter::~FormantFilter() {
 	// Clean up resources
 }
 
-void FormantFilter::update_coefficients(float sample_rate) {
+void FormantFilter::set_sample_rate(float p_sample_rate) {
+	FilterEffect::set_sample_rate(p_sample_rate);
+	update_coefficients();
+}
+
+void FormantFilter::update_coefficients() {
 	// Get current vowel position
 	float vowel_pos = 0.0f;
 	Ref<ModulatedParameter> vowel_param = get_parameter(PARAM_VOWEL_POSITION);
@@ -81,11 +87,13 @@ void FormantFilter::update_coefficients(float sample_rate) {
 
 		// Convert to angular frequency
 		float omega = 2.0f * Math_PI * freq / sample_rate;
-		float sin_omega = Math::sin(omega);
-		float cos_omega = Math::cos(omega);
+		float sin_omega = DspMath::sin(omega);
+		float cos_omega = DspMath::cos(omega);
 
-		// Calculate alpha (for bandwidth)
-		float alpha = sin_omega * Math::sinh(Math::log(2.0f) / 2.0f * bandwidth / freq * omega / sin_omega);
+		// Calculate alpha (for bandwidth), sinh(x) = (e^x - e^-x) / 2
+		float sinh_arg = Math_LN2 / 2.0f * bandwidth / freq * omega / sin_omega;
+		float e = DspMath::exp(sinh_arg);
+		float alpha = sin_omega * 0.5f * (e - 1.0f / e);
 
 		// Calculate coefficients for bandpass filter
 		float a0 = 1.0f + alpha;
@@ -109,7 +117,7 @@ float FormantFilter::process_sample(float sample, const Ref<SynthNoteContext> &c
 
 		// Update coefficients if vowel position changed
 		if (vowel_pos != vowel_param->get_base_value()) {
-			update_coefficients(44100.0f); // TODO: Get sample rate from context
+			update_coefficients();
 		}
 	}
 
@@ -169,6 +177,7 @@ float FormantFilter::get_vowel_position_base_value() const {
 
 Ref<SynthAudioEffect> FormantFilter::duplicate() const {
 	Ref<FormantFilter> new_filter = memnew(FormantFilter);
+	new_filter->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
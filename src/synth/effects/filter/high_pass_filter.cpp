@@ -17,6 +17,7 @@ HighPassFilter::~HighPassFilter() {
 
 Ref<SynthAudioEffect> HighPassFilter::duplicate() const {
     Ref<HighPassFilter> new_filter = memnew(HighPassFilter);
+    new_filter->set_sample_rate(sample_rate);
     
     // Copy parameters
     Dictionary params = get_parameters();
@@ -17,6 +17,7 @@ LowPassFilter::~LowPassFilter() {
 
 Ref<SynthAudioEffect> LowPassFilter::duplicate() const {
     Ref<LowPassFilter> new_filter = memnew(LowPassFilter);
+    new_filter->set_sample_rate(sample_rate);
     
     // Copy parameters
     Dictionary params = get_parameters();
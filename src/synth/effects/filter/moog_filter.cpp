@@ -1,4 +1,6 @@
 #include "moog_filter.h"
+#include "../../core/dsp_math.h"
+#include <algorithm>
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -12,8 +14,9 @@ void MoogFilter::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_oversampling_parameter"), &MoogFilter::get_oversampling_parameter);
 	ClassDB::bind_method(D_METHOD("set_oversampling_base_value", "value"), &MoogFilter::set_oversampling_base_value);
 	ClassDB::bind_method(D_METHOD("get_oversampling_base_value"), &MoogFilter::get_oversampling_base_value);
+	ClassDB::bind_method(D_METHOD("get_latency_samples"), &MoogFilter::get_latency_samples);
 
-	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "oversampling_base_value", PROPERTY_HINT_RANGE, "1,4,1"),
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "oversampling_base_value", PROPERTY_HINT_RANGE, "1,8,1"),
 			"set_oversampling_base_value", "get_oversampling_base_value");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "oversampling_parameter", PROPERTY_HINT_RESOURCE_TYPE, "ModulatedParameter"),
 			"set_oversampling_parameter", "get_oversampling_parameter");
@@ -27,7 +30,7 @@ MoogFilter::MoogFilter() {
 	Ref<ModulatedParameter> oversampling_mp = memnew(ModulatedParameter);
 	oversampling_mp->set_base_value(2.0f); // Default to 2x oversampling
 	oversampling_mp->set_mod_min(1.0f);
-	oversampling_mp->set_mod_max(4.0f);
+	oversampling_mp->set_mod_max(8.0f);
 	set_parameter(PARAM_OVERSAMPLING, oversampling_mp);
 }
 
@@ -35,17 +38,7 @@ MoogFilter::~MoogFilter() {
 	// Clean up resources
 }
 
-// Fast approximation of tanh that's suitable for audio
-inline float fast_tanh(float x) {
-	float x2 = x * x;
-	return x * (27.0f + x2) / (27.0f + 9.0f * x2);
-}
-
-float MoogFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-	if (!context.is_valid()) {
-		return sample;
-	}
-
+void MoogFilter::update_coefficients(const Ref<SynthNoteContext> &context) {
 	// Get modulated parameter values
 	float cutoff_freq = 1000.0f; // Default to 1000 Hz
 	float q = 0.707f; // Default Q value
@@ -65,11 +58,15 @@ float MoogFilter::process_sample(float sample, const Ref<SynthNoteContext> &cont
 	Ref<ModulatedParameter> oversampling_param = get_parameter(PARAM_OVERSAMPLING);
 	if (oversampling_param.is_valid()) {
 		oversampling = static_cast<int>(Math::round(oversampling_param->get_value(context)));
-		oversampling = Math::clamp(oversampling, 1, 4);
+		oversampling = Math::clamp(oversampling, 1, 8);
 	}
 
-	// Get sample rate from context or use default
-	float sample_rate = 44100.0f; // TODO: Get from context
+	// Halfband stages come in powers of two. Changing the factor restarts the
+	// resampling filters, so avoid modulating it quickly.
+	oversampling = Oversampler::get_supported_factor(MIN(oversampling, max_oversampling));
+	if (oversampling != oversampler.get_factor()) {
+		oversampler.setup(oversampling, Oversampler::PHASE_MINIMUM);
+	}
 
 	// Apply oversampling to sample rate for internal processing
 	float internal_sample_rate = sample_rate * oversampling;
@@ -94,36 +91,141 @@ float MoogFilter::process_sample(float sample, const Ref<SynthNoteContext> &cont
 		old_tune = 2.0f * f * (1.0f - f);
 		old_acr = 1.0f - k * 0.5f;
 	}
+}
 
-	// Apply oversampling
-	float output = 0.0f;
-	for (int j = 0; j < oversampling; j++) {
+float MoogFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid()) {
+		return sample;
+	}
+
+	update_coefficients(context);
+
+	// Run the ladder at the oversampled rate, band limited on the way in and out
+	return oversampler.process(sample, [&](float x) {
 		// Input with resonance applied
-		float input = sample - 4.0f * stage[3] * old_acr;
+		float input = x - 4.0f * stage[3] * old_acr;
 
 		// Four cascaded one-pole filters (bilinear transform)
 		input *= 0.35013f; // Scale input to prevent clipping
 
 		// First stage
-		stage[0] = stage[0] + old_tune * (fast_tanh(input) - tanhstage[0]);
-		tanhstage[0] = fast_tanh(stage[0]);
+		stage[0] = stage[0] + old_tune * (DspMath::tanh(input) - tanhstage[0]);
+		tanhstage[0] = DspMath::tanh(stage[0]);
 
 		// Second stage
 		stage[1] = stage[1] + old_tune * (tanhstage[0] - tanhstage[1]);
-		tanhstage[1] = fast_tanh(stage[1]);
+		tanhstage[1] = DspMath::tanh(stage[1]);
 
 		// Third stage
 		stage[2] = stage[2] + old_tune * (tanhstage[1] - tanhstage[2]);
-		tanhstage[2] = fast_tanh(stage[2]);
+		tanhstage[2] = DspMath::tanh(stage[2]);
 
 		// Fourth stage
-		stage[3] = stage[3] + old_tune * (tanhstage[2] - fast_tanh(stage[3]));
+		stage[3] = stage[3] + old_tune * (tanhstage[2] - DspMath::tanh(stage[3]));
 
-		output += stage[3];
+		return stage[3];
+	});
+}
+
+void MoogFilter::process_lanes(const EffectLanes &p_lanes) {
+	constexpr int LANES = EffectLanes::MAX_LANES;
+
+	// The context stands still during a block, so reading the parameters once per lane
+	// matches reading them every sample
+	int factor = 0;
+	bool uniform = true;
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		MoogFilter *filter = p_lanes.get_effect<MoogFilter>(l);
+		if (!p_lanes.contexts[l].is_valid()) {
+			uniform = false;
+			continue;
+		}
+		filter->update_coefficients(p_lanes.contexts[l]);
+		int lane_factor = filter->oversampler.get_factor();
+		uniform = uniform && (factor == 0 || factor == lane_factor);
+		factor = lane_factor;
+	}
+	if (!uniform || p_lanes.sample_count > EffectLanes::MAX_SAMPLES) {
+		SynthAudioEffect::process_lanes(p_lanes);
+		return;
 	}
 
-	// Average the oversampled output
-	return output / oversampling;
+	// Every lane at the same rate, the ladders step together with their states side by side
+	float tune[LANES] = {};
+	float acr[LANES] = {};
+	float s0[LANES] = {};
+	float s1[LANES] = {};
+	float s2[LANES] = {};
+	float s3[LANES] = {};
+	float t0[LANES] = {};
+	float t1[LANES] = {};
+	float t2[LANES] = {};
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		MoogFilter *filter = p_lanes.get_effect<MoogFilter>(l);
+		tune[l] = filter->old_tune;
+		acr[l] = filter->old_acr;
+		s0[l] = filter->stage[0];
+		s1[l] = filter->stage[1];
+		s2[l] = filter->stage[2];
+		s3[l] = filter->stage[3];
+		t0[l] = filter->tanhstage[0];
+		t1[l] = filter->tanhstage[1];
+		t2[l] = filter->tanhstage[2];
+	}
+
+	int count = p_lanes.sample_count * factor;
+	float lane_buffer[EffectLanes::MAX_SAMPLES * Oversampler::MAX_FACTOR];
+	float frames[EffectLanes::MAX_SAMPLES * Oversampler::MAX_FACTOR * LANES];
+	for (int l = 0; l < LANES; l++) {
+		if (l >= p_lanes.lane_count) {
+			for (int n = 0; n < count; n++) {
+				frames[n * LANES + l] = 0.0f;
+			}
+			continue;
+		}
+		const float *source = p_lanes.buffers[l];
+		if (factor > 1) {
+			p_lanes.get_effect<MoogFilter>(l)->oversampler.upsample(p_lanes.buffers[l], p_lanes.sample_count, lane_buffer);
+			source = lane_buffer;
+		}
+		for (int n = 0; n < count; n++) {
+			frames[n * LANES + l] = source[n];
+		}
+	}
+
+	for (int n = 0; n < count; n++) {
+		float *frame = frames + n * LANES;
+		for (int l = 0; l < LANES; l++) {
+			float input = (frame[l] - 4.0f * s3[l] * acr[l]) * 0.35013f;
+			s0[l] = s0[l] + tune[l] * (DspMath::tanh(input) - t0[l]);
+			t0[l] = DspMath::tanh(s0[l]);
+			s1[l] = s1[l] + tune[l] * (t0[l] - t1[l]);
+			t1[l] = DspMath::tanh(s1[l]);
+			s2[l] = s2[l] + tune[l] * (t1[l] - t2[l]);
+			t2[l] = DspMath::tanh(s2[l]);
+			s3[l] = s3[l] + tune[l] * (t2[l] - DspMath::tanh(s3[l]));
+			frame[l] = s3[l];
+		}
+	}
+
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		MoogFilter *filter = p_lanes.get_effect<MoogFilter>(l);
+		for (int n = 0; n < count; n++) {
+			lane_buffer[n] = frames[n * LANES + l];
+		}
+		if (factor > 1) {
+			filter->oversampler.downsample(lane_buffer, p_lanes.sample_count, p_lanes.buffers[l]);
+		} else {
+			std::copy(lane_buffer, lane_buffer + count, p_lanes.buffers[l]);
+		}
+		filter->stage[0] = s0[l];
+		filter->stage[1] = s1[l];
+		filter->stage[2] = s2[l];
+		filter->stage[3] = s3[l];
+		filter->tanhstage[0] = t0[l];
+		filter->tanhstage[1] = t1[l];
+		filter->tanhstage[2] = t2[l];
+	}
 }
 
 void MoogFilter::reset() {
@@ -141,6 +243,8 @@ void MoogFilter::reset() {
 	old_res = 0.0f;
 	old_acr = 0.0f;
 	old_tune = 0.0f;
+
+	oversampler.reset();
 }
 
 void MoogFilter::set_oversampling_parameter(const Ref<ModulatedParameter> &param) {
@@ -156,7 +260,7 @@ Ref<ModulatedParameter> MoogFilter::get_oversampling_parameter() const {
 void MoogFilter::set_oversampling_base_value(float p_value) {
 	Ref<ModulatedParameter> param = get_parameter(PARAM_OVERSAMPLING);
 	if (param.is_valid()) {
-		param->set_base_value(Math::clamp(p_value, 1.0f, 4.0f));
+		param->set_base_value(Math::clamp(p_value, 1.0f, 8.0f));
 	}
 }
 
@@ -165,8 +269,17 @@ float MoogFilter::get_oversampling_base_value() const {
 	return param.is_valid() ? param->get_base_value() : 2.0f;
 }
 
+float MoogFilter::get_latency_samples() const {
+	return oversampler.get_latency();
+}
+
+void MoogFilter::apply_quality(const SynthQualityProfile::Settings &p_settings) {
+	max_oversampling = p_settings.max_oversampling;
+}
+
 Ref<SynthAudioEffect> MoogFilter::duplicate() const {
 	Ref<MoogFilter> new_filter = memnew(MoogFilter);
+	new_filter->set_sample_rate(sample_rate);
 
 	// Copy filter type
 	new_filter->set_filter_type(get_filter_type());
@@ -1,6 +1,7 @@
 #ifndef MOOG_FILTER_H
 #define MOOG_FILTER_H
 
+#include "../oversampler.h"
 #include "filter_effect.h"
 
 namespace godot {
@@ -21,6 +22,15 @@ private:
 	float old_acr = 0.0f;
 	float old_tune = 0.0f;
 
+	// Upper bound on oversampling set by the quality tier
+	int max_oversampling = Oversampler::MAX_FACTOR;
+
+	// Minimum phase resampling keeps the filter's added delay to a few samples
+	Oversampler oversampler;
+
+	// Read the parameters, set the oversampling factor and retune the ladder
+	void update_coefficients(const Ref<SynthNoteContext> &context);
+
 protected:
 	static void _bind_methods();
 
@@ -29,7 +39,9 @@ public:
 	~MoogFilter();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_lanes(const EffectLanes &p_lanes) override;
 	void reset() override;
+	void apply_quality(const SynthQualityProfile::Settings &p_settings) override;
 
 	// Oversampling parameter accessors
 	void set_oversampling_parameter(const Ref<ModulatedParameter> &param);
@@ -37,6 +49,9 @@ public:
 	void set_oversampling_base_value(float p_value);
 	float get_oversampling_base_value() const;
 
+	// Delay added by oversampling, in samples
+	float get_latency_samples() const;
+
 	Ref<SynthAudioEffect> duplicate() const override;
 };
 
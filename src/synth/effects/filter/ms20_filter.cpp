@@ -1,4 +1,5 @@
 #include "ms20_filter.h"
+#include "../../core/dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -36,7 +37,7 @@ float MS20Filter::saturate(float x, float p_saturation) const {
 	// Soft clipping function
 	if (p_saturation < 0.0001f)
 		return x;
-	return Math::tanh(x * p_saturation) / p_saturation;
+	return DspMath::tanh(x * p_saturation) / p_saturation;
 }
 
 float MS20Filter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
@@ -66,18 +67,16 @@ float MS20Filter::process_sample(float sample, const Ref<SynthNoteContext> &cont
 		saturation = Math::clamp(saturation, 0.0f, 1.0f);
 	}
 
-	// Get sample rate from context or use default
-	float sample_rate = 44100.0f; // TODO: Get from context
-
 	// Calculate filter coefficients
 	float w0 = 2.0f * Math_PI * cutoff_freq / sample_rate;
-	float alpha = Math::sin(w0) / (2.0f * q);
+	float alpha = DspMath::sin(w0) / (2.0f * q);
+	float cos_w0 = DspMath::cos(w0);
 
 	// Update coefficients
-	b0 = (1.0f - Math::cos(w0)) / 2.0f;
-	b1 = 1.0f - Math::cos(w0);
-	b2 = (1.0f - Math::cos(w0)) / 2.0f;
-	a1 = -2.0f * Math::cos(w0);
+	b0 = (1.0f - cos_w0) / 2.0f;
+	b1 = 1.0f - cos_w0;
+	b2 = (1.0f - cos_w0) / 2.0f;
+	a1 = -2.0f * cos_w0;
 	a2 = 1.0f - alpha;
 
 	// Apply saturation to input
@@ -124,6 +123,7 @@ float MS20Filter::get_saturation_base_value() const {
 
 Ref<SynthAudioEffect> MS20Filter::duplicate() const {
 	Ref<MS20Filter> new_filter = memnew(MS20Filter);
+	new_filter->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
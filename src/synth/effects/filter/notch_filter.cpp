@@ -34,23 +34,15 @@ NotchFilter::~NotchFilter() {
 	// Cleanup if needed
 }
 
-float NotchFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-	if (!context.is_valid())
-		return sample;
-
+void NotchFilter::update_coefficients(const Ref<SynthNoteContext> &context, int p_ramp_samples) {
 	// Get parameter values
-	float cutoff = 0.5f; // Default: normalized cutoff frequency (0.0 to 1.0)
-	float resonance = 0.7f; // Default: moderate resonance
+	float cutoff_freq = 1000.0f; // Default to 1000 Hz
 	float bandwidth = 0.5f; // Default: moderate bandwidth
 
 	Ref<ModulatedParameter> cutoff_param = get_parameter(PARAM_CUTOFF);
 	if (cutoff_param.is_valid()) {
-		cutoff = cutoff_param->get_value(context);
-	}
-
-	Ref<ModulatedParameter> resonance_param = get_parameter(PARAM_RESONANCE);
-	if (resonance_param.is_valid()) {
-		resonance = resonance_param->get_value(context);
+		cutoff_freq = cutoff_param->get_value(context);
+		cutoff_freq = Math::clamp(cutoff_freq, 20.0f, 20000.0f);
 	}
 
 	Ref<ModulatedParameter> bandwidth_param = get_parameter(PARAM_BANDWIDTH);
@@ -58,48 +50,15 @@ float NotchFilter::process_sample(float sample, const Ref<SynthNoteContext> &con
 		bandwidth = bandwidth_param->get_value(context);
 	}
 
-	// Get sample rate from context or use default
-	float sample_rate = 44100.0f; // TODO: Get from context
-
-	// Convert normalized cutoff to angular frequency (0 to pi)
-	float omega = Math_PI * cutoff;
-
-	// Calculate filter coefficients
-	float alpha = Math::sin(omega) * bandwidth;
-	float cosw = Math::cos(omega);
-	float beta = 1.0f - alpha * resonance;
-
-	// Normalize coefficients
-	float a0 = 1.0f + alpha;
-	float a1 = -2.0f * cosw;
-	float a2 = 1.0f - alpha;
-	float b0 = 1.0f;
-	float b1 = -2.0f * cosw;
-	float b2 = 1.0f;
-
-	// Normalize by a0
-	b0 /= a0;
-	b1 /= a0;
-	b2 /= a0;
-	a1 /= a0;
-	a2 /= a0;
-
-	// Direct form II implementation
-	float y = b0 * sample + z1;
-	z1 = b1 * sample - a1 * y + z2;
-	z2 = b2 * sample - a2 * y;
-
-	return y;
-}
+	// Bandwidth is the RBJ alpha / sin(omega) = 1 / 2Q, wider notches have lower Q
+	float q = 0.5f / Math::max(bandwidth, 0.01f);
 
-void NotchFilter::reset() {
-	// Reset filter state
-	z1 = 0.0f;
-	z2 = 0.0f;
+	core.set_target(FilterCore::MODE_NOTCH, cutoff_freq, q, 0.0f, sample_rate, p_ramp_samples);
 }
 
 Ref<SynthAudioEffect> NotchFilter::duplicate() const {
 	Ref<NotchFilter> new_filter = memnew(NotchFilter);
+	new_filter->set_sample_rate(sample_rate);
 
 	// Copy parameters
 	Dictionary params = get_parameters();
@@ -15,13 +15,12 @@ public:
 protected:
 	static void _bind_methods();
 
+	void update_coefficients(const Ref<SynthNoteContext> &context, int p_ramp_samples) override;
+
 public:
 	NotchFilter();
 	~NotchFilter();
 
-	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
-	void reset() override;
-
 	// Parameter accessors
 	void set_bandwidth_parameter(const Ref<ModulatedParameter> &param);
 	Ref<ModulatedParameter> get_bandwidth_parameter() const;
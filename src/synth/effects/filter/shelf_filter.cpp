@@ -19,10 +19,7 @@ ShelfFilter::~ShelfFilter() {
     // Clean up resources
 }
 
-float ShelfFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-    if (!context.is_valid())
-        return sample;
-
+void ShelfFilter::update_coefficients(const Ref<SynthNoteContext> &context, int p_ramp_samples) {
     // Get parameter values
     float cutoff_freq = 1000.0f; // Default to 1000 Hz
     float gain_db = 0.0f; // Default gain in dB
@@ -38,60 +35,9 @@ float ShelfFilter::process_sample(float sample, const Ref<SynthNoteContext> &con
         gain_db = gain_param->get_value(context);
     }
 
-    // Get sample rate from context or use default
-    float sample_rate = 44100.0f; // TODO: Get from context
-
-    // Convert dB gain to linear gain
-    float A = Math::db2linear(gain_db);
-    
-    // Calculate filter coefficients
-    float omega = 2.0f * Math_PI * cutoff_freq / sample_rate;
-    float sin_omega = Math::sin(omega);
-    float cos_omega = Math::cos(omega);
-    float alpha = sin_omega / 2.0f * Math::sqrt((A + 1.0f/A) * (1.0f/0.707f - 1.0f) + 2.0f);
-    float beta = 2.0f * Math::sqrt(A) * alpha;
-
-    float a0, a1, a2, b0, b1, b2;
-
-    if (get_filter_type() == FilterType::LOWSHELF) {
-        // Low shelf coefficients
-        b0 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega + beta);
-        b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cos_omega);
-        b2 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega - beta);
-        a0 = (A + 1.0f) + (A - 1.0f) * cos_omega + beta;
-        a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cos_omega);
-        a2 = (A + 1.0f) + (A - 1.0f) * cos_omega - beta;
-    } else { // HIGHSHELF
-        // High shelf coefficients
-        b0 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega + beta);
-        b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cos_omega);
-        b2 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega - beta);
-        a0 = (A + 1.0f) - (A - 1.0f) * cos_omega + beta;
-        a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cos_omega);
-        a2 = (A + 1.0f) - (A - 1.0f) * cos_omega - beta;
-    }
-
-    // Normalize coefficients
-    b0 /= a0;
-    b1 /= a0;
-    b2 /= a0;
-    a1 /= a0;
-    a2 /= a0;
-
-    // Apply biquad filter
-    float output = b0 * sample + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
-
-    // Update state variables
-    x2 = x1;
-    x1 = sample;
-    y2 = y1;
-    y1 = output;
-
-    return output;
-}
-
-void ShelfFilter::reset() {
-    x1 = x2 = y1 = y2 = 0.0f;
+    // Butterworth slope, the shelf reaches gain_db without overshoot
+    FilterCore::Mode mode = is_low_shelf() ? FilterCore::MODE_LOW_SHELF : FilterCore::MODE_HIGH_SHELF;
+    core.set_target(mode, cutoff_freq, 0.707f, gain_db, sample_rate, p_ramp_samples);
 }
 
 void ShelfFilter::set_low_shelf() {
@@ -108,6 +54,7 @@ bool ShelfFilter::is_low_shelf() const {
 
 Ref<SynthAudioEffect> ShelfFilter::duplicate() const {
     Ref<ShelfFilter> new_filter = memnew(ShelfFilter);
+    new_filter->set_sample_rate(sample_rate);
     
     // Copy filter type (low shelf or high shelf)
     if (is_low_shelf()) {
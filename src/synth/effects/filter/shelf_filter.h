@@ -1,30 +1,22 @@
 #ifndef SHELF_FILTER_H
 #define SHELF_FILTER_H
 
-#include "filter_effect.h"
+#include "state_variable_filter.h"
 
 namespace godot {
 
-class ShelfFilter : public FilterEffect {
-    GDCLASS(ShelfFilter, FilterEffect)
-
-private:
-    // Filter state variables
-    float x1 = 0.0f;
-    float x2 = 0.0f;
-    float y1 = 0.0f;
-    float y2 = 0.0f;
+class ShelfFilter : public StateVariableFilter {
+    GDCLASS(ShelfFilter, StateVariableFilter)
 
 protected:
     static void _bind_methods();
 
+    void update_coefficients(const Ref<SynthNoteContext> &context, int p_ramp_samples) override;
+
 public:
     ShelfFilter();
     ~ShelfFilter();
     
-    float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
-    void reset() override;
-    
     // Set shelf type (low or high)
     void set_low_shelf();
     void set_high_shelf();
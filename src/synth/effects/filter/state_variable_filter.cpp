@@ -1,4 +1,5 @@
 #include "state_variable_filter.h"
+#include "../effect_chain.h"
 #include <godot_cpp/core/math.hpp>
 
 namespace godot {
@@ -8,22 +9,37 @@ void StateVariableFilter::_bind_methods() {
 }
 
 StateVariableFilter::StateVariableFilter() {
-	// Initialize state variables
-	z1 = 0.0f;
-	z2 = 0.0f;
+	// The core takes its first coefficients without a glide
 }
 
 StateVariableFilter::~StateVariableFilter() {
 	// Clean up resources
 }
 
-float StateVariableFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
-	if (!context.is_valid())
-		return sample;
+FilterCore::Mode StateVariableFilter::get_core_mode() const {
+	switch (get_filter_type()) {
+		case FilterType::HIGHPASS:
+			return FilterCore::MODE_HIGHPASS;
+		case FilterType::BANDPASS:
+			return FilterCore::MODE_BANDPASS;
+		case FilterType::NOTCH:
+			return FilterCore::MODE_NOTCH;
+		case FilterType::PEAK:
+			return FilterCore::MODE_PEAK;
+		case FilterType::LOWSHELF:
+			return FilterCore::MODE_LOW_SHELF;
+		case FilterType::HIGHSHELF:
+			return FilterCore::MODE_HIGH_SHELF;
+		default:
+			return FilterCore::MODE_LOWPASS;
+	}
+}
 
+void StateVariableFilter::update_coefficients(const Ref<SynthNoteContext> &context, int p_ramp_samples) {
 	// Get modulated parameter values
 	float cutoff_freq = 1000.0f; // Default to 1000 Hz
 	float q = 0.707f; // Default Q value
+	float gain_db = 0.0f; // Peak and shelf modes only
 
 	Ref<ModulatedParameter> cutoff_param = get_parameter(PARAM_CUTOFF);
 	if (cutoff_param.is_valid()) {
@@ -36,51 +52,114 @@ float StateVariableFilter::process_sample(float sample, const Ref<SynthNoteConte
 		q = res_param->get_value(context) * 10.0f + 0.707f; // Map 0-1 to Q range
 	}
 
-	// Get sample rate from context or use default
-	float sample_rate = 44100.0f; // TODO: Get from context
+	Ref<ModulatedParameter> gain_param = get_parameter(PARAM_GAIN);
+	if (gain_param.is_valid()) {
+		gain_db = gain_param->get_value(context);
+	}
 
-	// Calculate filter coefficients (State Variable Filter)
-	float f = 2.0f * Math::sin(Math_PI * cutoff_freq / sample_rate);
-	float q_factor = 1.0f / q;
+	core.set_target(get_core_mode(), cutoff_freq, q, gain_db, sample_rate, p_ramp_samples);
+}
 
-	// State variable filter algorithm
-	float lowpass = z1 + f * z2;
-	float highpass = sample - lowpass - q_factor * z2;
-	float bandpass = f * highpass + z2;
-	float notch = lowpass + highpass;
+float StateVariableFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid())
+		return sample;
 
-	// Update filter state
-	z2 = bandpass;
-	z1 = lowpass;
+	// Even one sample at a time, the parameters are only read at control rate
+	if (control_countdown <= 0) {
+		update_coefficients(context, EffectChain::BLOCK_SIZE);
+		control_countdown = EffectChain::BLOCK_SIZE;
+	}
+	control_countdown--;
 
-	// Select output based on filter type
-	float output = 0.0f;
-	switch (get_filter_type()) {
-		case FilterType::LOWPASS:
-			output = lowpass;
-			break;
-		case FilterType::HIGHPASS:
-			output = highpass;
-			break;
-		case FilterType::BANDPASS:
-			output = bandpass;
-			break;
-		case FilterType::NOTCH:
-			output = notch;
-			break;
-		default:
-			output = lowpass; // Default to lowpass
+	return core.process(sample);
+}
+
+void StateVariableFilter::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid() || p_count <= 0)
+		return;
+
+	// The context stands at the last sample, so the glide lands on its parameters
+	update_coefficients(context, p_count);
+	core.process_block(p_buffer, p_buffer, p_count);
+	control_countdown = 0;
+}
+
+void StateVariableFilter::process_lanes(const EffectLanes &p_lanes) {
+	static_assert(FilterCore::LANE_WIDTH == EffectLanes::MAX_LANES, "Lane layouts must match");
+
+	bool valid = p_lanes.sample_count > 0 && p_lanes.sample_count <= EffectLanes::MAX_SAMPLES;
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		valid = valid && p_lanes.contexts[l].is_valid();
+	}
+	if (!valid) {
+		SynthAudioEffect::process_lanes(p_lanes);
+		return;
 	}
 
-	return output;
+	FilterCore *cores[EffectLanes::MAX_LANES];
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		StateVariableFilter *filter = p_lanes.get_effect<StateVariableFilter>(l);
+		filter->update_coefficients(p_lanes.contexts[l], p_lanes.sample_count);
+		filter->control_countdown = 0;
+		cores[l] = &filter->core;
+	}
+
+	float frames[EffectLanes::MAX_SAMPLES * EffectLanes::MAX_LANES];
+	p_lanes.interleave(frames);
+	FilterCore::process_lanes(cores, p_lanes.lane_count, frames, p_lanes.sample_count);
+	p_lanes.deinterleave(frames);
+}
+
+void StateVariableFilter::Kernel::begin(StateVariableFilter *p_filter, int p_count, const Ref<SynthNoteContext> &context) {
+	// Same coefficients as process_block
+	p_filter->update_coefficients(context, p_count);
+	p_filter->control_countdown = 0;
+	stepper.begin(&p_filter->core);
 }
 
 void StateVariableFilter::reset() {
-	z1 = z2 = 0.0f;
+	core.reset();
+	control_countdown = 0;
+}
+
+bool StateVariableFilter::get_constant_gain(float &r_gain) const {
+	// At 0 dB A = 1, and the peak and shelf mixes reduce to the input alone
+	FilterCore::Mode mode = get_core_mode();
+	if (mode != FilterCore::MODE_PEAK && mode != FilterCore::MODE_LOW_SHELF && mode != FilterCore::MODE_HIGH_SHELF) {
+		return false;
+	}
+	r_gain = 1.0f;
+	return has_constant_value(PARAM_GAIN, 0.0f);
+}
+
+bool StateVariableFilter::is_linear() const {
+	return true;
+}
+
+bool StateVariableFilter::can_fuse(const SynthAudioEffect *p_next) const {
+	return Object::cast_to<StateVariableFilter>(p_next) != nullptr;
+}
+
+void StateVariableFilter::process_fused(SynthAudioEffect *const *p_effects, int p_count, float *p_buffer, int p_samples, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid() || p_samples <= 0 || p_count > EffectChain::MAX_FUSED) {
+		SynthAudioEffect::process_fused(p_effects, p_count, p_buffer, p_samples, context);
+		return;
+	}
+
+	// Same coefficients as process_block, then every stage in a single pass
+	FilterCore *cores[EffectChain::MAX_FUSED];
+	for (int i = 0; i < p_count; i++) {
+		StateVariableFilter *filter = static_cast<StateVariableFilter *>(p_effects[i]);
+		filter->update_coefficients(context, p_samples);
+		filter->control_countdown = 0;
+		cores[i] = &filter->core;
+	}
+	FilterCore::process_cascade(cores, p_count, p_buffer, p_samples);
 }
 
 Ref<SynthAudioEffect> StateVariableFilter::duplicate() const {
     Ref<StateVariableFilter> new_filter = memnew(StateVariableFilter);
+    new_filter->set_sample_rate(sample_rate);
     
     // Copy filter type
     new_filter->set_filter_type(get_filter_type());
@@ -1,26 +1,57 @@
 #ifndef STATE_VARIABLE_FILTER_H
 #define STATE_VARIABLE_FILTER_H
 
+#include "filter_core.h"
 #include "filter_effect.h"
 
 namespace godot {
 
+// Multi-mode filter on the shared FilterCore. The filter type picks the mode, and
+// the low pass, high pass, band pass, notch and shelf filters build on this class.
+// Coefficients are recomputed once per block, or every EffectChain::BLOCK_SIZE samples
+// when processed one sample at a time, and glide in between.
 class StateVariableFilter : public FilterEffect {
     GDCLASS(StateVariableFilter, FilterEffect)
 
 protected:
-    // Filter state variables
-    float z1 = 0.0f;
-    float z2 = 0.0f;
-    
+    FilterCore core;
+    int control_countdown = 0;
+
     static void _bind_methods();
 
+    // Read the parameters and glide the core to them over p_ramp_samples
+    virtual void update_coefficients(const Ref<SynthNoteContext> &context, int p_ramp_samples);
+
+    FilterCore::Mode get_core_mode() const;
+
 public:
+    // The core stepped sample by sample, for StaticEffectChain
+    struct Kernel {
+        using Effect = StateVariableFilter;
+
+        FilterCore::Stepper stepper;
+
+        static bool can_run(const StateVariableFilter *) { return true; }
+        void begin(StateVariableFilter *p_filter, int p_count, const Ref<SynthNoteContext> &context);
+        void end() { stepper.end(); }
+        float process(float p_sample) { return stepper.process(p_sample); }
+    };
+
     StateVariableFilter();
     ~StateVariableFilter();
 
     float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+    void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) override;
+    void process_lanes(const EffectLanes &p_lanes) override;
     void reset() override;
+
+    // A peak or shelf at 0 dB passes its input unchanged
+    bool get_constant_gain(float &r_gain) const override;
+    bool is_linear() const override;
+
+    // Adjacent filters of this family run as one cascade through FilterCore::process_cascade
+    bool can_fuse(const SynthAudioEffect *p_next) const override;
+    void process_fused(SynthAudioEffect *const *p_effects, int p_count, float *p_buffer, int p_samples, const Ref<SynthNoteContext> &context) override;
     
     Ref<SynthAudioEffect> duplicate() const override;
 };
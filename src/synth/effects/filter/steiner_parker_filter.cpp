@@ -1,4 +1,5 @@
 #include "steiner_parker_filter.h"
+#include "../../core/dsp_math.h"
 #include <cmath>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -30,12 +31,6 @@ SteinerParkerFilter::~SteinerParkerFilter() {
 	// Clean up resources
 }
 
-float SteinerParkerFilter::fast_tanh(float x) const {
-	// Fast approximation of tanh
-	float x2 = x * x;
-	return x * (27.0f + x2) / (27.0f + 9.0f * x2);
-}
-
 float SteinerParkerFilter::process_sample(float sample, const Ref<SynthNoteContext> &context) {
 	if (!context.is_valid())
 		return sample;
@@ -60,17 +55,14 @@ float SteinerParkerFilter::process_sample(float sample, const Ref<SynthNoteConte
 		resonance = Math::clamp(resonance, 0.0f, 1.0f);
 	}
 
-	// Get sample rate from context or use default
-	float sample_rate = 44100.0f;
-
 	// Calculate filter coefficients
-	float f = 2.0f * Math::sin(Math_PI * cutoff_freq / sample_rate);
+	float f = 2.0f * DspMath::sin_turns(0.5f * cutoff_freq / sample_rate);
 	float q = resonance * 10.0f;
 	float scale = Math::sqrt(q) * 0.1f;
 
 	// Apply input drive/saturation
 	if (drive_value > 0.0f) {
-		sample = fast_tanh(sample * (1.0f + drive_value * 5.0f)) / (1.0f + drive_value * 5.0f);
+		sample = DspMath::tanh(sample * (1.0f + drive_value * 5.0f)) / (1.0f + drive_value * 5.0f);
 	}
 
 	// Steiner-Parker filter algorithm
@@ -80,8 +72,8 @@ float SteinerParkerFilter::process_sample(float sample, const Ref<SynthNoteConte
 
 	// Apply nonlinear feedback for more character
 	if (drive_value > 0.0f) {
-		bp = fast_tanh(bp * (1.0f + drive_value * 2.0f)) / (1.0f + drive_value * 2.0f);
-		lp = fast_tanh(lp * (1.0f + drive_value * 2.0f)) / (1.0f + drive_value * 2.0f);
+		bp = DspMath::tanh(bp * (1.0f + drive_value * 2.0f)) / (1.0f + drive_value * 2.0f);
+		lp = DspMath::tanh(lp * (1.0f + drive_value * 2.0f)) / (1.0f + drive_value * 2.0f);
 	}
 
 	// Store state for next sample
@@ -137,6 +129,7 @@ float SteinerParkerFilter::get_drive_base_value() const {
 
 Ref<SynthAudioEffect> SteinerParkerFilter::duplicate() const {
 	Ref<SteinerParkerFilter> new_filter = memnew(SteinerParkerFilter);
+	new_filter->set_sample_rate(sample_rate);
 	new_filter->set_filter_type(get_filter_type());
 
 	Dictionary params = get_parameters();
@@ -19,9 +19,6 @@ private:
 	float bp = 0.0f;
 	float lp = 0.0f;
 
-	// Tanh approximation for saturation
-	float fast_tanh(float x) const;
-
 protected:
 	static void _bind_methods();
 
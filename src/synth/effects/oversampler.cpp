@@ -0,0 +1,325 @@
+#include "oversampler.h"
+#include <cmath>
+
+namespace godot {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Halfband FIR stored as the taps of its filtering branch, newest sample first.
+// The other branch is a single tap of 0.5 at the centre and becomes a pure delay.
+struct FirHalfband {
+	float taps[24] = {};
+	int count = 0;
+
+	FirHalfband(int p_count, double p_beta) {
+		count = p_count;
+		double centre = p_count - 1;
+
+		double sum = 0.0;
+		double window[24];
+		for (int i = 0; i < p_count; i++) {
+			// Non-zero taps sit at even positions, an odd distance from the centre
+			double offset = 2 * i - centre;
+			double t = offset / (centre + 1.0);
+			double sinc = std::sin(PI * offset * 0.5) / (PI * offset);
+			window[i] = sinc * bessel_i0(p_beta * std::sqrt(1.0 - t * t)) / bessel_i0(p_beta);
+			sum += window[i];
+		}
+
+		// The branch carries half the DC gain, the centre tap the other half
+		for (int i = 0; i < p_count; i++) {
+			taps[i] = static_cast<float>(window[i] * 0.5 / sum);
+		}
+	}
+
+	static double bessel_i0(double p_x) {
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; k++) {
+			term *= (p_x * 0.5 / k) * (p_x * 0.5 / k);
+			sum += term;
+		}
+		return sum;
+	}
+};
+
+// Allpass polyphase IIR halfband. Coefficients follow the elliptic design of
+// Valenzuela and Constantinides for the given count and transition band.
+struct IirHalfband {
+	float coefs[8] = {};
+	int count = 0;
+
+	// Low frequency delay of an upsample/downsample round trip, in low rate samples
+	float latency = 0.0f;
+
+	IirHalfband(int p_count, double p_transition) {
+		count = p_count;
+		int order = p_count * 2 + 1;
+
+		double k = std::tan((1.0 - p_transition * 2.0) * PI * 0.25);
+		k *= k;
+		double kk = std::pow(1.0 - k * k, 0.25);
+		double e = 0.5 * (1.0 - kk) / (1.0 + kk);
+		double e2 = e * e;
+		double e4 = e2 * e2;
+		double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+		for (int i = 0; i < p_count; i++) {
+			int c = i + 1;
+			double num = 0.0;
+			double sign = 1.0;
+			for (int j = 0; j < 32; j++) {
+				num += std::pow(q, j * (j + 1)) * std::sin((j * 2 + 1) * c * PI / order) * sign;
+				sign = -sign;
+			}
+			double den = 0.0;
+			sign = -1.0;
+			for (int j = 1; j < 32; j++) {
+				den += std::pow(q, j * j) * std::cos(j * 2 * c * PI / order) * sign;
+				sign = -sign;
+			}
+			double ww = num * std::pow(q, 0.25) / (den + 0.5);
+			double wwsq = ww * ww;
+			double x = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+			coefs[i] = static_cast<float>((1.0 - x) / (1.0 + x));
+		}
+
+		// Each first order allpass delays low frequencies by (1 - a) / (1 + a) samples.
+		// The two branches are one high rate sample apart and are averaged.
+		double branch[2] = { 0.0, 0.0 };
+		for (int i = 0; i < p_count; i++) {
+			branch[i & 1] += (1.0 - coefs[i]) / (1.0 + coefs[i]);
+		}
+		latency = static_cast<float>(branch[0] + branch[1]);
+	}
+};
+
+// The first stage sees the full band and needs a steep transition. Later stages only
+// have to reject images far above the original band, so they are much shorter.
+const FirHalfband &get_fir_first() {
+	static const FirHalfband filter(24, 8.0);
+	return filter;
+}
+
+const FirHalfband &get_fir_later() {
+	static const FirHalfband filter(8, 6.0);
+	return filter;
+}
+
+const IirHalfband &get_iir_first() {
+	static const IirHalfband filter(8, 0.04);
+	return filter;
+}
+
+const IirHalfband &get_iir_later() {
+	static const IirHalfband filter(4, 0.2);
+	return filter;
+}
+
+// Four independent sums so the loop vectorizes without reassociating floats
+inline float dot(const float *p_a, const float *p_b, int p_count) {
+	float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < p_count; i += 4) {
+		acc[0] += p_a[i] * p_b[i];
+		acc[1] += p_a[i + 1] * p_b[i + 1];
+		acc[2] += p_a[i + 2] * p_b[i + 2];
+		acc[3] += p_a[i + 3] * p_b[i + 3];
+	}
+	return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+inline float allpass(float p_in, float p_coef, float &r_x, float &r_y) {
+	float out = (p_in - r_y) * p_coef + r_x;
+	r_x = p_in;
+	r_y = out;
+	return out;
+}
+
+} // namespace
+
+void Oversampler::Stage::reset() {
+	for (int i = 0; i < MAX_FIR_TAPS * 2; i++) {
+		up_history[i] = 0.0f;
+		down_history[i] = 0.0f;
+	}
+	for (int i = 0; i < MAX_FIR_TAPS / 2; i++) {
+		down_odd[i] = 0.0f;
+	}
+	for (int i = 0; i < MAX_IIR_COEFS; i++) {
+		up_x[i] = 0.0f;
+		up_y[i] = 0.0f;
+		down_x[i] = 0.0f;
+		down_y[i] = 0.0f;
+	}
+	up_pos = 0;
+	down_pos = 0;
+	down_odd_pos = 0;
+}
+
+void Oversampler::Stage::upsample_fir(const float *p_in, int p_count, float *p_out) {
+	for (int n = 0; n < p_count; n++) {
+		up_pos = up_pos == 0 ? taps - 1 : up_pos - 1;
+		up_history[up_pos] = p_in[n];
+		up_history[up_pos + taps] = p_in[n];
+
+		// Zero stuffing doubles the gain the halfband removes
+		const float *window = up_history + up_pos;
+		p_out[n * 2] = 2.0f * dot(fir, window, taps);
+		p_out[n * 2 + 1] = window[taps / 2 - 1];
+	}
+}
+
+void Oversampler::Stage::downsample_fir(const float *p_in, int p_count, float *p_out) {
+	for (int n = 0; n < p_count; n++) {
+		down_pos = down_pos == 0 ? taps - 1 : down_pos - 1;
+		down_history[down_pos] = p_in[n * 2];
+		down_history[down_pos + taps] = p_in[n * 2];
+
+		// The centre tap reads the odd branch half a branch length back
+		float odd = down_odd[down_odd_pos];
+		down_odd[down_odd_pos] = p_in[n * 2 + 1];
+		down_odd_pos = down_odd_pos + 1 == taps / 2 ? 0 : down_odd_pos + 1;
+
+		p_out[n] = dot(fir, down_history + down_pos, taps) + 0.5f * odd;
+	}
+}
+
+void Oversampler::Stage::upsample_iir(const float *p_in, int p_count, float *p_out) {
+	for (int n = 0; n < p_count; n++) {
+		float even = p_in[n];
+		float odd = p_in[n];
+		for (int i = 0; i < coef_count; i += 2) {
+			even = allpass(even, iir[i], up_x[i], up_y[i]);
+			if (i + 1 < coef_count) {
+				odd = allpass(odd, iir[i + 1], up_x[i + 1], up_y[i + 1]);
+			}
+		}
+		p_out[n * 2] = even;
+		p_out[n * 2 + 1] = odd;
+	}
+}
+
+void Oversampler::Stage::downsample_iir(const float *p_in, int p_count, float *p_out) {
+	for (int n = 0; n < p_count; n++) {
+		float even = p_in[n * 2 + 1];
+		float odd = p_in[n * 2];
+		for (int i = 0; i < coef_count; i += 2) {
+			even = allpass(even, iir[i], down_x[i], down_y[i]);
+			if (i + 1 < coef_count) {
+				odd = allpass(odd, iir[i + 1], down_x[i + 1], down_y[i + 1]);
+			}
+		}
+		p_out[n] = 0.5f * (even + odd);
+	}
+}
+
+int Oversampler::get_supported_factor(int p_factor) {
+	if (p_factor >= 8) {
+		return 8;
+	}
+	if (p_factor >= 4) {
+		return 4;
+	}
+	if (p_factor >= 2) {
+		return 2;
+	}
+	return 1;
+}
+
+void Oversampler::setup(int p_factor, Phase p_phase) {
+	factor = get_supported_factor(p_factor);
+	phase = p_phase;
+	stage_count = 0;
+	while ((1 << stage_count) < factor) {
+		stage_count++;
+	}
+
+	// Stage i runs between 2^i and 2^(i+1) times the input rate, so its delay counts
+	// 2^i times less in input samples
+	latency = 0.0f;
+	for (int i = 0; i < stage_count; i++) {
+		Stage &stage = stages[i];
+		float scale = 1.0f / static_cast<float>(1 << i);
+		if (phase == PHASE_LINEAR) {
+			const FirHalfband &filter = i == 0 ? get_fir_first() : get_fir_later();
+			stage.taps = filter.count;
+			stage.fir = filter.taps;
+			stage.coef_count = 0;
+			stage.iir = nullptr;
+			latency += static_cast<float>(filter.count - 1) * scale;
+		} else {
+			const IirHalfband &filter = i == 0 ? get_iir_first() : get_iir_later();
+			stage.coef_count = filter.count;
+			stage.iir = filter.coefs;
+			stage.taps = 0;
+			stage.fir = nullptr;
+			latency += filter.latency * scale;
+		}
+	}
+
+	reset();
+}
+
+void Oversampler::reset() {
+	for (int i = 0; i < MAX_STAGES; i++) {
+		stages[i].reset();
+	}
+}
+
+void Oversampler::upsample(const float *p_in, int p_count, float *p_out) {
+	if (stage_count == 0) {
+		for (int i = 0; i < p_count; i++) {
+			p_out[i] = p_in[i];
+		}
+		return;
+	}
+
+	float scratch[2][BLOCK_SIZE * MAX_FACTOR];
+	for (int offset = 0; offset < p_count; offset += BLOCK_SIZE) {
+		int count = p_count - offset < BLOCK_SIZE ? p_count - offset : BLOCK_SIZE;
+		const float *source = p_in + offset;
+
+		// Each stage doubles the block, the last one writes straight to the output
+		for (int i = 0; i < stage_count; i++) {
+			float *target = i == stage_count - 1 ? p_out + offset * factor : scratch[i & 1];
+			if (phase == PHASE_LINEAR) {
+				stages[i].upsample_fir(source, count, target);
+			} else {
+				stages[i].upsample_iir(source, count, target);
+			}
+			source = target;
+			count *= 2;
+		}
+	}
+}
+
+void Oversampler::downsample(const float *p_in, int p_count, float *p_out) {
+	if (stage_count == 0) {
+		for (int i = 0; i < p_count; i++) {
+			p_out[i] = p_in[i];
+		}
+		return;
+	}
+
+	float scratch[2][BLOCK_SIZE * MAX_FACTOR];
+	for (int offset = 0; offset < p_count; offset += BLOCK_SIZE) {
+		int count = (p_count - offset < BLOCK_SIZE ? p_count - offset : BLOCK_SIZE) * factor;
+		const float *source = p_in + offset * factor;
+
+		// Stages unwind from the highest rate, the first one writes the output
+		for (int i = stage_count - 1; i >= 0; i--) {
+			count /= 2;
+			float *target = i == 0 ? p_out + offset : scratch[i & 1];
+			if (phase == PHASE_LINEAR) {
+				stages[i].downsample_fir(source, count, target);
+			} else {
+				stages[i].downsample_iir(source, count, target);
+			}
+			source = target;
+		}
+	}
+}
+
+} // namespace godot
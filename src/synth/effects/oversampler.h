@@ -0,0 +1,116 @@
+#ifndef OVERSAMPLER_H
+#define OVERSAMPLER_H
+
+namespace godot {
+
+// Polyphase halfband oversampler for the nonlinear parts of effects.
+// 2x, 4x and 8x are built from cascaded 2x stages. Each stage is a halfband lowpass
+// split into its two polyphase branches, so the filter only ever runs at the lower of
+// its two rates and the zero-stuffed or discarded samples are never computed.
+//
+// Linear phase stages are windowed sinc FIR halfbands: symmetric, every other tap zero,
+// constant delay. Minimum phase stages are allpass polyphase IIR halfbands: a few
+// multiplies per sample and a delay of one or two samples at low frequencies, with
+// phase shift near the band edge. get_latency() reports the delay of a full
+// upsample/downsample round trip in input samples so callers can align dry signals.
+//
+// The state is fixed size, an oversampler can be a plain member of an effect.
+class Oversampler {
+public:
+	enum Phase {
+		PHASE_LINEAR,
+		PHASE_MINIMUM
+	};
+
+	static constexpr int MAX_FACTOR = 8;
+	static constexpr int MAX_STAGES = 3;
+
+	// Input samples handled per pass of the block API
+	static constexpr int BLOCK_SIZE = 32;
+
+private:
+	// Largest branch length of a FIR stage, a multiple of four for the dot product
+	static constexpr int MAX_FIR_TAPS = 24;
+	static constexpr int MAX_IIR_COEFS = 8;
+
+	struct Stage {
+		int taps = 0;
+		const float *fir = nullptr;
+
+		int coef_count = 0;
+		const float *iir = nullptr;
+
+		// FIR upsampler history, written twice so the newest taps are always contiguous
+		float up_history[MAX_FIR_TAPS * 2] = {};
+		int up_pos = 0;
+
+		// FIR downsampler history of the even branch, and the delay of the odd branch
+		float down_history[MAX_FIR_TAPS * 2] = {};
+		int down_pos = 0;
+		float down_odd[MAX_FIR_TAPS / 2] = {};
+		int down_odd_pos = 0;
+
+		// IIR allpass memories, one input and one output per coefficient
+		float up_x[MAX_IIR_COEFS] = {};
+		float up_y[MAX_IIR_COEFS] = {};
+		float down_x[MAX_IIR_COEFS] = {};
+		float down_y[MAX_IIR_COEFS] = {};
+
+		void reset();
+
+		void upsample_fir(const float *p_in, int p_count, float *p_out);
+		void downsample_fir(const float *p_in, int p_count, float *p_out);
+		void upsample_iir(const float *p_in, int p_count, float *p_out);
+		void downsample_iir(const float *p_in, int p_count, float *p_out);
+	};
+
+	Stage stages[MAX_STAGES];
+	int factor = 1;
+	int stage_count = 0;
+	Phase phase = PHASE_LINEAR;
+	float latency = 0.0f;
+
+public:
+	Oversampler() = default;
+	Oversampler(int p_factor, Phase p_phase) { setup(p_factor, p_phase); }
+
+	// Factor is rounded down to 1, 2, 4 or 8. Changing the setup clears the filter state.
+	void setup(int p_factor, Phase p_phase);
+	void reset();
+
+	int get_factor() const { return factor; }
+	Phase get_phase() const { return phase; }
+
+	// Delay of an upsample followed by a downsample, in input samples
+	float get_latency() const { return latency; }
+
+	// p_out receives p_count * factor samples
+	void upsample(const float *p_in, int p_count, float *p_out);
+
+	// p_in holds p_count * factor samples, p_out receives p_count samples
+	void downsample(const float *p_in, int p_count, float *p_out);
+
+	// Run p_core on every oversampled sample of one input sample
+	template <typename F>
+	float process(float p_sample, F &&p_core) {
+		if (factor == 1) {
+			return p_core(p_sample);
+		}
+
+		float buffer[MAX_FACTOR];
+		upsample(&p_sample, 1, buffer);
+		for (int i = 0; i < factor; i++) {
+			buffer[i] = p_core(buffer[i]);
+		}
+		float output;
+		downsample(buffer, 1, &output);
+		return output;
+	}
+
+	// Round a requested factor down to a supported one
+	static int get_supported_factor(int p_factor);
+};
+
+} // namespace godot
+
+#endif // OVERSAMPLER_H
@@ -0,0 +1,368 @@
+#include "convolution_reverb.h"
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/math.hpp>
+
+namespace godot {
+
+namespace {
+
+// Stream, sample rate, kept length in milliseconds and normalization
+typedef std::tuple<uint64_t, int, int, bool> KernelKey;
+
+std::mutex kernel_cache_mutex;
+std::map<KernelKey, std::weak_ptr<const ConvolutionKernel>> kernel_cache;
+
+// Mono samples at p_sample_rate, cut to p_max_length seconds and trailing silence
+std::vector<float> decode_impulse(const Ref<AudioStreamWAV> &p_stream, float p_sample_rate, float p_max_length, bool p_normalize) {
+	std::vector<float> impulse;
+	AudioStreamWAV::Format format = p_stream->get_format();
+	ERR_FAIL_COND_V_MSG(format != AudioStreamWAV::FORMAT_8_BITS && format != AudioStreamWAV::FORMAT_16_BITS, impulse,
+			"ConvolutionReverb needs an uncompressed 8 or 16 bit impulse response.");
+
+	PackedByteArray data = p_stream->get_data();
+	int channels = p_stream->is_stereo() ? 2 : 1;
+	int sample_bytes = format == AudioStreamWAV::FORMAT_16_BITS ? 2 : 1;
+	int frames = data.size() / (channels * sample_bytes);
+	if (frames == 0) {
+		return impulse;
+	}
+
+	// Both formats are signed, 16 bit is little endian
+	const uint8_t *bytes = data.ptr();
+	std::vector<float> source(frames);
+	for (int f = 0; f < frames; f++) {
+		float sum = 0.0f;
+		for (int c = 0; c < channels; c++) {
+			const uint8_t *sample = bytes + (f * channels + c) * sample_bytes;
+			if (sample_bytes == 2) {
+				sum += static_cast<int16_t>(sample[0] | (sample[1] << 8)) * (1.0f / 32768.0f);
+			} else {
+				sum += static_cast<int8_t>(sample[0]) * (1.0f / 128.0f);
+			}
+		}
+		source[f] = sum / channels;
+	}
+
+	// Linear resampling is enough for a response, it only shades the top octave
+	double step = static_cast<double>(p_stream->get_mix_rate()) / p_sample_rate;
+	int length = MIN(static_cast<int>(frames / step), static_cast<int>(p_max_length * p_sample_rate));
+	impulse.resize(MAX(length, 0));
+	for (int i = 0; i < length; i++) {
+		double position = i * step;
+		int index = static_cast<int>(position);
+		float frac = static_cast<float>(position - index);
+		float next = index + 1 < frames ? source[index + 1] : 0.0f;
+		impulse[i] = source[index] + (next - source[index]) * frac;
+	}
+
+	// Silence at the end would only cost partitions
+	while (!impulse.empty() && std::fabs(impulse.back()) < 1.0e-5f) {
+		impulse.pop_back();
+	}
+
+	if (p_normalize) {
+		double energy = 0.0;
+		for (float value : impulse) {
+			energy += static_cast<double>(value) * value;
+		}
+		if (energy > 0.0) {
+			float scale = static_cast<float>(1.0 / std::sqrt(energy));
+			for (float &value : impulse) {
+				value *= scale;
+			}
+		}
+	}
+	return impulse;
+}
+
+std::shared_ptr<const ConvolutionKernel> acquire_kernel(const Ref<AudioStreamWAV> &p_stream, float p_sample_rate, float p_max_length, bool p_normalize, bool p_rebuild) {
+	if (p_stream.is_null()) {
+		return nullptr;
+	}
+
+	KernelKey key(p_stream->get_instance_id(), static_cast<int>(p_sample_rate), static_cast<int>(p_max_length * 1000.0f), p_normalize);
+	std::lock_guard<std::mutex> lock(kernel_cache_mutex);
+
+	// Forget kernels no effect holds any more
+	for (auto it = kernel_cache.begin(); it != kernel_cache.end();) {
+		if (it->second.expired()) {
+			it = kernel_cache.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	if (!p_rebuild) {
+		auto found = kernel_cache.find(key);
+		if (found != kernel_cache.end()) {
+			std::shared_ptr<const ConvolutionKernel> kernel = found->second.lock();
+			if (kernel) {
+				return kernel;
+			}
+		}
+	}
+
+	std::vector<float> impulse = decode_impulse(p_stream, p_sample_rate, p_max_length, p_normalize);
+	std::shared_ptr<const ConvolutionKernel> kernel = ConvolutionKernel::build(impulse.data(), static_cast<int>(impulse.size()));
+	kernel_cache[key] = kernel;
+	return kernel;
+}
+
+} // namespace
+
+// Define parameter name constants
+const char *ConvolutionReverb::PARAM_MIX = "mix";
+const char *ConvolutionReverb::PARAM_GAIN = "gain";
+
+void ConvolutionReverb::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_impulse_response", "impulse_response"), &ConvolutionReverb::set_impulse_response);
+	ClassDB::bind_method(D_METHOD("get_impulse_response"), &ConvolutionReverb::get_impulse_response);
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "impulse_response", PROPERTY_HINT_RESOURCE_TYPE, "AudioStreamWAV"),
+			"set_impulse_response", "get_impulse_response");
+
+	ClassDB::bind_method(D_METHOD("set_max_length", "seconds"), &ConvolutionReverb::set_max_length);
+	ClassDB::bind_method(D_METHOD("get_max_length"), &ConvolutionReverb::get_max_length);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_length", PROPERTY_HINT_RANGE, "0.1,10,0.1,suffix:s"),
+			"set_max_length", "get_max_length");
+
+	ClassDB::bind_method(D_METHOD("set_normalize", "normalize"), &ConvolutionReverb::set_normalize);
+	ClassDB::bind_method(D_METHOD("get_normalize"), &ConvolutionReverb::get_normalize);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "normalize"), "set_normalize", "get_normalize");
+
+	ClassDB::bind_method(D_METHOD("get_impulse_length"), &ConvolutionReverb::get_impulse_length);
+
+	// Mix
+	ClassDB::bind_method(D_METHOD("set_mix_base_value", "value"), &ConvolutionReverb::set_mix_base_value);
+	ClassDB::bind_method(D_METHOD("get_mix_base_value"), &ConvolutionReverb::get_mix_base_value);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "mix", PROPERTY_HINT_RANGE, "0,1,0.01"),
+			"set_mix_base_value", "get_mix_base_value");
+
+	ClassDB::bind_method(D_METHOD("set_mix_parameter", "param"), &ConvolutionReverb::set_mix_parameter);
+	ClassDB::bind_method(D_METHOD("get_mix_parameter"), &ConvolutionReverb::get_mix_parameter);
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mix_parameter", PROPERTY_HINT_RESOURCE_TYPE, "ModulatedParameter"),
+			"set_mix_parameter", "get_mix_parameter");
+
+	// Gain
+	ClassDB::bind_method(D_METHOD("set_gain_base_value", "value"), &ConvolutionReverb::set_gain_base_value);
+	ClassDB::bind_method(D_METHOD("get_gain_base_value"), &ConvolutionReverb::get_gain_base_value);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "gain", PROPERTY_HINT_RANGE, "0,4,0.01"),
+			"set_gain_base_value", "get_gain_base_value");
+
+	ClassDB::bind_method(D_METHOD("set_gain_parameter", "param"), &ConvolutionReverb::set_gain_parameter);
+	ClassDB::bind_method(D_METHOD("get_gain_parameter"), &ConvolutionReverb::get_gain_parameter);
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "gain_parameter", PROPERTY_HINT_RESOURCE_TYPE, "ModulatedParameter"),
+			"set_gain_parameter", "get_gain_parameter");
+}
+
+ConvolutionReverb::ConvolutionReverb() {
+	Ref<ModulatedParameter> mix_param = memnew(ModulatedParameter);
+	mix_param->set_base_value(0.3f); // 30% wet/dry mix
+	mix_param->set_mod_min(0.0f); // Dry only
+	mix_param->set_mod_max(1.0f); // Wet only
+	set_parameter(PARAM_MIX, mix_param);
+
+	Ref<ModulatedParameter> gain_param = memnew(ModulatedParameter);
+	gain_param->set_base_value(1.0f); // Unity wet level
+	gain_param->set_mod_min(0.0f);
+	gain_param->set_mod_max(4.0f);
+	set_parameter(PARAM_GAIN, gain_param);
+}
+
+ConvolutionReverb::~ConvolutionReverb() {
+}
+
+void ConvolutionReverb::update_kernel(bool p_rebuild) {
+	kernel = acquire_kernel(impulse_response, sample_rate, max_length, normalize, p_rebuild);
+	convolver.set_kernel(kernel);
+}
+
+float ConvolutionReverb::process_sample(float sample, const Ref<SynthNoteContext> &context) {
+	process_block(&sample, 1, context);
+	return sample;
+}
+
+void ConvolutionReverb::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	if (!context.is_valid() || !kernel) {
+		return;
+	}
+
+	float mix = 0.3f;
+	Ref<ModulatedParameter> mix_param = get_parameter(PARAM_MIX);
+	if (mix_param.is_valid()) {
+		mix = mix_param->get_value(context);
+	}
+
+	float gain = 1.0f;
+	Ref<ModulatedParameter> gain_param = get_parameter(PARAM_GAIN);
+	if (gain_param.is_valid()) {
+		gain = gain_param->get_value(context);
+	}
+
+	float dry_gain = 1.0f - mix;
+	float wet_gain = gain * mix;
+	float wet[ConvolutionKernel::BLOCK_SIZE];
+	for (int offset = 0; offset < p_count; offset += ConvolutionKernel::BLOCK_SIZE) {
+		int count = MIN(ConvolutionKernel::BLOCK_SIZE, p_count - offset);
+		float *buffer = p_buffer + offset;
+		convolver.process(buffer, wet, count);
+		for (int i = 0; i < count; i++) {
+			buffer[i] = buffer[i] * dry_gain + wet[i] * wet_gain;
+		}
+	}
+}
+
+void ConvolutionReverb::reset() {
+	convolver.reset();
+}
+
+bool ConvolutionReverb::get_constant_gain(float &r_gain) const {
+	// The wet gain is gain * mix, so a dry mix drops the convolution
+	r_gain = 1.0f;
+	return has_constant_value(PARAM_MIX, 0.0f);
+}
+
+bool ConvolutionReverb::is_linear() const {
+	return true;
+}
+
+float ConvolutionReverb::get_tail_length() const {
+	if (!kernel) {
+		return 0.0f;
+	}
+	return (kernel->get_length() + ConvolutionKernel::BLOCK_SIZE) / sample_rate;
+}
+
+Ref<SynthAudioEffect> ConvolutionReverb::duplicate() const {
+	Ref<ConvolutionReverb> new_reverb = memnew(ConvolutionReverb);
+
+	// The copy shares the kernel instead of loading the response again
+	new_reverb->impulse_response = impulse_response;
+	new_reverb->max_length = max_length;
+	new_reverb->normalize = normalize;
+	new_reverb->sample_rate = sample_rate;
+	new_reverb->kernel = kernel;
+	new_reverb->convolver.set_kernel(kernel);
+
+	// Copy parameters
+	Dictionary params = get_parameters();
+	Array param_names = params.keys();
+	for (int i = 0; i < param_names.size(); i++) {
+		String name = param_names[i];
+		Ref<ModulatedParameter> param = params[name];
+		if (param.is_valid()) {
+			Ref<ModulatedParameter> new_param = param->duplicate();
+			new_reverb->set_parameter(name, new_param);
+		}
+	}
+
+	return new_reverb;
+}
+
+size_t ConvolutionReverb::get_state_size() const {
+	return VoiceStateArena::align_size(convolver.get_state_size());
+}
+
+void ConvolutionReverb::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	if (convolver.get_state_size() == 0) {
+		return;
+	}
+	convolver.bind_storage(p_allocator.allocate(convolver.get_state_size()));
+}
+
+void ConvolutionReverb::set_sample_rate(float p_sample_rate) {
+	if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+		return;
+	}
+	sample_rate = p_sample_rate;
+	update_kernel(false);
+}
+
+void ConvolutionReverb::set_impulse_response(const Ref<AudioStreamWAV> &p_impulse_response) {
+	impulse_response = p_impulse_response;
+	update_kernel(true);
+}
+
+Ref<AudioStreamWAV> ConvolutionReverb::get_impulse_response() const {
+	return impulse_response;
+}
+
+void ConvolutionReverb::set_max_length(float p_max_length) {
+	max_length = CLAMP(p_max_length, 0.1f, 10.0f);
+	update_kernel(false);
+}
+
+float ConvolutionReverb::get_max_length() const {
+	return max_length;
+}
+
+void ConvolutionReverb::set_normalize(bool p_normalize) {
+	normalize = p_normalize;
+	update_kernel(false);
+}
+
+bool ConvolutionReverb::get_normalize() const {
+	return normalize;
+}
+
+int ConvolutionReverb::get_impulse_length() const {
+	return kernel ? kernel->get_length() : 0;
+}
+
+// Parameter accessors
+void ConvolutionReverb::set_mix_parameter(const Ref<ModulatedParameter> &param) {
+	if (param.is_valid()) {
+		set_parameter(PARAM_MIX, param);
+	}
+}
+
+Ref<ModulatedParameter> ConvolutionReverb::get_mix_parameter() const {
+	return get_parameter(PARAM_MIX);
+}
+
+void ConvolutionReverb::set_mix_base_value(float p_value) {
+	Ref<ModulatedParameter> param = get_mix_parameter();
+	if (param.is_valid()) {
+		param->set_base_value(p_value);
+	}
+}
+
+float ConvolutionReverb::get_mix_base_value() const {
+	Ref<ModulatedParameter> param = get_mix_parameter();
+	if (param.is_valid()) {
+		return param->get_base_value();
+	}
+	return 0.0f;
+}
+
+void ConvolutionReverb::set_gain_parameter(const Ref<ModulatedParameter> &param) {
+	if (param.is_valid()) {
+		set_parameter(PARAM_GAIN, param);
+	}
+}
+
+Ref<ModulatedParameter> ConvolutionReverb::get_gain_parameter() const {
+	return get_parameter(PARAM_GAIN);
+}
+
+void ConvolutionReverb::set_gain_base_value(float p_value) {
+	Ref<ModulatedParameter> param = get_gain_parameter();
+	if (param.is_valid()) {
+		param->set_base_value(p_value);
+	}
+}
+
+float ConvolutionReverb::get_gain_base_value() const {
+	Ref<ModulatedParameter> param = get_gain_parameter();
+	if (param.is_valid()) {
+		return param->get_base_value();
+	}
+	return 0.0f;
+}
+
+} // namespace godot
@@ -0,0 +1,82 @@
+#ifndef CONVOLUTION_REVERB_H
+#define CONVOLUTION_REVERB_H
+
+#include "../synth_audio_effect.h"
+#include "partitioned_convolver.h"
+#include <godot_cpp/classes/audio_stream_wav.hpp>
+#include <memory>
+
+namespace godot {
+
+// Reverb that convolves with a recorded impulse response.
+// The response is read from an AudioStreamWAV, mixed to mono, resampled to the engine's
+// rate and transformed into a ConvolutionKernel. Kernels are cached by stream and rate,
+// so every voice of every player using the same response shares one read-only copy and
+// keeps only its own input history. The wet signal runs one 32-sample block late.
+class ConvolutionReverb : public SynthAudioEffect {
+	GDCLASS(ConvolutionReverb, SynthAudioEffect)
+
+private:
+	Ref<AudioStreamWAV> impulse_response;
+	float max_length = 4.0f;
+	bool normalize = true;
+	float sample_rate = 44100.0f;
+
+	std::shared_ptr<const ConvolutionKernel> kernel;
+	PartitionedConvolver convolver;
+
+	// Look the kernel up again, p_rebuild skips the cache for edited streams
+	void update_kernel(bool p_rebuild);
+
+public:
+	// Parameter names
+	static const char *PARAM_MIX;
+	static const char *PARAM_GAIN;
+
+protected:
+	static void _bind_methods();
+
+public:
+	ConvolutionReverb();
+	~ConvolutionReverb();
+
+	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) override;
+	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
+	bool is_linear() const override;
+	float get_tail_length() const override;
+	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
+	void set_sample_rate(float p_sample_rate) override;
+
+	void set_impulse_response(const Ref<AudioStreamWAV> &p_impulse_response);
+	Ref<AudioStreamWAV> get_impulse_response() const;
+
+	// Seconds of the response that are kept, the rest is cut off
+	void set_max_length(float p_max_length);
+	float get_max_length() const;
+
+	// Scale the response to unit energy, so the tail is about as loud as the input
+	void set_normalize(bool p_normalize);
+	bool get_normalize() const;
+
+	// Samples of the response after loading, 0 without one
+	int get_impulse_length() const;
+
+	// Parameter accessors
+	void set_mix_parameter(const Ref<ModulatedParameter> &param);
+	Ref<ModulatedParameter> get_mix_parameter() const;
+	void set_mix_base_value(float p_value);
+	float get_mix_base_value() const;
+
+	void set_gain_parameter(const Ref<ModulatedParameter> &param);
+	Ref<ModulatedParameter> get_gain_parameter() const;
+	void set_gain_base_value(float p_value);
+	float get_gain_base_value() const;
+};
+
+} // namespace godot
+
+#endif // CONVOLUTION_REVERB_H
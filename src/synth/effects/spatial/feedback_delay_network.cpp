@@ -0,0 +1,337 @@
+#include "feedback_delay_network.h"
+#include "../../core/dsp_math.h"
+#include <algorithm>
+
+namespace godot {
+
+namespace {
+
+// Spread over a bit more than an octave so the echo densities of the lines interleave
+const float LINE_TIMES_MS[FeedbackDelayNetwork::LINE_COUNT] = { 31.7f, 37.3f, 41.9f, 47.3f, 53.1f, 59.9f, 67.7f, 73.3f };
+
+const float EARLY_TAP_TIMES_MS[FeedbackDelayNetwork::EARLY_TAP_COUNT] = { 4.3f, 9.7f, 14.9f, 21.1f, 27.8f, 35.3f };
+const float EARLY_TAP_GAINS[FeedbackDelayNetwork::EARLY_TAP_COUNT] = { 0.42f, 0.36f, 0.3f, 0.25f, 0.21f, 0.18f };
+
+const float DIFFUSER_TIMES_MS[FeedbackDelayNetwork::DIFFUSER_COUNT] = { 4.77f, 3.59f };
+
+// Unrelated rates so the drifts never line up
+const float MODULATION_DEPTH_MS = 0.3f;
+const float MODULATION_RATES[FeedbackDelayNetwork::LINE_COUNT] = { 0.53f, 0.71f, 0.37f, 0.89f, 0.61f, 0.43f, 0.97f, 0.79f };
+
+// Input and output sign patterns, neither is a row of the matrix so every line takes
+// part in both directions
+const float INPUT_SIGNS[FeedbackDelayNetwork::LINE_COUNT] = { 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+const float OUTPUT_SIGNS[FeedbackDelayNetwork::LINE_COUNT] = { 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f };
+
+// Normalizes the Hadamard matrix of order eight
+const float MATRIX_SCALE = 0.353553391f;
+
+// Level of the tail relative to the early reflections
+const float INPUT_GAIN = 0.5f;
+const float OUTPUT_GAIN = 0.35f;
+
+bool is_prime(int p_value) {
+	if (p_value < 2) {
+		return false;
+	}
+	for (int divisor = 2; divisor * divisor <= p_value; divisor++) {
+		if (p_value % divisor == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int next_prime(int p_value) {
+	while (!is_prime(p_value)) {
+		p_value++;
+	}
+	return p_value;
+}
+
+} // namespace
+
+void FeedbackDelayNetwork::setup(float p_sample_rate) {
+	sample_rate = p_sample_rate;
+	float samples_per_ms = sample_rate * 0.001f;
+
+	for (int i = 0; i < EARLY_TAP_COUNT; i++) {
+		early_taps[i] = std::max(static_cast<int>(EARLY_TAP_TIMES_MS[i] * samples_per_ms + 0.5f), 1);
+	}
+	int max_pre_delay = static_cast<int>(MAX_PRE_DELAY * sample_rate);
+	input_line.resize(std::max(early_taps[EARLY_TAP_COUNT - 1], max_pre_delay) + BLOCK_SIZE);
+
+	for (int i = 0; i < DIFFUSER_COUNT; i++) {
+		diffuser_lengths[i] = next_prime(std::max(static_cast<int>(DIFFUSER_TIMES_MS[i] * samples_per_ms), 2));
+		diffusers[i].resize(diffuser_lengths[i]);
+	}
+
+	// Every read head must stay more than a block behind its write head
+	modulation_depth = MODULATION_DEPTH_MS * samples_per_ms;
+	int shortest = BLOCK_SIZE + static_cast<int>(modulation_depth) + 2;
+	for (int i = 0; i < LINE_COUNT; i++) {
+		line_lengths[i] = next_prime(std::max(static_cast<int>(LINE_TIMES_MS[i] * samples_per_ms), shortest));
+		lines[i].resize(line_lengths[i]);
+		modulation_increments[i] = MODULATION_RATES[i] / sample_rate;
+	}
+
+	// The loop gains depend on the line lengths
+	coefficients_valid = false;
+	set_settings(settings);
+	reset();
+}
+
+void FeedbackDelayNetwork::release() {
+	input_line.resize(0);
+	for (int i = 0; i < DIFFUSER_COUNT; i++) {
+		diffusers[i].resize(0);
+	}
+	for (int i = 0; i < LINE_COUNT; i++) {
+		lines[i].resize(0);
+	}
+}
+
+void FeedbackDelayNetwork::reset() {
+	input_line.clear();
+	for (int i = 0; i < DIFFUSER_COUNT; i++) {
+		diffusers[i].clear();
+	}
+	for (int i = 0; i < LINE_COUNT; i++) {
+		lines[i].clear();
+		lowpass_states[i] = 0.0f;
+		modulation_phases[i] = static_cast<float>(i) / LINE_COUNT;
+	}
+	update_read_delays(read_delays, 0);
+	drift_countdown = 0;
+}
+
+void FeedbackDelayNetwork::set_modulation(bool p_enabled) {
+	if (p_enabled && !modulation) {
+		// Start every drift at the top of the line, where the heads rested
+		for (int i = 0; i < LINE_COUNT; i++) {
+			modulation_phases[i] = 0.75f;
+			read_delays[i] = static_cast<float>(line_lengths[i]);
+		}
+		drift_countdown = 0;
+	}
+	modulation = p_enabled;
+}
+
+void FeedbackDelayNetwork::update_read_delays(float *r_targets, int p_count) {
+	for (int i = 0; i < LINE_COUNT; i++) {
+		float phase = modulation_phases[i] + modulation_increments[i] * static_cast<float>(p_count);
+		phase -= static_cast<float>(static_cast<int>(phase));
+		modulation_phases[i] = phase;
+		float drift = 0.5f + 0.5f * DspMath::sin_turns(phase);
+		r_targets[i] = static_cast<float>(line_lengths[i]) - modulation_depth * drift;
+	}
+}
+
+size_t FeedbackDelayNetwork::get_state_size() const {
+	size_t size = VoiceStateArena::align_size(input_line.get_capacity());
+	for (int i = 0; i < DIFFUSER_COUNT; i++) {
+		size += VoiceStateArena::align_size(diffusers[i].get_capacity());
+	}
+	for (int i = 0; i < LINE_COUNT; i++) {
+		size += VoiceStateArena::align_size(lines[i].get_capacity());
+	}
+	return size;
+}
+
+void FeedbackDelayNetwork::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	input_line.bind_storage(p_allocator.allocate(input_line.get_capacity()));
+	for (int i = 0; i < DIFFUSER_COUNT; i++) {
+		diffusers[i].bind_storage(p_allocator.allocate(diffusers[i].get_capacity()));
+	}
+	for (int i = 0; i < LINE_COUNT; i++) {
+		lines[i].bind_storage(p_allocator.allocate(lines[i].get_capacity()));
+	}
+}
+
+void FeedbackDelayNetwork::set_settings(const Settings &p_settings) {
+	// Gains scaled to each line's length give every line the same decay time, the
+	// lowpass in the loop shortens it for the highs
+	if (!coefficients_valid || p_settings.decay_time != settings.decay_time || p_settings.damping_cutoff != settings.damping_cutoff) {
+		float decay_time = std::max(p_settings.decay_time, 0.05f);
+		for (int i = 0; i < LINE_COUNT; i++) {
+			float decay_db = -60.0f * static_cast<float>(line_lengths[i]) / (decay_time * sample_rate);
+			gains[i] = MATRIX_SCALE * DspMath::db_to_gain(decay_db);
+		}
+		lowpass = DspMath::one_pole_coefficient(std::min(p_settings.damping_cutoff, 0.45f * sample_rate), sample_rate);
+		coefficients_valid = true;
+	}
+	diffusion = std::min(std::max(p_settings.diffusion, 0.0f), 0.9f);
+	pre_delay = std::min(std::max(static_cast<int>(p_settings.pre_delay * sample_rate), 0), static_cast<int>(MAX_PRE_DELAY * sample_rate));
+	settings = p_settings;
+}
+
+void FeedbackDelayNetwork::process_block(const float *p_input, float *p_early, float *p_late, int p_count) {
+	for (int offset = 0; offset < p_count; offset += BLOCK_SIZE) {
+		int count = std::min(BLOCK_SIZE, p_count - offset);
+		process_chunk(p_input + offset, p_early + offset, p_late + offset, count);
+	}
+}
+
+void FeedbackDelayNetwork::process_sample(float p_input, float &r_early, float &r_late) {
+	input_line.write(p_input);
+
+	float early = 0.0f;
+	for (int t = 0; t < EARLY_TAP_COUNT; t++) {
+		early += input_line.read(1 + early_taps[t]) * EARLY_TAP_GAINS[t];
+	}
+	float tank_input = input_line.read(1 + pre_delay);
+
+	for (int d = 0; d < DIFFUSER_COUNT; d++) {
+		DelayLine<float> &diffuser = diffusers[d];
+		float delayed = diffuser.read(diffuser_lengths[d]);
+		float w = tank_input + diffusion * delayed;
+		diffuser.write(w);
+		tank_input = delayed - diffusion * w;
+	}
+
+	// The heads glide a block at a time, so the drift costs one sine per line per block
+	float taps[LINE_COUNT];
+	if (modulation) {
+		if (drift_countdown == 0) {
+			float targets[LINE_COUNT];
+			update_read_delays(targets, BLOCK_SIZE);
+			for (int i = 0; i < LINE_COUNT; i++) {
+				drift_steps[i] = (targets[i] - read_delays[i]) / static_cast<float>(BLOCK_SIZE);
+			}
+			drift_countdown = BLOCK_SIZE;
+		}
+		drift_countdown--;
+		for (int i = 0; i < LINE_COUNT; i++) {
+			taps[i] = lines[i].read_linear(read_delays[i]);
+			read_delays[i] += drift_steps[i];
+		}
+	} else {
+		for (int i = 0; i < LINE_COUNT; i++) {
+			taps[i] = lines[i].read(line_lengths[i]);
+		}
+	}
+
+	float late = 0.0f;
+	for (int i = 0; i < LINE_COUNT; i++) {
+		late += taps[i] * OUTPUT_SIGNS[i] * OUTPUT_GAIN;
+		float decayed = taps[i] * gains[i];
+		lowpass_states[i] = decayed + lowpass * (lowpass_states[i] - decayed);
+		taps[i] = lowpass_states[i];
+	}
+
+	for (int span = 1; span < LINE_COUNT; span <<= 1) {
+		for (int i = 0; i < LINE_COUNT; i += span * 2) {
+			for (int j = i; j < i + span; j++) {
+				float x = taps[j];
+				float y = taps[j + span];
+				taps[j] = x + y;
+				taps[j + span] = x - y;
+			}
+		}
+	}
+
+	for (int i = 0; i < LINE_COUNT; i++) {
+		lines[i].write(taps[i] + tank_input * INPUT_SIGNS[i] * INPUT_GAIN);
+	}
+
+	r_early = early;
+	r_late = late;
+}
+
+void FeedbackDelayNetwork::process_chunk(const float *p_input, float *p_early, float *p_late, int p_count) {
+	alignas(32) float taps[LINE_COUNT][BLOCK_SIZE];
+	alignas(32) float tank_input[BLOCK_SIZE];
+	alignas(32) float tap[BLOCK_SIZE];
+
+	// The dry block goes in first so a pre-delay shorter than the block can read it
+	input_line.write_block(p_input, p_count);
+
+	for (int n = 0; n < p_count; n++) {
+		p_early[n] = 0.0f;
+	}
+	for (int t = 0; t < EARLY_TAP_COUNT; t++) {
+		input_line.read_block(tap, p_count, p_count + early_taps[t]);
+		float gain = EARLY_TAP_GAINS[t];
+		for (int n = 0; n < p_count; n++) {
+			p_early[n] += tap[n] * gain;
+		}
+	}
+	input_line.read_block(tank_input, p_count, p_count + pre_delay);
+
+	// Series allpasses smear the input into a dense burst before it enters the tank
+	for (int d = 0; d < DIFFUSER_COUNT; d++) {
+		DelayLine<float> &diffuser = diffusers[d];
+		int length = diffuser_lengths[d];
+		for (int n = 0; n < p_count; n++) {
+			float delayed = diffuser.read(length);
+			float w = tank_input[n] + diffusion * delayed;
+			diffuser.write(w);
+			tank_input[n] = delayed - diffusion * w;
+		}
+	}
+
+	// Read the whole block from every line, none of them is shorter than the block
+	if (modulation) {
+		float targets[LINE_COUNT];
+		update_read_delays(targets, p_count);
+		for (int i = 0; i < LINE_COUNT; i++) {
+			lines[i].read_block_linear(taps[i], p_count, read_delays[i], targets[i]);
+			read_delays[i] = targets[i];
+		}
+		// A following single sample starts a new glide from here
+		drift_countdown = 0;
+	} else {
+		for (int i = 0; i < LINE_COUNT; i++) {
+			lines[i].read_block(taps[i], p_count, line_lengths[i]);
+		}
+	}
+
+	for (int n = 0; n < p_count; n++) {
+		p_late[n] = 0.0f;
+	}
+	for (int i = 0; i < LINE_COUNT; i++) {
+		float sign = OUTPUT_SIGNS[i] * OUTPUT_GAIN;
+		for (int n = 0; n < p_count; n++) {
+			p_late[n] += taps[i][n] * sign;
+		}
+	}
+
+	// Decay and damping, the one pole runs along each line
+	for (int i = 0; i < LINE_COUNT; i++) {
+		float gain = gains[i];
+		float state = lowpass_states[i];
+		for (int n = 0; n < p_count; n++) {
+			float decayed = taps[i][n] * gain;
+			state = decayed + lowpass * (state - decayed);
+			taps[i][n] = state;
+		}
+		lowpass_states[i] = state;
+	}
+
+	// Fast Hadamard transform, three butterfly stages across the lines. Each
+	// butterfly runs along the block, so the loops vectorize over samples.
+	for (int span = 1; span < LINE_COUNT; span <<= 1) {
+		for (int i = 0; i < LINE_COUNT; i += span * 2) {
+			for (int j = i; j < i + span; j++) {
+				float *a = taps[j];
+				float *b = taps[j + span];
+				for (int n = 0; n < p_count; n++) {
+					float x = a[n];
+					float y = b[n];
+					a[n] = x + y;
+					b[n] = x - y;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < LINE_COUNT; i++) {
+		float sign = INPUT_SIGNS[i] * INPUT_GAIN;
+		for (int n = 0; n < p_count; n++) {
+			taps[i][n] += tank_input[n] * sign;
+		}
+		lines[i].write_block(taps[i], p_count);
+	}
+}
+
+} // namespace godot
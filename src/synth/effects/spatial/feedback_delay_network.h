@@ -0,0 +1,103 @@
+#ifndef FEEDBACK_DELAY_NETWORK_H
+#define FEEDBACK_DELAY_NETWORK_H
+
+#include "../../core/voice_state_arena.h"
+#include "../delay/delay_line.h"
+
+namespace godot {
+
+// Reverb tank of eight delay lines fed back through a Hadamard matrix.
+// The matrix is orthogonal, so the loop neither gains nor loses energy and the decay is
+// set by one gain per line, scaled to the line's length so every line falls 60 dB in
+// the same time. Line lengths are given in milliseconds and turned into prime sample
+// counts for the running sample rate.
+//
+// Every line is longer than BLOCK_SIZE, so none of them reads what the same block
+// writes. A block is read from all lines at once, mixed across the lines one vector of
+// samples at a time, and written back as a block. Slow, unrelated drifts of the read
+// heads keep the modes of the tank from ringing metallic. A single sample runs the same
+// loop without the block buffers, its read heads gliding towards a target set once per
+// BLOCK_SIZE samples.
+class FeedbackDelayNetwork {
+public:
+	static constexpr int LINE_COUNT = 8;
+	static constexpr int EARLY_TAP_COUNT = 6;
+	static constexpr int DIFFUSER_COUNT = 2;
+	static constexpr int BLOCK_SIZE = 32;
+
+	// Longest pre-delay in seconds
+	static constexpr float MAX_PRE_DELAY = 0.1f;
+
+	struct Settings {
+		float decay_time = 2.0f; // Seconds for the tail to fall 60 dB
+		float damping_cutoff = 8000.0f; // Hz, higher frequencies die out faster
+		float diffusion = 0.5f; // Gain of the input allpasses, below 1
+		float pre_delay = 0.02f; // Seconds between the dry sound and the tail
+	};
+
+private:
+	float sample_rate = 44100.0f;
+	bool modulation = true;
+
+	// Dry input, read by the early reflection taps and the pre-delay
+	DelayLine<float> input_line;
+	DelayLine<float> diffusers[DIFFUSER_COUNT];
+	DelayLine<float> lines[LINE_COUNT];
+
+	int early_taps[EARLY_TAP_COUNT] = {};
+	int diffuser_lengths[DIFFUSER_COUNT] = {};
+	int line_lengths[LINE_COUNT] = {};
+
+	// Read heads drift up to modulation_depth samples shorter than the line
+	float modulation_depth = 0.0f;
+	float modulation_phases[LINE_COUNT] = {};
+	float modulation_increments[LINE_COUNT] = {};
+	float read_delays[LINE_COUNT] = {};
+
+	// Per sample glide of the read heads and the samples left until the next target
+	float drift_steps[LINE_COUNT] = {};
+	int drift_countdown = 0;
+
+	float lowpass_states[LINE_COUNT] = {};
+
+	// Loop coefficients for the last settings, only redone when the decay or damping moves
+	Settings settings;
+	bool coefficients_valid = false;
+	float gains[LINE_COUNT] = {};
+	float lowpass = 0.0f;
+	float diffusion = 0.0f;
+	int pre_delay = 0;
+
+	void update_read_delays(float *r_targets, int p_count);
+	void process_chunk(const float *p_input, float *p_early, float *p_late, int p_count);
+
+public:
+	// Size the lines for p_sample_rate and clear them, needed before the first block
+	void setup(float p_sample_rate);
+
+	// Shrink the lines to almost nothing while another algorithm runs
+	void release();
+
+	void reset();
+
+	// Drifting read heads, off is cheaper and reads whole blocks without interpolation
+	void set_modulation(bool p_enabled);
+	bool get_modulation() const { return modulation; }
+
+	size_t get_state_size() const;
+	void bind_state(VoiceStateArena::Allocator &p_allocator);
+
+	// Settings for the following blocks and samples
+	void set_settings(const Settings &p_settings);
+
+	// Early reflections and late tail of p_count input samples, unscaled.
+	// The outputs must not alias the input.
+	void process_block(const float *p_input, float *p_early, float *p_late, int p_count);
+
+	// Early reflections and late tail of a single input sample, unscaled
+	void process_sample(float p_input, float &r_early, float &r_late);
+};
+
+} // namespace godot
+
+#endif // FEEDBACK_DELAY_NETWORK_H
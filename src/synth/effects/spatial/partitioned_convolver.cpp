@@ -0,0 +1,249 @@
+#include "partitioned_convolver.h"
+#include "../../core/voice_state_arena.h"
+#include <algorithm>
+
+namespace godot {
+
+namespace {
+
+uint32_t next_power_of_two(uint32_t p_value) {
+	uint32_t size = 1;
+	while (size < p_value) {
+		size <<= 1;
+	}
+	return size;
+}
+
+// r += a * b over p_count complex bins
+void multiply_accumulate(const float *__restrict p_a_re, const float *__restrict p_a_im, const float *__restrict p_b_re, const float *__restrict p_b_im,
+		float *__restrict r_re, float *__restrict r_im, int p_count) {
+	for (int k = 0; k < p_count; k++) {
+		r_re[k] += p_a_re[k] * p_b_re[k] - p_a_im[k] * p_b_im[k];
+		r_im[k] += p_a_re[k] * p_b_im[k] + p_a_im[k] * p_b_re[k];
+	}
+}
+
+} // namespace
+
+std::shared_ptr<const ConvolutionKernel> ConvolutionKernel::build(const float *p_impulse, int p_length) {
+	std::shared_ptr<ConvolutionKernel> kernel = std::make_shared<ConvolutionKernel>();
+	kernel->length = std::max(p_length, 0);
+
+	RealFft fft;
+	std::vector<float> frame;
+	int offset = 0;
+	int size = BLOCK_SIZE;
+	while (offset < kernel->length) {
+		// Cover the response up to where the next partition size may start
+		int next = size * 8;
+		int end = kernel->length;
+		if (next <= MAX_PARTITION_SIZE) {
+			end = std::min(end, std::max(2 * next, offset + size));
+		}
+
+		Segment segment;
+		segment.partition_size = size;
+		segment.offset = offset;
+		segment.partition_count = (end - offset + size - 1) / size;
+
+		// Partitions are zero padded to the FFT length, 1 / 2P undoes the inverse's gain
+		int bins = size + 1;
+		segment.spectra_re.resize(segment.partition_count * bins);
+		segment.spectra_im.resize(segment.partition_count * bins);
+		fft.setup(2 * size);
+		frame.assign(2 * size, 0.0f);
+		float scale = 1.0f / (2 * size);
+		for (int k = 0; k < segment.partition_count; k++) {
+			int start = offset + k * size;
+			for (int i = 0; i < size; i++) {
+				frame[i] = start + i < kernel->length ? p_impulse[start + i] * scale : 0.0f;
+			}
+			fft.forward(frame.data(), segment.spectra_re.data() + k * bins, segment.spectra_im.data() + k * bins);
+		}
+
+		offset += segment.partition_count * size;
+		kernel->segments.push_back(std::move(segment));
+		if (next <= MAX_PARTITION_SIZE) {
+			size = next;
+		}
+	}
+	return kernel;
+}
+
+void PartitionedConvolver::set_kernel(const std::shared_ptr<const ConvolutionKernel> &p_kernel) {
+	kernel.reset();
+	states.clear();
+	storage = nullptr;
+	storage_size = 0;
+	input_ring = nullptr;
+	output_ring = nullptr;
+	if (!p_kernel || p_kernel->get_segments().empty()) {
+		return;
+	}
+	kernel = p_kernel;
+
+	// The input ring holds the longest frame, the output ring reaches as far ahead as
+	// the last segment writes
+	const std::vector<ConvolutionKernel::Segment> &segments = kernel->get_segments();
+	int longest = ConvolutionKernel::BLOCK_SIZE;
+	int reach = 0;
+	states.resize(segments.size());
+	for (size_t s = 0; s < segments.size(); s++) {
+		int size = segments[s].partition_size;
+		states[s].fft.setup(2 * size);
+		longest = std::max(longest, size);
+		reach = std::max(reach, segments[s].offset + size);
+	}
+	input_mask = next_power_of_two(2 * longest) - 1;
+	output_mask = next_power_of_two(reach + 2 * ConvolutionKernel::BLOCK_SIZE) - 1;
+
+	// Only measured here, the state lives in storage bound at configuration time
+	layout(nullptr);
+	reset();
+}
+
+void PartitionedConvolver::layout(float *p_storage) {
+	size_t used = 0;
+	auto take = [&](size_t p_count) {
+		float *block = p_storage ? p_storage + used : nullptr;
+		used += VoiceStateArena::align_size(p_count);
+		return block;
+	};
+
+	input_ring = take(input_mask + 1);
+	output_ring = take(output_mask + 1);
+	const std::vector<ConvolutionKernel::Segment> &segments = kernel->get_segments();
+	for (size_t s = 0; s < segments.size(); s++) {
+		SegmentState &state = states[s];
+		size_t bins = segments[s].partition_size + 1;
+		state.history_re = take(segments[s].partition_count * bins);
+		state.history_im = take(segments[s].partition_count * bins);
+		state.sum_re = take(bins);
+		state.sum_im = take(bins);
+		state.frame = take(2 * segments[s].partition_size);
+	}
+	storage_size = used;
+}
+
+void PartitionedConvolver::bind_storage(float *p_storage) {
+	if (p_storage == nullptr || storage_size == 0) {
+		return;
+	}
+	layout(p_storage);
+	storage = p_storage;
+	reset();
+}
+
+void PartitionedConvolver::reset() {
+	time = 0;
+	if (!kernel) {
+		return;
+	}
+	if (storage) {
+		std::fill(storage, storage + storage_size, 0.0f);
+	}
+
+	// Idle until the first partition of each segment is complete
+	const std::vector<ConvolutionKernel::Segment> &segments = kernel->get_segments();
+	for (size_t s = 0; s < segments.size(); s++) {
+		SegmentState &state = states[s];
+		state.head = 0;
+		state.block_end = 0;
+		state.work_done = segments[s].partition_count + 2;
+		state.ticks_done = segments[s].partition_size / ConvolutionKernel::BLOCK_SIZE;
+	}
+}
+
+void PartitionedConvolver::process(const float *p_input, float *r_output, int p_count) {
+	if (!kernel || !storage) {
+		// No allocation here, an unbound convolver stays silent
+		std::fill(r_output, r_output + p_count, 0.0f);
+		return;
+	}
+
+	const uint32_t block_mask = ConvolutionKernel::BLOCK_SIZE - 1;
+	int i = 0;
+	while (i < p_count) {
+		int run = std::min(p_count - i, static_cast<int>(ConvolutionKernel::BLOCK_SIZE - (time & block_mask)));
+		for (int n = 0; n < run; n++) {
+			uint32_t t = time + n;
+			float input = p_input[i + n];
+			input_ring[t & input_mask] = input;
+			r_output[i + n] = output_ring[t & output_mask];
+			output_ring[t & output_mask] = 0.0f;
+		}
+		time += run;
+		i += run;
+		if ((time & block_mask) == 0) {
+			tick();
+		}
+	}
+}
+
+void PartitionedConvolver::tick() {
+	const std::vector<ConvolutionKernel::Segment> &segments = kernel->get_segments();
+	for (size_t s = 0; s < segments.size(); s++) {
+		const ConvolutionKernel::Segment &segment = segments[s];
+		SegmentState &state = states[s];
+		int ticks = segment.partition_size / ConvolutionKernel::BLOCK_SIZE;
+		int units = segment.partition_count + 2;
+
+		if ((time & static_cast<uint32_t>(segment.partition_size - 1)) == 0) {
+			state.block_end = time;
+			state.work_done = 0;
+			state.ticks_done = 0;
+		}
+		if (state.ticks_done >= ticks) {
+			continue;
+		}
+
+		// An even share of the job per tick: the transform, one unit per partition
+		// and the inverse
+		state.ticks_done++;
+		int target = (units * state.ticks_done + ticks - 1) / ticks;
+		while (state.work_done < target) {
+			run_work(static_cast<int>(s), state.work_done++);
+		}
+	}
+}
+
+void PartitionedConvolver::run_work(int p_segment, int p_unit) {
+	const ConvolutionKernel::Segment &segment = kernel->get_segments()[p_segment];
+	SegmentState &state = states[p_segment];
+	int size = segment.partition_size;
+	int bins = size + 1;
+	int count = segment.partition_count;
+
+	if (p_unit == 0) {
+		// Overlap-save frame, the last two partitions of input
+		uint32_t start = state.block_end - 2 * size;
+		for (int n = 0; n < 2 * size; n++) {
+			state.frame[n] = input_ring[(start + n) & input_mask];
+		}
+		state.head = state.head + 1 < count ? state.head + 1 : 0;
+		state.fft.forward(state.frame, state.history_re + state.head * bins, state.history_im + state.head * bins);
+		std::fill(state.sum_re, state.sum_re + bins, 0.0f);
+		std::fill(state.sum_im, state.sum_im + bins, 0.0f);
+		return;
+	}
+
+	if (p_unit <= count) {
+		// Partition k meets the input block k blocks older
+		int k = p_unit - 1;
+		int slot = state.head - k;
+		slot = slot < 0 ? slot + count : slot;
+		multiply_accumulate(state.history_re + slot * bins, state.history_im + slot * bins, segment.spectra_re.data() + k * bins,
+				segment.spectra_im.data() + k * bins, state.sum_re, state.sum_im, bins);
+		return;
+	}
+
+	// The second half of the frame is valid, it lands offset samples after the block
+	// plus the convolver's fixed latency
+	state.fft.inverse(state.sum_re, state.sum_im, state.frame);
+	uint32_t start = state.block_end - size + segment.offset + ConvolutionKernel::BLOCK_SIZE;
+	for (int n = 0; n < size; n++) {
+		output_ring[(start + n) & output_mask] += state.frame[size + n];
+	}
+}
+
+} // namespace godot
@@ -0,0 +1,111 @@
+#ifndef PARTITIONED_CONVOLVER_H
+#define PARTITIONED_CONVOLVER_H
+
+#include "../../core/real_fft.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace godot {
+
+// Impulse response cut into partitions and transformed once.
+// The head is cut into BLOCK_SIZE partitions and later parts into partitions eight times
+// longer per step, up to MAX_PARTITION_SIZE. A segment of partition size P starts no
+// earlier than 2 P into the response, which leaves P samples to spread its FFT work over.
+// Short responses end up with one uniform segment. A kernel never changes once built, so
+// every voice and player can share one.
+class ConvolutionKernel {
+public:
+	static constexpr int BLOCK_SIZE = 32;
+	static constexpr int MAX_PARTITION_SIZE = 2048;
+
+	struct Segment {
+		int partition_size = 0; // P, transformed with an FFT of 2 P
+		int offset = 0; // First sample of the response in this segment
+		int partition_count = 0;
+
+		// partition_count spectra of P + 1 bins, scaled for the unnormalized inverse
+		std::vector<float> spectra_re;
+		std::vector<float> spectra_im;
+	};
+
+private:
+	std::vector<Segment> segments;
+	int length = 0;
+
+public:
+	static std::shared_ptr<const ConvolutionKernel> build(const float *p_impulse, int p_length);
+
+	const std::vector<Segment> &get_segments() const { return segments; }
+	int get_length() const { return length; }
+};
+
+// Uniformly partitioned overlap-save convolution per segment of a shared kernel.
+// Every BLOCK_SIZE samples the input block is transformed once per segment that starts a
+// block there, multiplied with each partition's spectrum against the spectra of earlier
+// input blocks and transformed back into an output ring. Segments with longer partitions
+// spread the transform, the multiplies and the inverse over the ticks of one partition,
+// so no single block pays for a long FFT. The output runs BLOCK_SIZE samples late.
+class PartitionedConvolver {
+private:
+	struct SegmentState {
+		RealFft fft;
+
+		// Spectra of the last partition_count input blocks, newest at head
+		float *history_re = nullptr;
+		float *history_im = nullptr;
+		float *sum_re = nullptr;
+		float *sum_im = nullptr;
+		float *frame = nullptr; // 2 P samples
+		int head = 0;
+
+		// Amortized job of the block that ended at block_end
+		uint32_t block_end = 0;
+		int work_done = 0;
+		int ticks_done = 0;
+	};
+
+	std::shared_ptr<const ConvolutionKernel> kernel;
+	std::vector<SegmentState> states;
+
+	float *input_ring = nullptr;
+	uint32_t input_mask = 0;
+	float *output_ring = nullptr;
+	uint32_t output_mask = 0;
+	uint32_t time = 0;
+
+	float *storage = nullptr;
+	size_t storage_size = 0;
+
+	void layout(float *p_storage);
+	void tick();
+	void run_work(int p_segment, int p_unit);
+
+public:
+	PartitionedConvolver() = default;
+	PartitionedConvolver(const PartitionedConvolver &p_other) { set_kernel(p_other.kernel); }
+	PartitionedConvolver &operator=(const PartitionedConvolver &p_other) {
+		if (this != &p_other) {
+			set_kernel(p_other.kernel);
+		}
+		return *this;
+	}
+
+	// Size the state for p_kernel and clear it, null leaves the convolver silent.
+	// The state has no storage, and the output is silent, until it is bound.
+	void set_kernel(const std::shared_ptr<const ConvolutionKernel> &p_kernel);
+	const std::shared_ptr<const ConvolutionKernel> &get_kernel() const { return kernel; }
+
+	// Floats of state, and moving it into external storage of that size
+	size_t get_state_size() const { return storage_size; }
+	void bind_storage(float *p_storage);
+
+	void reset();
+
+	// Convolved input, BLOCK_SIZE samples late. The output may alias the input.
+	void process(const float *p_input, float *r_output, int p_count);
+};
+
+} // namespace godot
+
+#endif // PARTITIONED_CONVOLVER_H
@@ -1,4 +1,5 @@
 #include "reverb.h"
+#include "../../core/dsp_math.h"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/core/math.hpp>
@@ -14,6 +15,14 @@ const char *Reverb::PARAM_PRE_DELAY = "pre_delay";
 const char *Reverb::PARAM_DIFFUSION = "diffusion";
 
 void Reverb::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_algorithm", "algorithm"), &Reverb::set_algorithm);
+    ClassDB::bind_method(D_METHOD("get_algorithm"), &Reverb::get_algorithm);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "algorithm", PROPERTY_HINT_ENUM, "Classic,Feedback Delay Network"),
+            "set_algorithm", "get_algorithm");
+
+    BIND_ENUM_CONSTANT(ALGORITHM_CLASSIC);
+    BIND_ENUM_CONSTANT(ALGORITHM_FEEDBACK_DELAY_NETWORK);
+
     // Bind parameter accessors
     ClassDB::bind_method(D_METHOD("set_room_size_parameter", "param"), &Reverb::set_room_size_parameter);
     ClassDB::bind_method(D_METHOD("get_room_size_parameter"), &Reverb::get_room_size_parameter);
@@ -47,29 +56,8 @@ void Reverb::_bind_methods() {
 }
 
 Reverb::Reverb() {
-    // Initialize delay lines for early reflections (8 delay lines)
-    early_delay_lines.resize(8);
-    early_positions.resize(8, 0);
-    
-    // Prime numbers for early reflection delays (in samples)
-    const int early_delays[8] = {607, 743, 821, 941, 1061, 1151, 1223, 1327};
-    
-    // Initialize early reflection delay lines
-    for (int i = 0; i < 8; i++) {
-        early_delay_lines[i].resize(early_delays[i], 0.0f);
-    }
-    
-    // Initialize delay lines for late reverb (4 delay lines)
-    late_delay_lines.resize(4);
-    late_positions.resize(4, 0);
-    
-    // Prime numbers for late reverb delays (in samples)
-    const int late_delays[4] = {1453, 1597, 1747, 1867};
-    
-    // Initialize late reverb delay lines
-    for (int i = 0; i < 4; i++) {
-        late_delay_lines[i].resize(late_delays[i], 0.0f);
-    }
+    // Only the running algorithm gets full size lines
+    size_lines();
     
     // Initialize filter states
     lp_states.resize(4, 0.0f);
@@ -117,9 +105,102 @@ Reverb::~Reverb() {
     // Cleanup if needed
 }
 
+void Reverb::size_lines() {
+    // Prime numbers of samples at the tuning rate, scaled to the running rate
+    const int early_delays[EARLY_LINE_COUNT] = {607, 743, 821, 941, 1061, 1151, 1223, 1327};
+    const int late_delays[LATE_LINE_COUNT] = {1453, 1597, 1747, 1867};
+    float scale = sample_rate / TUNING_SAMPLE_RATE;
+    
+    for (int i = 0; i < EARLY_LINE_COUNT; i++) {
+        early_lengths[i] = MAX(static_cast<int>(early_delays[i] * scale + 0.5f), 1);
+    }
+    for (int i = 0; i < LATE_LINE_COUNT; i++) {
+        late_lengths[i] = MAX(static_cast<int>(late_delays[i] * scale + 0.5f), 1);
+    }
+    
+    allocate_lines();
+}
+
+void Reverb::allocate_lines() {
+    bool classic = algorithm == ALGORITHM_CLASSIC;
+    for (int i = 0; i < EARLY_LINE_COUNT; i++) {
+        early_delay_lines[i].resize(classic ? early_lengths[i] : 0);
+    }
+    for (int i = 0; i < LATE_LINE_COUNT; i++) {
+        late_delay_lines[i].resize(classic ? late_lengths[i] : 0);
+    }
+
+    if (classic) {
+        network.release();
+    } else {
+        network.setup(sample_rate);
+    }
+}
+
+float Reverb::get_parameter_value(const char *p_name, float p_default, const Ref<SynthNoteContext> &context) const {
+    Ref<ModulatedParameter> param = get_parameter(p_name);
+    if (param.is_valid()) {
+        return param->get_value(context);
+    }
+    return p_default;
+}
+
+Reverb::NetworkGains Reverb::update_network(const Ref<SynthNoteContext> &context) {
+    float room_size = get_parameter_value(PARAM_ROOM_SIZE, 0.5f, context);
+    float damping = get_parameter_value(PARAM_DAMPING, 0.5f, context);
+    float width = get_parameter_value(PARAM_WIDTH, 0.7f, context);
+    float mix = get_parameter_value(PARAM_MIX, 0.3f, context);
+
+    // Decay time follows get_tail_length(), damping moves the loop lowpass from
+    // 16 kHz down to 1 kHz
+    FeedbackDelayNetwork::Settings settings;
+    settings.decay_time = 1.0f + room_size * 2.0f;
+    settings.damping_cutoff = 16000.0f * DspMath::exp2(-4.0f * damping);
+    settings.diffusion = get_parameter_value(PARAM_DIFFUSION, 0.6f, context) * 0.7f;
+    settings.pre_delay = get_parameter_value(PARAM_PRE_DELAY, 0.02f, context);
+    network.set_settings(settings);
+
+    // Same balance as the classic algorithm
+    NetworkGains gains;
+    gains.dry = 1.0f - mix;
+    gains.early = (1.0f - room_size) * width * mix;
+    gains.late = room_size * width * mix;
+    return gains;
+}
+
+void Reverb::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+    if (algorithm == ALGORITHM_CLASSIC) {
+        SynthAudioEffect::process_block(p_buffer, p_count, context);
+        return;
+    }
+    if (!context.is_valid()) {
+        return;
+    }
+
+    NetworkGains gains = update_network(context);
+    float early[FeedbackDelayNetwork::BLOCK_SIZE];
+    float late[FeedbackDelayNetwork::BLOCK_SIZE];
+    for (int offset = 0; offset < p_count; offset += FeedbackDelayNetwork::BLOCK_SIZE) {
+        int count = MIN(FeedbackDelayNetwork::BLOCK_SIZE, p_count - offset);
+        float *buffer = p_buffer + offset;
+        network.process_block(buffer, early, late, count);
+        for (int i = 0; i < count; i++) {
+            buffer[i] = buffer[i] * gains.dry + early[i] * gains.early + late[i] * gains.late;
+        }
+    }
+}
+
 float Reverb::process_sample(float sample, const Ref<SynthNoteContext> &context) {
     if (!context.is_valid())
         return sample; // Return original sample if context is invalid
+
+    if (algorithm == ALGORITHM_FEEDBACK_DELAY_NETWORK) {
+        NetworkGains gains = update_network(context);
+        float early;
+        float late;
+        network.process_sample(sample, early, late);
+        return sample * gains.dry + early * gains.early + late * gains.late;
+    }
     
     // Get parameter values
     float room_size = 0.5f;  // Default: medium room
@@ -159,8 +240,8 @@ float Reverb::process_sample(float sample, const Ref<SynthNoteContext> &context)
         diffusion = diffusion_param->get_value(context);
     }
     
-    // Calculate pre-delay in samples (assuming 44.1kHz sample rate)
-    int pre_delay_samples = static_cast<int>(pre_delay * 44100.0f);
+    // Calculate pre-delay in samples
+    int pre_delay_samples = static_cast<int>(pre_delay * sample_rate);
     
     // Calculate feedback amount based on room size
     float feedback = 0.7f + room_size * 0.25f;
@@ -176,28 +257,28 @@ float Reverb::process_sample(float sample, const Ref<SynthNoteContext> &context)
     float early_sum = 0.0f;
     float late_sum = 0.0f;
     
+    // Cheap mode runs every other early line and doubles their level
+    const int early_step = cheap_mode ? 2 : 1;
+
     // Process early reflections
-    for (int j = 0; j < 8; j++) {
+    for (int j = 0; j < EARLY_LINE_COUNT; j += early_step) {
         // Read from delay line
-        float delayed = early_delay_lines[j][early_positions[j]];
+        float delayed = early_delay_lines[j].read(early_lengths[j]);
         
         // Apply diffusion (cross-feedback between delay lines)
         if (j > 0) {
-            delayed += early_delay_lines[j-1][early_positions[j-1]] * diffusion_amount;
+            delayed += early_delay_lines[j-early_step].read(early_lengths[j-early_step]) * diffusion_amount;
         }
         
         // Write to delay line
-        early_delay_lines[j][early_positions[j]] = input * (0.7f - j * 0.08f); // Decreasing gain for later reflections
-        
-        // Increment position with wraparound
-        early_positions[j] = (early_positions[j] + 1) % early_delay_lines[j].size();
+        early_delay_lines[j].write(input * (0.7f - j * 0.08f)); // Decreasing gain for later reflections
         
         // Add to output sum
         early_sum += delayed * (1.0f - j * 0.1f); // Decreasing gain for later reflections
     }
     
     // Scale early reflections
-    early_sum *= 0.25f;
+    early_sum *= 0.25f * early_step;
     
     // Process late reverb (with pre-delay)
     float late_input = input;
@@ -208,9 +289,9 @@ float Reverb::process_sample(float sample, const Ref<SynthNoteContext> &context)
     }
     
     // Process through feedback delay network
-    for (int j = 0; j < 4; j++) {
+    for (int j = 0; j < LATE_LINE_COUNT; j++) {
         // Read from delay line
-        float delayed = late_delay_lines[j][late_positions[j]];
+        float delayed = late_delay_lines[j].read(late_lengths[j]);
         
         // Apply damping (simple low-pass filter)
         lp_states[j] = lp_states[j] * lp_coeff + delayed * (1.0f - lp_coeff);
@@ -223,18 +304,23 @@ float Reverb::process_sample(float sample, const Ref<SynthNoteContext> &context)
         float fb_input = late_input;
         
         // Add cross-feedback from other delay lines
-        for (int k = 0; k < 4; k++) {
-            if (k != j) {
-                int pos = (late_positions[k] + pre_delay_samples) % late_delay_lines[k].size();
-                fb_input += late_delay_lines[k][pos] * diffusion_amount * 0.25f;
+        if (cheap_mode) {
+            // Only the next line, weighted for the three it stands in for
+            int k = (j + 1) % LATE_LINE_COUNT;
+            int tap = late_lengths[k] - (pre_delay_samples % late_lengths[k]);
+            fb_input += late_delay_lines[k].read(tap) * diffusion_amount * 0.75f;
+        } else {
+            for (int k = 0; k < LATE_LINE_COUNT; k++) {
+                if (k != j) {
+                    // Tap pre_delay_samples past the oldest sample, wrapped to the line length
+                    int tap = late_lengths[k] - (pre_delay_samples % late_lengths[k]);
+                    fb_input += late_delay_lines[k].read(tap) * diffusion_amount * 0.25f;
+                }
             }
         }
         
         // Write to delay line with feedback
-        late_delay_lines[j][late_positions[j]] = fb_input + lp_states[j] * feedback;
-        
-        // Increment position with wraparound
-        late_positions[j] = (late_positions[j] + 1) % late_delay_lines[j].size();
+        late_delay_lines[j].write(fb_input + lp_states[j] * feedback);
         
         // Add to output sum
         late_sum += hp_out;
@@ -256,22 +342,52 @@ float Reverb::process_sample(float sample, const Ref<SynthNoteContext> &context)
 void Reverb::reset() {
     // Clear all delay lines
     for (auto &line : early_delay_lines) {
-        std::fill(line.begin(), line.end(), 0.0f);
+        line.clear();
     }
     
     for (auto &line : late_delay_lines) {
-        std::fill(line.begin(), line.end(), 0.0f);
+        line.clear();
     }
     
-    // Reset positions
-    std::fill(early_positions.begin(), early_positions.end(), 0);
-    std::fill(late_positions.begin(), late_positions.end(), 0);
-    
     // Reset filter states
     std::fill(lp_states.begin(), lp_states.end(), 0.0f);
     std::fill(hp_states.begin(), hp_states.end(), 0.0f);
-    
-    UtilityFunctions::print("Reverb: Reset called - all buffers cleared");
+
+    network.reset();
+}
+
+void Reverb::apply_quality(const SynthQualityProfile::Settings &p_settings) {
+    cheap_mode = p_settings.cheap_reverb;
+
+    // The network keeps all its lines and drops the drifting read heads
+    network.set_modulation(!cheap_mode);
+}
+
+void Reverb::set_sample_rate(float p_sample_rate) {
+    if (p_sample_rate <= 0.0f || p_sample_rate == sample_rate) {
+        return;
+    }
+    sample_rate = p_sample_rate;
+    size_lines();
+}
+
+void Reverb::set_algorithm(Algorithm p_algorithm) {
+    if (p_algorithm == algorithm) {
+        return;
+    }
+    algorithm = p_algorithm;
+    allocate_lines();
+    reset();
+}
+
+Reverb::Algorithm Reverb::get_algorithm() const {
+    return algorithm;
+}
+
+bool Reverb::get_constant_gain(float &r_gain) const {
+    // Both algorithms blend input * (1 - mix) with the wet reflections
+    r_gain = 1.0f;
+    return has_constant_value(PARAM_MIX, 0.0f);
 }
 
 float Reverb::get_tail_length() const {
@@ -288,6 +404,8 @@ float Reverb::get_tail_length() const {
 
 Ref<SynthAudioEffect> Reverb::duplicate() const {
     Ref<Reverb> new_reverb = memnew(Reverb);
+    new_reverb->set_sample_rate(sample_rate);
+    new_reverb->set_algorithm(algorithm);
     
     // Copy parameters
     Dictionary params = get_parameters();
@@ -365,4 +483,25 @@ Ref<ModulatedParameter> Reverb::get_diffusion_parameter() const {
     return get_parameter(PARAM_DIFFUSION);
 }
 
+size_t Reverb::get_state_size() const {
+    size_t size = 0;
+    for (const auto &line : early_delay_lines) {
+        size += VoiceStateArena::align_size(line.get_capacity());
+    }
+    for (const auto &line : late_delay_lines) {
+        size += VoiceStateArena::align_size(line.get_capacity());
+    }
+    return size + network.get_state_size();
+}
+
+void Reverb::bind_state(VoiceStateArena::Allocator &p_allocator) {
+    for (auto &line : early_delay_lines) {
+        line.bind_storage(p_allocator.allocate(line.get_capacity()));
+    }
+    for (auto &line : late_delay_lines) {
+        line.bind_storage(p_allocator.allocate(line.get_capacity()));
+    }
+    network.bind_state(p_allocator);
+}
+
 } // namespace godot
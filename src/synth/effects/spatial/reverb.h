@@ -2,6 +2,8 @@
 #define REVERB_H
 
 #include "../synth_audio_effect.h"
+#include "../delay/delay_line.h"
+#include "feedback_delay_network.h"
 #include <vector>
 
 namespace godot {
@@ -9,19 +11,56 @@ namespace godot {
 class Reverb : public SynthAudioEffect {
 	GDCLASS(Reverb, SynthAudioEffect)
 
+public:
+	enum Algorithm {
+		ALGORITHM_CLASSIC,
+		ALGORITHM_FEEDBACK_DELAY_NETWORK
+	};
+
 private:
+	static constexpr int EARLY_LINE_COUNT = 8;
+	static constexpr int LATE_LINE_COUNT = 4;
+
+	// Rate the classic line lengths were tuned at
+	static constexpr float TUNING_SAMPLE_RATE = 44100.0f;
+
 	// Delay lines for early reflections and late reverb
-	std::vector<std::vector<float>> early_delay_lines;
-	std::vector<std::vector<float>> late_delay_lines;
+	DelayLine<float> early_delay_lines[EARLY_LINE_COUNT];
+	DelayLine<float> late_delay_lines[LATE_LINE_COUNT];
 
-	// Delay line positions
-	std::vector<int> early_positions;
-	std::vector<int> late_positions;
+	// Delay line lengths in samples
+	int early_lengths[EARLY_LINE_COUNT];
+	int late_lengths[LATE_LINE_COUNT];
 
 	// Feedback filters
 	std::vector<float> lp_states;
 	std::vector<float> hp_states;
 
+	// Half the early reflections and a single cross-feed tap per late line
+	bool cheap_mode = false;
+
+	// Eight line tank with its lines sized for the sample rate
+	FeedbackDelayNetwork network;
+	Algorithm algorithm = ALGORITHM_CLASSIC;
+	float sample_rate = 44100.0f;
+
+	// Line lengths for the sample rate, then allocate_lines()
+	void size_lines();
+
+	// Size the lines of the running algorithm, the other one keeps a few samples
+	void allocate_lines();
+
+	float get_parameter_value(const char *p_name, float p_default, const Ref<SynthNoteContext> &context) const;
+
+	struct NetworkGains {
+		float dry;
+		float early;
+		float late;
+	};
+
+	// Pass the parameters on to the network, returns the balance of its outputs
+	NetworkGains update_network(const Ref<SynthNoteContext> &context);
+
 public:
 	// Parameter names
 	static const char *PARAM_ROOM_SIZE;
@@ -39,9 +78,18 @@ public:
 	~Reverb();
 
 	float process_sample(float sample, const Ref<SynthNoteContext> &context) override;
+	void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) override;
 	void reset() override;
+	bool get_constant_gain(float &r_gain) const override;
 	float get_tail_length() const override;
 	Ref<SynthAudioEffect> duplicate() const override;
+	size_t get_state_size() const override;
+	void bind_state(VoiceStateArena::Allocator &p_allocator) override;
+	void apply_quality(const SynthQualityProfile::Settings &p_settings) override;
+	void set_sample_rate(float p_sample_rate) override;
+
+	void set_algorithm(Algorithm p_algorithm);
+	Algorithm get_algorithm() const;
 
 	// Parameter accessors
 	void set_room_size_parameter(const Ref<ModulatedParameter> &param);
@@ -65,4 +113,6 @@ public:
 
 } // namespace godot
 
+VARIANT_ENUM_CAST(Reverb::Algorithm);
+
 #endif // REVERB_H
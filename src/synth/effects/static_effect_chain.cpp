@@ -0,0 +1,67 @@
+#include "static_effect_chain.h"
+#include "distortion/clip_distortion.h"
+#include "filter/state_variable_filter.h"
+
+namespace godot {
+
+namespace {
+
+typedef bool (*Matcher)(SynthAudioEffect *p_effect);
+
+template <typename T>
+bool is(SynthAudioEffect *p_effect) {
+	return Object::cast_to<T>(p_effect) != nullptr;
+}
+
+// Effects past the static part, reverbs and delays that work on whole blocks anyway
+bool any(SynthAudioEffect *) {
+	return true;
+}
+
+// The static chain over the first effects, then the TAIL effects after it one by one
+template <typename Chain, int TAIL>
+bool run(SynthAudioEffect *const *p_effects, float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	if (!Chain::process(p_effects, p_buffer, p_count, context)) {
+		return false;
+	}
+	for (int i = 0; i < TAIL; i++) {
+		p_effects[Chain::SIZE + i]->process_block(p_buffer, p_count, context);
+	}
+	return true;
+}
+
+struct Entry {
+	static constexpr int MAX_EFFECTS = 3;
+
+	Matcher matchers[MAX_EFFECTS];
+	int count;
+	StaticEffectChains::Kernel kernel;
+};
+
+typedef StaticEffectChain<StateVariableFilter::Kernel, ClipDistortion::Kernel> FilterClip;
+typedef StaticEffectChain<ClipDistortion::Kernel> Clip;
+
+// Laser and Kick, Explosion and Snare, GunShot and UIError
+const Entry entries[] = {
+	{ { is<StateVariableFilter>, is<ClipDistortion> }, 2, run<FilterClip, 0> },
+	{ { is<StateVariableFilter>, is<ClipDistortion>, any }, 3, run<FilterClip, 1> },
+	{ { is<ClipDistortion>, any }, 2, run<Clip, 1> },
+	{ { is<ClipDistortion> }, 1, run<Clip, 0> },
+};
+
+} // namespace
+
+StaticEffectChains::Kernel StaticEffectChains::find(SynthAudioEffect *const *p_effects, int p_count) {
+	for (const Entry &entry : entries) {
+		bool match = entry.count == p_count;
+		for (int i = 0; i < entry.count && match; i++) {
+			match = entry.matchers[i](p_effects[i]);
+		}
+		if (match) {
+			return entry.kernel;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace godot
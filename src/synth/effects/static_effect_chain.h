@@ -0,0 +1,69 @@
+#ifndef STATIC_EFFECT_CHAIN_H
+#define STATIC_EFFECT_CHAIN_H
+
+#include "../core/synth_note_context.h"
+#include "synth_audio_effect.h"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace godot {
+
+// A fixed sequence of effects fused into one loop over the block.
+// Every kernel type reads its effect's parameters once in begin(), then process() runs
+// one sample inline, so the compiler sees the whole chain per sample with no virtual
+// calls in between. A kernel provides:
+//
+//   using Effect = ...;
+//   static bool can_run(const Effect *p_effect);
+//   void begin(Effect *p_effect, int p_count, const Ref<SynthNoteContext> &context);
+//   float process(float p_sample);
+//   void end();
+//
+// The result is the same as each effect's process_block in turn.
+template <typename... Kernels>
+class StaticEffectChain {
+	template <std::size_t... I>
+	static bool run(SynthAudioEffect *const *p_effects, float *p_buffer, int p_count, const Ref<SynthNoteContext> &context, std::index_sequence<I...>) {
+		// Nothing is touched unless every kernel can take its effect
+		if (!context.is_valid() || !(Kernels::can_run(static_cast<const typename Kernels::Effect *>(p_effects[I])) && ...)) {
+			return false;
+		}
+
+		std::tuple<Kernels...> kernels;
+		(std::get<I>(kernels).begin(static_cast<typename Kernels::Effect *>(p_effects[I]), p_count, context), ...);
+		for (int n = 0; n < p_count; n++) {
+			float sample = p_buffer[n];
+			((sample = std::get<I>(kernels).process(sample)), ...);
+			p_buffer[n] = sample;
+		}
+		(std::get<I>(kernels).end(), ...);
+		return true;
+	}
+
+public:
+	static constexpr int SIZE = sizeof...(Kernels);
+
+	// Run the first SIZE effects of p_effects, whose types must match the kernels.
+	// Returns false without processing when the context is invalid or a kernel can't
+	// take its effect, for example a distortion with oversampling.
+	static bool process(SynthAudioEffect *const *p_effects, float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+		return run(p_effects, p_buffer, p_count, context, std::index_sequence_for<Kernels...>());
+	}
+};
+
+// Prebuilt StaticEffectChains for the topologies the built-in presets use.
+// EffectChain::compile() looks its stages up here, user-built chains that match nothing
+// keep running stage by stage.
+class StaticEffectChains {
+public:
+	// Runs p_effects over the block, or returns false to have the caller run them itself
+	typedef bool (*Kernel)(SynthAudioEffect *const *p_effects, float *p_buffer, int p_count, const Ref<SynthNoteContext> &context);
+
+	// Kernel for exactly this sequence of effects, nullptr when there is none
+	static Kernel find(SynthAudioEffect *const *p_effects, int p_count);
+};
+
+} // namespace godot
+
+#endif // STATIC_EFFECT_CHAIN_H
@@ -17,6 +17,7 @@ void SynthAudioEffect::_bind_methods() {
 
 void SynthAudioEffect::add_parameter(const String &p_name, const Ref<ModulatedParameter> &p_param) {
 	parameters[p_name] = p_param;
+	revision.fetch_add(1, std::memory_order_relaxed);
 }
 
 SynthAudioEffect::SynthAudioEffect() {
@@ -32,6 +33,37 @@ float SynthAudioEffect::process_sample(float sample, const Ref<SynthNoteContext>
 	return sample;
 }
 
+void SynthAudioEffect::process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context) {
+	for (int i = 0; i < p_count; i++) {
+		p_buffer[i] = process_sample(p_buffer[i], context);
+	}
+}
+
+void SynthAudioEffect::process_lanes(const EffectLanes &p_lanes) {
+	for (int l = 0; l < p_lanes.lane_count; l++) {
+		p_lanes.effects[l]->process_block(p_lanes.buffers[l], p_lanes.sample_count, p_lanes.contexts[l]);
+	}
+}
+
+bool SynthAudioEffect::get_constant_gain(float &r_gain) const {
+	// Base implementation makes no promise about its output
+	return false;
+}
+
+bool SynthAudioEffect::is_linear() const {
+	return false;
+}
+
+bool SynthAudioEffect::can_fuse(const SynthAudioEffect *p_next) const {
+	return false;
+}
+
+void SynthAudioEffect::process_fused(SynthAudioEffect *const *p_effects, int p_count, float *p_buffer, int p_samples, const Ref<SynthNoteContext> &context) {
+	for (int i = 0; i < p_count; i++) {
+		p_effects[i]->process_block(p_buffer, p_samples, context);
+	}
+}
+
 void SynthAudioEffect::reset() {
 	// Base implementation does nothing, to be overridden by derived classes
 }
@@ -46,9 +78,27 @@ Ref<SynthAudioEffect> SynthAudioEffect::duplicate() const {
 	return nullptr;
 }
 
+size_t SynthAudioEffect::get_state_size() const {
+	// Base implementation keeps no buffers
+	return 0;
+}
+
+void SynthAudioEffect::bind_state(VoiceStateArena::Allocator &p_allocator) {
+	// Base implementation does nothing, to be overridden by effects with buffers
+}
+
+void SynthAudioEffect::apply_quality(const SynthQualityProfile::Settings &p_settings) {
+	// Base implementation has a single quality level
+}
+
+void SynthAudioEffect::set_sample_rate(float p_sample_rate) {
+	// Base implementation assumes 44.1 kHz
+}
+
 void SynthAudioEffect::set_parameter(const String &name, const Ref<ModulatedParameter> &param) {
 	if (param.is_valid()) {
 		parameters[name] = param;
+		revision.fetch_add(1, std::memory_order_relaxed);
 	}
 }
 
@@ -63,4 +113,25 @@ Dictionary SynthAudioEffect::get_parameters() const {
 	return parameters;
 }
 
+void SynthAudioEffect::clear_parameters() {
+	parameters.clear();
+	revision.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SynthAudioEffect::get_constant_parameter(const String &p_name, float &r_value) const {
+	Ref<ModulatedParameter> param = get_parameter(p_name);
+	if (!param.is_valid() || param->get_mod_source().is_valid()) {
+		return false;
+	}
+
+	// Without a source the value is the clamped base value, whatever the context
+	r_value = param->get_value(Ref<SynthNoteContext>());
+	return true;
+}
+
+bool SynthAudioEffect::has_constant_value(const String &p_name, float p_value) const {
+	float value = 0.0f;
+	return get_constant_parameter(p_name, value) && value == p_value;
+}
+
 } // namespace godot
@@ -3,9 +3,13 @@
 
 #include "../core/modulated_parameter.h"
 #include "../core/synth_note_context.h"
+#include "../core/synth_quality_profile.h"
+#include "../core/voice_state_arena.h"
+#include "effect_lanes.h"
 #include <godot_cpp/classes/resource.hpp>
 #include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
+#include <atomic>
 
 namespace godot {
 
@@ -16,6 +20,16 @@ protected:
 	// Assuming you have a container for parameters, for example:
 	Dictionary parameters;
 
+	// Bumped by set_parameter and by settings that change what the effect does, compiled
+	// effect chains watch it from the audio thread
+	std::atomic<uint32_t> revision{ 0 };
+
+	// True when p_name exists without a modulation source, r_value is what it always yields
+	bool get_constant_parameter(const String &p_name, float &r_value) const;
+
+	// True when p_name is unmodulated and always yields exactly p_value
+	bool has_constant_value(const String &p_name, float p_value) const;
+
 public:
 	// Add this declaration:
 	void add_parameter(const String &p_name, const Ref<ModulatedParameter> &p_param);
@@ -26,6 +40,31 @@ public:
 	virtual ~SynthAudioEffect();
 
 	virtual float process_sample(float sample, const Ref<SynthNoteContext> &context);
+
+	// Process p_count samples in place. Parameters may be read once for the whole block,
+	// the context stands at its last sample. The default runs process_sample on each.
+	virtual void process_block(float *p_buffer, int p_count, const Ref<SynthNoteContext> &context);
+
+	// Process the same stage of several voices at once. Called on the first lane's effect,
+	// every lane holds a copy of it from the same patch. The default runs process_block
+	// on each lane.
+	virtual void process_lanes(const EffectLanes &p_lanes);
+
+	// True when this effect, under its unmodulated parameters, only multiplies its input by
+	// r_gain, a gain of 1 being a no-op. EffectChain::compile() drops such effects and
+	// merges their gains. The default is false.
+	virtual bool get_constant_gain(float &r_gain) const;
+
+	// Linear effects commute with a constant gain, which the chain moves past them
+	virtual bool is_linear() const;
+
+	// Whether p_next may directly follow this effect in one process_fused() pass
+	virtual bool can_fuse(const SynthAudioEffect *p_next) const;
+
+	// Run p_count adjacent effects that accepted each other through can_fuse() in a single
+	// pass over the block. Called on the first of them, the default runs process_block on each.
+	virtual void process_fused(SynthAudioEffect *const *p_effects, int p_count, float *p_buffer, int p_samples, const Ref<SynthNoteContext> &context);
+
 	virtual void reset();
 
 	// Returns the tail length in seconds (how long the effect continues after input stops)
@@ -34,9 +73,27 @@ public:
 	// Create a duplicate of this effect with the same parameters
 	virtual Ref<SynthAudioEffect> duplicate() const;
 
+	// Size in floats of the buffers this effect can place in a voice state arena
+	virtual size_t get_state_size() const;
+
+	// Move this effect's buffers into storage taken from a voice state arena
+	virtual void bind_state(VoiceStateArena::Allocator &p_allocator);
+
+	// Adapt to the quality tier chosen by the governor
+	virtual void apply_quality(const SynthQualityProfile::Settings &p_settings);
+
+	// Sample rate of the engine running this effect, set before the state is measured
+	virtual void set_sample_rate(float p_sample_rate);
+
 	void set_parameter(const String &name, const Ref<ModulatedParameter> &param);
 	Ref<ModulatedParameter> get_parameter(const String &name) const;
 	Dictionary get_parameters() const;
+
+	// Drop every parameter, so duplicate() only copies the effect's settings
+	void clear_parameters();
+
+	// Changes whenever a parameter is replaced or a setting changes
+	uint32_t get_revision() const { return revision.load(std::memory_order_relaxed); }
 };
 
 } // namespace godot
@@ -32,6 +32,10 @@ ArticulationModSource::ArticulationModSource() {
 ArticulationModSource::~ArticulationModSource() {
 }
 
+ModulationSource::Variability ArticulationModSource::get_variability() const {
+	return VARIABILITY_PER_NOTE;
+}
+
 float ArticulationModSource::get_value(const Ref<SynthNoteContext> &context) const {
 	ERR_FAIL_COND_V(context.is_null(), 1.0f);
 	return context->get_articulation();
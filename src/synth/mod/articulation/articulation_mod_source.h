@@ -18,6 +18,9 @@ public:
 
 	// Get the articulation value from the note context
 	float get_value(const Ref<SynthNoteContext> &context) const override;
+
+	// Articulation is fixed at note-on, so the value is folded once per note
+	virtual Variability get_variability() const override;
 	// Reset is not needed for velocity (it's stateless)
 	virtual void reset() override;
 	// Create a duplicate of this modulation source
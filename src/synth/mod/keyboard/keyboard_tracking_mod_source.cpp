@@ -34,6 +34,10 @@ KeyboardTrackingModSource::KeyboardTrackingModSource() {
 KeyboardTrackingModSource::~KeyboardTrackingModSource() {
 }
 
+ModulationSource::Variability KeyboardTrackingModSource::get_variability() const {
+	return VARIABILITY_PER_NOTE;
+}
+
 float KeyboardTrackingModSource::get_value(const Ref<SynthNoteContext> &context) const {
 	if (context.is_null()) {
 		return 0.0f;
@@ -23,6 +23,9 @@ public:
 
 	// Override the base class method to provide keyboard tracking modulation
 	virtual float get_value(const Ref<SynthNoteContext> &context) const override;
+
+	// The note number is fixed at note-on, so the value is folded once per note
+	virtual Variability get_variability() const override;
 	
 	// Reset is not needed for keyboard tracking (it's stateless)
 	virtual void reset() override;
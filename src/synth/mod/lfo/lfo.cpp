@@ -69,6 +69,10 @@ void LFO::reset() {
 	phase = 0.0;
 }
 
+bool LFO::is_deterministic() const {
+	return wave_type != WaveHelper::NOISE;
+}
+
 void LFO::set_pulse_width(float p_pulse_width) {
 	pulse_width = Math::clamp(p_pulse_width, 0.01f, 0.99f);
 }
@@ -41,6 +41,7 @@ public:
 	// Implement ModulationSource interface
 	float get_value(const Ref<SynthNoteContext> &context) const override;
 	void reset() override;
+	bool is_deterministic() const override;
 
 	void set_pulse_width(float p_pulse_width);
 	float get_pulse_width() const;
@@ -29,6 +29,10 @@ VelocityModSource::VelocityModSource() {
 VelocityModSource::~VelocityModSource() {
 }
 
+ModulationSource::Variability VelocityModSource::get_variability() const {
+	return VARIABILITY_PER_NOTE;
+}
+
 float VelocityModSource::get_value(const Ref<SynthNoteContext> &context) const {
 	if (context.is_null()) {
 		return 0.0f;
@@ -22,6 +22,9 @@ public:
 
 	// Override the base class method to provide velocity-based modulation
 	virtual float get_value(const Ref<SynthNoteContext> &context) const override;
+
+	// Velocity is fixed at note-on, so the value is folded once per note
+	virtual Variability get_variability() const override;
 	
 	// Reset is not needed for velocity (it's stateless)
 	virtual void reset() override;
@@ -1,6 +1,7 @@
 #pragma once
 #include "register_types.h"
 #include <gdextension_interface.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
@@ -8,13 +9,19 @@
 // Include core classes
 #include "core/audio_stream_generator_engine.h"
 #include "core/audio_synth_player.h"
+#include "core/audio_synth_player_3d.h"
 #include "core/engine_factory.h"
 #include "core/modulated_parameter.h"
 #include "core/modulation_source.h"
+#include "core/render_ahead_worker.h"
 #include "core/synth_audio_stream.h"
 #include "core/synth_configuration.h"
 #include "core/synth_note_context.h"
+#include "core/synth_preset_bank.h"
+#include "core/synth_quality_governor.h"
+#include "core/synth_quality_profile.h"
 #include "core/synth_voice.h"
+#include "core/synth_voice_manager.h"
 #include "core/wave_helper_cache.h"
 
 // Include modulation sources
@@ -56,6 +63,7 @@
 #include "effects/distortion/wave_shaper_distortion.h"
 
 #include "effects/effect_chain.h"
+#include "effects/spatial/convolution_reverb.h"
 #include "effects/spatial/reverb.h"
 #include "effects/synth_audio_effect.h"
 
@@ -73,6 +81,7 @@
 #include "core/wave_helper.h"
 
 #include "time/bpm_manager.h"
+#include "time/sequencer.h"
 
 using namespace godot;
 
@@ -92,6 +101,41 @@ void register_core_classes() {
 	GDREGISTER_CLASS(SynthAudioStream);
 	GDREGISTER_CLASS(SynthAudioStreamPlayback);
 	GDREGISTER_CLASS(AudioSynthPlayer);
+	GDREGISTER_CLASS(AudioSynthPlayer3D);
+	GDREGISTER_CLASS(SynthPresetBank);
+	GDREGISTER_CLASS(SynthVoiceManager);
+	GDREGISTER_CLASS(SynthQualityProfile);
+	GDREGISTER_CLASS(SynthQualityGovernor);
+	GDREGISTER_INTERNAL_CLASS(RenderAheadWorker);
+}
+
+void register_singletons() {
+	// Waveform tables, built here rather than lazily by the first engine
+	WaveHelperCache::create_singleton();
+
+	// Shared voice budget for players that opt in
+	SynthVoiceManager *voice_manager = memnew(SynthVoiceManager);
+	Engine::get_singleton()->register_singleton("SynthVoiceManager", voice_manager);
+
+	// Quality tiers driven by the measured DSP load
+	SynthQualityGovernor *quality_governor = memnew(SynthQualityGovernor);
+	Engine::get_singleton()->register_singleton("SynthQualityGovernor", quality_governor);
+}
+
+void unregister_singletons() {
+	SynthQualityGovernor *quality_governor = SynthQualityGovernor::get_singleton();
+	if (quality_governor != nullptr) {
+		Engine::get_singleton()->unregister_singleton("SynthQualityGovernor");
+		memdelete(quality_governor);
+	}
+
+	SynthVoiceManager *voice_manager = SynthVoiceManager::get_singleton();
+	if (voice_manager != nullptr) {
+		Engine::get_singleton()->unregister_singleton("SynthVoiceManager");
+		memdelete(voice_manager);
+	}
+
+	WaveHelperCache::free_singleton();
 }
 
 void register_filters() {
@@ -130,8 +174,8 @@ void register_distortion_effects() {
 }
 
 void register_spatial_effects() {
-	// TODO: Fix reverb
-	//GDREGISTER_CLASS(Reverb);
+	GDREGISTER_CLASS(Reverb);
+	GDREGISTER_CLASS(ConvolutionReverb);
 }
 
 void register_effects() {
@@ -193,6 +237,7 @@ void register_chord_classes() {
 void register_sequencer() {
 	GDREGISTER_CLASS(BPMManager);
 	GDREGISTER_CLASS(BPMEvent);
+	GDREGISTER_CLASS(SynthSequencer);
 }
 
 void initialize_gdextension_types(ModuleInitializationLevel p_level) {
@@ -214,13 +259,17 @@ void initialize_gdextension_types(ModuleInitializationLevel p_level) {
 		// register_chord_classes();
 
 		register_sequencer();
+
+		register_singletons();
 	}
 }
 
 void uninitialize_gdextension_types(ModuleInitializationLevel p_level) {
-	if (p_level == MODULE_INITIALIZATION_LEVEL_SCENE) {
+	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+
+	unregister_singletons();
 }
 
 extern "C" {
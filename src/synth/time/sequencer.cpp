@@ -0,0 +1,594 @@
+#include "sequencer.h"
+#include "../core/synth_configuration.h"
+#include "bpm_manager.h"
+#include <godot_cpp/classes/audio_server.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace godot {
+
+SynthSequencer::Schedule::Schedule(float p_sample_rate) :
+		sample_rate(p_sample_rate) {
+	// Sounding notes never allocate on the audio thread
+	sounding.reserve(MAX_SOUNDING);
+}
+
+void SynthSequencer::Schedule::set_pattern(const std::shared_ptr<const Pattern> &p_pattern) {
+	patterns.publish(p_pattern);
+}
+
+void SynthSequencer::Schedule::set_pool(const std::shared_ptr<const SynthPlayerVoices::VoicePool> &p_pool) {
+	pools.publish(p_pool);
+}
+
+void SynthSequencer::Schedule::collect() {
+	patterns.collect();
+	pools.collect();
+}
+
+void SynthSequencer::Schedule::set_bpm(float p_bpm) {
+	if (p_bpm > 0.0f) {
+		bpm.store(p_bpm);
+	}
+}
+
+void SynthSequencer::Schedule::set_running(bool p_running) {
+	running.store(p_running);
+}
+
+void SynthSequencer::Schedule::restart() {
+	start_serial.fetch_add(1);
+	running.store(true);
+}
+
+bool SynthSequencer::Schedule::is_running() const {
+	return running.load();
+}
+
+double SynthSequencer::Schedule::get_position() const {
+	return reported_position.load();
+}
+
+void SynthSequencer::Schedule::seek() {
+	loop_index = 0;
+	next_event = 0;
+	if (!pattern || pattern->events.empty()) {
+		return;
+	}
+
+	// First note at or after the current position, within the current pass of the loop
+	double local = position;
+	if (pattern->looping) {
+		loop_index = static_cast<int64_t>(Math::floor(position / pattern->length));
+		local = position - loop_index * pattern->length;
+	}
+	const std::vector<Event> &events = pattern->events;
+	next_event = static_cast<int>(std::lower_bound(events.begin(), events.end(), local, [](const Event &p_event, double p_time) {
+		return p_event.time < p_time;
+	}) - events.begin());
+	if (next_event == static_cast<int>(events.size()) && pattern->looping) {
+		loop_index++;
+		next_event = 0;
+	}
+}
+
+void SynthSequencer::Schedule::release_all() {
+	for (SoundingNote &note : sounding) {
+		note.context->note_off(note.context->get_absolute_time());
+	}
+	sounding.clear();
+}
+
+void SynthSequencer::Schedule::release_sounding(SynthAudioStreamPlayback &p_driver) {
+	for (const SoundingNote &note : sounding) {
+		p_driver.release_voice_by_id(static_cast<int64_t>(note.voice->get_instance_id()));
+	}
+	sounding.clear();
+}
+
+void SynthSequencer::Schedule::remove_sounding(size_t p_index) {
+	if (p_index + 1 < sounding.size()) {
+		sounding[p_index] = sounding.back();
+	}
+	sounding.pop_back();
+}
+
+void SynthSequencer::Schedule::start_note(SynthAudioStreamPlayback &p_playback, const Event &p_event, double p_on_position) {
+	if (!pool) {
+		return;
+	}
+
+	// Past the limit the oldest note makes room
+	if (sounding.size() >= MAX_SOUNDING) {
+		size_t oldest = 0;
+		for (size_t i = 1; i < sounding.size(); i++) {
+			if (sounding[i].on_position < sounding[oldest].on_position) {
+				oldest = i;
+			}
+		}
+		sounding[oldest].context->note_off(sounding[oldest].context->get_absolute_time());
+		remove_sounding(oldest);
+	}
+
+	// This runs on the thread rendering the playback, so a stolen voice restarts right here
+	SynthPlayerVoices::NoteVoice note_voice = SynthPlayerVoices::take_voice(*pool, next_voice_index, p_playback.get_current_time(), true);
+	Ref<SynthVoice> voice = note_voice.voice;
+	if (!voice.is_valid()) {
+		return;
+	}
+	if (!voice->get_engine().is_valid()) {
+		SynthPlayerVoices::give_back(note_voice);
+		return;
+	}
+
+	// A stolen voice ends the note it was playing
+	for (size_t i = 0; i < sounding.size(); i++) {
+		if (sounding[i].voice == voice) {
+			remove_sounding(i);
+			break;
+		}
+	}
+
+	// Keyed by the voice, so a stolen voice replaces its own entry in the playback
+	int64_t voice_id = static_cast<int64_t>(voice->get_instance_id());
+	p_playback.add_scheduled_voice(voice_id, voice);
+
+	Ref<SynthNoteContext> context = voice->get_current_context();
+	context->set_voice_id(voice_id);
+	context->note_on(p_event.note, p_event.velocity);
+	context->set_articulation(p_event.articulation);
+
+	SoundingNote note;
+	note.voice = voice;
+	note.context = context;
+	note.on_position = p_on_position;
+	note.off_position = p_on_position + p_event.length;
+	sounding.push_back(note);
+}
+
+double SynthSequencer::Schedule::get_next_on_position() const {
+	if (!pattern || next_event >= static_cast<int>(pattern->events.size())) {
+		return std::numeric_limits<double>::infinity();
+	}
+	return loop_index * pattern->length + pattern->events[next_event].time;
+}
+
+int SynthSequencer::Schedule::fire(SynthAudioStreamPlayback &p_playback, int p_max_frames) {
+	// start_pattern() begins again from the first step
+	uint32_t serial = start_serial.load();
+	if (serial != played_serial) {
+		played_serial = serial;
+		release_all();
+		position = 0.0;
+		seek();
+	}
+
+	// A new pattern continues from the current position
+	if (patterns.acquire()) {
+		pattern = patterns.get().get();
+		seek();
+	}
+	if (pools.acquire()) {
+		pool = pools.get().get();
+	}
+
+	if (!running.load()) {
+		if (playing) {
+			release_all();
+			playing = false;
+		}
+		return p_max_frames;
+	}
+	playing = true;
+
+	int steps_per_beat = pattern ? pattern->steps_per_beat : 4;
+	frames_per_step = sample_rate * 60.0 / (static_cast<double>(bpm.load()) * steps_per_beat);
+
+	// Anything within half a frame is due now, segments end on the nearest frame
+	double due = position + 0.5 / frames_per_step;
+
+	// Note offs first, so a note played again on the same step starts after the old one ends
+	for (size_t i = 0; i < sounding.size();) {
+		if (sounding[i].off_position <= due) {
+			sounding[i].context->note_off(sounding[i].context->get_absolute_time());
+			remove_sounding(i);
+		} else {
+			i++;
+		}
+	}
+
+	while (get_next_on_position() <= due) {
+		const std::vector<Event> &events = pattern->events;
+		start_note(p_playback, events[next_event], get_next_on_position());
+		next_event++;
+		if (next_event == static_cast<int>(events.size()) && pattern->looping) {
+			loop_index++;
+			next_event = 0;
+		}
+	}
+
+	double next = get_next_on_position();
+	for (const SoundingNote &note : sounding) {
+		next = MIN(next, note.off_position);
+	}
+	double frames = Math::round((next - position) * frames_per_step);
+	if (frames >= p_max_frames) {
+		return p_max_frames;
+	}
+	return MAX(static_cast<int>(frames), 1);
+}
+
+void SynthSequencer::Schedule::advance(int p_frames) {
+	if (playing && frames_per_step > 0.0) {
+		position += p_frames / frames_per_step;
+	}
+	reported_position.store(position);
+}
+
+void SynthSequencer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_configuration", "config"), &SynthSequencer::set_configuration);
+	ClassDB::bind_method(D_METHOD("get_configuration"), &SynthSequencer::get_configuration);
+	ClassDB::bind_method(D_METHOD("set_polyphony", "polyphony"), &SynthSequencer::set_polyphony);
+	ClassDB::bind_method(D_METHOD("get_polyphony"), &SynthSequencer::get_polyphony);
+
+	ClassDB::bind_method(D_METHOD("set_pattern", "pattern"), &SynthSequencer::set_pattern);
+	ClassDB::bind_method(D_METHOD("get_pattern"), &SynthSequencer::get_pattern);
+	ClassDB::bind_method(D_METHOD("set_pattern_steps", "steps"), &SynthSequencer::set_pattern_steps);
+	ClassDB::bind_method(D_METHOD("get_pattern_steps"), &SynthSequencer::get_pattern_steps);
+	ClassDB::bind_method(D_METHOD("set_steps_per_beat", "steps"), &SynthSequencer::set_steps_per_beat);
+	ClassDB::bind_method(D_METHOD("get_steps_per_beat"), &SynthSequencer::get_steps_per_beat);
+	ClassDB::bind_method(D_METHOD("set_swing", "swing"), &SynthSequencer::set_swing);
+	ClassDB::bind_method(D_METHOD("get_swing"), &SynthSequencer::get_swing);
+	ClassDB::bind_method(D_METHOD("set_looping", "looping"), &SynthSequencer::set_looping);
+	ClassDB::bind_method(D_METHOD("get_looping"), &SynthSequencer::get_looping);
+	ClassDB::bind_method(D_METHOD("set_bpm", "bpm"), &SynthSequencer::set_bpm);
+	ClassDB::bind_method(D_METHOD("get_bpm"), &SynthSequencer::get_bpm);
+	ClassDB::bind_method(D_METHOD("set_bpm_manager", "path"), &SynthSequencer::set_bpm_manager);
+	ClassDB::bind_method(D_METHOD("get_bpm_manager"), &SynthSequencer::get_bpm_manager);
+	ClassDB::bind_method(D_METHOD("set_autostart", "autostart"), &SynthSequencer::set_autostart);
+	ClassDB::bind_method(D_METHOD("get_autostart"), &SynthSequencer::get_autostart);
+	ClassDB::bind_method(D_METHOD("set_render_ahead", "seconds"), &SynthSequencer::set_render_ahead);
+	ClassDB::bind_method(D_METHOD("get_render_ahead"), &SynthSequencer::get_render_ahead);
+	ClassDB::bind_method(D_METHOD("get_render_ahead_underruns"), &SynthSequencer::get_render_ahead_underruns);
+
+	ClassDB::bind_method(D_METHOD("start_pattern"), &SynthSequencer::start_pattern);
+	ClassDB::bind_method(D_METHOD("stop_pattern"), &SynthSequencer::stop_pattern);
+	ClassDB::bind_method(D_METHOD("is_pattern_playing"), &SynthSequencer::is_pattern_playing);
+	ClassDB::bind_method(D_METHOD("get_position"), &SynthSequencer::get_position);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "configuration", PROPERTY_HINT_RESOURCE_TYPE, "SynthConfiguration"), "set_configuration", "get_configuration");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "polyphony", PROPERTY_HINT_RANGE, "1,32,1"), "set_polyphony", "get_polyphony");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_FLOAT32_ARRAY, "pattern"), "set_pattern", "get_pattern");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "pattern_steps", PROPERTY_HINT_RANGE, "1,256,1"), "set_pattern_steps", "get_pattern_steps");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "steps_per_beat", PROPERTY_HINT_RANGE, "1,16,1"), "set_steps_per_beat", "get_steps_per_beat");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "swing", PROPERTY_HINT_RANGE, "0,0.5,0.01"), "set_swing", "get_swing");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "looping"), "set_looping", "get_looping");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "bpm", PROPERTY_HINT_RANGE, "20,400,0.1"), "set_bpm", "get_bpm");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "bpm_manager", PROPERTY_HINT_NODE_PATH_VALID_TYPES, "BPMManager"), "set_bpm_manager", "get_bpm_manager");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "autostart"), "set_autostart", "get_autostart");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "render_ahead", PROPERTY_HINT_RANGE, "0,1,0.01,or_greater,suffix:s"), "set_render_ahead", "get_render_ahead");
+
+	BIND_CONSTANT(EVENT_STRIDE);
+}
+
+SynthSequencer::SynthSequencer() :
+		sample_rate(44100.0f) {
+	stream.instantiate();
+	sample_rate = AudioServer::get_singleton()->get_mix_rate();
+	stream->set_mix_rate(sample_rate);
+	voices.set_sample_rate(sample_rate);
+
+	schedule = std::make_shared<Schedule>(sample_rate);
+	schedule->set_bpm(bpm);
+	publish_pattern();
+
+	worker.instantiate();
+}
+
+SynthSequencer::~SynthSequencer() {
+	// The playback may outlive the node, it drops the schedule and keeps its voices
+	worker->stop();
+	detach_schedule();
+	if (playback.is_valid()) {
+		playback->set_render_ahead(nullptr);
+	}
+}
+
+void SynthSequencer::_ready() {
+	set_stream(stream);
+	voices.set_ready(true);
+
+	play();
+	voices.initialize_voice_pool();
+	publish_pool();
+
+	// Before the first playback is taken, so the schedule starts out on the right driver
+	apply_render_ahead();
+	acquire_playback();
+
+	if (autostart) {
+		start_pattern();
+	}
+}
+
+void SynthSequencer::_process(double delta) {
+	// Publish a voice pool once its background build is done
+	voices.poll_voice_pool_rebuild(false);
+	voices.update_effects();
+	publish_pool();
+	acquire_playback();
+	schedule->collect();
+
+	if (!bpm_manager.is_empty()) {
+		BPMManager *manager = Object::cast_to<BPMManager>(get_node_or_null(bpm_manager));
+		if (manager != nullptr) {
+			schedule->set_bpm(manager->get_bpm());
+		}
+	}
+}
+
+bool SynthSequencer::acquire_playback() {
+	if (!has_stream_playback()) {
+		return false;
+	}
+
+	// Playing again creates a new playback, the schedule or the ring moves to it
+	Ref<SynthAudioStreamPlayback> current = Object::cast_to<SynthAudioStreamPlayback>(get_stream_playback().ptr());
+	if (current != playback) {
+		if (playback.is_valid()) {
+			playback->set_render_ahead(nullptr);
+		}
+		bool drives = driver.is_valid() && driver == playback;
+		playback = current;
+		if (playback.is_valid() && ring) {
+			playback->set_render_ahead(ring);
+		} else if (playback.is_valid() && (drives || !driver.is_valid())) {
+			// The old playback stopped and renders no more, its voices can go straight to the new one
+			detach_schedule();
+			attach_schedule(playback);
+		}
+	}
+	return playback.is_valid();
+}
+
+void SynthSequencer::detach_schedule() {
+	if (!driver.is_valid()) {
+		return;
+	}
+
+	// set_scheduler() returns once the driver's thread is done with the schedule, after
+	// that the node may touch its notes
+	driver->set_scheduler(nullptr);
+	schedule->release_sounding(**driver);
+	driver.unref();
+}
+
+void SynthSequencer::attach_schedule(const Ref<SynthAudioStreamPlayback> &p_driver) {
+	driver = p_driver;
+	if (driver.is_valid()) {
+		driver->set_scheduler(schedule);
+	}
+}
+
+void SynthSequencer::apply_render_ahead() {
+	worker->stop();
+	if (playback.is_valid()) {
+		playback->set_render_ahead(nullptr);
+	}
+	ring.reset();
+
+	Ref<SynthAudioStreamPlayback> next = playback;
+	if (render_ahead > 0.0f) {
+		// The renderer is never attached to the audio server, only the worker mixes it
+		if (!renderer.is_valid()) {
+			renderer.instantiate();
+			renderer->set_sample_rate(sample_rate);
+		}
+		next = renderer;
+	}
+
+	if (next != driver) {
+		// Voices the previous driver still renders, release tails included, must not be
+		// started on another thread. The schedule goes on with a fresh pool, and picks up
+		// the pattern again once it is built. published_pool keeps the old one, so
+		// publish_pool() waits for the new one.
+		if (driver.is_valid()) {
+			schedule->set_pool(nullptr);
+			voices.request_voice_pool_rebuild();
+		}
+		detach_schedule();
+		attach_schedule(next);
+	}
+
+	if (next.is_valid() && next == renderer) {
+		int frames = MAX(static_cast<int>(render_ahead * sample_rate), RenderAheadWorker::CHUNK_FRAMES * 2);
+		ring = std::make_shared<RenderAheadRing>(frames);
+		worker->start(renderer, ring);
+		if (playback.is_valid()) {
+			playback->set_render_ahead(ring);
+		}
+	}
+}
+
+void SynthSequencer::publish_pool() {
+	std::shared_ptr<const SynthPlayerVoices::VoicePool> pool = voices.get_voice_pool();
+	if (pool != published_pool) {
+		published_pool = pool;
+		schedule->set_pool(pool);
+	}
+}
+
+void SynthSequencer::publish_pattern() {
+	std::shared_ptr<Pattern> snapshot = std::make_shared<Pattern>();
+	snapshot->length = pattern_steps;
+	snapshot->looping = looping;
+	snapshot->steps_per_beat = steps_per_beat;
+
+	const float *data = pattern.ptr();
+	int count = pattern.size() / EVENT_STRIDE;
+	snapshot->events.reserve(count);
+	for (int i = 0; i < count; i++) {
+		const float *values = data + i * EVENT_STRIDE;
+		double step = values[0];
+		if (step < 0.0 || step >= pattern_steps) {
+			continue;
+		}
+
+		// Swing pushes the off-beat steps late, at most to the end of the loop
+		Event event;
+		event.time = step;
+		if (static_cast<int64_t>(Math::floor(step)) % 2 == 1) {
+			event.time = MIN(step + swing, snapshot->length);
+		}
+		event.note = static_cast<int>(values[1]);
+		event.velocity = CLAMP(values[2], 0.0f, 1.0f);
+		event.articulation = values[3];
+		event.length = MAX(values[4], 0.0f);
+		snapshot->events.push_back(event);
+	}
+	std::stable_sort(snapshot->events.begin(), snapshot->events.end(), [](const Event &a, const Event &b) {
+		return a.time < b.time;
+	});
+
+	schedule->set_pattern(snapshot);
+}
+
+void SynthSequencer::set_configuration(const Ref<SynthConfiguration> &p_config) {
+	if (p_config.is_valid()) {
+		set_bus(p_config->get_output_bus());
+	}
+	voices.set_configuration(p_config);
+}
+
+Ref<SynthConfiguration> SynthSequencer::get_configuration() const {
+	return voices.get_configuration();
+}
+
+void SynthSequencer::set_polyphony(int p_polyphony) {
+	voices.set_polyphony(p_polyphony);
+}
+
+int SynthSequencer::get_polyphony() const {
+	return voices.get_polyphony();
+}
+
+void SynthSequencer::set_pattern(const PackedFloat32Array &p_pattern) {
+	pattern = p_pattern;
+	publish_pattern();
+}
+
+PackedFloat32Array SynthSequencer::get_pattern() const {
+	return pattern;
+}
+
+void SynthSequencer::set_pattern_steps(int p_steps) {
+	pattern_steps = MAX(p_steps, 1);
+	publish_pattern();
+}
+
+int SynthSequencer::get_pattern_steps() const {
+	return pattern_steps;
+}
+
+void SynthSequencer::set_steps_per_beat(int p_steps) {
+	steps_per_beat = MAX(p_steps, 1);
+	publish_pattern();
+}
+
+int SynthSequencer::get_steps_per_beat() const {
+	return steps_per_beat;
+}
+
+void SynthSequencer::set_swing(float p_swing) {
+	swing = CLAMP(p_swing, 0.0f, 0.5f);
+	publish_pattern();
+}
+
+float SynthSequencer::get_swing() const {
+	return swing;
+}
+
+void SynthSequencer::set_looping(bool p_looping) {
+	looping = p_looping;
+	publish_pattern();
+}
+
+bool SynthSequencer::get_looping() const {
+	return looping;
+}
+
+void SynthSequencer::set_bpm(float p_bpm) {
+	if (p_bpm <= 0.0f) {
+		return;
+	}
+	bpm = p_bpm;
+	schedule->set_bpm(bpm);
+}
+
+float SynthSequencer::get_bpm() const {
+	return bpm;
+}
+
+void SynthSequencer::set_bpm_manager(const NodePath &p_path) {
+	bpm_manager = p_path;
+
+	// Back to the sequencer's own tempo until the manager is found
+	schedule->set_bpm(bpm);
+}
+
+NodePath SynthSequencer::get_bpm_manager() const {
+	return bpm_manager;
+}
+
+void SynthSequencer::set_autostart(bool p_autostart) {
+	autostart = p_autostart;
+}
+
+bool SynthSequencer::get_autostart() const {
+	return autostart;
+}
+
+void SynthSequencer::set_render_ahead(float p_seconds) {
+	float seconds = Math::clamp(p_seconds, 0.0f, 2.0f);
+	if (seconds == render_ahead) {
+		return;
+	}
+	render_ahead = seconds;
+
+	// Before _ready the playback doesn't exist yet, _ready applies it
+	if (is_inside_tree()) {
+		apply_render_ahead();
+	}
+}
+
+float SynthSequencer::get_render_ahead() const {
+	return render_ahead;
+}
+
+int SynthSequencer::get_render_ahead_underruns() const {
+	return ring ? static_cast<int>(ring->get_underrun_count()) : 0;
+}
+
+void SynthSequencer::start_pattern() {
+	if (is_inside_tree() && !is_playing()) {
+		play();
+	}
+	acquire_playback();
+	schedule->restart();
+}
+
+void SynthSequencer::stop_pattern() {
+	schedule->set_running(false);
+}
+
+bool SynthSequencer::is_pattern_playing() const {
+	return schedule->is_running();
+}
+
+double SynthSequencer::get_position() const {
+	return schedule->get_position();
+}
+
+} // namespace godot
@@ -1,16 +1,205 @@
-// // C++ (GDExtension) - Core Sequencer
-// #include <godot_cpp/classes/ref_counted.hpp>
-// #include ""
-// namespace godot {
+#pragma once
+#include "../core/audio_handoff.h"
+#include "../core/render_ahead_worker.h"
+#include "../core/synth_audio_stream.h"
+#include "../core/synth_audio_stream_playback.h"
+#include "../core/synth_player_voices.h"
+#include <godot_cpp/classes/audio_stream_player.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
 
-// class Sequencer : public RefCounted {
+namespace godot {
 
-//     GDCLASS(Sequencer, RefCounted);
+class SynthConfiguration;
 
-//     std::vector<NoteEvent> timeline;
+// Plays a looping pattern of notes on the audio clock.
+// The pattern is a flat PackedFloat32Array, EVENT_STRIDE values per note: step, MIDI
+// note, velocity, articulation and length in steps. Steps may be fractional. Notes start
+// and stop on the audio thread between rendered segments, on the exact frame their step
+// falls on, so timing doesn't depend on the frame rate and GDScript never sees a note.
+// The tempo comes from bpm, or from a BPMManager when bpm_manager points at one.
+// With render_ahead above 0 the pattern renders on a worker thread instead, see
+// apply_render_ahead().
+class SynthSequencer : public AudioStreamPlayer {
+	GDCLASS(SynthSequencer, AudioStreamPlayer);
 
-// public:
-// 	void add_note(double time, const MusicNote &note);
-// 	void process(double current_time); // Sends MIDI/audio events
-// };
-// } //namespace godot
\ No newline at end of file
+public:
+	static constexpr int EVENT_STRIDE = 5;
+
+private:
+	// One note of the pattern, in steps from the start of the loop, swing applied
+	struct Event {
+		double time = 0.0;
+		double length = 1.0;
+		int note = 60;
+		float velocity = 1.0f;
+		float articulation = 1.0f;
+	};
+
+	// What the audio thread plays. Snapshots are never modified once published, an edit
+	// builds a new one.
+	struct Pattern {
+		std::vector<Event> events; // Sorted by time
+		double length = 16.0;
+		bool looping = true;
+		int steps_per_beat = 4;
+	};
+
+	// The audio thread side, owned by the playback as its scheduler
+	class Schedule : public SynthAudioStreamPlayback::Scheduler {
+		struct SoundingNote {
+			Ref<SynthVoice> voice;
+			Ref<SynthNoteContext> context;
+			double on_position = 0.0;
+			double off_position = 0.0;
+		};
+
+		// Written by the node, read in fire(). Replaced snapshots go back to the node to be
+		// freed, see collect().
+		AudioHandoff<const Pattern> patterns;
+		AudioHandoff<const SynthPlayerVoices::VoicePool> pools;
+		std::atomic<float> bpm{ 120.0f };
+		std::atomic<bool> running{ false };
+		std::atomic<uint32_t> start_serial{ 0 };
+		std::atomic<double> reported_position{ 0.0 };
+
+		// Audio thread only
+		float sample_rate = 44100.0f;
+		const Pattern *pattern = nullptr;
+		const SynthPlayerVoices::VoicePool *pool = nullptr;
+		uint32_t played_serial = 0;
+		bool playing = false;
+		double position = 0.0; // Steps since start_pattern(), loops included
+		double frames_per_step = 0.0;
+		int64_t loop_index = 0;
+		int next_event = 0;
+		int next_voice_index = 0;
+		std::vector<SoundingNote> sounding; // Unordered
+
+		void seek();
+		void release_all();
+		void remove_sounding(size_t p_index);
+		void start_note(SynthAudioStreamPlayback &p_playback, const Event &p_event, double p_on_position);
+		double get_next_on_position() const;
+
+	public:
+		static constexpr int MAX_SOUNDING = 64;
+
+		explicit Schedule(float p_sample_rate);
+
+		void set_pattern(const std::shared_ptr<const Pattern> &p_pattern);
+		void set_pool(const std::shared_ptr<const SynthPlayerVoices::VoicePool> &p_pool);
+		void collect();
+
+		// Release the notes still sounding on p_driver, the playback that fired them, and
+		// forget them. Main thread, only while no playback fires the schedule.
+		void release_sounding(SynthAudioStreamPlayback &p_driver);
+		void set_bpm(float p_bpm);
+		void set_running(bool p_running);
+		void restart();
+		bool is_running() const;
+		double get_position() const;
+
+		virtual int fire(SynthAudioStreamPlayback &p_playback, int p_max_frames) override;
+		virtual void advance(int p_frames) override;
+	};
+
+	Ref<SynthAudioStream> stream;
+	Ref<SynthAudioStreamPlayback> playback;
+	float sample_rate;
+
+	// Voice pool, rebuilt in the background when the configuration or polyphony changes
+	SynthPlayerVoices voices;
+	std::shared_ptr<Schedule> schedule;
+	std::shared_ptr<const SynthPlayerVoices::VoicePool> published_pool;
+
+	PackedFloat32Array pattern;
+	int pattern_steps = 16;
+	int steps_per_beat = 4;
+	float swing = 0.0f;
+	bool looping = true;
+	float bpm = 120.0f;
+	NodePath bpm_manager;
+	bool autostart = false;
+
+	// Render ahead: the schedule drives a playback of its own on the worker, and the audio
+	// thread only reads the ring it fills
+	float render_ahead = 0.0f;
+	Ref<SynthAudioStreamPlayback> renderer;
+	std::shared_ptr<RenderAheadRing> ring;
+	Ref<RenderAheadWorker> worker;
+
+	// The playback firing the schedule, playback or renderer
+	Ref<SynthAudioStreamPlayback> driver;
+
+	void publish_pattern();
+	void publish_pool();
+	bool acquire_playback();
+	void apply_render_ahead();
+	void detach_schedule();
+	void attach_schedule(const Ref<SynthAudioStreamPlayback> &p_driver);
+
+protected:
+	static void _bind_methods();
+
+public:
+	SynthSequencer();
+	~SynthSequencer();
+
+	void _ready() override;
+	virtual void _process(double delta) override;
+
+	void set_configuration(const Ref<SynthConfiguration> &p_config);
+	Ref<SynthConfiguration> get_configuration() const;
+
+	void set_polyphony(int p_polyphony);
+	int get_polyphony() const;
+
+	// Pattern data, EVENT_STRIDE floats per note
+	void set_pattern(const PackedFloat32Array &p_pattern);
+	PackedFloat32Array get_pattern() const;
+
+	// Loop length in steps, notes starting past it are left out
+	void set_pattern_steps(int p_steps);
+	int get_pattern_steps() const;
+
+	void set_steps_per_beat(int p_steps);
+	int get_steps_per_beat() const;
+
+	// Delay of every odd step, as a fraction of a step. About 0.33 gives a triplet feel.
+	void set_swing(float p_swing);
+	float get_swing() const;
+
+	void set_looping(bool p_looping);
+	bool get_looping() const;
+
+	// Tempo used while no BPMManager is set
+	void set_bpm(float p_bpm);
+	float get_bpm() const;
+
+	void set_bpm_manager(const NodePath &p_path);
+	NodePath get_bpm_manager() const;
+
+	void set_autostart(bool p_autostart);
+	bool get_autostart() const;
+
+	// Seconds of music rendered ahead on a worker thread, 0 renders it in the audio
+	// callback. Starts, stops and tempo changes are heard this much later.
+	void set_render_ahead(float p_seconds);
+	float get_render_ahead() const;
+
+	// Blocks the audio thread found the render ahead ring short
+	int get_render_ahead_underruns() const;
+
+	// Play the pattern from its first step, or stop it and release its notes
+	void start_pattern();
+	void stop_pattern();
+	bool is_pattern_playing() const;
+
+	// Steps played since start_pattern(), as of the last mixed block
+	double get_position() const;
+};
+
+} // namespace godot
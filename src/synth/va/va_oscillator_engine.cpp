@@ -1,4 +1,5 @@
 #include "va_oscillator_engine.h"
+#include "../core/dsp_math.h"
 #include "../core/modulated_parameter.h"
 #include "../core/synth_note_context.h"
 #include "../core/wave_helper_cache.h"
@@ -42,7 +43,7 @@ VAOscillatorEngine::~VAOscillatorEngine() {
 
 float VAOscillatorEngine::get_frequency_for_note(int note) const {
 	// A4 = 440Hz = MIDI note 69
-	return 440.0f * std::pow(2.0f, (note - 69) / 12.0f);
+	return DspMath::note_to_frequency(static_cast<float>(note));
 }
 
 float VAOscillatorEngine::get_morphed_sample(float p_phase, float morph_position, float pulse_width) const {
@@ -88,21 +89,17 @@ Dictionary VAOscillatorEngine::get_parameters() const {
 	return parameters;
 }
 
-PackedFloat32Array VAOscillatorEngine::process_block(int buffer_size, const Ref<SynthNoteContext> &context) {
-	// Create output buffer
-	PackedFloat32Array output_buffer;
-	output_buffer.resize(buffer_size);
-
+bool VAOscillatorEngine::render_block(float *p_output, int p_count, double p_start_time, const Ref<SynthNoteContext> &context) {
 	if (!context.is_valid()) {
 		// Fill buffer with silence
-		std::fill(output_buffer.ptrw(), output_buffer.ptrw() + buffer_size, 0.0f);
-		return output_buffer;
+		std::fill(p_output, p_output + p_count, 0.0f);
+		return false;
 	}
 
 	// If no note is playing, return silence
 	if (context->get_note() < 0 || context->get_velocity() <= 0.0f) {
-		std::fill(output_buffer.ptrw(), output_buffer.ptrw() + buffer_size, 0.0f);
-		return output_buffer;
+		std::fill(p_output, p_output + p_count, 0.0f);
+		return false;
 	}
 
 	// Calculate frequency for the current note
@@ -115,7 +112,7 @@ PackedFloat32Array VAOscillatorEngine::process_block(int buffer_size, const Ref<
 			float pitch_offset = pitch_param->get_value(context);
 			// Convert semitone offset to frequency multiplier
 			// Each semitone is a factor of 2^(1/12)
-			float pitch_multiplier = std::pow(2.0f, pitch_offset / 12.0f);
+			float pitch_multiplier = DspMath::semitones_to_ratio(pitch_offset);
 			frequency *= pitch_multiplier;
 		}
 	}
@@ -124,7 +121,7 @@ PackedFloat32Array VAOscillatorEngine::process_block(int buffer_size, const Ref<
 
 	// Calculate time increment per sample
 	double time_increment = 1.0 / sample_rate;
-	double current_time = context->get_absolute_time();
+	double current_time = p_start_time;
 
 	// Pre-fetch parameter values for the first sample
 	// We'll update these periodically rather than every sample
@@ -159,9 +156,9 @@ PackedFloat32Array VAOscillatorEngine::process_block(int buffer_size, const Ref<
 	
 	// How often to update modulation values (every N samples)
 	const int mod_update_rate = 8; // Update every 8 samples
-	
+
 	// Generate audio samples
-	for (int i = 0; i < buffer_size; i++) {
+	for (int i = 0; i < p_count; i++) {
 		// Update context time for this sample
 		context->update_time(current_time);
 
@@ -195,12 +192,7 @@ PackedFloat32Array VAOscillatorEngine::process_block(int buffer_size, const Ref<
 		// Get the morphed waveform sample using cached values
 		float sample = get_morphed_sample(phase, cached_morph_position, cached_pulse_width);
 		// Apply amplitude (including ADSR envelope)
-		float output_sample = sample * cached_amplitude * context->get_velocity();
-		// Apply effects if available
-		if (effect_chain.is_valid()) {
-			output_sample = effect_chain->process_sample(output_sample, context);
-		}
-		output_buffer[i] = output_sample;
+		p_output[i] = sample * cached_amplitude * context->get_velocity();
 
 		// Increment phase
 		phase += phase_increment;
@@ -212,7 +204,7 @@ PackedFloat32Array VAOscillatorEngine::process_block(int buffer_size, const Ref<
 		current_time += time_increment;
 	}
 
-	return output_buffer;
+	return true;
 }
 
 void VAOscillatorEngine::reset() {
@@ -223,6 +215,10 @@ void VAOscillatorEngine::reset() {
 	AudioStreamGeneratorEngine::reset();
 }
 
+bool VAOscillatorEngine::is_deterministic() const {
+	return bottom_waveform != WaveHelper::NOISE && middle_waveform != WaveHelper::NOISE && top_waveform != WaveHelper::NOISE;
+}
+
 Ref<AudioStreamGeneratorEngine> VAOscillatorEngine::duplicate() const {
 	Ref<VAOscillatorEngine> new_engine = memnew(VAOscillatorEngine);
 
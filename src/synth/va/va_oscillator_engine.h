@@ -50,8 +50,9 @@ public:
 	virtual Dictionary get_parameters() const override;
 
 	// Override base methods
-	virtual PackedFloat32Array process_block(int buffer_size, const Ref<SynthNoteContext> &context) override;
+	virtual bool render_block(float *p_output, int p_count, double p_start_time, const Ref<SynthNoteContext> &context) override;
 	virtual void reset() override;
+	virtual bool is_deterministic() const override;
 	
 	// Create a duplicate of this engine
 	virtual Ref<AudioStreamGeneratorEngine> duplicate() const override;
@@ -97,33 +97,26 @@ VASynthConfiguration::~VASynthConfiguration() {
 }
 
 Ref<AudioStreamGeneratorEngine> VASynthConfiguration::create_engine() const {
-	// Create a VA engine instance
-	Ref<VAOscillatorEngine> engine = memnew(VAOscillatorEngine);
+	Ref<AudioStreamGeneratorEngine> engine = instantiate_engine();
 
 	// Set the sample rate
 	engine->set_sample_rate(44100.0f); // Use a default sample rate
 
-	// Configure the engine with our parameters
+	// Transfer all parameters and the effect chain to the engine
+	engine->build_modulation_graph(get_parameters(), get_effect_chain());
+
+	return engine;
+}
+
+Ref<AudioStreamGeneratorEngine> VASynthConfiguration::instantiate_engine() const {
+	// Create a VA engine instance
+	Ref<VAOscillatorEngine> engine = memnew(VAOscillatorEngine);
+
+	// Configure the engine with our oscillator settings
 	engine->set_bottom_waveform(bottom_waveform);
 	engine->set_middle_waveform(middle_waveform);
 	engine->set_top_waveform(top_waveform);
 
-	// Transfer all parameters to the engine
-	Dictionary params = get_parameters();
-	Array param_names = params.keys();
-	for (int i = 0; i < param_names.size(); i++) {
-		String name = param_names[i];
-		Ref<ModulatedParameter> param = static_cast<Ref<ModulatedParameter>>(params[name])->duplicate();
-		if (param.is_valid()) {
-			engine->set_parameter(name, param);
-		}
-	}
-
-	// Set effect chain if available
-	if (get_effect_chain().is_valid()) {
-		engine->set_effect_chain(get_effect_chain()->duplicate());
-	}
-
 	return engine;
 }
 
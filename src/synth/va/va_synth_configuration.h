@@ -32,6 +32,7 @@ public:
 
 	// Implementation of the abstract method
 	virtual Ref<AudioStreamGeneratorEngine> create_engine() const override;
+	virtual Ref<AudioStreamGeneratorEngine> instantiate_engine() const override;
 
 	// Waveform setters/getters
 	void set_bottom_waveform(WaveHelper::WaveType p_type);
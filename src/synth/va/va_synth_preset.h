@@ -322,6 +322,7 @@ public:
 
 		// Add reverb for a more polished sound
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.2f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -569,6 +570,7 @@ public:
 
 		// Add reverb for spaciousness
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.8f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -661,6 +663,7 @@ public:
 
 		// Add reverb for space
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.3f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -735,6 +738,7 @@ public:
 
 		// Add reverb for wet sound
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.4f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -934,6 +938,7 @@ public:
 
 		// Add reverb for size
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.9f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -1019,6 +1024,7 @@ public:
 
 		// Add reverb for echo
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.7f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -1301,6 +1307,7 @@ public:
 
 		// Add reverb for space
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.9f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
@@ -1499,6 +1506,7 @@ public:
 
 		// Add reverb for space
 		Ref<Reverb> reverb = memnew(Reverb);
+		reverb->set_algorithm(Reverb::ALGORITHM_FEEDBACK_DELAY_NETWORK);
 		Ref<ModulatedParameter> room_size = memnew(ModulatedParameter);
 		room_size->set_base_value(0.3f);
 		reverb->set_parameter(Reverb::PARAM_ROOM_SIZE, room_size);
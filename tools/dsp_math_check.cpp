@@ -0,0 +1,170 @@
+// Accuracy table and microbenchmark for DspMath.
+// Standalone, not part of the SCons build. From the repository root:
+//
+//   g++ -std=c++17 -O3 -march=native tools/dsp_math_check.cpp -o dsp_math_check
+//   ./dsp_math_check
+//
+// Every function is swept over the range listed in the dsp_math.h header and compared
+// against the double precision std version. The program exits with 1 if any error is
+// above its limit, which is the figure from the header table with a little headroom.
+// The timings compare the block versions against the same loop over the std functions.
+// Do not build with -ffast-math, DspMath relies on the exact float rounding.
+
+#include "../src/synth/core/dsp_math.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using godot::DspMath;
+
+namespace {
+
+constexpr int SWEEP_POINTS = 1 << 22;
+constexpr double PI = 3.14159265358979323846;
+
+struct Check {
+	const char *name;
+	const char *range;
+	bool relative;
+	double limit;
+};
+
+int failures = 0;
+
+// Worst error of p_fast against p_exact over [p_low, p_high]
+template <typename Fast, typename Exact>
+void sweep(const Check &p_check, double p_low, double p_high, Fast p_fast, Exact p_exact) {
+	double worst = 0.0;
+	double worst_at = p_low;
+	for (int i = 0; i <= SWEEP_POINTS; i++) {
+		float x = static_cast<float>(p_low + (p_high - p_low) * i / SWEEP_POINTS);
+		double exact = p_exact(static_cast<double>(x));
+		double error = std::fabs(static_cast<double>(p_fast(x)) - exact);
+		if (p_check.relative) {
+			error /= std::fabs(exact);
+		}
+		if (!(error <= worst)) {
+			worst = error;
+			worst_at = x;
+		}
+	}
+
+	bool ok = worst <= p_check.limit;
+	failures += ok ? 0 : 1;
+	std::printf("  %-18s %-20s %-9s %9.2e  (limit %.1e, worst at %g)%s\n", p_check.name, p_check.range,
+			p_check.relative ? "relative" : "absolute", worst, p_check.limit, worst_at, ok ? "" : "  FAIL");
+}
+
+// Inputs far outside the polynomial range must saturate instead of wrapping
+bool saturates_to(float p_value, double p_limit) {
+	return std::fabs(p_value - p_limit) <= 1e-6 * p_limit;
+}
+
+void check_saturation() {
+	const double low = std::ldexp(1.0, -125);
+	const double high = std::ldexp(1.0, 127);
+	const float inputs[] = { -1e30f, -1e7f, -4194304.0f, -200.0f, -126.0f, 127.5f, 200.0f, 4194304.0f, 1e7f, 1e30f };
+	for (float x : inputs) {
+		float value = DspMath::exp2(x);
+		bool ok = saturates_to(value, x < 0.0f ? low : high);
+		failures += ok ? 0 : 1;
+		std::printf("  exp2(%-8g) = %-12g%s\n", x, value, ok ? "" : "  FAIL");
+	}
+
+	float e = DspMath::exp(-1e7f);
+	bool ok = saturates_to(e, low);
+	failures += ok ? 0 : 1;
+	std::printf("  exp(-1e7)      = %-12g%s\n", e, ok ? "" : "  FAIL");
+}
+
+volatile float sink;
+
+// Nanoseconds per value for a block function over p_input
+template <typename Block>
+double time_block(const std::vector<float> &p_input, Block p_block) {
+	constexpr int ROUNDS = 2000;
+	std::vector<float> output(p_input.size());
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < ROUNDS; r++) {
+		p_block(p_input.data(), output.data(), static_cast<int>(p_input.size()));
+		sink = output[r % output.size()];
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / (static_cast<double>(ROUNDS) * p_input.size());
+}
+
+template <typename Fast, typename Std>
+void bench(const char *p_name, float p_low, float p_high, Fast p_fast, Std p_std) {
+	std::vector<float> input(4096);
+	for (size_t i = 0; i < input.size(); i++) {
+		input[i] = p_low + (p_high - p_low) * static_cast<float>(i) / input.size();
+	}
+	double fast = time_block(input, p_fast);
+	double reference = time_block(input, p_std);
+	std::printf("  %-12s %7.3f ns  std %7.3f ns  %5.1fx\n", p_name, fast, reference, reference / fast);
+}
+
+} // namespace
+
+int main() {
+	std::printf("Accuracy against double precision:\n");
+	sweep({ "exp2(x)", "x in [-125, 127]", true, 3e-7 }, -125.0, 127.0,
+			[](float x) { return DspMath::exp2(x); }, [](double x) { return std::exp2(x); });
+	sweep({ "exp(x)", "x in [-10, 10]", true, 8e-7 }, -10.0, 10.0,
+			[](float x) { return DspMath::exp(x); }, [](double x) { return std::exp(x); });
+	sweep({ "log2(x)", "x in [0.5, 2]", false, 2e-7 }, 0.5, 2.0,
+			[](float x) { return DspMath::log2(x); }, [](double x) { return std::log2(x); });
+	sweep({ "log2(x)", "x in [1e-6, 1e6]", false, 1.2e-6 }, 1e-6, 1e6,
+			[](float x) { return DspMath::log2(x); }, [](double x) { return std::log2(x); });
+	sweep({ "tanh(x)", "x in [-20, 20]", false, 2e-7 }, -20.0, 20.0,
+			[](float x) { return DspMath::tanh(x); }, [](double x) { return std::tanh(x); });
+	sweep({ "sin_turns(x)", "x in [-1, 1]", false, 3e-7 }, -1.0, 1.0,
+			[](float x) { return DspMath::sin_turns(x); }, [](double x) { return std::sin(2.0 * PI * x); });
+	sweep({ "sin(x)", "x in [-pi, pi]", false, 4e-7 }, -PI, PI,
+			[](float x) { return DspMath::sin(x); }, [](double x) { return std::sin(x); });
+	sweep({ "cos(x)", "x in [-pi, pi]", false, 4e-7 }, -PI, PI,
+			[](float x) { return DspMath::cos(x); }, [](double x) { return std::cos(x); });
+	sweep({ "note_to_frequency", "notes 0 to 127", true, 7e-7 }, 0.0, 127.0,
+			[](float x) { return DspMath::note_to_frequency(x); }, [](double x) { return 440.0 * std::exp2((x - 69.0) / 12.0); });
+	sweep({ "cents_to_ratio", "+-2400 cents", true, 4e-7 }, -2400.0, 2400.0,
+			[](float x) { return DspMath::cents_to_ratio(x); }, [](double x) { return std::exp2(x / 1200.0); });
+	sweep({ "db_to_gain", "-120 to 24 dB", true, 1e-6 }, -120.0, 24.0,
+			[](float x) { return DspMath::db_to_gain(x); }, [](double x) { return std::pow(10.0, x / 20.0); });
+	sweep({ "gain_to_db", "gain 1e-5 to 16", true, 4e-7 }, 1e-5, 16.0,
+			[](float x) { return DspMath::gain_to_db(x); }, [](double x) { return 20.0 * std::log10(x); });
+
+	std::printf("\nSaturation:\n");
+	check_saturation();
+
+	std::printf("\nBlocks of 4096 values, time per value:\n");
+	bench("exp2", -20.0f, 20.0f, DspMath::exp2_block, [](const float *in, float *out, int n) {
+		for (int i = 0; i < n; i++) {
+			out[i] = std::exp2(in[i]);
+		}
+	});
+	bench("log2", 1e-3f, 1e3f, DspMath::log2_block, [](const float *in, float *out, int n) {
+		for (int i = 0; i < n; i++) {
+			out[i] = std::log2(in[i]);
+		}
+	});
+	bench("tanh", -4.0f, 4.0f, DspMath::tanh_block, [](const float *in, float *out, int n) {
+		for (int i = 0; i < n; i++) {
+			out[i] = std::tanh(in[i]);
+		}
+	});
+	bench("sin_turns", -1.0f, 1.0f, DspMath::sin_turns_block, [](const float *in, float *out, int n) {
+		for (int i = 0; i < n; i++) {
+			out[i] = std::sin(static_cast<float>(2.0 * PI) * in[i]);
+		}
+	});
+	bench("db_to_gain", -120.0f, 24.0f, DspMath::db_to_gain_block, [](const float *in, float *out, int n) {
+		for (int i = 0; i < n; i++) {
+			out[i] = std::pow(10.0f, in[i] * 0.05f);
+		}
+	});
+
+	std::printf("\n%s\n", failures == 0 ? "All checks passed" : "Some checks failed");
+	return failures == 0 ? 0 : 1;
+}